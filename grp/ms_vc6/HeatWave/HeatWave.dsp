@@ -93,24 +93,88 @@ SOURCE=..\..\..\src\HeatWaveAVIReader.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\HeatWaveAVIWriter.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\HeatWaveBitplaneCoder.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\HeatWaveCache.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\HeatWaveComponent.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\HeatWaveDigest.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\HeatWaveEvaluator.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\HeatWaveFloatComponent.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\HeatWaveImage.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\HeatWaveImageFile.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\HeatWaveLift.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\HeatWaveLineTransform.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\HeatWaveMath.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\HeatWaveMemory.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\HeatWavePipeline.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\HeatWaveProfiler.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\HeatWaveQuantizer.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\HeatWaveResampler.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\HeatWaveStages.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\HeatWaveVideo.cpp
 # End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\HeatWaveView.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\HeatWaveWorkerPool.cpp
+# End Source File
 # End Group
 # Begin Group "Header Files"
 
@@ -141,6 +205,10 @@ SOURCE=..\..\..\inc\CommonInlines.hpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\inc\CommonThreads.hpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\inc\HeatWave.hpp
 # End Source File
 # Begin Source File
@@ -157,32 +225,96 @@ SOURCE=..\..\..\inc\HeatWaveAVIStructs.hpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\inc\HeatWaveAVIWriter.hpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\inc\HeatWaveBitplaneCoder.hpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\inc\HeatWaveCache.hpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\inc\HeatWaveComponent.hpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\inc\HeatWaveDigest.hpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\inc\HeatWaveEnums.hpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\inc\HeatWaveEvaluator.hpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\inc\HeatWaveFloatComponent.hpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\inc\HeatWaveImage.hpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\inc\HeatWaveImageFile.hpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\inc\HeatWaveLift.hpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\inc\HeatWaveLineTransform.hpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\inc\HeatWaveMath.hpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\inc\HeatWaveMemory.hpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\inc\HeatWavePipeline.hpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\inc\HeatWaveProfiler.hpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\inc\HeatWaveQuantizer.hpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\inc\HeatWaveResampler.hpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\inc\HeatWaveStages.hpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\inc\HeatWaveTypes.hpp
 # End Source File
 # Begin Source File
 
 SOURCE=..\..\..\inc\HeatWaveVideo.hpp
 # End Source File
+# Begin Source File
+
+SOURCE=..\..\..\inc\HeatWaveView.hpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\inc\HeatWaveWorkerPool.hpp
+# End Source File
 # End Group
 # End Target
 # End Project
@@ -9,12 +9,30 @@
 #ifndef __COMMONDATATYPES_HPP__
 #define __COMMONDATATYPES_HPP__
 
+#if !defined(_MSC_VER)
+#include <stdint.h>
+#endif
+
 /** 64-bit (or more) signed floating point number. */
 typedef double SFloat64;
 
 /** 32-bit signed floating point number. */
 typedef float SFloat32;
 
+#if defined(_MSC_VER)
+/** 64-bit signed integer, no stdint.h before Visual C++ 2010. */
+typedef __int64 SInt64;
+
+/** 64-bit unsigned integer. */
+typedef unsigned __int64 UInt64;
+#else
+/** 64-bit signed integer. */
+typedef int64_t SInt64;
+
+/** 64-bit unsigned integer. */
+typedef uint64_t UInt64;
+#endif
+
 /** 32-bit (or more) signed integer. */
 typedef signed int SInt;
 
@@ -14,5 +14,6 @@
 #include "CommonDataVectors.hpp"
 #include "CommonDefines.hpp"
 #include "CommonInlines.hpp"
+#include "CommonThreads.hpp"
 
 #endif  //__COMMONHEADERS_HPP__
@@ -55,4 +55,21 @@ inline void DelMatrixSFloat64(SFloat64 **& mtrx)
   mtrx = NULL;
 }
 
+/**
+ *
+ * Swap two values.
+ *
+ * @param a The one value.
+ * @param b The other value.
+ *
+ **/
+
+template <class T>
+inline void SwapValues(T & a, T & b)
+{
+  T tmp = a;
+  a = b;
+  b = tmp;
+}
+
 #endif // __COMMONINLINES_HPP__
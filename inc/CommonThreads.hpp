@@ -0,0 +1,308 @@
+/****************************************************************************/
+/**
+ ** @file   CommonThreads.hpp
+ ** @brief  Threads and atomic operations, or single threaded stand-ins.
+ ** @author Johan Hendrik Ehlers <https://github.com/johanhendrikehlers>
+ **
+ **/
+
+#ifndef __COMMONTHREADS_HPP__
+#define __COMMONTHREADS_HPP__
+
+#include "CommonIncludes.hpp"
+#include "CommonDataTypes.hpp"
+#include "CommonDefines.hpp"
+
+/****************************************************************************/
+/* -- POSIX threads, or single threaded on systems without them. Others may
+ * ask for a single threaded build with -DHEATWAVENOTHREADS. */
+#if !defined(HEATWAVENOTHREADS) && \
+  (defined(_WIN32_WCE) || defined(__SYMBIAN32__) || defined(__EPOC32__) || \
+   defined(_MSC_VER))
+#define HEATWAVENOTHREADS
+#endif
+
+#ifndef HEATWAVENOTHREADS
+
+#if !defined(__GNUC__)
+#error "Atomic operations need GCC builtins, build with -DHEATWAVENOTHREADS!"
+#endif
+
+#include <pthread.h>
+
+/** A thread. */
+typedef pthread_t CommonThread;
+
+/** A lock. */
+typedef pthread_mutex_t CommonMutex;
+
+/** A condition waited on under a lock. */
+typedef pthread_cond_t CommonCond;
+
+/** A flag to run something once. */
+typedef pthread_once_t CommonOnce;
+
+/** Initial value of a CommonMutex not set up with InitMutex(). */
+#define COMMONMUTEXINIT PTHREAD_MUTEX_INITIALIZER
+
+/** Initial value of a CommonOnce. */
+#define COMMONONCEINIT PTHREAD_ONCE_INIT
+
+/** Atomic operations by the GCC builtins, full barriers. */
+#define COMMONATOMICADD(p, v) __sync_add_and_fetch(p, v)
+#define COMMONATOMICCAS(p, o, v) __sync_bool_compare_and_swap(p, o, v)
+
+/**
+ *
+ * Start a thread.
+ *
+ * @param thr (OUT) The thread.
+ * @param fnc The function it runs.
+ * @param arg The argument of the function.
+ * @return True if started.
+ *
+ **/
+
+inline Bool StartThread(CommonThread * thr, void * (*fnc)(void *), void * arg)
+{
+  return ( pthread_create(thr, NULL, fnc, arg) == 0 );
+}
+
+/**
+ *
+ * Wait for a thread to end.
+ *
+ * @param thr The thread.
+ *
+ **/
+
+inline void JoinThread(CommonThread thr)
+{
+  pthread_join(thr, NULL);
+}
+
+/**
+ *
+ * Run a function once whatever the number of threads calling.
+ *
+ * @param once The flag, COMMONONCEINIT at first.
+ * @param fnc The function.
+ *
+ **/
+
+inline void RunOnce(CommonOnce * once, void (*fnc)(void))
+{
+  pthread_once(once, fnc);
+}
+
+inline void InitMutex(CommonMutex * mtx)
+{
+  pthread_mutex_init(mtx, NULL);
+}
+
+inline void FreeMutex(CommonMutex * mtx)
+{
+  pthread_mutex_destroy(mtx);
+}
+
+inline void LockMutex(CommonMutex * mtx)
+{
+  pthread_mutex_lock(mtx);
+}
+
+inline void UnlockMutex(CommonMutex * mtx)
+{
+  pthread_mutex_unlock(mtx);
+}
+
+inline void InitCond(CommonCond * cnd)
+{
+  pthread_cond_init(cnd, NULL);
+}
+
+inline void FreeCond(CommonCond * cnd)
+{
+  pthread_cond_destroy(cnd);
+}
+
+/**
+ *
+ * Wake one thread waiting on a condition.
+ *
+ * @param cnd The condition.
+ *
+ **/
+
+inline void SignalCond(CommonCond * cnd)
+{
+  pthread_cond_signal(cnd);
+}
+
+/**
+ *
+ * Wake all threads waiting on a condition.
+ *
+ * @param cnd The condition.
+ *
+ **/
+
+inline void BroadcastCond(CommonCond * cnd)
+{
+  pthread_cond_broadcast(cnd);
+}
+
+/**
+ *
+ * Wait on a condition, the lock is released while waiting.
+ *
+ * @param cnd The condition.
+ * @param mtx The lock, held by the caller.
+ *
+ **/
+
+inline void WaitCond(CommonCond * cnd, CommonMutex * mtx)
+{
+  pthread_cond_wait(cnd, mtx);
+}
+
+#else // HEATWAVENOTHREADS
+
+/****************************************************************************/
+/* -- Single threaded stand-ins. Locks do nothing and threads never start,
+ * so the worker pool runs jobs in the calling thread, the pipeline runs its
+ * stages in turn and the AVI reader does not read ahead. Waiting on a
+ * condition must not happen with one thread. */
+
+typedef SInt CommonThread;
+typedef SInt CommonMutex;
+typedef SInt CommonCond;
+typedef SInt CommonOnce;
+
+#define COMMONMUTEXINIT 0
+#define COMMONONCEINIT 0
+
+/** Plain operations, nothing else runs. */
+#define COMMONATOMICADD(p, v) (*(p) += (v))
+#define COMMONATOMICCAS(p, o, v)                        \
+  ((*(p) == (o)) ? ((*(p) = (v)), True) : False)
+
+inline Bool StartThread(CommonThread *, void * (*)(void *), void *)
+{
+  return False;
+}
+
+inline void JoinThread(CommonThread)
+{
+}
+
+inline void RunOnce(CommonOnce * once, void (*fnc)(void))
+{
+  if ( *once == 0 ){
+    *once = 1;
+    fnc();
+  }
+}
+
+inline void InitMutex(CommonMutex * mtx)
+{
+  *mtx = 0;
+}
+
+inline void FreeMutex(CommonMutex *)
+{
+}
+
+inline void LockMutex(CommonMutex *)
+{
+}
+
+inline void UnlockMutex(CommonMutex *)
+{
+}
+
+inline void InitCond(CommonCond * cnd)
+{
+  *cnd = 0;
+}
+
+inline void FreeCond(CommonCond *)
+{
+}
+
+inline void SignalCond(CommonCond *)
+{
+}
+
+inline void BroadcastCond(CommonCond *)
+{
+}
+
+inline void WaitCond(CommonCond *, CommonMutex *)
+{
+  ASSERT ( False );
+}
+
+#endif // HEATWAVENOTHREADS
+
+/****************************************************************************/
+/* -- Atomic operations on values shared between threads. */
+
+/**
+ *
+ * Add to a value shared between threads, an add of 0 reads it.
+ *
+ * @param ptr The value.
+ * @param val What to add.
+ * @return The new value.
+ *
+ **/
+
+inline SInt AtomicAdd(SInt * ptr, SInt val)
+{
+  return COMMONATOMICADD(ptr, val);
+}
+
+inline SInt64 AtomicAdd(SInt64 * ptr, SInt64 val)
+{
+  return COMMONATOMICADD(ptr, val);
+}
+
+/**
+ *
+ * Replace a value shared between threads if it still holds the old one.
+ *
+ * @param ptr The value.
+ * @param old The value expected.
+ * @param val The new value.
+ * @return True if replaced.
+ *
+ **/
+
+inline Bool AtomicSwap(SInt64 * ptr, SInt64 old, SInt64 val)
+{
+  return COMMONATOMICCAS(ptr, old, val);
+}
+
+inline Bool AtomicSwap(SInt ** ptr, SInt * old, SInt * val)
+{
+  return COMMONATOMICCAS(ptr, old, val);
+}
+
+/**
+ *
+ * Set a value shared between threads.
+ *
+ * @param ptr The value.
+ * @param val The new value.
+ *
+ **/
+
+inline void AtomicSet(SInt64 * ptr, SInt64 val)
+{
+  SInt64 old = AtomicAdd(ptr, (SInt64)0);
+  while ( !AtomicSwap(ptr, old, val) ){
+    old = AtomicAdd(ptr, (SInt64)0);
+  }
+}
+
+#endif // __COMMONTHREADS_HPP__
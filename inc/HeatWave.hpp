@@ -15,10 +15,29 @@
 #include "HeatWaveTypes.hpp"
 #include "HeatWaveEnums.hpp"
 #include "HeatWaveLift.hpp"
+#include "HeatWaveWorkerPool.hpp"
+#include "HeatWaveProfiler.hpp"
+#include "HeatWaveMemory.hpp"
+#include "HeatWaveView.hpp"
+
 #include "HeatWaveComponent.hpp"
+#include "HeatWaveFloatComponent.hpp"
+#include "HeatWaveLineTransform.hpp"
+#include "HeatWaveResampler.hpp"
+
+
 #include "HeatWaveImage.hpp"
 #include "HeatWaveVideo.hpp"
 #include "HeatWaveAVIReader.hpp"
+#include "HeatWaveAVIWriter.hpp"
 #include "HeatWaveAVIStructs.hpp"
+#include "HeatWavePipeline.hpp"
+#include "HeatWaveStages.hpp"
+#include "HeatWaveEvaluator.hpp"
+#include "HeatWaveDigest.hpp"
+#include "HeatWaveCache.hpp"
+#include "HeatWaveImageFile.hpp"
+#include "HeatWaveBitplaneCoder.hpp"
+#include "HeatWaveQuantizer.hpp"
 
 #endif //__HEATWAVE_HPP__
@@ -25,10 +25,38 @@
 /** Constant two cc length */
 #define TWO_CC 2
 
+/**
+ *
+ * How the samples of a frame are stored in a frame chunk.
+ *
+ **/
+
+enum EnumVideoLayout
+  {
+    /** One plane after the other in color order. */
+    LayPlanar = 0,
+
+    /** Planes in Y, V, U order. */
+    LayPlanarYVU,
+
+    /** A Y plane followed by a plane of interleaved U and V pairs. */
+    LaySemiPlanar,
+
+    /** Rows of interleaved Y0 U Y1 V quads. */
+    LayYUYV,
+
+    /** Rows of interleaved U Y0 V Y1 quads. */
+    LayUYVY,
+
+    /** Rows of B G R triplets, padded to 4 bytes, bottom row first unless
+     ** the height is negative. */
+    LayBGR
+  };
+
 /**
  *
  * A structure to associate a video type with a color space the color order,
- * and sampling ratios.
+ * sampling ratios and sample layout.
  *
  **/
 
@@ -40,6 +68,7 @@ typedef struct
   EnumColor m_order[MAXCOLORSINANYSPACE];
   SInt m_hSampling[MAXCOLORSINANYSPACE];
   SInt m_vSampling[MAXCOLORSINANYSPACE];
+  EnumVideoLayout m_layout;
 } StructCodingType;
 
 /****************************************************************************/
@@ -16,12 +16,17 @@
 #include "HeatWaveAVIStructs.hpp"
 #include "HeatWaveAVIBase.hpp"
 
+/** Size in bytes of the block the chunk headers are read through. */
+#define HEATWAVEAVIBLOCK (1 << 16)
+
 /****************************************************************************/
 /**
  ** A AVI file handling class. This class works by going thoroug the file and
- ** then constucting a tree structure which is used later to locate specific
- ** data chunks. All Avi files are made up of a tree like system consisting of
- ** chunks and lists.
+ ** then constucting a flat table of the chunks which is used later to locate
+ ** specific data chunks. All Avi files are made up of a tree like system
+ ** consisting of chunks and lists. The frame chunks in the movi list are not
+ ** put in the table, they are found through the idx1 index when there is
+ ** one, so opening a file reads little more than its headers.
  ** Order of obtaining a video or a image is to:
  ** <ol>
  ** <li> Open the file (CHECK RETURNED VALUE!)</li>
@@ -29,6 +34,9 @@
  ** <li> Get the video or image! </li>
  ** <li> Close the file </li>
  ** </ol>
+ ** Frames can be read ahead by a background (POSIX) thread, see
+ ** SetPrefetch(), so that the file is read while the previous frames are
+ ** being worked on.
  **/
 
 class HeatWaveAVIReader : public HeatWaveAVIBase
@@ -100,11 +108,13 @@ public:
    *
    * Load the video. (Loads entire video onto internal buffer, very costly!)
    *
+   * @param pack Pack each frame into 16-bit samples as it is loaded, where
+   * it fits, see HeatWaveImage::DoPack(). (False by default)
    * @return True if video loaded ok, False if not.
    *
    **/
 
-  HeatWaveVideo * LoadVideo();
+  HeatWaveVideo * LoadVideo(Bool pack = False);
 
   /**
    *
@@ -117,6 +127,42 @@ public:
   
   HeatWaveImage * LoadFrame(SInt num);
 
+  /**
+   *
+   * Start (or stop) reading frames ahead in a background thread. Frames are
+   * read in order from the frame after the last one loaded, so loading the
+   * frames in order returns them without waiting on the file once the
+   * thread is ahead. Loading any other frame restarts the read ahead after
+   * it. The file must be analysed first. Built with HEATWAVENOTHREADS
+   * frames are never read ahead.
+   *
+   * @param ahead The number of frames to read ahead, 0 or less to stop.
+   * @return True if ok, False if the thread could not be started.
+   *
+   **/
+
+  Bool SetPrefetch(SInt ahead);
+
+  /**
+   *
+   * @return The number of frames read ahead, 0 if not prefetching.
+   *
+   **/
+
+  SInt GetPrefetch() const;
+
+  /**
+   *
+   * Hand back a loaded frame that is no longer needed, its samples are
+   * reused for a later frame if it still has the layout of the video,
+   * otherwise (or if enough frames are kept already) it is deleted.
+   *
+   * @param img The frame, owned by the reader from now on.
+   *
+   **/
+
+  void DoRecycle(HeatWaveImage * img);
+
   /**
    *
    * Load the audio. (Loads entire audio track onto internal buffer.)
@@ -175,7 +221,7 @@ protected:
 
   /** 
    *
-   * Analyse the underlying file.
+   * Analyse the underlying file, filling the chunk table.
    *
    * @param file_size The file size.
    * @return True if the file is an ok avi file, false otherwise.
@@ -186,15 +232,14 @@ protected:
 
   /**
    *
-   * Analyse a certain chunk. Recursive function called from 
-   * AnalyseFileInternal().
+   * Append a chunk to the chunk table.
    *
-   * @param chk The chunk to analyse.
-   * @param max The maximum allowed size in bytes of chunk.
+   * @param chk The chunk.
+   * @return Its index in the table.
    *
    **/
 
-  Bool AnalyseChunk(DataChunk * chk, SInt max);
+  SInt DoAddChunk(const DataChunk & chk);
 
   /**
    *
@@ -202,7 +247,7 @@ protected:
    *
    * @param str The chunk name or list type.
    * @param hop The amount of time to skip.
-   * @param anl The datachunk to search in.
+   * @param anl The list to search in, NULL for the whole file.
    * @return Datachunk if found else NULL.
    *
    **/
@@ -241,17 +286,162 @@ protected:
 
   Bool GetCharacters(SInt len, char * str);
 
+  /**
+   *
+   * Get bytes from the underlying video file. Small reads are served from
+   * a block of HEATWAVEAVIBLOCK bytes, so neighbouring headers cost a
+   * single read.
+   *
+   * @param off The file offset.
+   * @param len The number of bytes.
+   * @param str The array large enough to hold the bytes.
+   * @return True if ok, false otherwise.
+   *
+   **/
+
+  Bool GetBytes(SInt off, SInt len, char * str);
+
   /**
    *
    * Get a frame from the file. Note the file should be set to read first
    * byte of underlying frame.
    *
    * @param actSize The actual size of the underlying data vector.
-   * @return True if all went ok, False otherwise.
+   * @param reuse A recycled frame to read into, NULL to create one. It is
+   * deleted if it does not fit.
+   * @return The frame, NULL on error.
+   *
+   **/
+
+  HeatWaveImage * GetFrame(SInt actSize, HeatWaveImage * reuse = NULL);
+
+  /**
+   *
+   * Seek to and read a frame, using the frame table.
+   *
+   * @param num The frame number, in range.
+   * @param reuse A recycled frame to read into, NULL to create one.
+   * @return The frame, NULL on error.
    *
    **/
 
-  HeatWaveImage * GetFrame(SInt actSize);
+  HeatWaveImage * GetFrameAt(SInt num, HeatWaveImage * reuse = NULL);
+
+  /**
+   *
+   * Spread the bytes of a frame on m_raw over the components, in one pass
+   * for the interleaved layouts. The planar, NV12, YUY2 and UYVY rows use
+   * SSE2 where available.
+   *
+   * @param img The frame, in the layout of m_coder.
+   *
+   **/
+
+  void DoDeinterleave(HeatWaveImage & img) const;
+
+  /**
+   *
+   * Check if a recycled frame still has the layout of the video and reset
+   * it to a freshly read state.
+   *
+   * @param img The frame.
+   * @return True if it can be read into.
+   *
+   **/
+
+  Bool IsReusable(HeatWaveImage & img) const;
+
+  /**
+   *
+   * Build the frame table, the offset and size of each frame chunk, so
+   * frames are found without walking the chunk tree.
+   *
+   * @return True if ok, False otherwise.
+   *
+   **/
+
+  Bool DoIndexFrames();
+
+  /**
+   *
+   * Fill the frame table from the idx1 index.
+   *
+   * @param movi The movi list.
+   * @param idx1 The idx1 chunk.
+   * @return True if the index is usable, False otherwise.
+   *
+   **/
+
+  Bool DoIndexFromIdx1(const DataChunk & movi, const DataChunk & idx1);
+
+  /**
+   *
+   * Fill the frame table by reading the chunk headers in the movi list.
+   *
+   * @param movi The movi list.
+   * @return True if ok, False otherwise.
+   *
+   **/
+
+  Bool DoIndexFromMovi(const DataChunk & movi);
+
+  /**
+   *
+   * @param name A chunk name.
+   * @return True if it names a frame chunk of the video stream.
+   *
+   **/
+
+  Bool IsFrameChunk(const char * name) const;
+
+  /**
+   *
+   * Start the read ahead thread at m_next.
+   *
+   * @return True if ok, False otherwise.
+   *
+   **/
+
+  Bool DoStartPrefetch();
+
+  /**
+   *
+   * Stop the read ahead thread and keep its unused frames for reuse,
+   * m_next is left at the first frame not handed out.
+   *
+   **/
+
+  void DoStopPrefetch();
+
+  /**
+   *
+   * Keep a frame for reuse or delete it if enough are kept. The thread must
+   * not be running or the mutex must be held.
+   *
+   * @param img The frame.
+   *
+   **/
+
+  void DoPoolPush(HeatWaveImage * img);
+
+  /**
+   *
+   * Thread entry point.
+   *
+   * @param arg The reader.
+   * @return NULL.
+   *
+   **/
+
+  static void * ThreadMain(void * arg);
+
+  /**
+   *
+   * The read ahead loop.
+   *
+   **/
+
+  void DoPrefetch();
 
   /** 
    *
@@ -327,11 +517,8 @@ protected:
     /** Offset to name of chunk in file. **/
     SInt m_offset;
 
-    /** Pointer to next chunk. **/
-    DataChunk * m_nxt;
-
-    /** Pointer to first sub chunk. **/
-    DataChunk * m_sub;
+    /** Index in the chunk table after the last sub chunk. **/
+    SInt m_end;
     
     /**
      *
@@ -348,58 +535,7 @@ protected:
       m_size = 0;
       m_list = True;
       m_offset = 0;
-      m_nxt = NULL;
-      m_sub = NULL;
-    }
-
-    /**
-     *
-     * Copy Constructor.
-     *
-     * @param oth The other DataChunk to copy. 
-     * @param nxt Copy the DataChunk tree on m_nxt member.(True by def.)
-     * @param sub Copy the DataChunk tree on m_sub member.(True by def.)
-     * @note The data pointers are not copyed and initiated to NULL.
-     *
-     **/
-
-    DataChunk(const DataChunk & oth, Bool nxt = True, Bool sub = True)
-    {
-      for ( SInt i = 0; i < 4 ; ++i ){
-        m_name[i]=oth.m_name[i];
-        m_type[i]=oth.m_type[i];
-      }
-      m_size = oth.m_size;
-      m_list = oth.m_list;
-      m_offset = oth.m_offset;
-      m_nxt = NULL;
-      m_sub = NULL;
-      if ( (oth.m_nxt) && nxt ){
-        m_nxt = new DataChunk(*oth.m_nxt,True,True);
-        LEAVEONNULL(m_nxt);
-      }
-      if ( (oth.m_sub) && sub ){
-        m_sub = new DataChunk(*oth.m_sub,True,True);
-        LEAVEONNULL(m_sub);
-      }
-    }
-
-    /**
-     *
-     * Destructor.
-     *
-     **/
-
-    ~DataChunk()
-    {
-      if ( m_sub ){
-        delete m_sub;
-        m_sub = NULL;
-      }
-      if ( m_nxt ){
-        delete m_nxt;
-        m_nxt = NULL;
-      }
+      m_end = 0;
     }
   };
   
@@ -413,12 +549,93 @@ protected:
   
   void DoCopy(const HeatWaveAVIReader & rhs);
   
-  /** Main data chunk. 
+  /** The chunk table, in file order, a list followed by its sub chunks.
    ** @note Internal member only, no external access. **/
-  DataChunk m_chunk;
+  DataChunk * m_chunka;
+
+  /** Number of chunks in the table. **/
+  SInt m_chunkn;
+
+  /** Capacity of m_chunka. **/
+  SInt m_chunkLen;
+
+  /** Block of the file the headers are read through. **/
+  char * m_block;
+
+  /** File offset of m_block. **/
+  SInt m_blockOfs;
+
+  /** Valid bytes in m_block. **/
+  SInt m_blockN;
 
   /** Video decoder options **/
   StructCodingType m_coder;
+
+  /** File offset of each frame chunk. **/
+  SInt * m_frameOfs;
+
+  /** Size of each frame chunk. **/
+  SInt * m_frameLen;
+
+  /** Number of frame chunks. **/
+  SInt m_frameN;
+
+  /** Frame width. **/
+  SInt m_frameWidth;
+
+  /** Frame height. **/
+  SInt m_frameHeight;
+
+  /** Size in bytes of the samples of a frame. **/
+  SInt m_frameBytes;
+
+  /** The rows of a LayBGR frame are stored bottom row first. **/
+  Bool m_bottomUp;
+
+  /** The bytes of a frame, read in one go. **/
+  UInt8 * m_raw;
+
+  /** Size of m_raw. **/
+  SInt m_rawLen;
+
+  /** Frames to read ahead, 0 if not prefetching. **/
+  SInt m_ahead;
+
+  /** The read ahead thread is running. **/
+  Bool m_running;
+
+  /** Tells the read ahead thread to stop. **/
+  Bool m_stop;
+
+  /** The read ahead thread. **/
+  CommonThread m_thread;
+
+  /** Guards the members below while the thread runs. **/
+  CommonMutex m_mutex;
+
+  /** Signalled when a frame is read, handed out or on stop. **/
+  CommonCond m_cond;
+
+  /** Ring of frames read ahead, m_ahead long. **/
+  HeatWaveImage ** m_ring;
+
+  /** First frame on the ring. **/
+  SInt m_ringHead;
+
+  /** Number of frames on the ring. **/
+  SInt m_ringN;
+
+  /** The next frame to be read. **/
+  SInt m_next;
+
+  /** Recycled frames. **/
+  HeatWaveImage ** m_poola;
+
+  /** Number of recycled frames. **/
+  SInt m_pooln;
+
+  /** Capacity of m_poola. **/
+  SInt m_poolLen;
 };
 
 #endif // __HEATWAVEAVIREADER_HPP__
@@ -0,0 +1,276 @@
+/****************************************************************************/
+/**
+ ** @File HeatWaveAVIWriter.hpp
+ ** @brief Contains the HeatWaveAVIWriter class definition.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVEAVIWRITER_HPP__
+#define __HEATWAVEAVIWRITER_HPP__
+
+#include "HeatWaveEnums.hpp"
+#include "HeatWaveImage.hpp"
+#include "HeatWaveVideo.hpp"
+#include "HeatWaveAVIStructs.hpp"
+#include "HeatWaveAVIBase.hpp"
+
+/** Size in bytes of the writers output buffer. */
+#define HEATWAVEAVIBUFFER (1 << 20)
+
+/** The stream handler of coefficient files. */
+#define HEATWAVEAVICOEF "HWCP"
+
+/** The largest file written, AVI 1.0 offsets and sizes are 32-bit and most
+ ** readers take them as signed. */
+#define HEATWAVEAVIMAXSIZE (0x7FFFFFFF)
+
+/****************************************************************************/
+/**
+ ** A AVI file writer. Frames are streamed to the file as they are added,
+ ** so a video never needs to be held in memory as a whole. The chunks are
+ ** gathered in a large buffer and written in big sequential blocks, the
+ ** sizes in the headers plus the idx1 index are written on closing.
+ ** Two kinds of files can be written:
+ ** <ol>
+ ** <li> Raw frames ("00db" chunks) of one of the planar video types (IYUV,
+ **      GREY), 8-bit samples in the plane order and sampling of the type,
+ **      readable by HeatWaveAVIReader. Frames in an other color space or sampling are
+ **      converted on a copy first, samples are clipped to 0..255. </li>
+ ** <li> Coefficient frames ("00dc" chunks, handler HEATWAVEAVICOEF) with the
+ **      same planes but signed 16-bit little endian samples, e.g. for
+ **      transformed frames. The strd chunk holds the name of the video type
+ **      giving the plane layout. </li>
+ ** </ol>
+ ** Order of writing a video is to:
+ ** <ol>
+ ** <li> Open the file (CHECK RETURNED VALUE!)</li>
+ ** <li> Add the frames </li>
+ ** <li> Close the file (CHECK RETURNED VALUE!)</li>
+ ** </ol>
+ **/
+
+class HeatWaveAVIWriter : public HeatWaveAVIBase
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   **/
+
+  HeatWaveAVIWriter();
+
+  /**
+   *
+   * Destructor, closes the file if still open.
+   *
+   **/
+
+  virtual ~HeatWaveAVIWriter();
+
+  /**
+   *
+   * Create a AVI file and write the headers.
+   *
+   * @param str The name of the file.
+   * @param type The video type, sets the planes and their sampling.
+   * @param width The frame width, a multiple of the horizontal sampling.
+   * @param height The frame height, a multiple of the vertical sampling.
+   * @param rate The number of frames per second. (25 by default)
+   * @param coef Write signed 16-bit coefficients instead of 8-bit
+   * samples. (False by default)
+   * @return True if the file is created, False if not.
+   *
+   **/
+
+  Bool OpenFile(const char * str, EnumVideoType type, SInt width,
+                SInt height, SInt rate = 25, Bool coef = False);
+
+  /**
+   *
+   * Append a frame. Once a frame failed all further frames are refused,
+   * but the file can still be closed. A frame that would take the file
+   * past HEATWAVEAVIMAXSIZE is refused on its own.
+   *
+   * @param img The frame, the same size as given on opening.
+   * @return True if written, False if not.
+   *
+   **/
+
+  Bool AddFrame(const HeatWaveImage & img);
+
+  /**
+   *
+   * Append all frames of a video.
+   *
+   * @param vid The video.
+   * @return True if written, False if not.
+   *
+   **/
+
+  Bool SaveVideo(const HeatWaveVideo & vid);
+
+  /**
+   *
+   * @return The number of frames written so far.
+   *
+   **/
+
+  SInt GetFrameN() const;
+
+  /**
+   *
+   * Write the index, fix the headers and close the file.
+   *
+   * @return True if closed ok, False otherwise.
+   *
+   **/
+
+  Bool CloseFile();
+
+protected:
+
+  /**
+   *
+   * Write the RIFF, hdrl and movi headers. Sizes are fixed on closing.
+   *
+   * @return True if ok, False otherwise.
+   *
+   **/
+
+  Bool DoWriteHeaders();
+
+  /**
+   *
+   * Write a chunk or list header.
+   *
+   * @param name The four character chunk (or list) name.
+   * @param size The chunk size.
+   * @param type The four character list type, NULL for a chunk.
+   * @return True if ok, False otherwise.
+   *
+   **/
+
+  Bool DoWriteHeader(const char * name, SInt size, const char * type = NULL);
+
+  /**
+   *
+   * Write the planes of a frame as one chunk.
+   *
+   * @param img The frame, in the layout of the video type.
+   * @return True if ok, False otherwise.
+   *
+   **/
+
+  Bool DoWriteFrame(const HeatWaveImage & img);
+
+  /**
+   *
+   * Append data to the output buffer, writing the buffer to the file when
+   * full. Large blocks go straight to the file.
+   *
+   * @param ptr The data.
+   * @param len The number of bytes.
+   * @return True if ok, False otherwise.
+   *
+   **/
+
+  Bool DoWrite(const void * ptr, SInt len);
+
+  /**
+   *
+   * Write the output buffer to the file.
+   *
+   * @return True if ok, False otherwise.
+   *
+   **/
+
+  Bool DoFlushBuffer();
+
+  /**
+   *
+   * Overwrite data at a earlier file position, the buffer must be flushed.
+   *
+   * @param off The file offset.
+   * @param ptr The data.
+   * @param len The number of bytes.
+   * @return True if ok, False otherwise.
+   *
+   **/
+
+  Bool DoPatch(SInt off, const void * ptr, SInt len);
+
+  /**
+   *
+   * Find the component holding a plane of the video type.
+   *
+   * @param img The frame.
+   * @param num The plane number.
+   * @return The component number, -1 if there is none.
+   *
+   **/
+
+  SInt GetPlane(const HeatWaveImage & img, SInt num) const;
+
+  /**
+   *
+   * Check that each plane of the video type is there with the right size.
+   *
+   * @param img The frame.
+   * @return True if the frame can be written as it is.
+   *
+   **/
+
+  Bool IsConform(const HeatWaveImage & img) const;
+
+  /** Video encoder options. */
+  StructCodingType m_coder;
+
+  /** Write coefficients. */
+  Bool m_coef;
+
+  /** A frame failed, refuse any more. */
+  Bool m_failed;
+
+  /** Size in bytes of a frame chunk (without header). */
+  SInt m_frameSize;
+
+  /** Output buffer. */
+  char * m_buf;
+
+  /** Bytes in the output buffer. */
+  SInt m_bufn;
+
+  /** File position after all written data, including the buffer. */
+  SInt m_pos;
+
+  /** File offset of the avih chunk data. */
+  SInt m_avihPos;
+
+  /** File offset of the strh chunk data. */
+  SInt m_strhPos;
+
+  /** File offset of the movi list. */
+  SInt m_moviPos;
+
+  /** The index. */
+  HeatWaveAVIIndexEntry * m_idxa;
+
+  /** Number of index entries. */
+  SInt m_idxn;
+
+  /** Capacity of m_idxa. */
+  SInt m_idxLen;
+
+private:
+
+  /** Not copyable. */
+  HeatWaveAVIWriter(const HeatWaveAVIWriter &);
+
+  /** Not assignable. */
+  HeatWaveAVIWriter & operator=(const HeatWaveAVIWriter &);
+};
+
+#endif // __HEATWAVEAVIWRITER_HPP__
@@ -0,0 +1,251 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveBitplaneCoder.hpp
+ ** @brief  Contains the HeatWaveBitplaneCoder class definition.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVEBITPLANECODER_HPP__
+#define __HEATWAVEBITPLANECODER_HPP__
+
+#include "CommonHeaders.hpp"
+#include "HeatWaveEnums.hpp"
+#include "HeatWaveComponent.hpp"
+
+/****************************************************************************/
+/**
+ ** Embedded bitplane coder of pyramid transformed components, after SPIHT
+ ** (set partitioning in hierarchical trees). Coefficients are sent a
+ ** bitplane at a time from the most significant down, with the sub-band
+ ** trees found through GetSubbandInfo() letting whole insignificant trees
+ ** be sent as one bit. Every coefficient of a detail band has as children
+ ** the 2x2 block at the same place in the same band of the next finer
+ ** level (the last row and column of parents also adopt an odd remainder),
+ ** the LL coefficients are the roots with the HL, LH and HH coefficients
+ ** at the same place as children. Each tile has its own trees.
+ **
+ ** The stream can be cut at any byte and still decodes, to the precision
+ ** reached, so a stream coded once can be sent at any rate. Decoding
+ ** places the coefficients in the middle of their remaining uncertainty
+ ** interval, a complete stream decodes exactly.
+ **
+ ** The stream is a header of HEATWAVEBITPLANEHEADER bytes, holding the
+ ** geometry and state of the component as little endian 32 bit integers,
+ ** followed by the raw decision bits, most significant bit first.
+ **
+ **/
+
+/** The size of the stream header in bytes. */
+#define HEATWAVEBITPLANEHEADER 40
+
+class HeatWaveBitplaneCoder
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   **/
+
+  HeatWaveBitplaneCoder();
+
+  /**
+   *
+   * Destructor.
+   *
+   **/
+
+  ~HeatWaveBitplaneCoder();
+
+  /**
+   *
+   * Encode a component, normally pyramid transformed. The component is not
+   * changed.
+   *
+   * @param cmp The component.
+   * @param budget The most bytes to write, header included, 0 or less for
+   * the complete (lossless) stream. (0 by default)
+   * @return The size of the stream in bytes, -1 if the budget does not hold
+   * the header.
+   *
+   **/
+
+  SInt DoEncode(HeatWaveComponent & cmp, SInt budget = 0);
+
+  /**
+   *
+   * @return The stream of the last DoEncode().
+   *
+   **/
+
+  const UInt8 * GetStream() const;
+
+  /**
+   *
+   * @return The size of the stream of the last DoEncode() in bytes.
+   *
+   **/
+
+  SInt GetStreamSize() const;
+
+  /**
+   *
+   * Decode a stream, or any prefix of one. The component must have the
+   * size and tiling of the encoded one, its samples, transform level and
+   * type, precision and sign are replaced.
+   *
+   * @param data The stream.
+   * @param size The number of bytes of the stream to use.
+   * @param cmp (OUT) The component.
+   * @return False if the header is cut or does not match the component.
+   *
+   **/
+
+  Bool DoDecode(const UInt8 * data, SInt size, HeatWaveComponent & cmp);
+
+protected:
+
+  /**
+   *
+   * A sub-band of a tile, in coordinates relative to the component.
+   *
+   **/
+
+  struct Band {
+    /** The top left x-coordinate. */
+    SInt x;
+    /** The top left y-coordinate. */
+    SInt y;
+    /** The width. */
+    SInt w;
+    /** The height. */
+    SInt h;
+    /** The bands holding the children, -1 if none. */
+    SInt kids[3];
+    /** LL band, its children are at the same place. */
+    Bool root;
+  };
+
+  /**
+   *
+   * Find the sub-bands of all tiles and the band of every coefficient.
+   *
+   * @param cmp The component.
+   * @param lev The transform level.
+   * @return False if the bands do not cover the component.
+   *
+   **/
+
+  Bool DoBands(const HeatWaveComponent & cmp, SInt lev);
+
+  /**
+   *
+   * Get the children of a coefficient.
+   *
+   * @param pos The coefficient, as row * width + column.
+   * @param kids (OUT) The children, room for 9.
+   * @return The number of children.
+   *
+   **/
+
+  SInt GetKids(SInt pos, SInt * kids) const;
+
+  /**
+   *
+   * Get the largest magnitude below each coefficient, for the encoder.
+   * m_maxD is over the descendants and m_maxL over the descendants of the
+   * children.
+   *
+   **/
+
+  void DoMaxima();
+
+  /**
+   *
+   * The coding passes, shared by the encoder and decoder so they make the
+   * same decisions.
+   *
+   * @param enc Encode, else decode.
+   * @param top The number of bitplanes.
+   *
+   **/
+
+  void DoPasses(Bool enc, SInt top);
+
+  /**
+   *
+   * Write or read one decision bit.
+   *
+   * @param enc Write the bit, else read it.
+   * @param bit (IN/OUT) The bit.
+   * @return False when the budget or stream is used up.
+   *
+   **/
+
+  Bool DoBit(Bool enc, Bool & bit);
+
+  /**
+   *
+   * Free the coding state, not the stream.
+   *
+   **/
+
+  void DoClear();
+
+  /** The width of the component coded. */
+  SInt m_width;
+
+  /** The height of the component coded. */
+  SInt m_height;
+
+  /** The sub-bands. */
+  Band * m_bands;
+
+  /** The number of sub-bands. */
+  SInt m_bandn;
+
+  /** The band of each coefficient. */
+  SInt * m_band;
+
+  /** The magnitude of each coefficient. */
+  UInt32 * m_mag;
+
+  /** The sign of each coefficient. */
+  UInt8 * m_sgn;
+
+  /** The largest magnitude of the descendants, encoder only. */
+  UInt32 * m_maxD;
+
+  /** The largest magnitude of the grand descendants, encoder only. */
+  UInt32 * m_maxL;
+
+  /** The last bitplane of each coefficient decoded, decoder only. */
+  SInt8 * m_plane;
+
+  /** The stream. */
+  UInt8 * m_data;
+
+  /** The bytes allocated for the stream. */
+  SInt m_cap;
+
+  /** The stream being read, decoder only. */
+  const UInt8 * m_read;
+
+  /** The current bit position in the stream. */
+  SInt64 m_bit;
+
+  /** The bit position the stream ends at. */
+  SInt64 m_end;
+
+private:
+
+  /** Not copyable. */
+  HeatWaveBitplaneCoder(const HeatWaveBitplaneCoder &);
+
+  /** Not assignable. */
+  HeatWaveBitplaneCoder & operator=(const HeatWaveBitplaneCoder &);
+};
+
+#endif // __HEATWAVEBITPLANECODER_HPP__
@@ -0,0 +1,246 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveCache.hpp
+ ** @brief  Contains the HeatWaveCache class definition.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVECACHE_HPP__
+#define __HEATWAVECACHE_HPP__
+
+#include "CommonHeaders.hpp"
+#include "HeatWaveEnums.hpp"
+#include "HeatWaveComponent.hpp"
+#include "HeatWaveVideo.hpp"
+
+/** The version of the transform implementations, part of every key. Raise
+ ** it with any change to a transform that changes its results, so results
+ ** filed before the change are no longer found. */
+#define HEATWAVECACHEVERSION 1
+
+/****************************************************************************/
+/**
+ ** An on disk cache of transform results, to repeat parameter sweeps
+ ** without repeating the transforms. A result is filed under a 128-bit key
+ ** made of the hash of the input samples and everything else the result
+ ** depends on: the geometry, precision, sign, current level and transform
+ ** and tiling of the components, the transform, level, direction and start
+ ** level asked for, for temporal transforms the grouping, and the version
+ ** of the transform implementations, HEATWAVECACHEVERSION. A file holds
+ ** the resulting samples, packed into 1, 2 or 4 bytes each from the lowest
+ ** sample up, and the resulting level, transform, precision and sign.
+ ** Files are written under a temporary name and renamed, so processes may
+ ** share a cache. A file that can not be read is treated as a miss.
+ **
+ **/
+
+class HeatWaveCache
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param dir The cache directory, which should exist.
+   *
+   **/
+
+  HeatWaveCache(const Char * dir);
+
+  /**
+   *
+   * Destructor.
+   *
+   **/
+
+  ~HeatWaveCache();
+
+  /**
+   *
+   * @return The cache directory.
+   *
+   **/
+
+  const Char * GetDirectory() const;
+
+  /**
+   *
+   * See HeatWaveComponent::DoPyramidTransform(), the result is read from the
+   * cache if there, else it is transformed and filed.
+   *
+   * @param cmp The component.
+   * @param trn The transform type.
+   * @param lev The level to transform to.
+   * @param fwd Forward transform, else inverse transform. (Forward by default)
+   * @param cur The current level, if less then 0 the internal level is used.
+   * (-1 by default)
+   * @return The new level of transform.
+   *
+   **/
+
+  SInt DoPyramidTransform(HeatWaveComponent & cmp, EnumTransform trn,
+                          SInt lev, Bool fwd = True, SInt cur = -1);
+
+  /**
+   *
+   * See HeatWaveVideo::DoSpatialTransform(), each component is looked up on
+   * its own.
+   *
+   * @param vid The video.
+   * @param trn The transform type.
+   * @param lev The level to transform to.
+   * @param fwd Forward transform, else inverse transform. (Forward by default)
+   * @param cur The current level, if less then 0 the internal level is used.
+   * (-1 by default)
+   * @return The new level of transform.
+   *
+   **/
+
+  SInt DoSpatialTransform(HeatWaveVideo & vid, EnumTransform trn, SInt lev,
+                          Bool fwd = True, SInt cur = -1);
+
+  /**
+   *
+   * See HeatWaveVideo::DoTemporalTransform(), all images are looked up as
+   * one.
+   *
+   * @param vid The video.
+   * @param trn The transform type.
+   * @param lev The level to transform to.
+   * @param fwd Forward transform, else inverse transform. (Forward by default)
+   * @param cur The current level, if less then 0 the internal level is used.
+   * (-1 by default)
+   * @return The new level of transform, -1 if not transformed.
+   *
+   **/
+
+  SInt DoTemporalTransform(HeatWaveVideo & vid, EnumTransform trn, SInt lev,
+                           Bool fwd = True, SInt cur = -1);
+
+  /**
+   *
+   * @return The number of results read from the cache.
+   *
+   **/
+
+  SInt GetHits() const;
+
+  /**
+   *
+   * @return The number of results not in the cache.
+   *
+   **/
+
+  SInt GetMisses() const;
+
+protected:
+
+  /**
+   *
+   * Start a key with the version and the transform asked for.
+   *
+   * @param key (OUT) The key.
+   * @param kind 0 for spatial and 1 for temporal.
+   * @param trn The transform type.
+   * @param lev The level to transform to.
+   * @param fwd Forward transform.
+   * @param cur The current level.
+   *
+   **/
+
+  static void DoKeyStart(UInt64 * key, SInt kind, EnumTransform trn, SInt lev,
+                         Bool fwd, SInt cur);
+
+  /**
+   *
+   * Add integers to a key.
+   *
+   * @param key (IN/OUT) The key.
+   * @param vals The integers.
+   * @param num The number of integers.
+   *
+   **/
+
+  static void DoKeyAdd(UInt64 * key, const SInt * vals, SInt num);
+
+  /**
+   *
+   * Add a component, its samples and state, to a key.
+   *
+   * @param key (IN/OUT) The key.
+   * @param cmp The component.
+   *
+   **/
+
+  static void DoKeyAdd(UInt64 * key, HeatWaveComponent & cmp);
+
+  /**
+   *
+   * Get the file name of a key.
+   *
+   * @param key The key.
+   * @param tmp A temporary name rather than the final one.
+   * @return The file name, to be deleted by the caller.
+   *
+   **/
+
+  Char * GetFileName(const UInt64 * key, Bool tmp) const;
+
+  /**
+   *
+   * Read a result into components.
+   *
+   * @param key The key.
+   * @param cmpa The components.
+   * @param cmpn The number of components.
+   * @param ret (OUT) The value returned by the transform.
+   * @param lev (OUT) The resulting level.
+   * @param trn (OUT) The resulting transform.
+   * @return True if read, the components are only changed if so.
+   *
+   **/
+
+  Bool DoRead(const UInt64 * key, HeatWaveComponent ** cmpa, SInt cmpn,
+              SInt & ret, SInt & lev, SInt & trn);
+
+  /**
+   *
+   * File a result.
+   *
+   * @param key The key.
+   * @param cmpa The components.
+   * @param cmpn The number of components.
+   * @param ret The value returned by the transform.
+   * @param lev The resulting level.
+   * @param trn The resulting transform.
+   * @return True if filed.
+   *
+   **/
+
+  Bool DoWrite(const UInt64 * key, HeatWaveComponent ** cmpa, SInt cmpn,
+               SInt ret, SInt lev, SInt trn);
+
+  /** The cache directory. */
+  Char * m_dir;
+
+  /** Results read. */
+  SInt m_hits;
+
+  /** Results not found. */
+  SInt m_misses;
+
+  /** Temporary file names made, to keep them apart. */
+  SInt m_tmpn;
+
+private:
+
+  /** Not copyable. */
+  HeatWaveCache(const HeatWaveCache &);
+
+  /** Not assignable. */
+  HeatWaveCache & operator=(const HeatWaveCache &);
+};
+
+#endif // __HEATWAVECACHE_HPP__
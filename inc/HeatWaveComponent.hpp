@@ -11,17 +11,26 @@
 
 #include "HeatWaveEnums.hpp"
 #include "HeatWaveLift.hpp"
+#include "HeatWaveWorkerPool.hpp"
+#include "HeatWaveView.hpp"
 #include "IIICommon.h"
 
 /** Fixed lenght for sample data's in iii file. **/
 #define HEATWAVEIIISAMPLELENGTH 10
 
+/** Samples added on each side of a region per level, see GetRegion(). **/
+#define HEATWAVEROIMARGIN 16
+
 /****************************************************************************/
 /**
  ** The Component class. A variable precision signed or unsigned sample
  ** (integer based) data matrix.  These objects are the building blocks of
  ** images (frames). Some variables, for example the top left x and y
  ** coordinate and sampling periods relates to the owning image grid system.
+ **
+ ** Copies share the (owned) sample storage through a reference count until
+ ** one of them is written to, which then takes a private copy first. So
+ ** copies and clones are cheap, e.g. to keep an original for comparison.
  ** 
  **/
 
@@ -152,7 +161,8 @@ public:
    * Set the horizontal sampling period.
    *
    * @param hstep Horizontal sampling period.
-   * @param rsze Resize the component if different sampling period. (false by
+   * @param rsze Resize the component if different sampling period, by an
+   *        octave for each factor of two, see HeatWaveResampler. (false by
    *        default)
    * @param trns The transform to use for interpolating when sampling
    *        is being reduced. (linear by default)
@@ -175,7 +185,8 @@ public:
    * Set the vertical sampling period.
    *
    * @param vstep Vertical sampling period.
-   * @param rsze Resize the component if different sampling period. (false by
+   * @param rsze Resize the component if different sampling period, by an
+   *        octave for each factor of two, see HeatWaveResampler. (false by
    *        default)
    * @param trns The transform to use for interpolating when sampling
    *        is being reduced. (linear by default)
@@ -275,7 +286,7 @@ public:
    *
    **/
   
-  SInt GetPrec();
+  SInt GetPrec() const;
 
   /**
    *
@@ -506,11 +517,25 @@ public:
 
   /**
    *
-   * @return Pointer to underlying sample data.
+   * @return Pointer to underlying sample data, private to this component so
+   * it may be written to (see DoUnshare()).
+   * @note Not available while the component is packed, see DoPack().
    *
    **/
+
   
-  Smpl * GetData() const;
+  Smpl * GetData();
+
+  /**
+   *
+   * @return Pointer to underlying sample data, for reading only. The
+   * storage is not unshared, so several threads may read a component and
+   * its copies.
+   * @note Not available while the component is packed, see DoPack().
+   *
+   **/
+
+  const Smpl * GetData() const;
 
   /**
    *
@@ -560,11 +585,26 @@ public:
 
   /**
    *
-   * @return The array of smpl pointers used for pointing to each row.
+   * @return The array of smpl pointers used for pointing to each row, the
+   * rows are private to this component so they may be written to (see
+   * DoUnshare()).
+   * @note Not available while the component is packed, see DoPack().
    *
    **/
 
-  Smpl ** GetRows() const;
+
+  Smpl ** GetRows();
+
+  /**
+   *
+   * @return The array of smpl pointers used for pointing to each row, for
+   * reading only. The storage is not unshared, so several threads may read
+   * a component and its copies.
+   * @note Not available while the component is packed, see DoPack().
+   *
+   **/
+
+  const Smpl * const * GetRows() const;
 
   /**
    *
@@ -622,6 +662,105 @@ public:
 
   Bool GetDesMem() const;
 
+  /**
+   *
+   * Check if the samples of a certain area, plus the coefficients of a
+   * further number of pyramid transform levels on it, fits into the compact
+   * 16-bit sample store. The check uses the range of the data (see
+   * GetMinPrecSgn) and the worst case gain of the transform (see
+   * HeatWaveLift::GetGains).
+   *
+   * @param tlx Top left x-coordinate.
+   * @param tly Top left y-coordinate.
+   * @param width The width of area.
+   * @param height The height of area.
+   * @param trn The transform type.
+   * @param lev The number of further transform levels.
+   * @return True if 16-bit samples are enough, False if not or bad area.
+   *
+   **/
+
+  Bool GetPackable(SInt tlx, SInt tly, SInt width, SInt height,
+                   EnumTransform trn, SInt lev) const;
+
+  /**
+   *
+   * Check if the whole component, plus a further number of pyramid transform
+   * levels on its current LL sub-band, fits into the compact 16-bit sample
+   * store.
+   *
+   * @param trn The transform type, Trn0_0 by default.
+   * @param lev The number of further transform levels, 0 by default.
+   * @return True if 16-bit samples are enough, False otherwise.
+   *
+   **/
+
+  Bool GetPackable(EnumTransform trn = Trn0_0, SInt lev = 0) const;
+
+  /**
+   *
+   * Move the samples into the compact 16-bit sample store, halving the
+   * memory used by the component. Sample access (GetSmpl, SetSmpl and all
+   * the functions build on them) and transforms work on packed data, a
+   * SetSmpl value or a transform that needs more then 16-bits will unpack
+   * the component first. The raw data (GetData, GetRows) is only available
+   * once unpacked.
+   *
+   * @param trn The transform type to be used while packed, Trn0_0 by
+   * default.
+   * @param lev The number of transform levels to be done while packed, 0 by
+   * default.
+   * @return True if packed (or was packed), False if the range is too large.
+   *
+   **/
+
+  Bool DoPack(EnumTransform trn = Trn0_0, SInt lev = 0);
+
+  /**
+   *
+   * Move the samples back from the compact 16-bit sample store into the
+   * normal sample store.
+   *
+   **/
+
+  void DoUnpack();
+
+  /**
+   *
+   * @return True if the samples are in the compact 16-bit sample store.
+   *
+   **/
+
+  Bool IsPacked() const;
+
+  /**
+   *
+   * @return True if the sample storage is shared with a copy.
+   *
+   **/
+
+  Bool IsShared() const;
+
+  /**
+   *
+   * Take a private copy of the sample storage if it is shared, it is then
+   * safe to write to the raw data (e.g. from several threads).
+   *
+   **/
+
+  void DoUnshare();
+
+  /**
+   *
+   * Swap the contents of two components without copying samples.
+   *
+   * @param other The other component.
+   *
+   **/
+
+  void DoSwap(HeatWaveComponent & other);
+
+
   /**
    *
    * Set the HeatWaveLift member.
@@ -667,7 +806,8 @@ public:
   
   /**
    *
-   * Pyramid type transform.
+   * Pyramid type transform. If tiling is set each tile gets its own
+   * pyramid, see DoTiledTransform().
    *
    * @param trn The transform type.
    * @param lev The level to transform to.
@@ -730,7 +870,9 @@ public:
   /**
    *
    * Resize component with the option of maintaining as much data as possible, 
-   * plus what the new data's default values should be.
+   * plus what the new data's default values should be. Owned storage is
+   * reused in place while it is large enough, growing reserves some extra
+   * room.
    *
    * @param width The new width of component.
    * @param height The new height of component.
@@ -742,6 +884,26 @@ public:
    **/
 
   void DoResize(SInt width, SInt height, Bool save, Smpl def, Bool desMem);
+
+  /**
+   *
+   * Reserve room for a number of samples, so resizing up to it does not
+   * reallocate. Does nothing for packed components or memory managed else
+   * where.
+   *
+   * @param size The number of samples.
+   *
+   **/
+
+  void DoReserve(SInt size);
+
+  /**
+   *
+   * @return The number of samples the storage has room for, 0 if unknown.
+   *
+   **/
+
+  SInt GetCapacity() const;
   
   /**
    *
@@ -754,13 +916,170 @@ public:
    * @param y (out) The top left y-coordinate.
    * @param width (out) The width.
    * @param height (out) The height.
-   * @return True if area is valid or reachable, false otherwise.
+   * @return True if area is valid or reachable, false otherwise. Always
+   * false for res above 0 if the component has several tiles, each has its
+   * own sub-bands (see the tile overload), so GetView() and GetVector() of a
+   * sub-band are invalid too.
    *
    **/
 
   Bool GetSubbandInfo ( SInt res, EnumSubband sub, SInt & x, SInt & y,
                         SInt & width, SInt & height ) const;
 
+  /**
+   *
+   * Get the top-left xy-coordinate, width and height for a sub-band of a
+   * particular resolution level within a tile.
+   *
+   * @param tile The tile number, see GetTileInfo().
+   * @param res The resolution level.
+   * @param sub The sub-band for the resolution level.
+   * @param x (out) The top left x-coordinate.
+   * @param y (out) The top left y-coordinate.
+   * @param width (out) The width.
+   * @param height (out) The height.
+   * @return True if area is valid or reachable, false otherwise.
+   *
+   **/
+
+  Bool GetSubbandInfo ( SInt tile, SInt res, EnumSubband sub, SInt & x,
+                        SInt & y, SInt & width, SInt & height ) const;
+
+  /**
+   *
+   * Get the top-left xy-coordinate, width and height for a sub-band of a
+   * particular resolution level within an arbitrary area, the layout used
+   * by GetSubbandInfo() (also for HeatWaveFloatComponent).
+   *
+   * @param tlx The top left x-coordinate of the area.
+   * @param tly The top left y-coordinate of the area.
+   * @param wid The width of the area.
+   * @param hei The height of the area.
+   * @param res The resolution level.
+   * @param sub The sub-band for the resolution level.
+   * @param x (out) The top left x-coordinate.
+   * @param y (out) The top left y-coordinate.
+   * @param width (out) The width.
+   * @param height (out) The height.
+   * @return True if area is valid or reachable, false otherwise.
+   *
+   **/
+
+  static Bool GetSubbandArea(SInt tlx, SInt tly, SInt wid, SInt hei,
+                             SInt res, EnumSubband sub, SInt & x, SInt & y,
+                             SInt & width, SInt & height);
+
+  /**
+   *
+   * Reconstruct the component at a reduced resolution, only the sub-bands
+   * of the levels above res are inverse transformed. This component is left
+   * unchanged.
+   *
+   * @param res The resolution level, 0 for full size, up to the transform
+   * level.
+   * @param out (out) The reconstruction, resized to the LL of level res.
+   * @return False if res is out of range or the component is tiled.
+   *
+   **/
+
+  Bool GetResolution(SInt res, HeatWaveComponent & out) const;
+
+  /**
+   *
+   * Reconstruct a region of interest at a resolution level. Only the
+   * coefficients whose support overlaps the region (plus a margin of
+   * HEATWAVEROIMARGIN samples per level) are inverse transformed, so the
+   * cost scales with the region rather than the component. This component is
+   * left unchanged.
+   *
+   * @param res The resolution level, 0 for full size, up to the transform
+   * level.
+   * @param tlx Top left x-coordinate, on the grid of level res which starts
+   * at GetTLX() like the component itself.
+   * @param tly Top left y-coordinate, see tlx.
+   * @param width The width of the region.
+   * @param height The height of the region.
+   * @param out (out) The reconstructed region, resized to width by height.
+   * @return False if the region or res is out of range or the component is
+   * tiled.
+   *
+   **/
+
+  Bool GetRegion(SInt res, SInt tlx, SInt tly, SInt width, SInt height,
+                 HeatWaveComponent & out) const;
+
+  /**
+   *
+   * Set the tiling, JPEG 2000 style. The component is partitioned into
+   * tiles of a fixed size (smaller at the right and bottom edges) starting
+   * at the top left corner, each transformed independently.
+   *
+   * @param twd The tile width, 0 or less to disable tiling.
+   * @param thg The tile height, 0 or less to disable tiling.
+   * @param pool The worker pool to transform the tiles on, if NULL tiles are
+   * transformed one after the other. (NULL by default)
+   *
+   **/
+
+  void SetTiling(SInt twd, SInt thg, HeatWaveWorkerPool * pool = NULL);
+
+  /**
+   *
+   * @return The tile width, 0 if not tiled.
+   *
+   **/
+
+  SInt GetTileWidth() const;
+
+  /**
+   *
+   * @return The tile height, 0 if not tiled.
+   *
+   **/
+
+  SInt GetTileHeight() const;
+
+  /**
+   *
+   * @return The number of tiles, 1 if not tiled.
+   *
+   **/
+
+  SInt GetTileCount() const;
+
+  /**
+   *
+   * Get the area of a tile, tiles are numbered row by row.
+   *
+   * @param tile The tile number.
+   * @param x (out) The top left x-coordinate.
+   * @param y (out) The top left y-coordinate.
+   * @param width (out) The width.
+   * @param height (out) The height.
+   * @return True if the tile exists.
+   *
+   **/
+
+  Bool GetTileInfo(SInt tile, SInt & x, SInt & y, SInt & width,
+                   SInt & height) const;
+
+  /**
+   *
+   * Pyramid type transform of each tile independently, tiles that are too
+   * small stop early.
+   *
+   * @param trn The transform type.
+   * @param lev The level to transform to.
+   * @param fwd Forward transform, else inverse transform. (Forward by default)
+   * @param pool The worker pool to use, if NULL tiles are transformed one
+   * after the other. (NULL by default)
+   * @return The new level of transform.
+   *
+   **/
+
+  SInt DoTiledTransform(EnumTransform trn, SInt lev, Bool fwd = True,
+                        HeatWaveWorkerPool * pool = NULL);
+
   /**
    *
    * Get a clone of this component.
@@ -781,6 +1100,42 @@ public:
 
   SFloat64 GetComparison(const HeatWaveComponent & other, EnumComparison cmp);
 
+  /**
+   *
+   * Get a view of the sample data of a certain area, no samples are copied.
+   *
+   * @param tlx Top left x-coordinate.
+   * @param tly Top left y-coordinate.
+   * @param width The width of the area.
+   * @param height The height of the area.
+   * @return The view, invalid if the area is not inside the component.
+   *
+   **/
+
+  HeatWaveView GetView(SInt tlx, SInt tly, SInt width, SInt height) const;
+
+  /**
+   *
+   * Get a view of a certain resolutions sub-band, no samples are copied.
+   *
+   * @param res Resolution level.
+   * @param area The sub-band area.
+   * @return The view, invalid if there is no such sub-band.
+   *
+   **/
+
+  HeatWaveView GetView(SInt res, EnumSubband area) const;
+
+  /**
+   *
+   * Get a view of the whole component.
+   *
+   * @return The view, invalid if the component is empty.
+   *
+   **/
+
+  HeatWaveView GetView() const;
+
   /**
    *
    * Return the copy of a vector of sample data for a certain area.
@@ -790,6 +1145,7 @@ public:
    * @param width The width of the area.
    * @param height The height of the area.
    * @return The vector if possible, else NULL.
+   * @see GetView() to avoid the copy.
    *
    **/
 
@@ -1004,6 +1360,9 @@ public:
 
 protected:
 
+  /** Runs DoTileTransform() on a worker pool. */
+  friend class HeatWaveTileJob;
+
   /**
    *
    * Set up the row pointers. 
@@ -1023,6 +1382,19 @@ protected:
 
   Bool ValidateSanity() const;
 
+  /**
+   *
+   * Get a sample using its offset in the (row by row) sample store, works
+   * for both packed and unpacked components.
+   *
+   * @param off The offset, 0 to size-1.
+   * @return The Smpl value.
+   *
+   **/
+
+  Smpl GetSmplAt(SInt off) const;
+
+
   /**
    *
    * Internal transform function.
@@ -1032,15 +1404,68 @@ protected:
    * @param wid The width.
    * @param hei The height.
    * @param hor Do a horizontal transform, else vertical.
-   * @param mem The pointer to the first sample.
+   * @param mem The pointer to the first sample, Smpl or Smpl16 if packed.
+   * @param lift The HeatWaveLift to use, each thread needs its own.
    * @param prd To do precision, true by default.
    * @param upd To do update, true by default.
    *
    **/
   
+  template <class T>
   void DoTransformInternal(Bool fwd, EnumTransform trn, SInt wid, SInt hei, 
-                           Bool hor, Smpl * mem, Bool prd = True, 
-                           Bool upd = True);
+                           Bool hor, T * mem, HeatWaveLift & lift,
+                           Bool prd = True, Bool upd = True);
+
+  /**
+   *
+   * Transform a (valid) area without updating the range or transform type.
+   *
+   * @param lift The HeatWaveLift to use, each thread needs its own.
+   * @see DoTransform()
+   *
+   **/
+
+  void DoTransformArea(HeatWaveLift & lift, Bool fwd, EnumTransform trn,
+                       SInt tlx, SInt tly, SInt wid, SInt hei, Bool prd,
+                       Bool upd, Bool vrt, Bool hrz);
+
+  /**
+   *
+   * Pyramid transform a single tile.
+   *
+   * @param lift The HeatWaveLift to use, each thread needs its own.
+   * @param tile The tile number.
+   * @param trn The transform type.
+   * @param cur The current level.
+   * @param lev The level to transform to.
+   * @param fwd Forward transform, else inverse transform.
+   * @return The level the tile reached.
+   *
+   **/
+
+  SInt DoTileTransform(HeatWaveLift & lift, SInt tile, EnumTransform trn,
+                       SInt cur, SInt lev, Bool fwd);
+
+  /**
+   *
+   * @param tile The tile number.
+   * @param cur The level of the component.
+   * @return The level the tile reached, small tiles stop early.
+   *
+   **/
+
+  SInt GetTileLevel(SInt tile, SInt cur) const;
+
+  /**
+   *
+   * DoPixelise() for a transformed component of several tiles.
+   *
+   * @param prec Precision to pixelise to.
+   * @param sgnd Underlying data should be signed.
+   *
+   **/
+
+  void DoPixeliseTiles(SInt prec, Bool sgnd);
 
   /**
    *
@@ -1091,6 +1516,56 @@ protected:
    **/
 
   void DoCopy(const HeatWaveComponent & rhs);
+
+  /**
+   *
+   * Resize while keeping the samples, moving the rows within the current
+   * storage which must be owned and large enough.
+   *
+   * @param width The new width.
+   * @param height The new height.
+   * @param def Default value for new samples.
+   *
+   **/
+
+  void DoRelayout(SInt width, SInt height, Smpl def);
+
+  /**
+   *
+   * Resize while keeping the samples, moving them into new storage.
+   *
+   * @param width The new width.
+   * @param height The new height.
+   * @param cap The number of samples to allocate, at least width*height.
+   * @param def Default value for new samples.
+   * @param desMem Delete the new memory on exit or assignment.
+   *
+   **/
+
+  void DoRelocate(SInt width, SInt height, SInt cap, Smpl def, Bool desMem);
+
+  /**
+   *
+   * Drop a reference to shared sample storage.
+   *
+   * @param refs The reference count, may be NULL for unshared storage.
+   * @return True if it was the last reference, the storage is then for the
+   * caller to free.
+   *
+   **/
+
+  static Bool DoDropRef(SInt * refs);
+
+  /**
+   *
+   * @param from A sampling period.
+   * @param to Another sampling period.
+   * @return The octaves (factors of two, rounded up) from one to the other,
+   * negative if to is the smaller.
+   *
+   **/
+
+  static SInt GetOctaves(SInt from, SInt to);
   
   /** Top left x-coordinate. */
   SInt m_tlx;
@@ -1137,6 +1612,28 @@ protected:
   /** Array of pointers to each row. */
   Smpl ** m_rows;
 
+  /** The data while packed into 16-bit samples, otherwise NULL. */
+  Smpl16 * m_pack;
+
+  /** References to the storage when shared with copies, otherwise NULL. */
+  SInt * m_refs;
+
+  /** Samples allocated for the data, 0 if unknown. */
+  SInt m_capacity;
+
+  /** Pointers allocated for the rows, 0 if unknown. */
+  SInt m_rowCapacity;
+
+  /** Tile width, 0 if not tiled. */
+  SInt m_tileW;
+
+  /** Tile height, 0 if not tiled. */
+  SInt m_tileH;
+
+  /** Worker pool for the tiles, not owned. */
+  HeatWaveWorkerPool * m_pool;
+
+
   /** A HeatWaveLift member. */
   HeatWaveLift m_lift;
 };
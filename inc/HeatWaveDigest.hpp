@@ -0,0 +1,219 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveDigest.hpp
+ ** @brief  Contains the HeatWaveDigest class definition.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVEDIGEST_HPP__
+#define __HEATWAVEDIGEST_HPP__
+
+#include "CommonHeaders.hpp"
+#include "HeatWaveWorkerPool.hpp"
+#include "HeatWaveVideo.hpp"
+
+/**
+ ** A one shot hash function, writing the digest of a block of bytes.
+ **/
+
+typedef void (*HeatWaveHashFunction)(const UInt8 * data, SInt len,
+                                     UInt8 * out);
+
+/****************************************************************************/
+/**
+ ** Digests the samples of a video as a tree, so that the blocks can be
+ ** hashed in parallel. Each component is cut into bands of rows of about
+ ** the chunk size, the leaves, which are hashed by jobs. A component digest
+ ** is the hash of a header and its leaf digests, a frame digest the hash of
+ ** its component digests and the root the hash of the frame digests. The
+ ** frame digests tell which frames of two videos differ. The hash function
+ ** is given, so that libraries outside this one (e.g. MD5) may be used as
+ ** well as the built in xxHash64 and CRC32C.
+ **
+ ** The samples are hashed as little endian 32 bit integers, packed
+ ** components as if unpacked. The header holds the top left corner, width,
+ ** height, steps, precision and sign of the component, the same way, so
+ ** components of the same samples in another shape differ. Digests are
+ ** comparable between builds and machines, for the same chunk size.
+ **
+ **/
+
+class HeatWaveDigest
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param fn The hash function.
+   * @param size The digest size in bytes of the hash function.
+   * @param chunk The leaf size in bytes, at least one row. (1 MiB by default)
+   *
+   **/
+
+  HeatWaveDigest(HeatWaveHashFunction fn, SInt size, SInt chunk = 1048576);
+
+  /**
+   *
+   * Destructor.
+   *
+   **/
+
+  ~HeatWaveDigest();
+
+  /**
+   *
+   * Digest the samples of all images of a video. The video is read only.
+   *
+   * @param vid The video.
+   * @param pool The pool running the jobs, NULL to run them here.
+   *
+   **/
+
+  void DoDigest(const HeatWaveVideo & vid, HeatWaveWorkerPool * pool = NULL);
+
+  /**
+   *
+   * @return The digest size in bytes.
+   *
+   **/
+
+  SInt GetSize() const;
+
+  /**
+   *
+   * @return The number of frames digested.
+   *
+   **/
+
+  SInt GetFrameN() const;
+
+  /**
+   *
+   * @param num The frame number.
+   * @return The digest of the frame.
+   *
+   **/
+
+  const UInt8 * GetFrame(SInt num) const;
+
+  /**
+   *
+   * @return The digest of all frames.
+   *
+   **/
+
+  const UInt8 * GetRoot() const;
+
+  /**
+   *
+   * Write a digest as lower case hexadecimal.
+   *
+   * @param dig The digest.
+   * @param size The digest size in bytes.
+   * @param hex The text, of at least 2*size+1 characters.
+   *
+   **/
+
+  static void GetHex(const UInt8 * dig, SInt size, Char * hex);
+
+  /**
+   *
+   * The xxHash64 of a block of bytes.
+   *
+   * @param data The bytes.
+   * @param len The number of bytes.
+   * @param seed The seed. (0 by default)
+   * @return The hash.
+   *
+   **/
+
+  static UInt64 GetXXH64(const UInt8 * data, SInt len, UInt64 seed = 0);
+
+  /**
+   *
+   * The CRC32C (Castagnoli) of a block of bytes, using the SSE4.2 crc32
+   * instruction where the processor has it.
+   *
+   * @param data The bytes.
+   * @param len The number of bytes.
+   * @param crc The CRC of the bytes before, to continue. (0 by default)
+   * @return The CRC.
+   *
+   **/
+
+  static UInt32 GetCRC32C(const UInt8 * data, SInt len, UInt32 crc = 0);
+
+  /*@{*/
+  /**
+   *
+   * The built in hash functions, with the digest in big endian order.
+   *
+   * @param data The bytes.
+   * @param len The number of bytes.
+   * @param out The digest, 8 bytes for xxHash64 and 4 for CRC32C.
+   *
+   **/
+
+  static void DoXXH64(const UInt8 * data, SInt len, UInt8 * out);
+  static void DoCRC32C(const UInt8 * data, SInt len, UInt8 * out);
+  /*@}*/
+
+protected:
+
+  /**
+   *
+   * Hash a number of digests into one.
+   *
+   * @param digs The digests.
+   * @param num The number of digests.
+   * @param out The digest.
+   *
+   **/
+
+  void DoCombine(const UInt8 * digs, SInt num, UInt8 * out) const;
+
+  /**
+   *
+   * Hash the header of a component and its leaf digests into one.
+   *
+   * @param cmp The component.
+   * @param digs The leaf digests.
+   * @param num The number of leaf digests.
+   * @param out The digest.
+   *
+   **/
+
+  void DoCombine(const HeatWaveComponent & cmp, const UInt8 * digs, SInt num,
+                 UInt8 * out) const;
+
+  /** The hash function. */
+  HeatWaveHashFunction m_fn;
+
+  /** The digest size. */
+  SInt m_size;
+
+  /** The leaf size. */
+  SInt m_chunk;
+
+  /** The frame digests. */
+  UInt8 * m_frames;
+
+  /** The number of frames. */
+  SInt m_framen;
+
+  /** The root digest. */
+  UInt8 * m_root;
+
+private:
+
+  /** Not copyable. */
+  HeatWaveDigest(const HeatWaveDigest &);
+
+  /** Not assignable. */
+  HeatWaveDigest & operator=(const HeatWaveDigest &);
+};
+
+#endif // __HEATWAVEDIGEST_HPP__
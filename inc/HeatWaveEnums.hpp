@@ -538,6 +538,21 @@ enum EnumVideoType
     /** GREY type */
     VidGREY,
     
+    /** YV12 type, planar 4:2:0 with V before U */
+    VidYV12,
+    
+    /** NV12 type, 4:2:0 with a Y plane and a interleaved UV plane */
+    VidNV12,
+    
+    /** YUY2 type, packed 4:2:2 in Y0 U Y1 V order */
+    VidYUY2,
+    
+    /** UYVY type, packed 4:2:2 in U Y0 V Y1 order */
+    VidUYVY,
+    
+    /** Uncompressed (BI_RGB) 24-bit bitmaps, B G R order */
+    VidRGB,
+    
     /** Total FCC */
     VidTotal,
 
@@ -561,6 +576,11 @@ VideoTypeName (EnumVideoType vid, Bool vrb = False)
   switch (vid){
   case VidIYUV:return vrb?"YUV 4:1:1":"IYUV";
   case VidGREY:return vrb?"Grey 1":"GREY";
+  case VidYV12:return vrb?"YVU 4:2:0":"YV12";
+  case VidNV12:return vrb?"YUV 4:2:0 interleaved UV":"NV12";
+  case VidYUY2:return vrb?"YUYV 4:2:2":"YUY2";
+  case VidUYVY:return vrb?"UYVY 4:2:2":"UYVY";
+  case VidRGB:return vrb?"BGR 24-bit":"DIB ";
   default: return "VideoTypeName() error!";
   }
 }
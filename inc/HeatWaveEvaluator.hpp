@@ -0,0 +1,276 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveEvaluator.hpp
+ ** @brief  Contains the HeatWaveEvaluator class definition.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVEEVALUATOR_HPP__
+#define __HEATWAVEEVALUATOR_HPP__
+
+#include "CommonHeaders.hpp"
+#include "HeatWaveEnums.hpp"
+#include "HeatWaveWorkerPool.hpp"
+#include "HeatWaveImage.hpp"
+#include "HeatWaveVideo.hpp"
+#include "HeatWaveQuantizer.hpp"
+
+/**
+ ** The score of one sub-band, summed over all evaluated images.
+ **/
+
+typedef struct
+{
+  /** The transform. */
+  EnumTransform m_trn;
+
+  /** The base quantizer step, 1 for the samples as they are. */
+  SFloat64 m_step;
+
+  /** The transform level. */
+  SInt m_lev;
+
+  /** The component number. */
+  SInt m_cmp;
+
+  /** The resolution level of the sub-band. */
+  SInt m_res;
+
+  /** The sub-band. */
+  EnumSubband m_sub;
+
+  /** The number of samples. */
+  SFloat64 m_samples;
+
+  /** Zero order entropy in bits, the entropy per sample times samples. */
+  SFloat64 m_entropy;
+
+  /** Size in bits of the samples coded with their own Huffman code. */
+  SFloat64 m_huffman;
+
+  /** Squared error of the reconstruction of the quantized samples,
+   ** weighted by the squared sub-band norm to estimate the error in the
+   ** image. */
+  SFloat64 m_distortion;
+} HeatWaveScore;
+
+/****************************************************************************/
+/**
+ ** Scores a set of transforms and levels on the same images in one run, to
+ ** pick the best wavelet for a corpus. Each component of each image is
+ ** transformed once per transform, by a job working on its own copy, while
+ ** the images are only read. The sub-bands are scored level by level on the
+ ** way up, so all levels cost one transform to the highest level.
+ ** Lossy sweeps add base quantizer steps: every sub-band is then also
+ ** quantized at each step on the way (see HeatWaveQuantizer) and the
+ ** quantization indices scored, with the error of their reconstruction,
+ ** without transforming again.
+ ** The scores are kept in a table with, for each transform, step and level
+ ** (in the order added) and each component, the detail sub-bands of
+ ** resolution 1 to the level followed by the LL sub-band of the level.
+ **
+ **/
+
+class HeatWaveEvaluator
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   **/
+
+  HeatWaveEvaluator();
+
+  /**
+   *
+   * Destructor.
+   *
+   **/
+
+  ~HeatWaveEvaluator();
+
+  /**
+   *
+   * Add a transform to evaluate.
+   *
+   * @param trn The transform.
+   *
+   **/
+
+  void AddTransform(EnumTransform trn);
+
+  /**
+   *
+   * Add a level to evaluate, 0 scores the untransformed component.
+   *
+   * @param lev The level.
+   *
+   **/
+
+  void AddLevel(SInt lev);
+
+  /**
+   *
+   * Add a base quantizer step to evaluate. Without any the samples are
+   * scored as they are, as with a step of 1.
+   *
+   * @param step The base step.
+   *
+   **/
+
+  void AddStep(SFloat64 step);
+
+  /**
+   *
+   * Score all transforms and levels on a image. The image is read only.
+   *
+   * @param img The image.
+   * @param pool The pool running the jobs, NULL to run them here.
+   *
+   **/
+
+  void DoEvaluate(const HeatWaveImage & img, HeatWaveWorkerPool * pool = NULL);
+
+  /**
+   *
+   * Score all transforms and levels on the images of a video, the scores
+   * are summed.
+   *
+   * @param vid The video.
+   * @param pool The pool running the jobs, NULL to run them here.
+   *
+   **/
+
+  void DoEvaluate(const HeatWaveVideo & vid, HeatWaveWorkerPool * pool = NULL);
+
+  /**
+   *
+   * @return The number of scores.
+   *
+   **/
+
+  SInt GetScoreN() const;
+
+  /**
+   *
+   * @param num The score number.
+   * @return The score.
+   *
+   **/
+
+  const HeatWaveScore & GetScore(SInt num) const;
+
+  /**
+   *
+   * Clear the scores, the transforms and levels are kept.
+   *
+   **/
+
+  void DoClear();
+
+  /**
+   *
+   * The size in bits of samples coded with a Huffman code made for them.
+   *
+   * @param hist The histogram of the samples.
+   * @param range The histogram length.
+   * @return The size in bits.
+   *
+   **/
+
+  static SFloat64 GetHuffmanBits(const Smpl * hist, SInt range);
+
+protected:
+
+  /**
+   *
+   * Score all transforms and levels on a number of images, the jobs of
+   * all images are queued before waiting.
+   *
+   * @param imga The images.
+   * @param imgn The number of images.
+   * @param pool The pool running the jobs, NULL to run them here.
+   *
+   **/
+
+  void DoEvaluate(const HeatWaveImage * const * imga, SInt imgn,
+                  HeatWaveWorkerPool * pool);
+
+  /**
+   *
+   * Find the first score of a transform, step, level and component, making
+   * the table if need be.
+   *
+   * @param trn The transform number, in the order added.
+   * @param stp The step number, in the order added.
+   * @param lev The level number, in the order added.
+   * @param cmp The component number.
+   * @return The score number.
+   *
+   **/
+
+  SInt GetScoreAt(SInt trn, SInt stp, SInt lev, SInt cmp);
+
+  /**
+   *
+   * @return The number of steps, 1 if none were added.
+   *
+   **/
+
+  SInt GetStepN() const;
+
+  /**
+   *
+   * @param stp The step number.
+   * @return The base step.
+   *
+   **/
+
+  SFloat64 GetStepAt(SInt stp) const;
+
+  /** The transforms. */
+  EnumTransform * m_trna;
+
+  /** The number of transforms. */
+  SInt m_trnn;
+
+  /** The levels. */
+  SInt * m_leva;
+
+  /** The number of levels. */
+  SInt m_levn;
+
+  /** The highest level. */
+  SInt m_levMax;
+
+  /** The base quantizer steps. */
+  SFloat64 * m_stpa;
+
+  /** The number of steps. */
+  SInt m_stpn;
+
+  /** The quantizer, for the sub-band steps and norms. */
+  HeatWaveQuantizer m_qnt;
+
+  /** The scores. */
+  HeatWaveScore * m_scorea;
+
+  /** The number of scores. */
+  SInt m_scoren;
+
+  /** The number of components in the table. */
+  SInt m_cmpn;
+
+private:
+
+  /** Not copyable. */
+  HeatWaveEvaluator(const HeatWaveEvaluator &);
+
+  /** Not assignable. */
+  HeatWaveEvaluator & operator=(const HeatWaveEvaluator &);
+};
+
+#endif //__HEATWAVEEVALUATOR_HPP__
@@ -0,0 +1,350 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveFloatComponent.hpp
+ ** @brief  Contains the HeatWaveFloatComponent class definition.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVEFLOATCOMPONENT_HPP__
+#define __HEATWAVEFLOATCOMPONENT_HPP__
+
+#include "HeatWaveEnums.hpp"
+#include "HeatWaveComponent.hpp"
+
+/** CDF 9/7 first predict coefficient. **/
+#define HEATWAVEF97ALPHA (-1.586134342059924f)
+
+/** CDF 9/7 first update coefficient. **/
+#define HEATWAVEF97BETA  (-0.052980118572961f)
+
+/** CDF 9/7 second predict coefficient. **/
+#define HEATWAVEF97GAMMA ( 0.882911075530934f)
+
+/** CDF 9/7 second update coefficient. **/
+#define HEATWAVEF97DELTA ( 0.443506852043971f)
+
+/** CDF 9/7 scaling, low pass is divided, high pass multiplied by it. **/
+#define HEATWAVEF97K     ( 1.230174104914001f)
+
+/****************************************************************************/
+/**
+ ** The float component class. A single precision floating point sample
+ ** matrix using the same grid (top left coordinates and Mallat sub-band
+ ** layout) as HeatWaveComponent, on which the irreversible CDF 9/7 wavelet
+ ** can be applied with its true (irrational) lifting coefficients and
+ ** scaling steps. Samples are converted from and to integer components by
+ ** SetComponent() and GetComponent().
+ **
+ **/
+
+class HeatWaveFloatComponent
+{
+public:
+
+  /**
+   *
+   * Default constructor.
+   *
+   **/
+
+  HeatWaveFloatComponent();
+
+  /**
+   *
+   * Conversion constructor.
+   *
+   * @param cmp The integer component to convert.
+   *
+   **/
+
+  HeatWaveFloatComponent(const HeatWaveComponent & cmp);
+
+  /**
+   *
+   * Copy constructor.
+   *
+   * @param oth The other HeatWaveFloatComponent to copy.
+   *
+   **/
+
+  HeatWaveFloatComponent(const HeatWaveFloatComponent & oth);
+
+  /**
+   *
+   * Destructor.
+   *
+   **/
+
+  ~HeatWaveFloatComponent();
+
+  /**
+   *
+   * @return Top left x-coordinate.
+   *
+   **/
+
+  SInt GetTLX() const;
+
+  /**
+   *
+   * @return Top left y-coordinate.
+   *
+   **/
+
+  SInt GetTLY() const;
+
+  /**
+   *
+   * @return The width.
+   *
+   **/
+
+  SInt GetWidth() const;
+
+  /**
+   *
+   * @return The height.
+   *
+   **/
+
+  SInt GetHeight() const;
+
+  /**
+   *
+   * @return The number of samples.
+   *
+   **/
+
+  SInt GetSize() const;
+
+  /**
+   *
+   * @return The current transform level.
+   *
+   **/
+
+  SInt GetTransformLevel() const;
+
+  /**
+   *
+   * Set the transform level, for samples written by other means (e.g. a
+   * HeatWaveLineTransform).
+   *
+   * @param lev The transform level.
+   *
+   **/
+
+  void SetTransformLevel(SInt lev);
+
+  /**
+   *
+   * @return A pointer to the (row by row) sample data.
+   *
+   **/
+
+  SFloat32 * GetData() const;
+
+  /**
+   *
+   * Get the value of a sample.
+   *
+   * @param x The x-coordinate.
+   * @param y The y-coordinate.
+   * @return The sample value.
+   *
+   **/
+
+  SFloat32 GetSmpl(const SInt x, const SInt y) const;
+
+  /**
+   *
+   * Set the value of a sample.
+   *
+   * @param x The x-coordinate.
+   * @param y The y-coordinate.
+   * @param val The new value.
+   *
+   **/
+
+  void SetSmpl(const SInt x, const SInt y, const SFloat32 val);
+
+  /**
+   *
+   * Replace the samples, size, position and transform level with those of
+   * an integer component.
+   *
+   * @param cmp The integer component.
+   *
+   **/
+
+  void SetComponent(const HeatWaveComponent & cmp);
+
+  /**
+   *
+   * Write the samples (rounded to the nearest integer) into an integer
+   * component, resizing it if needed. The transform level is copied and the
+   * transform type set to Trn9m7, the precision and sign are set to the
+   * minimum needed.
+   *
+   * @param cmp The integer component.
+   *
+   **/
+
+  void GetComponent(HeatWaveComponent & cmp) const;
+
+  /**
+   *
+   * Perform a single level 2D CDF 9/7 transform on an area.
+   *
+   * @param fwd Forward transform, else inverse transform.
+   * @param tlx The top left x-coordinate.
+   * @param tly The top left y-coordinate.
+   * @param width The width.
+   * @param height The height.
+   * @return True if successful.
+   *
+   **/
+
+  Bool DoTransform(Bool fwd, SInt tlx, SInt tly, SInt width, SInt height);
+
+  /**
+   *
+   * Pyramid type CDF 9/7 transform.
+   *
+   * @param lev The level to transform to.
+   * @param fwd Forward transform, else inverse transform. (Forward by default)
+   * @return The new level of transform.
+   *
+   **/
+
+  SInt DoPyramidTransform(SInt lev, Bool fwd = True);
+
+  /**
+   *
+   * Get the area of a sub-band, same layout as
+   * HeatWaveComponent::GetSubbandInfo().
+   *
+   * @param res The resolution level, 0 is the whole component.
+   * @param sub The sub-band.
+   * @param x The top left x-coordinate (returned).
+   * @param y The top left y-coordinate (returned).
+   * @param width The width (returned).
+   * @param height The height (returned).
+   * @return True if the sub-band exists.
+   *
+   **/
+
+  Bool GetSubbandInfo(SInt res, EnumSubband sub, SInt & x, SInt & y,
+                      SInt & width, SInt & height) const;
+
+  /**
+   *
+   * Validate coordinates.
+   *
+   * @param x The x-coordinate.
+   * @param y The y-coordinate.
+   * @return True if the coordinates are within this component.
+   *
+   **/
+
+  Bool ValidateCoords(SInt x, SInt y) const;
+
+  /**
+   *
+   * Assignment operator.
+   *
+   * @param rhs The right hand side.
+   * @return A reference to this.
+   *
+   **/
+
+  HeatWaveFloatComponent & operator=(const HeatWaveFloatComponent & rhs);
+
+  /**
+   *
+   * Lift a single line of interleaved samples (even, odd, even, ...).
+   * Whole sample symmetric extension is used at both ends. The lifting
+   * and scaling steps use SSE2 where available, rounding the same as the
+   * scalar loops.
+   *
+   * @param buf The samples.
+   * @param len The length of the line.
+   * @param fwd Forward transform, else inverse transform.
+   *
+   **/
+
+  static void DoLiftLine(SFloat32 * buf, SInt len, Bool fwd);
+
+protected:
+
+  /**
+   *
+   * Transform lines of an area in a single direction.
+   *
+   * @param fwd Forward transform, else inverse transform.
+   * @param wid The width.
+   * @param hei The height.
+   * @param hor Do a horizontal transform, else vertical.
+   * @param mem The pointer to the first sample.
+   *
+   **/
+
+  void DoTransformInternal(Bool fwd, SInt wid, SInt hei, Bool hor,
+                           SFloat32 * mem);
+
+  /**
+   *
+   * Create the sample and line buffers.
+   *
+   * @param width The width.
+   * @param height The height.
+   *
+   **/
+
+  void DoCreate(SInt width, SInt height);
+
+  /**
+   *
+   * Destroy allocated memory.
+   *
+   **/
+
+  void DoDestroy();
+
+  /**
+   *
+   * Void copy command.
+   *
+   * @param rhs The object to copy.
+   *
+   **/
+
+  void DoCopy(const HeatWaveFloatComponent & rhs);
+
+  /** Top left x-coordinate. */
+  SInt m_tlx;
+
+  /** Top left y-coordinate. */
+  SInt m_tly;
+
+  /** Width. */
+  SInt m_width;
+
+  /** Height. */
+  SInt m_height;
+
+  /** Number of samples. */
+  SInt m_size;
+
+  /** Transform level. */
+  SInt m_lev;
+
+  /** The sample data, row by row. */
+  SFloat32 * m_data;
+
+  /** Line buffer, large enough for the longest line. */
+  SFloat32 * m_buffer;
+};
+
+#endif //__HEATWAVEFLOATCOMPONENT_HPP__
@@ -327,6 +327,16 @@ public:
 
   HeatWaveImage * GetClone() const;
 
+  /**
+   *
+   * Swap the contents of two images without copying components.
+   *
+   * @param other The other image.
+   *
+   **/
+
+  void DoSwap(HeatWaveImage & other);
+
   /**
    *
    * Get the comparability of an image, returns true if both images share
@@ -412,6 +422,40 @@ public:
   SInt DoPyramidTransform(EnumTransform trn, SInt lev,
                           Bool fwd = True, SInt cur = -1);
   
+  /**
+   *
+   * Pack all sub-components into 16-bit samples, where possible.
+   *
+   * @param trn The transform to be applied after packing. (Trn0_0 by default)
+   * @param lev The number of levels to be applied. (0 by default)
+   * @return True if all sub-components were packed.
+   * @see HeatWaveComponent::DoPack()
+   *
+   **/
+  
+  Bool DoPack(EnumTransform trn = Trn0_0, SInt lev = 0);
+  
+  /**
+   *
+   * Set the tiling of all sub-components.
+   *
+   * @param twd The tile width, 0 or less to disable tiling.
+   * @param thg The tile height, 0 or less to disable tiling.
+   * @param pool The worker pool to transform the tiles on. (NULL by default)
+   * @see HeatWaveComponent::SetTiling()
+   *
+   **/
+  
+  void SetTiling(SInt twd, SInt thg, HeatWaveWorkerPool * pool = NULL);
+  
+  /**
+   *
+   * Unpack all sub-components back to full precision samples.
+   *
+   **/
+  
+  void DoUnpack();
+  
   /**
    *
    * Perform a (traditional) wavelet type transform, between (inter)
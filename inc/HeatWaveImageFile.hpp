@@ -0,0 +1,157 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveImageFile.hpp
+ ** @brief  Contains the HeatWaveImageFile class definition.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVEIMAGEFILE_HPP__
+#define __HEATWAVEIMAGEFILE_HPP__
+
+#include "CommonHeaders.hpp"
+#include "HeatWaveImage.hpp"
+
+/****************************************************************************/
+/**
+ ** Native readers and writers for the simple uncompressed image formats,
+ ** uncompressed BMP (8 bit grey or palette, 24 and 32 bit) and binary PNM
+ ** (P5 and P6, 8 and 16 bit), so that these need not go through a general
+ ** image library. Files are read through a memory map where the system has
+ ** one, else into a buffer, and the samples widened straight into the
+ ** component planes, writes narrow the samples a row at a time. Anything
+ ** else is left to the caller, i.e. a read returns NULL without an error
+ ** message and IsWritable() returns False.
+ **
+ **/
+
+class HeatWaveImageFile
+{
+public:
+
+  /**
+   *
+   * Read a image, if in a native format.
+   *
+   * @param file The file name.
+   * @param form The format name ("bmp" or "pnm"), NULL to go by the
+   * contents.
+   * @param errm (OUT) NULL, else the reason a native file could not be read.
+   * @return The image, NULL if not read.
+   *
+   **/
+
+  static HeatWaveImage * DoRead(const Char * file, const Char * form,
+                                const Char *& errm);
+
+  /**
+   *
+   * Check if a image can be written natively. It must have 1 (grey) or 3
+   * (RGB) unsigned components of the image size and no sub sampling, of at
+   * most 8 bits for BMP and 16 bits for PNM.
+   *
+   * @param img The image.
+   * @param file The file name, the format is taken from the extension if
+   * not given.
+   * @param form The format name ("bmp" or "pnm"), may be NULL.
+   * @return True if DoWrite() can write it.
+   *
+   **/
+
+  static Bool IsWritable(const HeatWaveImage & img, const Char * file,
+                         const Char * form);
+
+  /**
+   *
+   * Write a image natively, samples out of range are clipped.
+   *
+   * @param img The image.
+   * @param file The file name.
+   * @param form The format name, may be NULL.
+   * @param errm (OUT) NULL, else the reason it could not be written.
+   * @return True on success.
+   * @see IsWritable()
+   *
+   **/
+
+  static Bool DoWrite(const HeatWaveImage & img, const Char * file,
+                      const Char * form, const Char *& errm);
+
+protected:
+
+  /**
+   *
+   * The native formats.
+   *
+   **/
+
+  enum EnumFormat {
+    /** Not a native format. */
+    FmtNone = 0,
+    /** Windows bitmap. */
+    FmtBMP,
+    /** Portable any map. */
+    FmtPNM
+  };
+
+  /**
+   *
+   * Get the format from a format name or file extension.
+   *
+   * @param file The file name, may be NULL.
+   * @param form The format name, may be NULL.
+   * @return The format.
+   *
+   **/
+
+  static EnumFormat GetFormat(const Char * file, const Char * form);
+
+  /*@{*/
+  /**
+   *
+   * Decode a mapped file.
+   *
+   * @param data The file contents.
+   * @param size The file size.
+   * @param errm (OUT) The reason it could not be decoded.
+   * @return The image, NULL on error.
+   *
+   **/
+
+  static HeatWaveImage * DoReadBMP(const UInt8 * data, SInt64 size,
+                                   const Char *& errm);
+  static HeatWaveImage * DoReadPNM(const UInt8 * data, SInt64 size,
+                                   const Char *& errm);
+  /*@}*/
+
+  /**
+   *
+   * Decode a file by its magic number.
+   *
+   * @param data The file contents, at least 2 bytes.
+   * @param size The file size.
+   * @param errm (OUT) The reason it could not be decoded.
+   * @return The image, NULL on error or if not a native format.
+   *
+   **/
+
+  static HeatWaveImage * DoReadData(const UInt8 * data, SInt64 size,
+                                    const Char *& errm);
+
+  /*@{*/
+  /**
+   *
+   * Encode a image to a open file.
+   *
+   * @param img The image.
+   * @param out The file.
+   * @return True on success.
+   *
+   **/
+
+  static Bool DoWriteBMP(const HeatWaveImage & img, FILE * out);
+  static Bool DoWritePNM(const HeatWaveImage & img, FILE * out);
+  /*@}*/
+};
+
+#endif // __HEATWAVEIMAGEFILE_HPP__
@@ -29,6 +29,11 @@ class HeatWaveImage;
  ** Michael David Adams
  ** </li></ul>
  **
+ ** Split, Join and the lifting functions are templates on the sample type and
+ ** are instantiated for both Smpl and the compact Smpl16 sample types. The
+ ** (2,2) steps also lift whole runs of contiguous samples, and whole rows of
+ ** columns with DoLiftColumns(), which use SSE2 for both where available.
+ **
  ** @todo 1. Finite Data Range (FDR) or Property of Precision Preservation
  ** (PPP) is possible. Default is not to use it.<br> 2. Edges are dealt with
  ** using the half or full sample symmetry model.  <a
@@ -111,7 +116,8 @@ public:
    *
    **/
   
-  void Split(Smpl * dat, SInt len, SInt stp, Smpl* & evn, Smpl* & odd);
+  template <class T>
+  void Split(T * dat, SInt len, SInt stp, T* & evn, T* & odd);
   
   /**
    *
@@ -123,7 +129,38 @@ public:
    *
    **/
   
-  void Join(Smpl * dat, SInt len, SInt stp);
+  template <class T>
+  void Join(T * dat, SInt len, SInt stp);
+
+  /**
+   *
+   * Split neighbouring signals a row at a time, e.g. the columns of a
+   * component, moving the even rows up and the odd rows below them. The
+   * same as Split() on each column.
+   *
+   * @param dat The first sample of the first signal.
+   * @param len The number of rows.
+   * @param num The number of signals.
+   * @param stp The distance between rows, at least num.
+   *
+   **/
+
+  template <class T>
+  void SplitRows(T * dat, SInt len, SInt num, SInt stp);
+
+  /**
+   *
+   * Join neighbouring signals split by SplitRows().
+   *
+   * @param dat The first sample of the first signal.
+   * @param len The number of rows.
+   * @param num The number of signals.
+   * @param stp The distance between rows, at least num.
+   *
+   **/
+
+  template <class T>
+  void JoinRows(T * dat, SInt len, SInt num, SInt stp);
 
   /**
    * 
@@ -218,12 +255,18 @@ public:
   typedef void (HeatWaveLift::*m_lftFunction)(Smpl *, Smpl *, SInt, SInt, 
                                               Bool) const;
 
+  /** Function prototype used with all 16-bit sample lifting functions. **/
+
+  typedef void (HeatWaveLift::*m_lftFunction16)(Smpl16 *, Smpl16 *, SInt, 
+                                                SInt, Bool) const;
+
   /**
    *
    * Fill a list of function pointers using certain criteria that can be
    * called to perform lifting.
    *
-   * @param func [OUT] The array of function pointers. 
+   * @param func [OUT] The array of function pointers, either m_lftFunction
+   * or m_lftFunction16 depending on the sample type being lifted.
    * (Length of HEATWAVELIFTMAXSTEPS required) 
    * @param tran The transform type.
    * @param dirs The direction, true for forward else inverse.
@@ -233,8 +276,58 @@ public:
    *
    **/
   
-  SInt GetFuncArray(HeatWaveLift::m_lftFunction * func, EnumTransform tran,
-                    Bool dirs, Bool prd = True, Bool upd = True);
+  template <class T>
+  SInt GetFuncArray(void (HeatWaveLift::** func)(T *, T *, SInt, SInt, 
+                                                 Bool) const, 
+                    EnumTransform tran, Bool dirs, Bool prd = True, 
+                    Bool upd = True);
+
+  /**
+   *
+   * @param tran The transform type.
+   * @return True if the lifting steps of the transform lift a row of
+   * neighbouring signals at once in DoLiftColumns().
+   *
+   **/
+
+  static Bool HasRowKernels(EnumTransform tran);
+
+  /**
+   *
+   * Run a lifting step over neighbouring signals, e.g. the columns of a
+   * component, signal k starting at even+k and odd+k. Steps with row kernels
+   * go through all signals a row at a time, others lift the signals in turn.
+   *
+   * @param func The lifting step, see GetFuncArray().
+   * @param even The even samples of the first signal.
+   * @param odd The odd samples of the first signal.
+   * @param len The length of the signals.
+   * @param step The inter sample distance, at least num.
+   * @param num The number of signals.
+   * @param forward Do forward transform else inverse.
+   *
+   **/
+
+  template <class T>
+  void DoLiftColumns(void (HeatWaveLift::* func)(T *, T *, SInt, SInt, 
+                                                 Bool) const,
+                     T * even, T * odd, SInt len, SInt step, SInt num, 
+                     Bool forward) const;
+
+  /**
+   *
+   * Measure the worst case growth of the sample range for a single (one
+   * dimensional) forward pass of a transform. The gains are the L1 norms of
+   * the low and high pass responses, taken after every lifting step so that
+   * intermediate values are also accounted for.
+   *
+   * @param tran The transform type.
+   * @param low (OUT) The gain of the low pass (even) samples.
+   * @param high (OUT) The gain of the high pass (odd) samples.
+   *
+   **/
+
+  void GetGains(EnumTransform tran, SFloat64 & low, SFloat64 & high) const;
 
   /*@{*/
   /**
@@ -247,10 +340,14 @@ public:
    **/
 
 
-  inline void Trn1_1PrdFwd(const Smpl & a, Smpl & b) const;
-  inline void Trn1_1UpdFwd(Smpl & a, const Smpl & b) const;
-  inline void Trn1_1UpdRev(Smpl & a, const Smpl & b) const;
-  inline void Trn1_1PrdRev(const Smpl & a, Smpl & b) const;
+  template <class T>
+  inline void Trn1_1PrdFwd(const T & a, T & b) const;
+  template <class T>
+  inline void Trn1_1UpdFwd(T & a, const T & b) const;
+  template <class T>
+  inline void Trn1_1UpdRev(T & a, const T & b) const;
+  template <class T>
+  inline void Trn1_1PrdRev(const T & a, T & b) const;
   /*@}*/
 
   /*@{*/
@@ -264,10 +361,14 @@ public:
    **/
 
 
-  inline void Trn1_1mPrdFwd(const Smpl & a, Smpl & b) const;
-  inline void Trn1_1mUpdFwd(Smpl & a, const Smpl & b) const;
-  inline void Trn1_1mUpdRev(Smpl & a, const Smpl & b) const;
-  inline void Trn1_1mPrdRev(const Smpl & a, Smpl & b) const;
+  template <class T>
+  inline void Trn1_1mPrdFwd(const T & a, T & b) const;
+  template <class T>
+  inline void Trn1_1mUpdFwd(T & a, const T & b) const;
+  template <class T>
+  inline void Trn1_1mUpdRev(T & a, const T & b) const;
+  template <class T>
+  inline void Trn1_1mPrdRev(const T & a, T & b) const;
   /*@}*/
   
   /*@{*/
@@ -281,10 +382,14 @@ public:
    *
    **/
   
-  inline void Trn2_2PrdFwd(const Smpl & a, Smpl & b, const Smpl & c) const;
-  inline void Trn2_2UpdFwd(const Smpl & a, Smpl & b, const Smpl & c) const;
-  inline void Trn2_2UpdRev(const Smpl & a, Smpl & b, const Smpl & c) const;
-  inline void Trn2_2PrdRev(const Smpl & a, Smpl & b, const Smpl & c) const;
+  template <class T>
+  inline void Trn2_2PrdFwd(const T & a, T & b, const T & c) const;
+  template <class T>
+  inline void Trn2_2UpdFwd(const T & a, T & b, const T & c) const;
+  template <class T>
+  inline void Trn2_2UpdRev(const T & a, T & b, const T & c) const;
+  template <class T>
+  inline void Trn2_2PrdRev(const T & a, T & b, const T & c) const;
   /*@}*/
 
   /*@{*/
@@ -300,10 +405,12 @@ public:
    *
    **/
   
-  inline void Trn2p2_2PrdFwd(const Smpl & a, const Smpl & b, Smpl & c, 
-                             const Smpl & d, const Smpl & e) const;
-  inline void Trn2p2_2PrdRev(const Smpl & a, const Smpl & b, Smpl & c, 
-                             const Smpl & d, const Smpl & e) const;
+  template <class T>
+  inline void Trn2p2_2PrdFwd(const T & a, const T & b, T & c, 
+                             const T & d, const T & e) const;
+  template <class T>
+  inline void Trn2p2_2PrdRev(const T & a, const T & b, T & c, 
+                             const T & d, const T & e) const;
   /*@}*/
   
   /*@{*/
@@ -319,19 +426,25 @@ public:
    *
    **/
   
-  inline void Trn4_4PrdFwd(const Smpl & a, const Smpl & b, Smpl & c, 
-                           const Smpl & d,const Smpl & e) const;
-  inline void Trn4_4UpdFwd(const Smpl & a, const Smpl & b, Smpl & c, 
-                           const Smpl & d,const Smpl & e) const;
-  inline void Trn4_4UpdRev(const Smpl & a, const Smpl & b, Smpl & c, 
-                           const Smpl & d,const Smpl & e) const;
-  inline void Trn4_4PrdRev(const Smpl & a, const Smpl & b, Smpl & c, 
-                           const Smpl & d,const Smpl & e) const;
-
-  inline void Trn4_4BUpdFwd(const Smpl & a, const Smpl & b, Smpl & c, 
-                            const Smpl & d,const Smpl & e) const;
-  inline void Trn4_4BUpdRev(const Smpl & a, const Smpl & b, Smpl & c, 
-                            const Smpl & d,const Smpl & e) const;
+  template <class T>
+  inline void Trn4_4PrdFwd(const T & a, const T & b, T & c, 
+                           const T & d,const T & e) const;
+  template <class T>
+  inline void Trn4_4UpdFwd(const T & a, const T & b, T & c, 
+                           const T & d,const T & e) const;
+  template <class T>
+  inline void Trn4_4UpdRev(const T & a, const T & b, T & c, 
+                           const T & d,const T & e) const;
+  template <class T>
+  inline void Trn4_4PrdRev(const T & a, const T & b, T & c, 
+                           const T & d,const T & e) const;
+
+  template <class T>
+  inline void Trn4_4BUpdFwd(const T & a, const T & b, T & c, 
+                            const T & d,const T & e) const;
+  template <class T>
+  inline void Trn4_4BUpdRev(const T & a, const T & b, T & c, 
+                            const T & d,const T & e) const;
   /*@}*/
   
   /*@{*/
@@ -349,18 +462,22 @@ public:
    *
    **/
   
-  inline void Trn6_6PrdFwd(const Smpl & a, const Smpl & b, const Smpl & c, 
-                           Smpl & d, const Smpl & e, const Smpl & f,
-                           const Smpl & g) const;
-  inline void Trn6_6UpdFwd(const Smpl & a, const Smpl & b, const Smpl & c, 
-                           Smpl & d, const Smpl & e, const Smpl & f,
-                           const Smpl & g) const;
-  inline void Trn6_6UpdRev(const Smpl & a, const Smpl & b, const Smpl & c, 
-                           Smpl & d, const Smpl & e, const Smpl & f,
-                           const Smpl & g) const;
-  inline void Trn6_6PrdRev(const Smpl & a, const Smpl & b, const Smpl & c, 
-                           Smpl & d, const Smpl & e, const Smpl & f,
-                           const Smpl & g) const;
+  template <class T>
+  inline void Trn6_6PrdFwd(const T & a, const T & b, const T & c, 
+                           T & d, const T & e, const T & f,
+                           const T & g) const;
+  template <class T>
+  inline void Trn6_6UpdFwd(const T & a, const T & b, const T & c, 
+                           T & d, const T & e, const T & f,
+                           const T & g) const;
+  template <class T>
+  inline void Trn6_6UpdRev(const T & a, const T & b, const T & c, 
+                           T & d, const T & e, const T & f,
+                           const T & g) const;
+  template <class T>
+  inline void Trn6_6PrdRev(const T & a, const T & b, const T & c, 
+                           T & d, const T & e, const T & f,
+                           const T & g) const;
   /*@}*/
 
   /*@{*/
@@ -376,14 +493,22 @@ public:
    *
    **/
   
-  inline void Trn97_1PrdFwd(const Smpl & a, Smpl & b, const Smpl & c) const;
-  inline void Trn97_1UpdFwd(const Smpl & a, Smpl & b, const Smpl & c) const;
-  inline void Trn97_2PrdFwd(const Smpl & a, Smpl & b, const Smpl & c) const;
-  inline void Trn97_2UpdFwd(const Smpl & a, Smpl & b, const Smpl & c) const;
-  inline void Trn97_2UpdRev(const Smpl & a, Smpl & b, const Smpl & c) const;
-  inline void Trn97_2PrdRev(const Smpl & a, Smpl & b, const Smpl & c) const;
-  inline void Trn97_1UpdRev(const Smpl & a, Smpl & b, const Smpl & c) const;
-  inline void Trn97_1PrdRev(const Smpl & a, Smpl & b, const Smpl & c) const;
+  template <class T>
+  inline void Trn97_1PrdFwd(const T & a, T & b, const T & c) const;
+  template <class T>
+  inline void Trn97_1UpdFwd(const T & a, T & b, const T & c) const;
+  template <class T>
+  inline void Trn97_2PrdFwd(const T & a, T & b, const T & c) const;
+  template <class T>
+  inline void Trn97_2UpdFwd(const T & a, T & b, const T & c) const;
+  template <class T>
+  inline void Trn97_2UpdRev(const T & a, T & b, const T & c) const;
+  template <class T>
+  inline void Trn97_2PrdRev(const T & a, T & b, const T & c) const;
+  template <class T>
+  inline void Trn97_1UpdRev(const T & a, T & b, const T & c) const;
+  template <class T>
+  inline void Trn97_1PrdRev(const T & a, T & b, const T & c) const;
   /*@}*/
 
   /*@{*/
@@ -396,10 +521,14 @@ public:
    *
    **/
 
-  inline void TrnD4_1PrdFwd(const Smpl & a, Smpl & b) const;
-  inline void TrnD4_2PrdFwd(const Smpl & a, Smpl & b) const;
-  inline void TrnD4_2PrdRev(const Smpl & a, Smpl & b) const;
-  inline void TrnD4_1PrdRev(const Smpl & a, Smpl & b) const;
+  template <class T>
+  inline void TrnD4_1PrdFwd(const T & a, T & b) const;
+  template <class T>
+  inline void TrnD4_2PrdFwd(const T & a, T & b) const;
+  template <class T>
+  inline void TrnD4_2PrdRev(const T & a, T & b) const;
+  template <class T>
+  inline void TrnD4_1PrdRev(const T & a, T & b) const;
   /*@}*/
 
   /*@{*/
@@ -412,8 +541,10 @@ public:
    * @param c Sample b.
    *
    **/
-  inline void TrnD4_UpdFwd(const Smpl & a, Smpl & b, const Smpl & c) const;
-  inline void TrnD4_UpdRev(const Smpl & a, Smpl & b, const Smpl & c) const;
+  template <class T>
+  inline void TrnD4_UpdFwd(const T & a, T & b, const T & c) const;
+  template <class T>
+  inline void TrnD4_UpdRev(const T & a, T & b, const T & c) const;
   /*@}*/
    
   /**************************************************************************/
@@ -430,51 +561,70 @@ public:
    * 
    **/
   
-  void Trn1_1Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn1_1Prd(T * even, T * odd, SInt len, SInt step, 
                  Bool forward) const;
-  void Trn1_1Upd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn1_1Upd(T * even, T * odd, SInt len, SInt step, 
                  Bool forward) const;
 
-  void Trn1_1mPrd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn1_1mPrd(T * even, T * odd, SInt len, SInt step, 
                   Bool forward) const;
-  void Trn1_1mUpd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn1_1mUpd(T * even, T * odd, SInt len, SInt step, 
                   Bool forward) const;
   
-  void Trn2_2Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn2_2Prd(T * even, T * odd, SInt len, SInt step, 
                  Bool forward) const;
-  void Trn2_2Upd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn2_2Upd(T * even, T * odd, SInt len, SInt step, 
                  Bool forward) const;
 
-  void Trn2p2_2Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn2p2_2Prd(T * even, T * odd, SInt len, SInt step, 
                    Bool forward) const;
   
-  void Trn4_4Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn4_4Prd(T * even, T * odd, SInt len, SInt step, 
                  Bool forward) const;
-  void Trn4_4Upd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn4_4Upd(T * even, T * odd, SInt len, SInt step, 
                  Bool forward) const;
 
-  void Trn4_4BUpd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn4_4BUpd(T * even, T * odd, SInt len, SInt step, 
                   Bool forward) const;
   
-  void Trn6_6Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn6_6Prd(T * even, T * odd, SInt len, SInt step, 
                  Bool forward) const;
-  void Trn6_6Upd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn6_6Upd(T * even, T * odd, SInt len, SInt step, 
                  Bool forward) const;
 
-  void Trn97_1Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn97_1Prd(T * even, T * odd, SInt len, SInt step, 
                   Bool forward) const;
-  void Trn97_1Upd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn97_1Upd(T * even, T * odd, SInt len, SInt step, 
                   Bool forward) const;
-  void Trn97_2Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn97_2Prd(T * even, T * odd, SInt len, SInt step, 
                   Bool forward) const;
-  void Trn97_2Upd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void Trn97_2Upd(T * even, T * odd, SInt len, SInt step, 
                   Bool forward) const;
 
-  void TrnD4_1Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void TrnD4_1Prd(T * even, T * odd, SInt len, SInt step, 
                   Bool forward) const;
-  void TrnD4_Upd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void TrnD4_Upd(T * even, T * odd, SInt len, SInt step, 
                  Bool forward) const;
-  void TrnD4_2Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+  template <class T>
+  void TrnD4_2Prd(T * even, T * odd, SInt len, SInt step, 
                   Bool forward) const;
   /*@}*/
 
@@ -499,6 +649,16 @@ public:
    **/
 
   HeatWaveLift & operator=(const HeatWaveLift & oth);
+
+  /**
+   *
+   * Swap the buffers of two HeatWaveLift objects.
+   *
+   * @param oth The other HeatWaveLift object.
+   *
+   **/
+
+  void DoSwap(HeatWaveLift & oth);
   
 protected:
 
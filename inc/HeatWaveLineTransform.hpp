@@ -0,0 +1,257 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveLineTransform.hpp
+ ** @brief  Contains the HeatWaveLineTransform class definition.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVELINETRANSFORM_HPP__
+#define __HEATWAVELINETRANSFORM_HPP__
+
+#include "HeatWaveFloatComponent.hpp"
+
+/** Rows kept per level, enough for the support of the CDF 9/7 lifting. **/
+#define HEATWAVELINEROWS 6
+
+/****************************************************************************/
+/**
+ ** Receiver of the final sub-band rows of a HeatWaveLineTransform.
+ **
+ **/
+
+class HeatWaveLineSink
+{
+public:
+
+  /**
+   *
+   * Destructor.
+   *
+   **/
+
+  virtual ~HeatWaveLineSink();
+
+  /**
+   *
+   * Receive a final row segment. The coordinates are those of the Mallat
+   * layout used by HeatWaveComponent::GetSubbandInfo(), relative to the top
+   * left corner.
+   *
+   * @param x The x-coordinate of the first sample.
+   * @param y The y-coordinate.
+   * @param width The number of samples.
+   * @param row The samples, only valid during the call.
+   *
+   **/
+
+  virtual void PutRow(SInt x, SInt y, SInt width, const SFloat32 * row) = 0;
+};
+
+/****************************************************************************/
+/**
+ ** A sink writing rows into a HeatWaveFloatComponent.
+ **
+ **/
+
+class HeatWaveLineComponentSink : public HeatWaveLineSink
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param cmp The component to write to, it must be large enough.
+   *
+   **/
+
+  HeatWaveLineComponentSink(HeatWaveFloatComponent & cmp);
+
+  /**
+   *
+   * @see HeatWaveLineSink::PutRow()
+   *
+   **/
+
+  void PutRow(SInt x, SInt y, SInt width, const SFloat32 * row);
+
+protected:
+
+  /** The component written to. */
+  HeatWaveFloatComponent & m_cmp;
+};
+
+/****************************************************************************/
+/**
+ ** Line based (row streaming) multi level 2D CDF 9/7 transform. Rows are
+ ** pushed in top to bottom and each is lifted horizontally at once, the
+ ** vertical lifting steps are applied as soon as their neighbour rows are
+ ** available. Sub-band rows are handed to a HeatWaveLineSink as soon as they
+ ** are final, the LL rows feed the next level. Only HEATWAVELINEROWS rows
+ ** are kept per level, so the memory used is O(width). The output is the
+ ** same as HeatWaveFloatComponent::DoPyramidTransform(), to the bit.
+ **
+ ** It is meant for producers that deliver a frame a row at a time, such as
+ ** a capture or scan line decoder feeding an encoder. The readers in this
+ ** library (HeatWaveImageFile, HeatWaveAVIReader) hand out whole frames,
+ ** which the component transforms handle faster in place, so the tools do
+ ** not use it.
+ **
+ **/
+
+class HeatWaveLineTransform
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param width The width of the rows.
+   * @param height The number of rows.
+   * @param lev The number of levels, fewer are used if the LL becomes too
+   * small.
+   * @param sink The receiver of the final rows.
+   *
+   **/
+
+  HeatWaveLineTransform(SInt width, SInt height, SInt lev,
+                        HeatWaveLineSink * sink);
+
+  /**
+   *
+   * Destructor.
+   *
+   **/
+
+  ~HeatWaveLineTransform();
+
+  /**
+   *
+   * Push the next row.
+   *
+   * @param row The width samples of the row.
+   * @return False if all rows have already been pushed.
+   *
+   **/
+
+  Bool Push(const SFloat32 * row);
+
+  /**
+   *
+   * Push the next row.
+   *
+   * @param row The width samples of the row, e.g. from
+   * HeatWaveComponent::GetRows().
+   * @return False if all rows have already been pushed.
+   *
+   **/
+
+  Bool Push(const Smpl * row);
+
+  /**
+   *
+   * @return The number of transform levels actually applied.
+   *
+   **/
+
+  SInt GetLevels() const;
+
+  /**
+   *
+   * @return True once all rows have been pushed and all output given to the
+   * sink.
+   *
+   **/
+
+  Bool IsDone() const;
+
+protected:
+
+  /**
+   *
+   * Push a row already held in m_line.
+   *
+   **/
+
+  void DoPushLine();
+
+  /**
+   *
+   * Apply all vertical lifting steps which have their rows available.
+   *
+   **/
+
+  void DoAdvance();
+
+  /**
+   *
+   * @param n A row number, it may be outside the rows by one.
+   * @return The row number with symmetric extension applied.
+   *
+   **/
+
+  SInt GetMirror(SInt n) const;
+
+  /**
+   *
+   * @param n A row number.
+   * @return The row buffer holding it.
+   *
+   **/
+
+  SFloat32 * GetRow(SInt n) const;
+
+  /** Width. */
+  SInt m_width;
+
+  /** Height. */
+  SInt m_height;
+
+  /** The number of low pass samples in a row. */
+  SInt m_evw;
+
+  /** The number of low pass rows. */
+  SInt m_evh;
+
+  /** Rows received. */
+  SInt m_have;
+
+  /** The next (odd) row of the first predict step. */
+  SInt m_p1;
+
+  /** The next (even) row of the first update step. */
+  SInt m_p2;
+
+  /** The next (odd) row of the second predict step. */
+  SInt m_p3;
+
+  /** The next (even) row of the second update step. */
+  SInt m_p4;
+
+  /** Transform this level, else rows are passed to the sink. */
+  Bool m_trn;
+
+  /** The ring of rows. */
+  SFloat32 * m_rows;
+
+  /** Line buffer. */
+  SFloat32 * m_line;
+
+  /** The next level, or NULL. */
+  HeatWaveLineTransform * m_next;
+
+  /** The receiver of final rows. */
+  HeatWaveLineSink * m_sink;
+
+private:
+
+  /** Not copyable. */
+  HeatWaveLineTransform(const HeatWaveLineTransform &);
+
+  /** Not assignable. */
+  HeatWaveLineTransform & operator=(const HeatWaveLineTransform &);
+};
+
+#endif //__HEATWAVELINETRANSFORM_HPP__
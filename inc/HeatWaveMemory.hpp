@@ -0,0 +1,158 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveMemory.hpp
+ ** @brief  Contains the HeatWaveMemory class definition.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVEMEMORY_HPP__
+#define __HEATWAVEMEMORY_HPP__
+
+#include "CommonHeaders.hpp"
+
+/****************************************************************************/
+/**
+ ** The subsystems whose memory is accounted for.
+ **
+ **/
+
+enum EnumMemory
+  {
+    /** Component sample planes, full and packed. */
+    MemPlanes = 0,
+
+    /** Component row tables. */
+    MemRows,
+
+    /** Lifting buffers. */
+    MemLift,
+
+    /** AVI reader chunk table, read block and frame buffer. */
+    MemAVI,
+
+    /** Huffman tree nodes. */
+    MemHuffman,
+
+    /** Total number of subsystems, also used for all subsystems together. */
+    MemTotal
+  };
+
+/**
+ *
+ * Get the name of a subsystem.
+ *
+ * @param mem The subsystem.
+ * @return The subsystem name.
+ *
+ **/
+
+inline const char *
+MemoryName(EnumMemory mem)
+{
+  switch (mem){
+  case MemPlanes:return "planes";
+  case MemRows:return "rows";
+  case MemLift:return "lift";
+  case MemAVI:return "avi";
+  case MemHuffman:return "huffman";
+  case MemTotal:return "total";
+  default: return "MemoryName() error!";
+  }
+}
+
+/****************************************************************************/
+/**
+ ** Accounts for the live and peak bytes of the large allocations, per
+ ** subsystem. The owners of the memory add the bytes on allocation and take
+ ** them off on release, e.g. a component for its planes only once the last
+ ** copy sharing them lets go. The counters are global and updated
+ ** atomically, so they may be used from any thread.
+ **
+ **/
+
+class HeatWaveMemory
+{
+public:
+
+  /**
+   *
+   * Account for allocated bytes.
+   *
+   * @param mem The subsystem.
+   * @param byte The number of bytes.
+   *
+   **/
+
+  static void AddBytes(EnumMemory mem, SInt64 byte);
+
+  /**
+   *
+   * Account for released bytes.
+   *
+   * @param mem The subsystem.
+   * @param byte The number of bytes.
+   *
+   **/
+
+  static void SubBytes(EnumMemory mem, SInt64 byte);
+
+  /**
+   *
+   * @param mem The subsystem, MemTotal for all. (MemTotal by default)
+   * @return The live bytes.
+   *
+   **/
+
+  static SInt64 GetCurrent(EnumMemory mem = MemTotal);
+
+  /**
+   *
+   * @param mem The subsystem, MemTotal for all. (MemTotal by default)
+   * @return The most bytes live at once since the last reset.
+   *
+   **/
+
+  static SInt64 GetPeak(EnumMemory mem = MemTotal);
+
+  /**
+   *
+   * Lower the peaks to the live bytes, e.g. to measure a single stage.
+   *
+   **/
+
+  static void DoResetPeak();
+
+  /**
+   *
+   * Print a line per subsystem and one for the total, with the live and
+   * peak bytes in MiB.
+   *
+   * @param out The stream to print to.
+   * @param pre The prefix of each line.
+   *
+   **/
+
+  static void DoReport(FILE * out, const char * pre = "");
+
+protected:
+
+  /**
+   *
+   * Raise a peak to a value if it is lower.
+   *
+   * @param peak The peak.
+   * @param val The value.
+   *
+   **/
+
+  static void DoRaise(SInt64 * peak, SInt64 val);
+
+  /** Live bytes per subsystem, the last entry for all. */
+  static SInt64 m_current[MemTotal+1];
+
+  /** Peak bytes per subsystem, the last entry for all. */
+  static SInt64 m_peak[MemTotal+1];
+};
+
+#endif // __HEATWAVEMEMORY_HPP__
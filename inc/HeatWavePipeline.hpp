@@ -0,0 +1,362 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWavePipeline.hpp
+ ** @brief  Contains the HeatWaveFrameQueue, HeatWaveSource, HeatWaveStage and
+ **         HeatWavePipeline class definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVEPIPELINE_HPP__
+#define __HEATWAVEPIPELINE_HPP__
+
+#include "HeatWaveImage.hpp"
+
+/****************************************************************************/
+/**
+ ** A bounded first in first out queue of frames between two pipeline
+ ** threads. A push blocks while the queue is full and a pop while it is
+ ** empty, so a slow stage holds back the stages before it rather than
+ ** letting frames pile up. The producer closes the queue once it is done.
+ **
+ **/
+
+class HeatWaveFrameQueue
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param depth The maximum number of queued frames, at least 1.
+   * @param grow Grow when full rather than wait, for a queue pushed and
+   * popped by the same thread. (False by default)
+   *
+   **/
+
+  HeatWaveFrameQueue(SInt depth, Bool grow = False);
+
+  /**
+   *
+   * Destructor, deletes any frames still queued.
+   *
+   **/
+
+  ~HeatWaveFrameQueue();
+
+  /**
+   *
+   * Queue a frame, waiting for room if full.
+   *
+   * @param img The frame, the queue takes ownership.
+   * @return False if the queue is closed, the frame is then deleted.
+   *
+   **/
+
+  Bool DoPush(HeatWaveImage * img);
+
+  /**
+   *
+   * Take the first frame, waiting for one if empty.
+   *
+   * @return The frame, owned by the caller, or NULL once the queue is closed
+   * and empty.
+   *
+   **/
+
+  HeatWaveImage * DoPop();
+
+  /**
+   *
+   * Close the queue, no more frames may be pushed.
+   *
+   **/
+
+  void DoClose();
+
+  /**
+   *
+   * @return The maximum number of queued frames.
+   *
+   **/
+
+  SInt GetDepth() const;
+
+  /**
+   *
+   * @return The number of queued frames.
+   *
+   **/
+
+  SInt GetFrameN();
+
+protected:
+
+  /** Ring of queued frames. */
+  HeatWaveImage ** m_imga;
+
+  /** Capacity of the ring. */
+  SInt m_depth;
+
+  /** First queued frame. */
+  SInt m_head;
+
+  /** Number of queued frames. */
+  SInt m_imgn;
+
+  /** No more frames will be pushed. */
+  Bool m_closed;
+
+  /** Grow when full. */
+  Bool m_grow;
+
+  /** Guards the members above. */
+  CommonMutex m_mutex;
+
+  /** Signalled when a frame is pushed or on close. */
+  CommonCond m_notEmpty;
+
+  /** Signalled when a frame is popped or on close. */
+  CommonCond m_notFull;
+
+private:
+
+  /** Not copyable. */
+  HeatWaveFrameQueue(const HeatWaveFrameQueue &);
+
+  /** Not assignable. */
+  HeatWaveFrameQueue & operator=(const HeatWaveFrameQueue &);
+};
+
+/****************************************************************************/
+/**
+ ** The first stage of a pipeline, produces the frames (e.g. by decoding a
+ ** file).
+ **
+ **/
+
+class HeatWaveSource
+{
+public:
+
+  /**
+   *
+   * Destructor.
+   *
+   **/
+
+  virtual ~HeatWaveSource();
+
+  /**
+   *
+   * Produce the next frame.
+   *
+   * @return The frame, owned by the caller, or NULL at the end.
+   *
+   **/
+
+  virtual HeatWaveImage * GetNextFrame() = 0;
+};
+
+/****************************************************************************/
+/**
+ ** A processing stage of a pipeline. Each stage is run by a single thread,
+ ** so it sees the frames in order and needs no locking of its own members.
+ **
+ **/
+
+class HeatWaveStage
+{
+public:
+
+  /**
+   *
+   * Destructor.
+   *
+   **/
+
+  virtual ~HeatWaveStage();
+
+  /**
+   *
+   * Process a frame.
+   *
+   * @param img The frame, owned by the stage.
+   * @param out Where to push the frames for the next stage. A stage may hold
+   * on to frames (e.g. to gather a group) or keep them (e.g. a sink), any
+   * frame that is neither pushed nor kept must be deleted.
+   *
+   **/
+
+  virtual void DoFrame(HeatWaveImage * img, HeatWaveFrameQueue & out) = 0;
+
+  /**
+   *
+   * Called once after the last frame, push any frames still held. Does
+   * nothing by default.
+   *
+   * @param out Where to push the frames for the next stage.
+   *
+   **/
+
+  virtual void DoFlush(HeatWaveFrameQueue & out);
+};
+
+/****************************************************************************/
+/**
+ ** A chain of a source and stages, each run by its own (POSIX) thread and
+ ** joined by bounded frame queues. Frames flow through while the earlier
+ ** stages work on later frames, so reading overlaps with the transforms and
+ ** only about depth frames per stage are alive at any time. Frames coming
+ ** out of the last stage are deleted. The source and stages are owned by
+ ** the caller. Built with HEATWAVENOTHREADS the source and stages run in
+ ** turn in the calling thread.
+ **
+ **/
+
+class HeatWavePipeline
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param depth The capacity of each queue. (2 by default)
+   *
+   **/
+
+  HeatWavePipeline(SInt depth = 2);
+
+  /**
+   *
+   * Destructor.
+   *
+   **/
+
+  ~HeatWavePipeline();
+
+  /**
+   *
+   * Set the source.
+   *
+   * @param src The source.
+   *
+   **/
+
+  void SetSource(HeatWaveSource * src);
+
+  /**
+   *
+   * Append a stage.
+   *
+   * @param stg The stage, NULL is ignored.
+   *
+   **/
+
+  void AddStage(HeatWaveStage * stg);
+
+  /**
+   *
+   * @return The number of stages.
+   *
+   **/
+
+  SInt GetStageN() const;
+
+  /**
+   *
+   * Run all frames of the source through the stages, returns once the last
+   * stage is done.
+   *
+   * @return The number of frames produced by the source, -1 if there is no
+   * source.
+   *
+   **/
+
+  SInt DoRun();
+
+protected:
+
+  /** What a pipeline thread needs to know. */
+  struct Link
+  {
+    /** The pipeline. */
+    HeatWavePipeline * m_pipe;
+    /** The stage, NULL for the source. */
+    HeatWaveStage * m_stage;
+    /** The input, NULL for the source. */
+    HeatWaveFrameQueue * m_in;
+    /** The output. */
+    HeatWaveFrameQueue * m_out;
+  };
+
+  /**
+   *
+   * Thread entry point.
+   *
+   * @param arg The link.
+   * @return NULL.
+   *
+   **/
+
+  static void * ThreadMain(void * arg);
+
+  /**
+   *
+   * Run a source or a stage until its input ends, then close its output.
+   *
+   * @param lnk The link.
+   *
+   **/
+
+  void DoLink(Link & lnk);
+
+  /**
+   *
+   * Run the source and stages in turn in the calling thread, each frame as
+   * far through the stages as it goes before the next is read.
+   *
+   * @return The number of frames produced by the source.
+   *
+   **/
+
+  SInt DoSerial();
+
+  /**
+   *
+   * Run the stages on the frames queued, from a queue on.
+   *
+   * @param queues The queues, queue i feeds stage i.
+   * @param from The first queue.
+   *
+   **/
+
+  void DoDrain(HeatWaveFrameQueue ** queues, SInt from);
+
+  /** The source. */
+  HeatWaveSource * m_src;
+
+  /** The stages. */
+  HeatWaveStage ** m_stga;
+
+  /** The number of stages. */
+  SInt m_stgn;
+
+  /** The capacity of each queue. */
+  SInt m_depth;
+
+  /** The number of frames produced by the source. */
+  SInt m_frames;
+
+private:
+
+  /** Not copyable. */
+  HeatWavePipeline(const HeatWavePipeline &);
+
+  /** Not assignable. */
+  HeatWavePipeline & operator=(const HeatWavePipeline &);
+};
+
+#endif //__HEATWAVEPIPELINE_HPP__
@@ -0,0 +1,317 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveProfiler.hpp
+ ** @brief  Contains the HeatWaveProfiler and HeatWaveProfileTimer classes.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVEPROFILER_HPP__
+#define __HEATWAVEPROFILER_HPP__
+
+#include "CommonHeaders.hpp"
+
+/****************************************************************************/
+/**
+ ** The hot paths of the library that are timed and counted. Stages nest,
+ ** e.g. the lifting steps are timed inside the transforms.
+ **
+ **/
+
+enum EnumProfile
+  {
+    /** Spatial transform of a component (DoTransformInternal). */
+    PrfTransform = 0,
+
+    /** The lifting steps of the spatial transforms. */
+    PrfLift,
+
+    /** Temporal transform of a video. */
+    PrfTemporal,
+
+    /** Spectral transform of a image. */
+    PrfSpectral,
+
+    /** Reading and decoding AVI frames. */
+    PrfAVIRead,
+
+    /** Color transforms. */
+    PrfColor,
+
+    /** Making histograms. */
+    PrfHistogram,
+
+    /** Entropy calculations. */
+    PrfEntropy,
+
+    /** Huffman coding. */
+    PrfHuffman,
+
+    /** Hashing samples. */
+    PrfDigest,
+
+    /** Reading and writing native image files. */
+    PrfImageIO,
+
+    /** Embedded bitplane coding. */
+    PrfBitplane,
+
+    /** Quantizing and reconstructing sub-bands. */
+    PrfQuantize,
+
+    /** Sample buffer allocations, counted only. */
+    PrfAlloc,
+
+    /** Total number of stages. */
+    PrfTotal
+  };
+
+/**
+ *
+ * Get the name of a profile stage.
+ *
+ * @param prf The stage.
+ * @return The stage name.
+ *
+ **/
+
+inline const char *
+ProfileName(EnumProfile prf)
+{
+  switch (prf){
+  case PrfTransform:return "transform";
+  case PrfLift:return "lift";
+  case PrfTemporal:return "temporal";
+  case PrfSpectral:return "spectral";
+  case PrfAVIRead:return "avi read";
+  case PrfColor:return "color";
+  case PrfHistogram:return "histogram";
+  case PrfEntropy:return "entropy";
+  case PrfHuffman:return "huffman";
+  case PrfDigest:return "digest";
+  case PrfImageIO:return "image io";
+  case PrfBitplane:return "bitplane";
+  case PrfQuantize:return "quantize";
+  case PrfAlloc:return "alloc";
+  default: return "ProfileName() error!";
+  }
+}
+
+/****************************************************************************/
+/**
+ ** Time and work counters of the library stages. The counters are global
+ ** and updated atomically, so stages running in several threads add up
+ ** their times (the times are thread times, not elapsed time). Nothing is
+ ** counted until enabled. The library is only instrumented when compiled
+ ** with HEATWAVEPROFILING defined, see HEATWAVEPROFILE and HEATWAVECOUNT,
+ ** which the Makefile does not do by default ("make
+ ** PPDEF=-DHEATWAVEPROFILING" does).
+ **
+ **/
+
+class HeatWaveProfiler
+{
+public:
+
+  /**
+   *
+   * Switch counting on or off.
+   *
+   * @param on True to count.
+   *
+   **/
+
+  static void SetEnabled(Bool on);
+
+  /**
+   *
+   * @return True if counting.
+   *
+   **/
+
+  static Bool IsEnabled();
+
+  /**
+   *
+   * @return True if the library is instrumented.
+   *
+   **/
+
+  static Bool IsCompiled();
+
+  /**
+   *
+   * Add a call of a stage.
+   *
+   * @param prf The stage.
+   * @param nsec The time in nanoseconds.
+   * @param smpl The number of samples processed.
+   * @param byte The number of bytes read and written.
+   *
+   **/
+
+  static void AddCall(EnumProfile prf, SInt64 nsec, SInt64 smpl,
+                      SInt64 byte);
+
+  /**
+   *
+   * Zero all counters.
+   *
+   **/
+
+  static void DoReset();
+
+  /**
+   *
+   * @param prf The stage.
+   * @return The number of calls.
+   *
+   **/
+
+  static SInt64 GetCalls(EnumProfile prf);
+
+  /**
+   *
+   * @param prf The stage.
+   * @return The time in nanoseconds.
+   *
+   **/
+
+  static SInt64 GetTime(EnumProfile prf);
+
+  /**
+   *
+   * @param prf The stage.
+   * @return The number of samples.
+   *
+   **/
+
+  static SInt64 GetSamples(EnumProfile prf);
+
+  /**
+   *
+   * @param prf The stage.
+   * @return The number of bytes.
+   *
+   **/
+
+  static SInt64 GetBytes(EnumProfile prf);
+
+  /**
+   *
+   * @return A monotonic clock in nanoseconds, processor time on systems
+   * without one.
+   *
+   **/
+
+  static SInt64 GetClock();
+
+  /**
+   *
+   * Print a line per stage used, with the calls, time, time per sample and
+   * throughput.
+   *
+   * @param out The stream to print to.
+   * @param pre The prefix of each line.
+   *
+   **/
+
+  static void DoReport(FILE * out, const char * pre = "");
+
+protected:
+
+  /** Counting. */
+  static volatile SInt m_enabled;
+
+  /** Calls per stage. */
+  static SInt64 m_calls[PrfTotal];
+
+  /** Nanoseconds per stage. */
+  static SInt64 m_nsecs[PrfTotal];
+
+  /** Samples per stage. */
+  static SInt64 m_smpls[PrfTotal];
+
+  /** Bytes per stage. */
+  static SInt64 m_bytes[PrfTotal];
+};
+
+/****************************************************************************/
+/**
+ ** Times a stage from construction to destruction, if the profiler was
+ ** enabled at construction.
+ **
+ **/
+
+class HeatWaveProfileTimer
+{
+public:
+
+  /**
+   *
+   * Constructor, starts the clock.
+   *
+   * @param prf The stage.
+   * @param smpl The number of samples processed.
+   * @param byte The number of bytes read and written.
+   *
+   **/
+
+  HeatWaveProfileTimer(EnumProfile prf, SInt64 smpl, SInt64 byte);
+
+  /**
+   *
+   * Destructor, adds the call to the profiler.
+   *
+   **/
+
+  ~HeatWaveProfileTimer();
+
+protected:
+
+  /** The stage. */
+  EnumProfile m_prf;
+
+  /** The start time, -1 if not timing. */
+  SInt64 m_start;
+
+  /** Samples. */
+  SInt64 m_smpl;
+
+  /** Bytes. */
+  SInt64 m_byte;
+
+private:
+
+  /** Not copyable. */
+  HeatWaveProfileTimer(const HeatWaveProfileTimer &);
+
+  /** Not assignable. */
+  HeatWaveProfileTimer & operator=(const HeatWaveProfileTimer &);
+};
+
+#ifdef HEATWAVEPROFILING
+
+/** Time the rest of the scope as a stage, once per scope. */
+#define HEATWAVEPROFILE(prf, smpl, byte)                        \
+  HeatWaveProfileTimer heatwave_timer((prf), (smpl), (byte))
+
+/** Count work of a stage without timing it. */
+#define HEATWAVECOUNT(prf, smpl, byte)                          \
+  do {                                                          \
+    if ( HeatWaveProfiler::IsEnabled() ){                       \
+      HeatWaveProfiler::AddCall((prf), 0, (smpl), (byte));      \
+    }                                                           \
+  } while (0)
+
+#else
+
+/** Profiling not compiled in. */
+#define HEATWAVEPROFILE(prf, smpl, byte)
+
+/** Profiling not compiled in. */
+#define HEATWAVECOUNT(prf, smpl, byte) do { } while (0)
+
+#endif
+
+#endif // __HEATWAVEPROFILER_HPP__
@@ -0,0 +1,196 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveQuantizer.hpp
+ ** @brief  Contains the HeatWaveQuantizer class definition.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVEQUANTIZER_HPP__
+#define __HEATWAVEQUANTIZER_HPP__
+
+#include "CommonHeaders.hpp"
+#include "HeatWaveEnums.hpp"
+#include "HeatWaveComponent.hpp"
+
+/** The highest resolution level whose norms are measured, the norms of
+ ** higher levels are extrapolated from the last two levels. */
+#define HEATWAVEQUANTIZERLEVELS 4
+
+/****************************************************************************/
+/**
+ ** Dead-zone scalar quantizer of the sub-bands of pyramid transformed
+ ** components. Every sub-band gets a step size of the base step divided by
+ ** the norm of its synthesis basis, so each sub-band adds about the same
+ ** error per sample to the reconstruction whatever the level, orientation
+ ** or transform. Steps below 1 are raised to 1, which keeps the integer
+ ** coefficients exactly, and a base step of 1 leaves all sub-bands as they
+ ** are.
+ **
+ ** A coefficient c is quantized to sign(c) floor(|c| / step), so the zero
+ ** bin is twice as wide as the others, and reconstructed at the middle of
+ ** its bin, sign(q) floor((|q| + 0.5) step), zero staying zero. With a
+ ** step of 1 both are the identity.
+ **
+ ** The norms are measured once per transform by inverse transforming
+ ** impulses, which is not thread safe; the region functions are static and
+ ** may be run in parallel.
+ **
+ **/
+
+class HeatWaveQuantizer
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param step The base step size. (1 by default)
+   *
+   **/
+
+  HeatWaveQuantizer(SFloat64 step = 1.0);
+
+  /**
+   *
+   * Destructor.
+   *
+   **/
+
+  ~HeatWaveQuantizer();
+
+  /**
+   *
+   * @param step The base step size, at least 1 is used.
+   *
+   **/
+
+  void SetStep(SFloat64 step);
+
+  /**
+   *
+   * @return The base step size.
+   *
+   **/
+
+  SFloat64 GetStep() const;
+
+  /**
+   *
+   * Get the step size of a sub-band.
+   *
+   * @param trn The transform.
+   * @param res The resolution level, 0 for an untransformed component.
+   * @param sub The sub-band.
+   * @return The step size, at least 1.
+   *
+   **/
+
+  SFloat64 GetStep(EnumTransform trn, SInt res, EnumSubband sub);
+
+  /**
+   *
+   * Get the norm of the synthesis basis of a sub-band, i.e. the root of
+   * the energy of the reconstruction of a unit coefficient.
+   *
+   * @param trn The transform.
+   * @param res The resolution level.
+   * @param sub The sub-band.
+   * @return The norm.
+   *
+   **/
+
+  SFloat64 GetNorm(EnumTransform trn, SInt res, EnumSubband sub);
+
+  /**
+   *
+   * Quantize all sub-bands of a component in place, each tile to the level
+   * it reached.
+   *
+   * @param cmp The component.
+   *
+   **/
+
+  void DoQuantize(HeatWaveComponent & cmp);
+
+  /**
+   *
+   * Reconstruct all sub-bands of a quantized component in place.
+   *
+   * @param cmp The component.
+   *
+   **/
+
+  void DoDequantize(HeatWaveComponent & cmp);
+
+  /**
+   *
+   * Quantize a region in place.
+   *
+   * @param org The first sample.
+   * @param width The width.
+   * @param height The height.
+   * @param pitch The distance between rows in samples.
+   * @param step The step size.
+   *
+   **/
+
+  static void DoQuantize(Smpl * org, SInt width, SInt height, SInt pitch,
+                         SFloat64 step);
+
+  /**
+   *
+   * Reconstruct a quantized region in place.
+   *
+   * @param org The first sample.
+   * @param width The width.
+   * @param height The height.
+   * @param pitch The distance between rows in samples.
+   * @param step The step size.
+   *
+   **/
+
+  static void DoDequantize(Smpl * org, SInt width, SInt height, SInt pitch,
+                           SFloat64 step);
+
+protected:
+
+  /**
+   *
+   * Run a region function over all sub-bands of a component.
+   *
+   * @param cmp The component.
+   * @param fwd Quantize, else reconstruct.
+   *
+   **/
+
+  void DoBands(HeatWaveComponent & cmp, Bool fwd);
+
+  /**
+   *
+   * Measure the norms of a transform, up to HEATWAVEQUANTIZERLEVELS.
+   *
+   * @param trn The transform.
+   *
+   **/
+
+  void DoMeasure(EnumTransform trn);
+
+  /** The base step size. */
+  SFloat64 m_step;
+
+  /** The norms of each transform, per resolution level from 1 the LL, HL,
+   ** LH and HH sub-bands, NULL until measured. */
+  SFloat64 * m_norms[TrnTotal];
+
+private:
+
+  /** Not copyable. */
+  HeatWaveQuantizer(const HeatWaveQuantizer &);
+
+  /** Not assignable. */
+  HeatWaveQuantizer & operator=(const HeatWaveQuantizer &);
+};
+
+#endif // __HEATWAVEQUANTIZER_HPP__
@@ -0,0 +1,147 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveResampler.hpp
+ ** @brief  Contains the HeatWaveResampler class definition.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVERESAMPLER_HPP__
+#define __HEATWAVERESAMPLER_HPP__
+
+#include "HeatWaveComponent.hpp"
+
+/****************************************************************************/
+/**
+ ** Wavelet based multi octave resampler, as used for chroma sub-sampling
+ ** (e.g. 4:4:4 to 4:2:2 or 4:2:0 and back). Reducing keeps only the low pass
+ ** of a forward lifting pass, increasing runs the inverse with the high pass
+ ** set to zero. All octaves of a row are done in one go while it is at hand,
+ ** and the columns are lifted a row of all of them at a time, rather than a
+ ** transform and resize of the whole component per octave. The (2,2) steps
+ ** run the row kernels of HeatWaveLift, which use SSE2 where available. The
+ ** results are the same as those of HeatWaveComponent::DoTransform() followed
+ ** by a resize.
+ **
+ **/
+
+class HeatWaveResampler
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param trn The transform used for the filtering.
+   *
+   **/
+
+  HeatWaveResampler(EnumTransform trn);
+
+  /**
+   *
+   * Destructor.
+   *
+   **/
+
+  ~HeatWaveResampler();
+
+  /**
+   *
+   * Resample a component, the rows then the columns.
+   *
+   * @param cmp The component, it is unpacked.
+   * @param hoct The horizontal octaves, positive to reduce, negative to
+   * increase the width.
+   * @param voct The vertical octaves, positive to reduce, negative to
+   * increase the height.
+   *
+   **/
+
+  void DoResample(HeatWaveComponent & cmp, SInt hoct, SInt voct);
+
+  /**
+   *
+   * Reduce a line in place, the low pass is left at the start.
+   *
+   * @param line The samples.
+   * @param len The number of samples.
+   * @param oct The number of octaves, fewer are done if the line becomes
+   * a single sample.
+   * @return The new number of samples.
+   *
+   **/
+
+  SInt DoReduce(Smpl * line, SInt len, SInt oct);
+
+  /**
+   *
+   * Increase a line in place.
+   *
+   * @param line The samples, with room for len << oct samples.
+   * @param len The number of samples.
+   * @param oct The number of octaves.
+   * @return The new number of samples.
+   *
+   **/
+
+  SInt DoIncrease(Smpl * line, SInt len, SInt oct);
+
+  /**
+   *
+   * @param len A number of samples.
+   * @param oct The octaves, positive to reduce, negative to increase.
+   * @return The number of samples after resampling.
+   *
+   **/
+
+  static SInt GetLength(SInt len, SInt oct);
+
+protected:
+
+  /**
+   *
+   * Reduce the columns of a block of rows in place, as DoReduce().
+   *
+   * @param data The first sample of the first row.
+   * @param len The number of rows.
+   * @param num The number of columns, also the distance between rows.
+   * @param oct The number of octaves.
+   * @return The new number of rows.
+   *
+   **/
+
+  SInt DoReduceColumns(Smpl * data, SInt len, SInt num, SInt oct);
+
+  /**
+   *
+   * Increase the columns of a block of rows in place, as DoIncrease().
+   *
+   * @param data The first sample of the first row, with room for len << oct
+   * rows.
+   * @param len The number of rows.
+   * @param num The number of columns, also the distance between rows.
+   * @param oct The number of octaves.
+   * @return The new number of rows.
+   *
+   **/
+
+  SInt DoIncreaseColumns(Smpl * data, SInt len, SInt num, SInt oct);
+
+  /** The transform. */
+  EnumTransform m_trn;
+
+  /** The lifting functions. */
+  HeatWaveLift m_lift;
+
+private:
+
+  /** Not copyable. */
+  HeatWaveResampler(const HeatWaveResampler &);
+
+  /** Not assignable. */
+  HeatWaveResampler & operator=(const HeatWaveResampler &);
+};
+
+#endif //__HEATWAVERESAMPLER_HPP__
@@ -0,0 +1,344 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveStages.hpp
+ ** @brief  Contains the sources and stages for a HeatWavePipeline.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVESTAGES_HPP__
+#define __HEATWAVESTAGES_HPP__
+
+#include "HeatWavePipeline.hpp"
+#include "HeatWaveVideo.hpp"
+#include "HeatWaveAVIReader.hpp"
+#include "HeatWaveAVIWriter.hpp"
+
+/** Frames per temporal group unless told otherwise, so only a bounded number
+ ** of frames is held. */
+#define HEATWAVETEMPORALGOP (16)
+
+/****************************************************************************/
+/**
+ ** Decodes the frames of an opened and analysed AVI file, one at a time.
+ **
+ **/
+
+class HeatWaveAVISource : public HeatWaveSource
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param rdr The reader, it must outlive the source.
+   *
+   **/
+
+  HeatWaveAVISource(HeatWaveAVIReader & rdr);
+
+  /**
+   *
+   * Decode the next frame.
+   *
+   * @return The frame or NULL after the last one or on error.
+   *
+   **/
+
+  virtual HeatWaveImage * GetNextFrame();
+
+protected:
+
+  /** The reader. */
+  HeatWaveAVIReader & m_reader;
+
+  /** The next frame number. */
+  SInt m_next;
+
+  /** The number of frames in the file. */
+  SInt m_total;
+
+private:
+
+  /** Not assignable. */
+  HeatWaveAVISource & operator=(const HeatWaveAVISource &);
+};
+
+/****************************************************************************/
+/**
+ ** Color transforms each frame, see HeatWaveImage::SetSpace().
+ **
+ **/
+
+class HeatWaveColorStage : public HeatWaveStage
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param spc The color space.
+   * @param lsls True for the reversible (RCT) else the irreversible (ICT)
+   * transform.
+   *
+   **/
+
+  HeatWaveColorStage(EnumSpace spc, Bool lsls = True);
+
+  virtual void DoFrame(HeatWaveImage * img, HeatWaveFrameQueue & out);
+
+protected:
+
+  /** The color space. */
+  EnumSpace m_space;
+
+  /** Reversible. */
+  Bool m_lsls;
+};
+
+/****************************************************************************/
+/**
+ ** Spatially transforms each frame, see HeatWaveImage::DoPyramidTransform().
+ **
+ **/
+
+class HeatWaveSpatialStage : public HeatWaveStage
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param trn The transform.
+   * @param lev The level to transform to.
+   * @param fwd Forward or inverse.
+   *
+   **/
+
+  HeatWaveSpatialStage(EnumTransform trn, SInt lev, Bool fwd = True);
+
+  virtual void DoFrame(HeatWaveImage * img, HeatWaveFrameQueue & out);
+
+protected:
+
+  /** The transform. */
+  EnumTransform m_trn;
+
+  /** The level. */
+  SInt m_lev;
+
+  /** Forward or inverse. */
+  Bool m_fwd;
+};
+
+/****************************************************************************/
+/**
+ ** Temporally transforms groups of frames, see
+ ** HeatWaveVideo::DoTemporalTransform(). Frames are held until a group is
+ ** complete, then the group is transformed and passed on. Forward goes from
+ ** level 0 up to the level, inverse from the level down to 0.
+ **
+ **/
+
+class HeatWaveTemporalStage : public HeatWaveStage
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param trn The transform.
+   * @param lev The level.
+   * @param fwd Forward or inverse.
+   * @param gop The number of frames in a group, 0 or less for all frames,
+   * which holds the whole video. (HEATWAVETEMPORALGOP by default)
+   *
+   **/
+
+  HeatWaveTemporalStage(EnumTransform trn, SInt lev, Bool fwd = True,
+                        SInt gop = HEATWAVETEMPORALGOP);
+
+  /**
+   *
+   * Destructor.
+   *
+   **/
+
+  virtual ~HeatWaveTemporalStage();
+
+  virtual void DoFrame(HeatWaveImage * img, HeatWaveFrameQueue & out);
+
+  virtual void DoFlush(HeatWaveFrameQueue & out);
+
+protected:
+
+  /**
+   *
+   * Transform the held frames and pass them on.
+   *
+   * @param out Where to push the frames.
+   *
+   **/
+
+  void DoGroup(HeatWaveFrameQueue & out);
+
+  /** The transform. */
+  EnumTransform m_trn;
+
+  /** The level. */
+  SInt m_lev;
+
+  /** Forward or inverse. */
+  Bool m_fwd;
+
+  /** Frames per group. */
+  SInt m_gop;
+
+  /** The held frames. */
+  HeatWaveImage ** m_imga;
+
+  /** The number of held frames. */
+  SInt m_imgn;
+
+  /** Capacity of m_imga. */
+  SInt m_imgLen;
+
+private:
+
+  /** Not copyable. */
+  HeatWaveTemporalStage(const HeatWaveTemporalStage &);
+
+  /** Not assignable. */
+  HeatWaveTemporalStage & operator=(const HeatWaveTemporalStage &);
+};
+
+/****************************************************************************/
+/**
+ ** Adds up the zero order entropy of each component of each frame, an
+ ** estimate of the coded size.
+ **
+ **/
+
+class HeatWaveEntropyStage : public HeatWaveStage
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   **/
+
+  HeatWaveEntropyStage();
+
+  virtual void DoFrame(HeatWaveImage * img, HeatWaveFrameQueue & out);
+
+  /**
+   *
+   * @return The estimated number of bits of all frames so far.
+   *
+   **/
+
+  SFloat64 GetBits() const;
+
+  /**
+   *
+   * @return The number of samples of all frames so far.
+   *
+   **/
+
+  SFloat64 GetSampleN() const;
+
+  /**
+   *
+   * @return The number of frames so far.
+   *
+   **/
+
+  SInt GetFrameN() const;
+
+protected:
+
+  /** Estimated bits. */
+  SFloat64 m_bits;
+
+  /** Samples. */
+  SFloat64 m_smpln;
+
+  /** Frames. */
+  SInt m_frmn;
+};
+
+/****************************************************************************/
+/**
+ ** Collects the frames onto a video, which takes ownership of them.
+ **
+ **/
+
+class HeatWaveVideoSink : public HeatWaveStage
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param vid The video, it must outlive the sink and not be touched while
+   * the pipeline runs.
+   *
+   **/
+
+  HeatWaveVideoSink(HeatWaveVideo & vid);
+
+  virtual void DoFrame(HeatWaveImage * img, HeatWaveFrameQueue & out);
+
+protected:
+
+  /** The video. */
+  HeatWaveVideo & m_video;
+
+private:
+
+  /** Not assignable. */
+  HeatWaveVideoSink & operator=(const HeatWaveVideoSink &);
+};
+
+/****************************************************************************/
+/**
+ ** Streams the frames to an opened AVI file, see HeatWaveAVIWriter::AddFrame().
+ **
+ **/
+
+class HeatWaveAVISink : public HeatWaveStage
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param wrt The writer, it must outlive the sink and not be touched while
+   * the pipeline runs.
+   *
+   **/
+
+  HeatWaveAVISink(HeatWaveAVIWriter & wrt);
+
+  virtual void DoFrame(HeatWaveImage * img, HeatWaveFrameQueue & out);
+
+protected:
+
+  /** The writer. */
+  HeatWaveAVIWriter & m_writer;
+
+private:
+
+  /** Not assignable. */
+  HeatWaveAVISink & operator=(const HeatWaveAVISink &);
+};
+
+#endif //__HEATWAVESTAGES_HPP__
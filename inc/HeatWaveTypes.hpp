@@ -22,6 +22,13 @@ typedef Smpl * SmplPtr;
 #define SMPLMAX       ( 2147483647)
 #define SMPLMIN       (-2147483648) 
 
+/** Compact 16-bit sample data type, see HeatWaveComponent::DoPack(). **/
+typedef SInt16 Smpl16;
+
+#define SMPL16PRECISION (16)
+#define SMPL16MAX       ( 32767)
+#define SMPL16MIN       (-32768)
+
 /****************************************************************************/
 /**
  **
@@ -14,6 +14,9 @@
 #include "HeatWaveImage.hpp"
 #include "HeatWaveLift.hpp"
 
+/** Number of bins of the scene detection histograms. **/
+#define HEATWAVESCENEBINS 64
+
 /****************************************************************************/
 /**
  ** A video class made up of n images. Provides temporal wavelet transform 
@@ -368,6 +371,16 @@ public:
    **/
   
   HeatWaveVideo * GetClone() const;
+
+  /**
+   *
+   * Swap the contents of two videos without copying images.
+   *
+   * @param other The other video.
+   *
+   **/
+
+  void DoSwap(HeatWaveVideo & other);
   
   /**
    *
@@ -409,16 +422,112 @@ public:
   SInt DoSpatialTransform(EnumTransform trn, SInt lev, 
                           Bool fwd = True, SInt cur = -1);
   
+  /**
+   *
+   * Pack all images into 16-bit samples, where possible.
+   *
+   * @param trn The spatial transform to be applied. (Trn0_0 by default)
+   * @param lev The number of spatial levels to be applied. (0 by default)
+   * @return True if all images were packed.
+   * @see HeatWaveImage::DoPack()
+   *
+   **/
+  
+  Bool DoPack(EnumTransform trn = Trn0_0, SInt lev = 0);
+  
+  /**
+   *
+   * Set the tiling of all images.
+   *
+   * @param twd The tile width, 0 or less to disable tiling.
+   * @param thg The tile height, 0 or less to disable tiling.
+   * @param pool The worker pool to transform the tiles on. (NULL by default)
+   * @see HeatWaveImage::SetTiling()
+   *
+   **/
+  
+  void SetTiling(SInt twd, SInt thg, HeatWaveWorkerPool * pool = NULL);
+  
+  /**
+   *
+   * Unpack all images back to full precision samples.
+   *
+   **/
+  
+  void DoUnpack();
+
+  /**
+   *
+   * Detect scene changes and set the scene switch flag of each image. The
+   * first component of each image is reduced to (1/2^lev)th by averaging
+   * blocks of its low pass band, and a switch is flagged where the
+   * histogram of this thumbnail differs too much from that of the image
+   * before. The first image always starts a scene.
+   *
+   * @param thr The threshold, from 0 (any change) to 1 (no histogram
+   * overlap at all). (0.4 by default)
+   * @param lev The number of octaves to reduce by. (3 by default)
+   * @return The number of scenes.
+   *
+   **/
+
+  SInt DoSceneDetection(SFloat64 thr = 0.4, SInt lev = 3);
+
+  /**
+   *
+   * Set the grouping of the temporal transform. The images are split into
+   * groups (GOPs) at each scene switch and after at most len images, each
+   * group is transformed on its own.
+   *
+   * @param len The maximum group length, 0 or less for no limit.
+   * @param pool The worker pool to transform the groups on, if NULL groups
+   * are transformed one after the other. (NULL by default)
+   *
+   **/
+
+  void SetGrouping(SInt len, HeatWaveWorkerPool * pool = NULL);
+
+  /**
+   *
+   * @return The maximum group length, 0 if there is no limit.
+   *
+   **/
+
+  SInt GetGroupLength() const;
+
+  /**
+   *
+   * @return The number of groups, 1 if the images are not split.
+   *
+   **/
+
+  SInt GetGroupCount() const;
+
+  /**
+   *
+   * Get the images of a group.
+   *
+   * @param num The group number.
+   * @param strt (OUT) The first image.
+   * @param len (OUT) The number of images.
+   * @return False if there is no such group.
+   *
+   **/
+
+  Bool GetGroupInfo(SInt num, SInt & strt, SInt & len) const;
+  
   /**
    *
    * Temporal pyramid type transform across all components for sub-images.
+   * Each group (see SetGrouping()) is transformed independently, short
+   * groups may stop at a lower level.
    *
    * @param trn The transform type.
    * @param lev The level to transform to.
    * @param fwd Forward transform, else inverse transform. (Forward by default)
    * @param cur The current level, if less then 0 the internal level is used.
    * (-1 by default)
-   * @return The new level of transform.
+   * @return The new level of transform, the highest of all groups.
    *
    **/
   
@@ -564,6 +673,29 @@ protected:
    
   void SetTemporalVector(SInt cmp, SInt strt, SInt len, SInt x, SInt y,
                          Smpl * data);
+
+  /**
+   *
+   * Get the histogram of the reduced low pass of the first component of an
+   * image, see DoSceneDetection().
+   *
+   * @param num The image number.
+   * @param lev The number of octaves to reduce by.
+   * @param hist (OUT) HEATWAVESCENEBINS bins, normalised to a sum of 1.
+   *
+   **/
+
+  void GetSceneHistogram(SInt num, SInt lev, SFloat64 * hist) const;
+
+  /**
+   *
+   * @param len A number of images.
+   * @return The number of temporal levels before the low band is a single
+   * image.
+   *
+   **/
+
+  static SInt GetMaxLevel(SInt len);
   
   /**
    *
@@ -639,9 +771,12 @@ protected:
   /** Destroy memory pointers on delete or assignment. **/
   Bool m_desMem;
 
-  /** Scene length. **/
+  /** Maximum group length, 0 for no limit. **/
   SInt m_scene;
 
+  /** Worker pool for the groups, NULL to run them in turn. **/
+  HeatWaveWorkerPool * m_pool;
+
   /** Temporal transform level. **/
   SInt m_lev;
 
@@ -0,0 +1,270 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveView.hpp
+ ** @brief  Contains the HeatWaveView class definition.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVEVIEW_HPP__
+#define __HEATWAVEVIEW_HPP__
+
+#include "CommonHeaders.hpp"
+#include "HeatWaveTypes.hpp"
+
+/****************************************************************************/
+/**
+ ** A read only, strided window onto the samples of a component (e.g. a
+ ** sub-band or a rectangle). It holds only the origin, the size and the
+ ** row pitch, so it is cheap to pass by value and no samples are copied
+ ** unless GetCopy() is called. The samples may be full (Smpl) or packed
+ ** (Smpl16). A view is only valid while the component it was taken from is
+ ** neither resized, packed, unpacked nor destroyed, nor written to while its
+ ** storage is shared with a copy. Coordinates are relative to the top left
+ ** corner of the view.
+ **
+ **/
+
+class HeatWaveView
+{
+public:
+
+  /**
+   *
+   * Default constructor, an empty (invalid) view.
+   *
+   **/
+
+  HeatWaveView();
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param org The first sample.
+   * @param width The width.
+   * @param height The height.
+   * @param pitch The distance in samples between rows.
+   *
+   **/
+
+  HeatWaveView(const Smpl * org, SInt width, SInt height, SInt pitch);
+
+  /**
+   *
+   * Constructor for packed samples.
+   *
+   * @param org The first sample.
+   * @param width The width.
+   * @param height The height.
+   * @param pitch The distance in samples between rows.
+   *
+   **/
+
+  HeatWaveView(const Smpl16 * org, SInt width, SInt height, SInt pitch);
+
+  /**
+   *
+   * @return True if the view has samples.
+   *
+   **/
+
+  Bool IsValid() const;
+
+  /**
+   *
+   * @return True if the samples are 16-bit packed.
+   *
+   **/
+
+  Bool IsPacked() const;
+
+  /**
+   *
+   * @return The width.
+   *
+   **/
+
+  SInt GetWidth() const;
+
+  /**
+   *
+   * @return The height.
+   *
+   **/
+
+  SInt GetHeight() const;
+
+  /**
+   *
+   * @return The distance in samples between rows.
+   *
+   **/
+
+  SInt GetPitch() const;
+
+  /**
+   *
+   * @return The number of samples, width*height.
+   *
+   **/
+
+  SInt GetSize() const;
+
+  /**
+   *
+   * Get a sample.
+   *
+   * @param x The x-coordinate.
+   * @param y The y-coordinate.
+   * @return The sample value.
+   *
+   **/
+
+  Smpl GetSmpl(SInt x, SInt y) const;
+
+  /**
+   *
+   * Get a row in place, only for views which are not packed.
+   *
+   * @param y The y-coordinate.
+   * @return The width samples of the row.
+   *
+   **/
+
+  const Smpl * GetRow(SInt y) const;
+
+  /**
+   *
+   * Get a row, in place if possible else widened into a buffer.
+   *
+   * @param y The y-coordinate.
+   * @param buf A buffer of at least width samples, used for packed views.
+   * @return The width samples of the row.
+   *
+   **/
+
+  const Smpl * GetRow(SInt y, Smpl * buf) const;
+
+  /**
+   *
+   * Get a view of a part of this view.
+   *
+   * @param x Top left x-coordinate.
+   * @param y Top left y-coordinate.
+   * @param width The width.
+   * @param height The height.
+   * @return The view, invalid if the area does not fit.
+   *
+   **/
+
+  HeatWaveView GetView(SInt x, SInt y, SInt width, SInt height) const;
+
+  /**
+   *
+   * Get a contiguous copy of the samples, row after row.
+   *
+   * @return The samples, delete with delete [], NULL if invalid.
+   *
+   **/
+
+  Smpl * GetCopy() const;
+
+  /**
+   *
+   * Get some basic information.
+   *
+   * @param min (OUT) The minimum sample value.
+   * @param max (OUT) The maximum sample value.
+   * @param total (OUT) The sum of all the sample values.
+   * @return The number of samples.
+   *
+   **/
+
+  SInt GetBasicStats(Smpl & min, Smpl & max, SInt & total) const;
+
+  /**
+   *
+   * Get statistical information.
+   *
+   * @param min (OUT) The minimum sample value.
+   * @param max (OUT) The maximum sample value.
+   * @param total (OUT) The sum of all the sample values.
+   * @param mean (OUT) The mean sample value.
+   * @param std_dev (OUT) The standard deviation.
+   * @param std_err (OUT) The standard error.
+   * @param rms (OUT) The root mean square.
+   * @return False if the view is invalid.
+   *
+   **/
+
+  Bool GetStats(Smpl & min, Smpl & max, SInt & total, SFloat64 & mean,
+                SFloat64 & std_dev, SFloat64 & std_err, SFloat64 & rms) const;
+
+  /**
+   *
+   * Count the samples into a histogram.
+   *
+   * @param hist The histogram, counts are added to it.
+   * @param range The number of bins, samples outside are ignored.
+   * @param offset Added to a sample to get its bin.
+   *
+   **/
+
+  void DoHistogram(Smpl * hist, SInt range, SInt offset) const;
+
+  /**
+   *
+   * @param other A view of the same size.
+   * @return The sum of the squared differences.
+   *
+   **/
+
+  SFloat64 GetSquaredError(const HeatWaveView & other) const;
+
+  /**
+   *
+   * @param other A view of the same size.
+   * @return The sum of the absolute differences.
+   *
+   **/
+
+  SFloat64 GetAbsoluteError(const HeatWaveView & other) const;
+
+  /**
+   *
+   * @param other A view of the same size.
+   * @return The largest absolute difference.
+   *
+   **/
+
+  SFloat64 GetPeakError(const HeatWaveView & other) const;
+
+  /**
+   *
+   * @param other Another view.
+   * @return True if of the same size with the same samples.
+   *
+   **/
+
+  Bool IsEqual(const HeatWaveView & other) const;
+
+protected:
+
+  /** The first sample, or NULL. */
+  const Smpl * m_org;
+
+  /** The first packed sample, or NULL. */
+  const Smpl16 * m_pack;
+
+  /** Width. */
+  SInt m_width;
+
+  /** Height. */
+  SInt m_height;
+
+  /** The distance in samples between rows. */
+  SInt m_pitch;
+};
+
+#endif //__HEATWAVEVIEW_HPP__
@@ -0,0 +1,232 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveWorkerPool.hpp
+ ** @brief  Contains the HeatWaveJob and HeatWaveWorkerPool class definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#ifndef __HEATWAVEWORKERPOOL_HPP__
+#define __HEATWAVEWORKERPOOL_HPP__
+
+#include "CommonHeaders.hpp"
+
+/****************************************************************************/
+/**
+ ** A unit of work for a HeatWaveWorkerPool.
+ **
+ **/
+
+class HeatWaveJob
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   **/
+
+  HeatWaveJob();
+
+  /**
+   *
+   * Destructor.
+   *
+   **/
+
+  virtual ~HeatWaveJob();
+
+  /**
+   *
+   * Do the work, called once by one of the pool threads.
+   *
+   **/
+
+  virtual void DoRun() = 0;
+
+protected:
+
+  /** Sets m_batch. */
+  friend class HeatWaveWorkerPool;
+
+  /** The batch counter of a queued job, NULL if not part of one. */
+  SInt * m_batch;
+};
+
+/****************************************************************************/
+/**
+ ** A fixed size pool of (POSIX) threads running HeatWaveJob objects in
+ ** submission order. A pool of a single thread runs jobs in the calling
+ ** thread at submission, so serial and parallel use share the same code.
+ ** Jobs are owned by the caller and must live until DoWait() returns.
+ ** Jobs that submit jobs of their own must wait for them as a batch, a job
+ ** calling DoWait() would wait for itself. Built with HEATWAVENOTHREADS
+ ** every pool has a single thread.
+ **
+ **/
+
+class HeatWaveWorkerPool
+{
+public:
+
+  /**
+   *
+   * Constructor.
+   *
+   * @param threads The number of threads, if 0 or less the number of
+   * online processors is used. (0 by default)
+   *
+   **/
+
+  HeatWaveWorkerPool(SInt threads = 0);
+
+  /**
+   *
+   * Destructor, waits for the submitted jobs.
+   *
+   **/
+
+  ~HeatWaveWorkerPool();
+
+  /**
+   *
+   * @return The number of threads.
+   *
+   **/
+
+  SInt GetThreads() const;
+
+  /**
+   *
+   * Queue a job.
+   *
+   * @param job The job.
+   *
+   **/
+
+  void DoSubmit(HeatWaveJob * job);
+
+  /**
+   *
+   * Queue a job as part of a batch, see DoWait(SInt &).
+   *
+   * @param job The job.
+   * @param batch The batch, the number of its jobs that have not run yet.
+   * Set it to 0 before the first job.
+   *
+   **/
+
+  void DoSubmit(HeatWaveJob * job, SInt & batch);
+
+  /**
+   *
+   * Wait until all submitted jobs have run. Not to be called from a job.
+   *
+   **/
+
+  void DoWait();
+
+  /**
+   *
+   * Wait until the jobs of a batch have run. Meanwhile the calling thread
+   * runs queued jobs itself, so jobs of this pool may wait for batches of
+   * their own.
+   *
+   * @param batch The batch.
+   *
+   **/
+
+  void DoWait(SInt & batch);
+
+  /**
+   *
+   * @return The number of online processors, at least 1.
+   *
+   **/
+
+  static SInt GetProcessors();
+
+protected:
+
+  /**
+   *
+   * Thread entry point.
+   *
+   * @param arg The pool.
+   * @return NULL.
+   *
+   **/
+
+  static void * ThreadMain(void * arg);
+
+  /**
+   *
+   * Run jobs until asked to quit.
+   *
+   **/
+
+  void DoWork();
+
+  /**
+   *
+   * Queue a job, the mutex must be held.
+   *
+   * @param job The job.
+   *
+   **/
+
+  void DoQueue(HeatWaveJob * job);
+
+  /**
+   *
+   * Run the first queued job, the mutex must be held and is held again on
+   * return.
+   *
+   **/
+
+  void DoRunNext();
+
+  /** The threads, NULL if single threaded. */
+  CommonThread * m_threads;
+
+  /** The number of threads. */
+  SInt m_threadn;
+
+  /** Ring of queued jobs. */
+  HeatWaveJob ** m_jobs;
+
+  /** Capacity of the ring. */
+  SInt m_jobsLen;
+
+  /** First queued job. */
+  SInt m_jobsHead;
+
+  /** Number of queued jobs. */
+  SInt m_jobsn;
+
+  /** Number of jobs being run. */
+  SInt m_busy;
+
+  /** Threads should exit. */
+  Bool m_quit;
+
+  /** Guards the members above. */
+  CommonMutex m_mutex;
+
+  /** Signalled when a job is queued or on quit. */
+  CommonCond m_work;
+
+  /** Signalled when the pool runs out of work. */
+  CommonCond m_idle;
+
+private:
+
+  /** Not copyable. */
+  HeatWaveWorkerPool(const HeatWaveWorkerPool &);
+
+  /** Not assignable. */
+  HeatWaveWorkerPool & operator=(const HeatWaveWorkerPool &);
+};
+
+#endif //__HEATWAVEWORKERPOOL_HPP__
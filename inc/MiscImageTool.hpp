@@ -191,6 +191,24 @@ public:
   HeatWaveImage * ReadImage(const Char * file, const Char * form, 
 			    const Char * opts);
 
+  /**
+   *
+   * Read a JPEG image with libjpeg, optionally at a reduced size by DCT
+   * scaling and without the color convertion. The raw samples are the Y, Cb
+   * and Cr (or grey) planes at their own sampling, i.e. a 4:2:0 image gives
+   * chroma components of horizontal and vertical step 2.
+   *
+   * @param file The file name, NULL for standard input.
+   * @param scale Decode at 1/scale of the size, one of 1, 2, 4 or 8.
+   * @param raw Keep the planar YCbCr samples, else convert to RGB.
+   * @return Image on succes, else NULL.
+   * @note Print last error for more information. ReadImage() uses this for
+   * JPEG images, with the options "scale=<n>" and "raw".
+   *
+   **/
+
+  HeatWaveImage * ReadJPEG(const Char * file, SInt scale, Bool raw);
+
   /**
    *
    * Write a image from to a file or to standard output.
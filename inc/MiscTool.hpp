@@ -13,6 +13,8 @@
 #include "MiscImageTool.hpp"
 #include "SimpleCompressor.hpp"
 
+struct MiscBatch;
+
 /****************************************************************************/
 /**
  ** Command Line Interface For HeatWave Library.
@@ -85,6 +87,8 @@ protected:
   SInt DoMainImgLoad(EnumFunctionDuty duty, SInt argc, const Char ** argv);
   SInt DoMainImgSave(EnumFunctionDuty duty, SInt argc, const Char ** argv);
   SInt DoMainImgVidL(EnumFunctionDuty duty, SInt argc, const Char ** argv);
+  SInt DoMainImgVidP(EnumFunctionDuty duty, SInt argc, const Char ** argv);
+  SInt DoMainImgVidS(EnumFunctionDuty duty, SInt argc, const Char ** argv);
   SInt DoMainImgHIII(EnumFunctionDuty duty, SInt argc, const Char ** argv);
   /*@}*/
 
@@ -106,11 +110,33 @@ protected:
   SInt DoMainImgFuse(EnumFunctionDuty duty, SInt argc, const Char ** argv);
   SInt DoMainImgClrT(EnumFunctionDuty duty, SInt argc, const Char ** argv);
   SInt DoMainImgComp(EnumFunctionDuty duty, SInt argc, const Char ** argv);
+  SInt DoMainImgEval(EnumFunctionDuty duty, SInt argc, const Char ** argv);
+  SInt DoMainImgBitp(EnumFunctionDuty duty, SInt argc, const Char ** argv);
+  SInt DoMainImgQuan(EnumFunctionDuty duty, SInt argc, const Char ** argv);
   SInt DoMainImgHiEq(EnumFunctionDuty duty, SInt argc, const Char ** argv);
   SInt DoMainImgList(EnumFunctionDuty duty, SInt argc, const Char ** argv);
   SInt DoMainImgInfo(EnumFunctionDuty duty, SInt argc, const Char ** argv);
   SInt DoMainImgPlot(EnumFunctionDuty duty, SInt argc, const Char ** argv);
+  SInt DoMainProfile(EnumFunctionDuty duty, SInt argc, const Char ** argv);
+  SInt DoMainMemory(EnumFunctionDuty duty, SInt argc, const Char ** argv);
+  SInt DoMainBatch(EnumFunctionDuty duty, SInt argc, const Char ** argv);
+  SInt DoMainCache(EnumFunctionDuty duty, SInt argc, const Char ** argv);
   /*@}*/
+
+  /**
+   *
+   * Run the script of a batch for one of its files, with a tool of its own,
+   * and report the result. Called by the batch workers.
+   *
+   * @param bat The batch.
+   * @param indx The file index.
+   * @return True if the file went through without errors.
+   *
+   **/
+
+  Bool DoBatchFile(MiscBatch & bat, SInt indx);
+
+  friend class MiscBatchJob;
   
   /**
    *
@@ -238,6 +264,12 @@ protected:
   /** Image tool. **/
   MiscImageTool m_imgTool;
 
+  /** True if running a single file of a batch. **/
+  Bool m_batched;
+
+  /** The transform cache, NULL if not caching. **/
+  HeatWaveCache * m_cache;
+
 };
 
 #endif
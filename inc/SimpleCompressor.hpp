@@ -83,6 +83,19 @@ public:
 
   void SetData(vector<int> & vec);
 
+  /**
+   *
+   * Set the data vector from a strided area, e.g. a component view.
+   *
+   * @param data The first value.
+   * @param width The values per row.
+   * @param height The number of rows.
+   * @param pitch The distance in values between rows.
+   *
+   **/
+
+  void SetData(const int * data, int width, int height, int pitch);
+
   /**
    *
    * Get the Huffman table.
@@ -0,0 +1,54 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveAVIReader.hpp
+ * @brief  A test fixture for the HeatWaveAVIReader class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ *
+ **/
+
+#ifndef __TESTHEATWAVEAVIREADER_HPP__
+#define __TESTHEATWAVEAVIREADER_HPP__
+
+#include <HeatWaveAVIReader.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestHeatWaveAVIReader : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestHeatWaveAVIReader);
+#ifndef HEATWAVENOTHREADS
+  CPPUNIT_TEST (PrefetchInOrder);
+  CPPUNIT_TEST (PrefetchSeek);
+#endif
+  CPPUNIT_TEST (RecycleOtherLayout);
+  CPPUNIT_TEST (LayoutYV12);
+  CPPUNIT_TEST (LayoutNV12);
+  CPPUNIT_TEST (LayoutYUYV);
+  CPPUNIT_TEST (LayoutWide);
+  CPPUNIT_TEST (LayoutBGR);
+  CPPUNIT_TEST (LoadPacked);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+
+protected:
+  void PrefetchInOrder    (void);
+  void PrefetchSeek       (void);
+  void RecycleOtherLayout (void);
+  void LayoutYV12         (void);
+  void LayoutNV12         (void);
+  void LayoutYUYV         (void);
+  void LayoutWide         (void);
+  void LayoutBGR          (void);
+  void LoadPacked         (void);
+
+private:
+  Char file[64];
+};
+
+#endif
@@ -0,0 +1,41 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveAVIWriter.hpp
+ * @brief  A test fixture for the HeatWaveAVIWriter class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ *
+ **/
+
+#ifndef __TESTHEATWAVEAVIWRITER_HPP__
+#define __TESTHEATWAVEAVIWRITER_HPP__
+
+#include <HeatWaveAVIWriter.hpp>
+#include <HeatWaveAVIReader.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestHeatWaveAVIWriter : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestHeatWaveAVIWriter);
+  CPPUNIT_TEST (RoundTripIYUV);
+  CPPUNIT_TEST (RoundTripGrey);
+  CPPUNIT_TEST (SizeLimit);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+
+protected:
+  void RoundTripIYUV (void);
+  void RoundTripGrey (void);
+  void SizeLimit     (void);
+
+private:
+  Char file[64];
+};
+
+#endif
@@ -0,0 +1,46 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveBitplaneCoder.hpp
+ * @brief  A test fixture for the HeatWaveBitplaneCoder class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#ifndef __TESTHEATWAVEBITPLANECODER_HPP__
+#define __TESTHEATWAVEBITPLANECODER_HPP__
+
+#include <HeatWaveBitplaneCoder.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestHeatWaveBitplaneCoder : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestHeatWaveBitplaneCoder);
+  CPPUNIT_TEST (LosslessOdd);
+  CPPUNIT_TEST (LosslessTiled);
+  CPPUNIT_TEST (BudgetIsPrefix);
+  CPPUNIT_TEST (ErrorFallsWithBudget);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+  
+protected:
+  void LosslessOdd         (void);
+  void LosslessTiled       (void);
+  void BudgetIsPrefix      (void);
+  void ErrorFallsWithBudget(void);
+
+  /** A transformed test component, tiled if the tile sizes are not 0. */
+  HeatWaveComponent * GetComponent(SInt width, SInt height, SInt lev,
+                                   SInt twd = 0, SInt thg = 0);
+
+  /** Encode a component completely, decode it and compare. */
+  void DoRoundTrip(HeatWaveComponent & cmp);
+};
+
+#endif
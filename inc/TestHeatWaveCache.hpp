@@ -0,0 +1,45 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveCache.hpp
+ * @brief  A test fixture for the HeatWaveCache class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#ifndef __TESTHEATWAVECACHE_HPP__
+#define __TESTHEATWAVECACHE_HPP__
+
+#include <HeatWaveCache.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestHeatWaveCache : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestHeatWaveCache);
+  CPPUNIT_TEST (MissThenHit);
+  CPPUNIT_TEST (OtherInputMisses);
+  CPPUNIT_TEST (TruncatedFileMisses);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+  
+protected:
+  void MissThenHit        (void);
+  void OtherInputMisses   (void);
+  void TruncatedFileMisses(void);
+
+  /** The name of the only result file in the cache, NULL if not one. */
+  Char * GetResultFile();
+
+private:
+  Char dir[64];
+  HeatWaveComponent * cmpA;
+  HeatWaveComponent * cmpT;
+};
+
+#endif
@@ -0,0 +1,54 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveComponent.hpp
+ * @brief  A test fixture for the copy-on-write HeatWaveComponent storage.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#ifndef __TESTHEATWAVECOMPONENT_HPP__
+#define __TESTHEATWAVECOMPONENT_HPP__
+
+#include <HeatWaveComponent.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestHeatWaveComponent : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestHeatWaveComponent);
+  CPPUNIT_TEST (CopyThenWrite);
+  CPPUNIT_TEST (ConstReadKeepsShared);
+  CPPUNIT_TEST (UnsharePacked);
+  CPPUNIT_TEST (LastOwnerFrees);
+  CPPUNIT_TEST (Swap);
+  CPPUNIT_TEST (CopyKeepsLift);
+  CPPUNIT_TEST (TiledRoundTrip);
+  CPPUNIT_TEST (TiledInsideJob);
+  CPPUNIT_TEST (ResolutionMatchesInverse);
+  CPPUNIT_TEST (RegionMatchesInverse);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+  
+protected:
+  void CopyThenWrite       (void);
+  void ConstReadKeepsShared(void);
+  void UnsharePacked       (void);
+  void LastOwnerFrees      (void);
+  void Swap                (void);
+  void CopyKeepsLift       (void);
+  void TiledRoundTrip      (void);
+  void TiledInsideJob      (void);
+  void ResolutionMatchesInverse(void);
+  void RegionMatchesInverse(void);
+
+private:
+  HeatWaveComponent * cmpA;
+};
+
+#endif
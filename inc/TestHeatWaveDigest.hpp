@@ -0,0 +1,39 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveDigest.hpp
+ * @brief  A test fixture for the HeatWaveDigest class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#ifndef __TESTHEATWAVEDIGEST_HPP__
+#define __TESTHEATWAVEDIGEST_HPP__
+
+#include <HeatWaveDigest.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestHeatWaveDigest : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestHeatWaveDigest);
+  CPPUNIT_TEST (KnownXXH64);
+  CPPUNIT_TEST (KnownCRC32C);
+  CPPUNIT_TEST (PackedSame);
+  CPPUNIT_TEST (FirstDifference);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+  
+protected:
+  void KnownXXH64     (void);
+  void KnownCRC32C    (void);
+  void PackedSame     (void);
+  void FirstDifference(void);
+};
+
+#endif
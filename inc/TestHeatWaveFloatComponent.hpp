@@ -0,0 +1,39 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveFloatComponent.hpp
+ * @brief  A test fixture for the HeatWaveFloatComponent class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#ifndef __TESTHEATWAVEFLOATCOMPONENT_HPP__
+#define __TESTHEATWAVEFLOATCOMPONENT_HPP__
+
+#include <HeatWaveFloatComponent.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestHeatWaveFloatComponent : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestHeatWaveFloatComponent);
+  CPPUNIT_TEST (LiftLineReference);
+  CPPUNIT_TEST (RoundTrip97);
+  CPPUNIT_TEST (ConvertClamps);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+  
+protected:
+  void LiftLineReference(void);
+  void RoundTrip97      (void);
+  void ConvertClamps    (void);
+
+  HeatWaveComponent * cmpA;
+};
+
+#endif
@@ -0,0 +1,46 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveImageFile.hpp
+ * @brief  A test fixture for the HeatWaveImageFile class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ *
+ **/
+
+#ifndef __TESTHEATWAVEIMAGEFILE_HPP__
+#define __TESTHEATWAVEIMAGEFILE_HPP__
+
+#include <HeatWaveImageFile.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestHeatWaveImageFile : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestHeatWaveImageFile);
+  CPPUNIT_TEST (RoundTripBMP);
+  CPPUNIT_TEST (RoundTripPNM);
+  CPPUNIT_TEST (ReadPalette);
+  CPPUNIT_TEST (Read32Bit);
+  CPPUNIT_TEST (TruncatedBMP);
+  CPPUNIT_TEST (TruncatedPNM);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+
+protected:
+  void RoundTripBMP (void);
+  void RoundTripPNM (void);
+  void ReadPalette  (void);
+  void Read32Bit    (void);
+  void TruncatedBMP (void);
+  void TruncatedPNM (void);
+
+private:
+  Char file[64];
+};
+
+#endif
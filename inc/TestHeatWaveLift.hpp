@@ -26,6 +26,8 @@ class TestHeatWaveLift : public CPPUNIT_NS::TestFixture
   CPPUNIT_TEST (SplitAndJoinZ);
   CPPUNIT_TEST (SplitAndJoinN);
   CPPUNIT_TEST (SplitAndJoinAll);
+  CPPUNIT_TEST (LiftSmpl16);
+  CPPUNIT_TEST (LiftRows16);
   CPPUNIT_TEST_SUITE_END ();
 
 public:
@@ -38,6 +40,8 @@ protected:
   void SplitAndJoinZ  (void);
   void SplitAndJoinN  (void);
   void SplitAndJoinAll(void);
+  void LiftSmpl16     (void);
+  void LiftRows16     (void);
 
 private:
   HeatWaveLift * liftA, * liftB, * liftC;
@@ -0,0 +1,39 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveLineTransform.hpp
+ * @brief  A test fixture for the HeatWaveLineTransform class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#ifndef __TESTHEATWAVELINETRANSFORM_HPP__
+#define __TESTHEATWAVELINETRANSFORM_HPP__
+
+#include <HeatWaveLineTransform.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestHeatWaveLineTransform : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestHeatWaveLineTransform);
+  CPPUNIT_TEST (MatchColumn);
+  CPPUNIT_TEST (MatchRow);
+  CPPUNIT_TEST (MatchSquare);
+  CPPUNIT_TEST (MatchTall);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+  
+protected:
+  void MatchColumn(void);
+  void MatchRow   (void);
+  void MatchSquare(void);
+  void MatchTall  (void);
+};
+
+#endif
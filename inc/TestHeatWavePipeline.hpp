@@ -0,0 +1,35 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWavePipeline.hpp
+ * @brief  A test fixture for the HeatWavePipeline class and its stages.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#ifndef __TESTHEATWAVEPIPELINE_HPP__
+#define __TESTHEATWAVEPIPELINE_HPP__
+
+#include <HeatWaveStages.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestHeatWavePipeline : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestHeatWavePipeline);
+  CPPUNIT_TEST (KeepsOrder);
+  CPPUNIT_TEST (MatchesSequential);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+  
+protected:
+  void KeepsOrder       (void);
+  void MatchesSequential(void);
+};
+
+#endif
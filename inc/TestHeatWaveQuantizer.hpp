@@ -0,0 +1,37 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveQuantizer.hpp
+ * @brief  A test fixture for the HeatWaveQuantizer class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#ifndef __TESTHEATWAVEQUANTIZER_HPP__
+#define __TESTHEATWAVEQUANTIZER_HPP__
+
+#include <HeatWaveQuantizer.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestHeatWaveQuantizer : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestHeatWaveQuantizer);
+  CPPUNIT_TEST (QuantizeBoundaries);
+  CPPUNIT_TEST (DequantizeBoundaries);
+  CPPUNIT_TEST (StepOneKeeps);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+  
+protected:
+  void QuantizeBoundaries  (void);
+  void DequantizeBoundaries(void);
+  void StepOneKeeps        (void);
+};
+
+#endif
@@ -0,0 +1,35 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveResampler.hpp
+ * @brief  A test fixture for the HeatWaveResampler class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#ifndef __TESTHEATWAVERESAMPLER_HPP__
+#define __TESTHEATWAVERESAMPLER_HPP__
+
+#include <HeatWaveResampler.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestHeatWaveResampler : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestHeatWaveResampler);
+  CPPUNIT_TEST (MatchWide);
+  CPPUNIT_TEST (MatchTall);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+  
+protected:
+  void MatchWide(void);
+  void MatchTall(void);
+};
+
+#endif
@@ -0,0 +1,39 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveVideo.hpp
+ * @brief  A test fixture for the scene detection and grouping of the
+ *         HeatWaveVideo class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#ifndef __TESTHEATWAVEVIDEO_HPP__
+#define __TESTHEATWAVEVIDEO_HPP__
+
+#include <HeatWaveVideo.hpp>
+#include <HeatWaveWorkerPool.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestHeatWaveVideo : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestHeatWaveVideo);
+  CPPUNIT_TEST (SceneCut);
+  CPPUNIT_TEST (Groups);
+  CPPUNIT_TEST (GroupedRoundTrip);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+  
+protected:
+  void SceneCut        (void);
+  void Groups          (void);
+  void GroupedRoundTrip(void);
+};
+
+#endif
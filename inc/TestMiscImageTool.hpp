@@ -0,0 +1,47 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestMiscImageTool.hpp
+ * @brief  A test fixture for the MiscImageTool class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#ifndef __TESTMISCIMAGETOOL_HPP__
+#define __TESTMISCIMAGETOOL_HPP__
+
+#include <MiscImageTool.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestMiscImageTool : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestMiscImageTool);
+  CPPUNIT_TEST (SaveJasper);
+  CPPUNIT_TEST (SaveJasperPacked);
+  CPPUNIT_TEST (ReadJPEGScale);
+  CPPUNIT_TEST (ReadJPEGRaw);
+  CPPUNIT_TEST (ReadJPEGFallback);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+  
+protected:
+  void SaveJasper      (void);
+  void SaveJasperPacked(void);
+  void ReadJPEGScale   (void);
+  void ReadJPEGRaw     (void);
+  void ReadJPEGFallback(void);
+
+  /** Save the image with JasPer, load it back and compare. */
+  void DoRoundTrip(const HeatWaveImage & img);
+
+private:
+  HeatWaveImage * imgA;
+};
+
+#endif
@@ -0,0 +1,35 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestMiscTool.hpp
+ * @brief  A test fixture for the MiscTool class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ *
+ **/
+
+#ifndef __TESTMISCTOOL_HPP__
+#define __TESTMISCTOOL_HPP__
+
+#include <MiscTool.hpp>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace std;
+
+class TestMiscTool : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TestMiscTool);
+  CPPUNIT_TEST (BatchReport);
+  CPPUNIT_TEST (BatchFailure);
+  CPPUNIT_TEST_SUITE_END ();
+
+public:
+  void setUp (void);
+  void tearDown (void);
+
+protected:
+  void BatchReport (void);
+  void BatchFailure(void);
+};
+
+#endif
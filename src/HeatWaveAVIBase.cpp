@@ -67,8 +67,13 @@ const char * STREAM_TYPES[] = {
  **/
 
 const StructCodingType CODEING_TYPES[] = {
-  {VidIYUV,SpcYUV,3,{ClrY,ClrU,ClrV},{1,2,2},{1,2,2}},
-  {VidGREY,SpcGrey,1,{ClrY,ClrUnknown,ClrUnknown},{1,1,1},{1,1,1}},
+  {VidIYUV,SpcYUV,3,{ClrY,ClrU,ClrV},{1,2,2},{1,2,2},LayPlanar},
+  {VidGREY,SpcGrey,1,{ClrY,ClrUnknown,ClrUnknown},{1,1,1},{1,1,1},LayPlanar},
+  {VidYV12,SpcYUV,3,{ClrY,ClrU,ClrV},{1,2,2},{1,2,2},LayPlanarYVU},
+  {VidNV12,SpcYUV,3,{ClrY,ClrU,ClrV},{1,2,2},{1,2,2},LaySemiPlanar},
+  {VidYUY2,SpcYUV,3,{ClrY,ClrU,ClrV},{1,2,2},{1,1,1},LayYUYV},
+  {VidUYVY,SpcYUV,3,{ClrY,ClrU,ClrV},{1,2,2},{1,1,1},LayUYVY},
+  {VidRGB,SpcRGB,3,{ClrR,ClrG,ClrB},{1,1,1},{1,1,1},LayBGR},
 };
 
 HeatWaveAVIBase::HeatWaveAVIBase()
@@ -398,13 +403,13 @@ HeatWaveAVIBase::DoDestroy()
     delete m_avih;
     delete m_vids;
     delete m_vidsInfo;
-    delete m_vidsName;
-    delete m_vidsCodingInfo;
+    delete [] m_vidsName;
+    delete [] m_vidsCodingInfo;
     delete m_auds;
     delete m_audsInfo;
-    delete m_audsName;
-    delete m_audsCodingInfo;
-    delete m_error;
+    delete [] m_audsName;
+    delete [] m_audsCodingInfo;
+    delete [] m_error;
     memset(this,0,sizeof(HeatWaveAVIBase));
   }
 }
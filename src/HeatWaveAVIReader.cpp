@@ -7,15 +7,114 @@
  **/
 
 #include "HeatWaveAVIReader.hpp"
+#include "HeatWaveProfiler.hpp"
+#include "HeatWaveMemory.hpp"
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#include <emmintrin.h>
+#define HEATWAVEAVIREADERSSE2
+#endif
 
 /** Error message to use on general I/O failure. **/
 const char * IOERROR = "general I/O failure has occured";
 
+/****************************************************************************/
+
+/** Widen a run of bytes to samples. */
+static void
+DoSpread(const UInt8 * src, Smpl * dst, SInt num)
+{
+  SInt x = 0;
+#ifdef HEATWAVEAVIREADERSSE2
+  if ( sizeof(Smpl) == 4 ){
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; x+16 <= num ; x += 16 ){
+      __m128i val = _mm_loadu_si128((const __m128i*)(src+x));
+      __m128i lo = _mm_unpacklo_epi8(val, zero);
+      __m128i hi = _mm_unpackhi_epi8(val, zero);
+      _mm_storeu_si128((__m128i*)(dst+x), _mm_unpacklo_epi16(lo, zero));
+      _mm_storeu_si128((__m128i*)(dst+x+4), _mm_unpackhi_epi16(lo, zero));
+      _mm_storeu_si128((__m128i*)(dst+x+8), _mm_unpacklo_epi16(hi, zero));
+      _mm_storeu_si128((__m128i*)(dst+x+12), _mm_unpackhi_epi16(hi, zero));
+    }
+  }
+#endif
+  for ( ; x < num ; ++x ){
+    dst[x] = (Smpl)src[x];
+  }
+}
+
+/** Split a run of byte pairs, as the U and V of NV12, into two lines. */
+static void
+DoSpreadPairs(const UInt8 * src, Smpl * a, Smpl * b, SInt num)
+{
+  SInt x = 0;
+#ifdef HEATWAVEAVIREADERSSE2
+  if ( sizeof(Smpl) == 4 ){
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low = _mm_set1_epi16(0xff);
+    for ( ; x+8 <= num ; x += 8 ){
+      __m128i val = _mm_loadu_si128((const __m128i*)(src+(2*x)));
+      __m128i va = _mm_and_si128(val, low);
+      __m128i vb = _mm_srli_epi16(val, 8);
+      _mm_storeu_si128((__m128i*)(a+x), _mm_unpacklo_epi16(va, zero));
+      _mm_storeu_si128((__m128i*)(a+x+4), _mm_unpackhi_epi16(va, zero));
+      _mm_storeu_si128((__m128i*)(b+x), _mm_unpacklo_epi16(vb, zero));
+      _mm_storeu_si128((__m128i*)(b+x+4), _mm_unpackhi_epi16(vb, zero));
+    }
+  }
+#endif
+  for ( ; x < num ; ++x ){
+    a[x] = (Smpl)src[2*x];
+    b[x] = (Smpl)src[(2*x)+1];
+  }
+}
+
+/** Split a run of YUYV (oy 0) or UYVY (oy 1) quads into a line of luma and
+ ** lines of U and V. */
+static void
+DoSpreadQuads(const UInt8 * src, Smpl * l, Smpl * u, Smpl * v, SInt num,
+              SInt oy)
+{
+  SInt x = 0;
+#ifdef HEATWAVEAVIREADERSSE2
+  if ( sizeof(Smpl) == 4 ){
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low = _mm_set1_epi16(0xff);
+    const __m128i half = _mm_set1_epi32(0xffff);
+    for ( ; x+4 <= num ; x += 4 ){
+      __m128i val = _mm_loadu_si128((const __m128i*)(src+(4*x)));
+      __m128i even = _mm_and_si128(val, low);
+      __m128i odd = _mm_srli_epi16(val, 8);
+      __m128i vl = oy ? odd : even;
+      // U and V alternate, one pair in each 32 bits
+      __m128i vc = oy ? even : odd;
+      _mm_storeu_si128((__m128i*)(l+(2*x)), _mm_unpacklo_epi16(vl, zero));
+      _mm_storeu_si128((__m128i*)(l+(2*x)+4), _mm_unpackhi_epi16(vl, zero));
+      _mm_storeu_si128((__m128i*)(u+x), _mm_and_si128(vc, half));
+      _mm_storeu_si128((__m128i*)(v+x), _mm_srli_epi32(vc, 16));
+    }
+  }
+#endif
+  SInt ou = 1-oy;
+  for ( ; x < num ; ++x ){
+    const UInt8 * q = src+(4*x);
+    l[2*x] = (Smpl)q[oy];
+    l[(2*x)+1] = (Smpl)q[oy+2];
+    u[x] = (Smpl)q[ou];
+    v[x] = (Smpl)q[ou+2];
+  }
+}
+
+/****************************************************************************/
+
 HeatWaveAVIReader::HeatWaveAVIReader()
 {
   memset((char*)this,0,sizeof(HeatWaveAVIReader));
   m_desMem = True;
   m_coder.m_type = VidUnknown;
+  InitMutex(&m_mutex);
+  InitCond(&m_cond);
 }
   
 HeatWaveAVIReader::HeatWaveAVIReader(const char * str, HeatWaveVideo * vid)
@@ -23,17 +122,40 @@ HeatWaveAVIReader::HeatWaveAVIReader(const char * str, HeatWaveVideo * vid)
   memset((char*)this,0,sizeof(HeatWaveAVIReader));
   m_desMem = True;
   m_coder.m_type = VidUnknown;
+  InitMutex(&m_mutex);
+  InitCond(&m_cond);
   CpyFileName(str);
   SetVideoPtr(vid);
 }
 
 HeatWaveAVIReader::HeatWaveAVIReader(const HeatWaveAVIReader & oth)
 {
+  memset((char*)this,0,sizeof(HeatWaveAVIReader));
+  m_desMem = True;
+  m_coder.m_type = VidUnknown;
+  InitMutex(&m_mutex);
+  InitCond(&m_cond);
   DoCopy(oth);
 }
   
 HeatWaveAVIReader::~HeatWaveAVIReader()
 {
+  DoStopPrefetch();
+  for ( SInt i = 0 ; i < m_pooln ; ++i ){
+    delete m_poola[i];
+  }
+  delete [] m_poola;
+  delete [] m_ring;
+  delete [] m_frameOfs;
+  delete [] m_frameLen;
+  HeatWaveMemory::SubBytes(MemAVI, (SInt64)m_rawLen+
+                           (SInt64)m_chunkLen*sizeof(DataChunk)+
+                           (m_block ? HEATWAVEAVIBLOCK : 0));
+  delete [] m_raw;
+  delete [] m_chunka;
+  delete [] m_block;
+  FreeCond(&m_cond);
+  FreeMutex(&m_mutex);
   DoDestroy();
 }
 
@@ -91,6 +213,9 @@ HeatWaveAVIReader::AnalyseFile()
   if (!IsDecodable()){
     goto error;
   }
+  if (!DoIndexFrames()){
+    goto error;
+  }
   
   return True;
  error:
@@ -98,7 +223,7 @@ HeatWaveAVIReader::AnalyseFile()
 }
 
 HeatWaveVideo *
-HeatWaveAVIReader::LoadVideo()
+HeatWaveAVIReader::LoadVideo(Bool pack)
 {
   if ( (m_fileHandle == NULL) || (m_coder.m_type == VidUnknown) ){
     WARN_IF(True); // "forgot to check returned values" mistake
@@ -115,9 +240,12 @@ HeatWaveAVIReader::LoadVideo()
     if ( arr[i] == NULL ){
       goto error;
     }
+    if ( pack ){
+      arr[i]->DoPack();
+    }
   }
 
-  ret = new HeatWaveVideo(m_vids->rcFrame.right,m_vids->rcFrame.bottom,
+  ret = new HeatWaveVideo(m_frameWidth,m_frameHeight,
 			  m_coder.m_space,m_coder.m_hSampling,
 			  m_coder.m_vSampling,m_vids->dwLength,
 			  arr,True,False);
@@ -126,9 +254,9 @@ HeatWaveAVIReader::LoadVideo()
 
 error:
   for ( SInt i = 0 ; i < (SInt)(m_vids->dwLength) ; ++i ){
-    delete [] arr[i];
+    delete arr[i];
   }
-  delete arr;
+  delete [] arr;
   return NULL;
 }
 
@@ -146,69 +274,506 @@ HeatWaveAVIReader::LoadFrame(SInt num)
     CpyError(error);
     return NULL;
   }
-  char frame_id[FOUR_CC+1];
-  sprintf(frame_id,"%02ddb",m_vidsPriority);
-  DataChunk * img_data = LocateChunk(frame_id,num);
-  if ( img_data == NULL ){
+  if ( num >= m_frameN ){
     CpyError("file is missing frames!");
     return NULL;
   }
-  if ( fseek ( m_fileHandle, img_data->m_offset+CHUNK_HEADER, SEEK_SET )){
+
+  if ( m_running ){
+    LockMutex(&m_mutex);
+    // the next frame in order is on the ring or being read
+    if ( num == (m_next-m_ringN) ){
+      while ( m_ringN == 0 ){
+        WaitCond(&m_cond, &m_mutex);
+      }
+      HeatWaveImage * ret = m_ring[m_ringHead];
+      m_ringHead = (m_ringHead+1)%m_ahead;
+      --m_ringN;
+      BroadcastCond(&m_cond);
+      UnlockMutex(&m_mutex);
+      return ret;
+    }
+    UnlockMutex(&m_mutex);
+    DoStopPrefetch();
+  }
+
+  HeatWaveImage * reuse = NULL;
+  if ( m_pooln > 0 ){
+    reuse = m_poola[--m_pooln];
+  }
+  HeatWaveImage * ret = GetFrameAt(num, reuse);
+  m_next = num+1;
+  if ( m_ahead > 0 ){
+    DoStartPrefetch();
+  }
+  return ret;
+}
+
+Bool
+HeatWaveAVIReader::SetPrefetch(SInt ahead)
+{
+  if ( (m_fileHandle == NULL) || (m_coder.m_type == VidUnknown) ){
+    CpyError("no file analysed");
+    return False;
+  }
+  DoStopPrefetch();
+#ifdef HEATWAVENOTHREADS
+  ahead = 0;
+#endif
+  if ( ahead < 0 ){
+    ahead = 0;
+  }
+  delete [] m_ring;
+  m_ring = NULL;
+  if ( ahead > 0 ){
+    m_ring = new HeatWaveImage*[ahead];
+    LEAVEONNULL(m_ring);
+  }
+
+  // keep up to one more frame then read ahead
+  HeatWaveImage ** pool = new HeatWaveImage*[ahead+1];
+  LEAVEONNULL(pool);
+  SInt pooln = 0;
+  for ( SInt i = 0 ; i < m_pooln ; ++i ){
+    if ( pooln <= ahead ){
+      pool[pooln++] = m_poola[i];
+    }
+    else{
+      delete m_poola[i];
+    }
+  }
+  delete [] m_poola;
+  m_poola = pool;
+  m_pooln = pooln;
+  m_poolLen = ahead+1;
+
+  m_ahead = ahead;
+  if ( m_ahead > 0 ){
+    return DoStartPrefetch();
+  }
+  return True;
+}
+
+SInt
+HeatWaveAVIReader::GetPrefetch() const
+{
+  return m_ahead;
+}
+
+void
+HeatWaveAVIReader::DoRecycle(HeatWaveImage * img)
+{
+  if ( img == NULL ){
+    return;
+  }
+  if ( (m_coder.m_type == VidUnknown) || !IsReusable(*img) ){
+    delete img;
+    return;
+  }
+  LockMutex(&m_mutex);
+  DoPoolPush(img);
+  UnlockMutex(&m_mutex);
+}
+
+HeatWaveImage *
+HeatWaveAVIReader::GetFrameAt(SInt num, HeatWaveImage * reuse)
+{
+  ASSERT ( (num >= 0) && (num < m_frameN) );
+  if ( fseek ( m_fileHandle, m_frameOfs[num]+CHUNK_HEADER, SEEK_SET )){
     CpyError(IOERROR);
+    delete reuse;
     return NULL;
   }
-
-  return GetFrame(img_data->m_size);
+  return GetFrame(m_frameLen[num], reuse);
 }
 
-HeatWaveImage * 
-HeatWaveAVIReader::GetFrame(SInt actSize)
+Bool
+HeatWaveAVIReader::IsReusable(HeatWaveImage & img) const
 {
-  HeatWaveImage * ret = NULL;
-  HeatWaveComponent ** cmp = new HeatWaveComponent*[m_coder.m_colors];
-  LEAVEONNULL(cmp);
+  if ( (img.GetComponentN() != m_coder.m_colors) ||
+       (img.GetWidth() != m_frameWidth) ||
+       (img.GetHeight() != m_frameHeight) ||
+       !img.GetDesMem() ){
+    return False;
+  }
   for ( SInt c = 0 ; c < m_coder.m_colors ; ++c ){
-    SInt width = m_vidsInfo->biWidth;
-    SInt height = m_vidsInfo->biHeight;
+    const HeatWaveComponent & cmp = img.GetComponent(c);
     SInt hStep = m_coder.m_hSampling[c];
     SInt vStep = m_coder.m_vSampling[c];
-    if ( (width % hStep) || (height % vStep) ){
-      CpyError("unable to handle video image size!");
-      goto error;
+    if ( (cmp.GetTLX() != 0) || (cmp.GetTLY() != 0) ||
+         (cmp.GetHStep() != hStep) || (cmp.GetVStep() != vStep) ||
+         (cmp.GetWidth() != m_frameWidth/hStep) ||
+         (cmp.GetHeight() != m_frameHeight/vStep) ||
+         !cmp.GetDesMem() ){
+      return False;
     }
-    width = width / hStep;
-    height = height / vStep;
-    SInt size = height * width;
-    actSize -= size;
-    if ( actSize < 0 ){
-      CpyError("frame chunk is missing information!");
-      goto error;
+  }
+  // back to the state of a frame just read
+  for ( SInt c = 0 ; c < m_coder.m_colors ; ++c ){
+    HeatWaveComponent & cmp = img.GetComponent(c);
+    cmp.DoUnpack();
+    cmp.SetSgnd(False);
+    cmp.SetPrec(8);
+    cmp.SetColor(m_coder.m_order[c]);
+    cmp.SetTransformLevel(0);
+    cmp.SetTransformType(Trn0_0);
+    cmp.SetTiling(0, 0);
+  }
+  img.SetSpace(m_coder.m_space);
+  img.SetTransformLevel(0);
+  img.SetTransformType(Trn0_0);
+  img.SetSceneSwitch(False);
+  return True;
+}
+
+Bool
+HeatWaveAVIReader::DoIndexFrames()
+{
+  delete [] m_frameOfs;
+  delete [] m_frameLen;
+  m_frameOfs = NULL;
+  m_frameLen = NULL;
+  m_frameN = 0;
+  m_next = 0;
+
+  DataChunk * movi = LocateChunk(LIST_MOVI,0);
+  if ( movi == NULL ){
+    CpyError("avi file has no movi list");
+    return False;
+  }
+  SInt len = m_vids->dwLength;
+  if ( len < 1 ){
+    return True;
+  }
+  m_frameOfs = new SInt[len];
+  LEAVEONNULL(m_frameOfs);
+  m_frameLen = new SInt[len];
+  LEAVEONNULL(m_frameLen);
+
+  // the index saves reading a header per frame, without a usable one the
+  // movi list is walked
+  DataChunk * idx1 = LocateChunk(CHUNK_IDX1,0);
+  if ( idx1 && DoIndexFromIdx1(*movi,*idx1) ){
+    return True;
+  }
+  m_frameN = 0;
+  return DoIndexFromMovi(*movi);
+}
+
+Bool
+HeatWaveAVIReader::DoIndexFromIdx1(const DataChunk & movi,
+                                   const DataChunk & idx1)
+{
+  SInt len = m_vids->dwLength;
+  SInt n = (idx1.m_size)/sizeof(HeatWaveAVIIndexEntry);
+  SInt bytes = n*sizeof(HeatWaveAVIIndexEntry);
+  SInt size = GetFileSize();
+  if ( (n < 1) || (size < 0) ||
+       ((size-(idx1.m_offset+CHUNK_HEADER)) < bytes) ){
+    return False;
+  }
+  HeatWaveAVIIndexEntry * idx = new HeatWaveAVIIndexEntry[n];
+  LEAVEONNULL(idx);
+  Bool ok = GetBytes(idx1.m_offset+CHUNK_HEADER,bytes,(char*)idx);
+
+  // the offsets are from the movi type, or from the file start with some
+  // writers, the first frame tells which
+  SInt base = movi.m_offset+CHUNK_HEADER;
+  SInt beg = movi.m_offset+LIST_HEADER;
+  SInt end = movi.m_offset+CHUNK_HEADER+movi.m_size;
+  Bool first = True;
+  for ( SInt i = 0 ; ok && (i < n) && (m_frameN < len) ; ++i ){
+    const char * name = (const char *)&(idx[i].ckid);
+    if ( (idx[i].dwFlags & AVIIF_LIST) || !IsFrameChunk(name) ){
+      continue;
     }
-    cmp[c] = new HeatWaveComponent(0,0,hStep,vStep,width,height,False,8,
-                                 m_coder.m_order[c]);
-    LEAVEONNULL(cmp[c]);
-    Smpl * vect = cmp[c]->GetData();
-    SInt in;
-    for ( SInt i = 0 ; i < size ; ++i ){
-      if ( (in = fgetc(m_fileHandle)) == EOF ){
-        CpyError(IOERROR);
-        goto error;
-      }
-      else{
-        vect[i] = (Smpl)in;
+    SInt ofs = (SInt)(idx[i].dwChunkOffset);
+    SInt frm = (SInt)(idx[i].dwChunkLength);
+    char tmp[FOUR_CC];
+    if ( first ){
+      first = False;
+      if ( (ofs < 0) || (ofs > (end-base)) ||
+           !GetBytes(base+ofs,FOUR_CC,tmp) ||
+           (strncmp(tmp,name,FOUR_CC) != 0) ){
+        base = 0;
       }
     }
+    ofs += base;
+    if ( (ofs < beg) || (frm < 0) || (ofs > (end-CHUNK_HEADER)) ||
+         (frm > (end-CHUNK_HEADER-ofs)) ){
+      ok = False;
+    }
+    else if ( (base == 0) && (m_frameN == 0) &&
+              (!GetBytes(ofs,FOUR_CC,tmp) ||
+               (strncmp(tmp,name,FOUR_CC) != 0)) ){
+      ok = False;
+    }
+    else{
+      m_frameOfs[m_frameN] = ofs;
+      m_frameLen[m_frameN] = frm;
+      ++m_frameN;
+    }
   }
-  ret = new HeatWaveImage(0,0,m_vidsInfo->biWidth,m_vidsInfo->biHeight,
-                        m_coder.m_space,m_coder.m_colors,cmp,True,False);
-  LEAVEONNULL(ret);
-  return ret;
-  
- error:
-  delete [] cmp;
+  delete [] idx;
+  return ok && (m_frameN > 0);
+}
+
+Bool
+HeatWaveAVIReader::DoIndexFromMovi(const DataChunk & movi)
+{
+  SInt len = m_vids->dwLength;
+  SInt pos = movi.m_offset+LIST_HEADER;
+  SInt end = movi.m_offset+CHUNK_HEADER+movi.m_size;
+  SInt rec = -1;
+  DataChunk chk;
+
+  // frames may be grouped into rec lists, one level down
+  while ( m_frameN < len ){
+    if ( (rec >= 0) && ((rec-pos) < CHUNK_HEADER) ){
+      pos = rec;
+      rec = -1;
+    }
+    if ( (end-pos) < CHUNK_HEADER ){
+      break;
+    }
+    if ( !GetBytes(pos,CHUNK_HEADER,(char*)&chk) ){
+      CpyError(IOERROR);
+      return False;
+    }
+    if ( chk.m_size < 0 ){
+      CpyError("file structure error, contact author");
+      return False;
+    }
+    SInt next = pos+CHUNK_HEADER+(chk.m_size)+((chk.m_size) & 1);
+    if ( (rec < 0) && SeeIfInList(chk.m_name,LIST_NAMES,FOUR_CC) ){
+      rec = HeatWaveMath::Min(next,end);
+      pos += LIST_HEADER;
+      continue;
+    }
+    if ( IsFrameChunk(chk.m_name) ){
+      m_frameOfs[m_frameN] = pos;
+      m_frameLen[m_frameN] = chk.m_size;
+      ++m_frameN;
+    }
+    pos = next;
+  }
+  return True;
+}
+
+Bool
+HeatWaveAVIReader::IsFrameChunk(const char * name) const
+{
+  // uncompressed frames are "db" chunks, but some writers use "dc"
+  char frame_id[FOUR_CC+1];
+  sprintf(frame_id,"%02dd",m_vidsPriority);
+  return ( (strncmp(name,frame_id,TWO_CC+1) == 0) &&
+           ((name[TWO_CC+1] == 'b') || (name[TWO_CC+1] == 'c')) );
+}
+
+Bool
+HeatWaveAVIReader::DoStartPrefetch()
+{
+  ASSERT ( !m_running );
+  m_stop = False;
+  m_ringHead = 0;
+  m_ringN = 0;
+  if ( !StartThread(&m_thread, ThreadMain, this) ){
+    m_ahead = 0;
+    CpyError("unable to start the read ahead thread");
+    return False;
+  }
+  m_running = True;
+  return True;
+}
+
+void
+HeatWaveAVIReader::DoStopPrefetch()
+{
+  if ( !m_running ){
+    return;
+  }
+  LockMutex(&m_mutex);
+  m_stop = True;
+  BroadcastCond(&m_cond);
+  UnlockMutex(&m_mutex);
+  JoinThread(m_thread);
+  m_running = False;
+
+  // the frames not handed out are read again when asked for
+  m_next -= m_ringN;
+  for ( SInt i = 0 ; i < m_ringN ; ++i ){
+    HeatWaveImage * img = m_ring[(m_ringHead+i)%m_ahead];
+    if ( img ){
+      DoPoolPush(img);
+    }
+  }
+  m_ringN = 0;
+}
+
+void
+HeatWaveAVIReader::DoPoolPush(HeatWaveImage * img)
+{
+  if ( m_poola == NULL ){
+    m_poolLen = m_ahead+1;
+    m_poola = new HeatWaveImage*[m_poolLen];
+    LEAVEONNULL(m_poola);
+  }
+  if ( m_pooln < m_poolLen ){
+    m_poola[m_pooln++] = img;
+  }
+  else{
+    delete img;
+  }
+}
+
+void *
+HeatWaveAVIReader::ThreadMain(void * arg)
+{
+  ((HeatWaveAVIReader*)arg)->DoPrefetch();
   return NULL;
 }
 
+void
+HeatWaveAVIReader::DoPrefetch()
+{
+  LockMutex(&m_mutex);
+  while ( !m_stop ){
+    if ( (m_ringN == m_ahead) || (m_next >= m_frameN) ){
+      WaitCond(&m_cond, &m_mutex);
+      continue;
+    }
+    SInt num = m_next;
+    HeatWaveImage * img = NULL;
+    if ( m_pooln > 0 ){
+      img = m_poola[--m_pooln];
+    }
+    // only this thread touches the file while prefetching
+    UnlockMutex(&m_mutex);
+    img = GetFrameAt(num, img);
+    LockMutex(&m_mutex);
+    m_ring[(m_ringHead+m_ringN)%m_ahead] = img;
+    ++m_ringN;
+    ++m_next;
+    BroadcastCond(&m_cond);
+  }
+  UnlockMutex(&m_mutex);
+}
+
+HeatWaveImage * 
+HeatWaveAVIReader::GetFrame(SInt actSize, HeatWaveImage * reuse)
+{
+  HeatWaveImage * ret = reuse;
+  SInt64 smpl = 0;
+  for ( SInt c = 0 ; c < m_coder.m_colors ; ++c ){
+    smpl += (m_frameWidth/m_coder.m_hSampling[c])*
+      (m_frameHeight/m_coder.m_vSampling[c]);
+  }
+  HEATWAVEPROFILE(PrfAVIRead, smpl, m_frameBytes+(smpl*sizeof(Smpl)));
+  if ( actSize < m_frameBytes ){
+    CpyError("frame chunk is missing information!");
+    delete reuse;
+    return NULL;
+  }
+  // the whole frame in one read, then spread over the components
+  if ( m_frameBytes > m_rawLen ){
+    HeatWaveMemory::SubBytes(MemAVI, m_rawLen);
+    delete [] m_raw;
+    m_raw = new UInt8[m_frameBytes];
+    LEAVEONNULL(m_raw);
+    m_rawLen = m_frameBytes;
+    HeatWaveMemory::AddBytes(MemAVI, m_rawLen);
+  }
+  if ( fread(m_raw, 1, m_frameBytes, m_fileHandle) != (size_t)m_frameBytes ){
+    CpyError(IOERROR);
+    delete reuse;
+    return NULL;
+  }
+  if ( ret == NULL ){
+    HeatWaveComponent ** cmp = new HeatWaveComponent*[m_coder.m_colors];
+    LEAVEONNULL(cmp);
+    for ( SInt c = 0 ; c < m_coder.m_colors ; ++c ){
+      SInt hStep = m_coder.m_hSampling[c];
+      SInt vStep = m_coder.m_vSampling[c];
+      cmp[c] = new HeatWaveComponent(0,0,hStep,vStep,m_frameWidth/hStep,
+                                     m_frameHeight/vStep,False,8,
+                                     m_coder.m_order[c]);
+      LEAVEONNULL(cmp[c]);
+    }
+    ret = new HeatWaveImage(0,0,m_frameWidth,m_frameHeight,m_coder.m_space,
+                            m_coder.m_colors,cmp,True,False);
+    LEAVEONNULL(ret);
+  }
+  DoDeinterleave(*ret);
+  return ret;
+}
+
+void
+HeatWaveAVIReader::DoDeinterleave(HeatWaveImage & img) const
+{
+  const UInt8 * in = m_raw;
+  SInt width = m_frameWidth;
+  SInt height = m_frameHeight;
+  Smpl ** rows[MAXCOLORSINANYSPACE];
+  for ( SInt c = 0 ; c < m_coder.m_colors ; ++c ){
+    rows[c] = img.GetComponent(c).GetRows();
+  }
+
+  switch ( m_coder.m_layout ){
+  case LayPlanar:
+  case LayPlanarYVU:
+    for ( SInt p = 0 ; p < m_coder.m_colors ; ++p ){
+      SInt c = p;
+      if ( (m_coder.m_layout == LayPlanarYVU) && (p > 0) ){
+        c = 3-p;
+      }
+      SInt w = width/m_coder.m_hSampling[c];
+      SInt h = height/m_coder.m_vSampling[c];
+      for ( SInt y = 0 ; y < h ; ++y ){
+        DoSpread(in, rows[c][y], w);
+        in += w;
+      }
+    }
+    break;
+  case LaySemiPlanar:
+    for ( SInt y = 0 ; y < height ; ++y ){
+      DoSpread(in, rows[0][y], width);
+      in += width;
+    }
+    for ( SInt y = 0 ; y < height/2 ; ++y ){
+      DoSpreadPairs(in, rows[1][y], rows[2][y], width/2);
+      in += width;
+    }
+    break;
+  case LayYUYV:
+  case LayUYVY:
+    {
+      // byte offset of Y0 in each quad, Y1 follows it by 2
+      SInt oy = (m_coder.m_layout == LayYUYV) ? 0 : 1;
+      for ( SInt y = 0 ; y < height ; ++y ){
+        DoSpreadQuads(in, rows[0][y], rows[1][y], rows[2][y], width/2, oy);
+        in += 2*width;
+      }
+    }
+    break;
+  case LayBGR:
+    {
+      SInt pitch = ((3*width)+3) & ~3;
+      for ( SInt y = 0 ; y < height ; ++y ){
+        const UInt8 * t = m_raw+((m_bottomUp ? (height-1-y) : y)*pitch);
+        Smpl * r = rows[0][y];
+        Smpl * g = rows[1][y];
+        Smpl * b = rows[2][y];
+        for ( SInt x = 0 ; x < width ; ++x ){
+          b[x] = (Smpl)t[3*x];
+          g[x] = (Smpl)t[(3*x)+1];
+          r[x] = (Smpl)t[(3*x)+2];
+        }
+      }
+    }
+    break;
+  }
+}
+
 Bool 
 HeatWaveAVIReader::LoadAudio()
 {
@@ -219,6 +784,8 @@ HeatWaveAVIReader::LoadAudio()
 Bool 
 HeatWaveAVIReader::CloseFile()
 {
+  DoStopPrefetch();
+  m_blockN = 0;
   if ( m_fileHandle == NULL ){
     CpyError("no file open");
     goto error;
@@ -240,103 +807,91 @@ HeatWaveAVIReader::GetClone() const
   return NULL;
 }
 
+// unusaul for avi files to have more than 4 depth levels
+// also for stack size reasons we dont use recursive functions
+// (for Windows CE and Symbian)
 Bool 
 HeatWaveAVIReader::AnalyseFileInternal(SInt file_size)
 {
-  if ( fseek ( m_fileHandle, 0 , SEEK_SET )){
-    CpyError(IOERROR);
-    goto problem;
-  }
+  const SInt max_depth = 10; 
+  SInt open[max_depth];
+  SInt end[max_depth];
+  SInt depth = 0;
+  SInt pos = 0;
+  DataChunk chk;
+
+  m_chunkn = 0;
+  m_blockN = 0;
   if ( file_size < LIST_HEADER ){
     CpyError("file is to small, not suitable for usage");
     goto problem;
   }
-  else if ( !GetCharacters(LIST_HEADER,(char*)&m_chunk)){
+  else if ( !GetBytes(0,LIST_HEADER,(char*)&chk)){
     CpyError("file has errors, not suitable for usage");
     goto problem;
   }
-  if (( strncmp(m_chunk.m_name,LIST_NAMES[0],FOUR_CC) != 0 ) ||
-      ( strncmp(m_chunk.m_type,LIST_TYPES[0],FOUR_CC) != 0 ) ||
-      ( m_chunk.m_size > (file_size-CHUNK_HEADER))){
+  if (( strncmp(chk.m_name,LIST_NAMES[0],FOUR_CC) != 0 ) ||
+      ( strncmp(chk.m_type,LIST_TYPES[0],FOUR_CC) != 0 ) ||
+      ( chk.m_size < FOUR_CC ) ||
+      ( chk.m_size > (file_size-CHUNK_HEADER))){
     CpyError("file is not in RIFF format, i.e. not a AVI file");
     goto problem;
   }
-  else {
-    if ( m_chunk.m_sub ){
-      delete m_chunk.m_sub;
-      m_chunk.m_sub = NULL;
-    }
-    m_chunk.m_list = True;
-    m_chunk.m_sub = new DataChunk();
-    LEAVEONNULL(m_chunk.m_sub);
-    if (!AnalyseChunk(m_chunk.m_sub,m_chunk.m_size)){
-      goto problem;
-    }
-  }
-  
-  return True;
- problem:
-  return False;
-}
+  chk.m_list = True;
+  open[0] = DoAddChunk(chk);
+  end[0] = CHUNK_HEADER+chk.m_size;
+  pos = LIST_HEADER;
 
-Bool 
-HeatWaveAVIReader::AnalyseChunk(DataChunk * chk, SInt max)
-{
-  if ( max < CHUNK_HEADER ){
-    goto structure_problem;
-  }
-  chk->m_offset = ftell(m_fileHandle);
-  if ( chk->m_offset < 0 ){
-    goto io_problem;
-  }
-  if ( !GetCharacters(CHUNK_HEADER,(char*)chk)){
-    goto io_problem;
-  }
-  if ( SeeIfInList(chk->m_name,LIST_NAMES,FOUR_CC) ){
-    chk->m_list = True;
-    if ( !GetCharacters(FOUR_CC,chk->m_type) ){
+  // a list is followed by its sub chunks in the table, m_end is set once
+  // all of them are read
+  while ( depth >= 0 ){
+    if ( (end[depth]-pos) < CHUNK_HEADER ){
+      m_chunka[open[depth]].m_end = m_chunkn;
+      pos = end[depth];
+      --depth;
+      continue;
+    }
+    chk = DataChunk();
+    chk.m_offset = pos;
+    if ( !GetBytes(pos,CHUNK_HEADER,(char*)&chk)){
       goto io_problem;
     }
-    if ( !SeeIfInList(chk->m_type,LIST_TYPES,FOUR_CC) ){
+    if ( chk.m_size < 0 ){
       goto structure_problem;
     }
-    if ( (chk->m_size-FOUR_CC) >= CHUNK_HEADER){
-      chk->m_sub = new DataChunk();
-      LEAVEONNULL(chk->m_sub);
-      if (!AnalyseChunk(chk->m_sub,(chk->m_size-FOUR_CC))){
-        goto structure_problem;
-      }
-    }
-    if ( (max-((chk->m_size)+CHUNK_HEADER)) >= CHUNK_HEADER){
-      if (fseek(m_fileHandle,(chk->m_offset)+CHUNK_HEADER+(chk->m_size),
-                SEEK_SET)){
+    // chunks are word aligned, a odd size is followed by a pad byte
+    SInt next = pos+CHUNK_HEADER+(chk.m_size)+((chk.m_size) & 1);
+    if ( SeeIfInList(chk.m_name,LIST_NAMES,FOUR_CC) ){
+      if ( !GetBytes(pos+CHUNK_HEADER,FOUR_CC,chk.m_type) ){
         goto io_problem;
       }
-      chk->m_nxt = new DataChunk();
-      LEAVEONNULL(chk->m_sub);
-      if (!AnalyseChunk((chk->m_nxt),(max-((chk->m_size)+CHUNK_HEADER)))){
+      if ( !SeeIfInList(chk.m_type,LIST_TYPES,FOUR_CC) ||
+           (chk.m_size < FOUR_CC) ){
         goto structure_problem;
       }
-    }
-    return True;
-  }
-  else if ( SeeIfInList(chk->m_name,CHUNK_NAMES,FOUR_CC) ){
-    chk->m_list = False;
-    if ( (max-((chk->m_size)+CHUNK_HEADER)) >= CHUNK_HEADER){
-      if (fseek(m_fileHandle,(chk->m_offset)+CHUNK_HEADER+(chk->m_size),
-                SEEK_SET)){
-        return False;
+      SInt idx = DoAddChunk(chk);
+      // the frame chunks are left to DoIndexFrames()
+      if ( strncmp(chk.m_type,LIST_MOVI,FOUR_CC) == 0 ){
+        pos = next;
+        continue;
       }
-      chk->m_nxt = new DataChunk();
-      LEAVEONNULL(chk->m_nxt);
-      if (!AnalyseChunk((chk->m_nxt),(max-((chk->m_size)+CHUNK_HEADER)))){
-        goto structure_problem;
+      if ( (depth+1) >= max_depth ){
+        CpyError("avi file has to many depths! Possibly corrupted.");
+        goto problem;
       }
+      ++depth;
+      open[depth] = idx;
+      end[depth] = HeatWaveMath::Min(next,end[depth-1]);
+      pos += LIST_HEADER;
+    }
+    else if ( SeeIfInList(chk.m_name,CHUNK_NAMES,FOUR_CC) ){
+      chk.m_list = False;
+      DoAddChunk(chk);
+      pos = next;
+    }
+    else{
+      goto structure_problem;
     }
-    return True;
-  }
-  else{
-    goto structure_problem;
   }
   
   return True;
@@ -345,9 +900,31 @@ HeatWaveAVIReader::AnalyseChunk(DataChunk * chk, SInt max)
   return False;
  structure_problem:
   CpyError("file structure error, contact author");
+ problem:
   return False;
 }
 
+SInt
+HeatWaveAVIReader::DoAddChunk(const DataChunk & chk)
+{
+  if ( m_chunkn == m_chunkLen ){
+    SInt len = m_chunkLen+HEATWAVEVECTORGROWTH;
+    DataChunk * tmp = new DataChunk[len];
+    LEAVEONNULL(tmp);
+    for ( SInt i = 0 ; i < m_chunkn ; ++i ){
+      tmp[i] = m_chunka[i];
+    }
+    delete [] m_chunka;
+    HeatWaveMemory::AddBytes(MemAVI,
+                             (SInt64)(len-m_chunkLen)*sizeof(DataChunk));
+    m_chunka = tmp;
+    m_chunkLen = len;
+  }
+  m_chunka[m_chunkn] = chk;
+  m_chunka[m_chunkn].m_end = m_chunkn+1;
+  return m_chunkn++;
+}
+
 Bool 
 HeatWaveAVIReader::LoadMetaData()
 {
@@ -500,69 +1077,36 @@ HeatWaveAVIReader::LoadChunk(const DataChunk & chk, SInt hdr, SInt len,
     ptr[i] = 0;
   }
   ASSERT(hdr>=0);
-  if (fseek(m_fileHandle,(chk.m_offset)+(hdr),SEEK_SET)){
-    return -1;
-  }
   SInt min_size = chk.m_size;
   min_size = HeatWaveMath::Min(len,min_size);
-  if (!GetCharacters(min_size,ptr)){
+  if (!GetBytes((chk.m_offset)+(hdr),min_size,ptr)){
     return -1;
   }
   return min_size;
 }
 
-// unusaul for avi files to have more than 4 depth levels
-// also for stack size reasons we dont use recursive functions
-// (for Windows CE and Symbian)
 HeatWaveAVIReader::DataChunk * 
 HeatWaveAVIReader::LocateChunk(const char * str, SInt hop, DataChunk * anl)
 {
   ASSERT ( hop >= 0 );
   ASSERT ( strlen(str) == FOUR_CC );
-  const SInt max_depth = 10; 
-  DataChunk * split[max_depth];
-  SInt current_level = 0;
-  DataChunk * current;
+  SInt beg = 0;
+  SInt end = m_chunkn;
   if ( anl ){
-    current = anl;
+    beg = anl-m_chunka;
+    end = anl->m_end;
   }
-  else{
-    current = m_chunk.m_sub;
-  }
-  while ( (current!=NULL) ){
-    if (( strncmp(current->m_name,str,FOUR_CC) == 0 ) ||
-        ( strncmp(current->m_type,str,FOUR_CC) == 0 ) ){
+  for ( SInt i = beg ; i < end ; ++i ){
+    DataChunk & chk = m_chunka[i];
+    if (( strncmp(chk.m_name,str,FOUR_CC) == 0 ) ||
+        ( chk.m_list && (strncmp(chk.m_type,str,FOUR_CC) == 0) ) ){
       if ( hop == 0 ){
-        return current;
+        return &chk;
       }
       else{
         --hop;
       }
     }
-    if ( current->m_sub ){
-      split[current_level] = current;
-      ++current_level;
-      if ( current_level >= max_depth ){
-        CpyError("avi file has to many depths! Possibly corrupted."
-                 "(HeatWave solution increase max_depth in "__FILE__
-                 " function LocatChunk()");
-        return NULL;
-      }
-      current = current->m_sub;
-      continue;
-    }
-    if ( current->m_nxt ){
-      current = current->m_nxt;
-      continue;
-    }
-    current = NULL;
-    for ( SInt i = (current_level-1); i >= 0 ; --i ){
-      if (split[i]->m_nxt){
-        current = split[i]->m_nxt;
-        current_level = i;
-        break;
-      }
-    }
   }
   return NULL;
 }
@@ -571,11 +1115,30 @@ Bool HeatWaveAVIReader::IsDecodable()
 {
 
   ASSERT(m_vids != NULL);
+  ASSERT(m_vidsInfo != NULL);
   char tmp[FOUR_CC+1];
+  char cmp[FOUR_CC+1];
   strncpy(tmp,m_vids->fccHandler,FOUR_CC);
   tmp[FOUR_CC] = '\0';
-  m_coder.m_type = VideoTypeEnum(tmp);
+  memmove(cmp,&(m_vidsInfo->biCompression),FOUR_CC);
+  cmp[FOUR_CC] = '\0';
+
+  // the bitmap compression tells how the samples are stored, the handler
+  // is only a hint
+  m_coder.m_type = VideoTypeEnum(cmp);
+  if ( (m_coder.m_type == VidUnknown) && (m_vidsInfo->biCompression == 0) &&
+       (m_vidsInfo->biBitCount == 24) ){
+    m_coder.m_type = VidRGB;
+  }
   if ( m_coder.m_type == VidUnknown ){
+    m_coder.m_type = VideoTypeEnum(tmp);
+  }
+  if ( (m_coder.m_type == VidRGB) && ((m_vidsInfo->biCompression != 0) ||
+                                      (m_vidsInfo->biBitCount != 24)) ){
+    m_coder.m_type = VidUnknown;
+  }
+  if ( (m_coder.m_type == VidUnknown) || (m_coder.m_type == VidTotal) ){
+    m_coder.m_type = VidUnknown;
     char error[100];
     sprintf(error,"unknown video stream type : %s",tmp);
     CpyError(error);
@@ -591,6 +1154,30 @@ Bool HeatWaveAVIReader::IsDecodable()
       m_coder.m_hSampling[i] = CODEING_TYPES[offset].m_hSampling[i];
       m_coder.m_vSampling[i] = CODEING_TYPES[offset].m_vSampling[i];
     }
+    m_coder.m_layout = CODEING_TYPES[offset].m_layout;
+  }
+
+  // a negative height marks top down bitmaps
+  m_frameWidth = m_vidsInfo->biWidth;
+  m_frameHeight = (SInt)(m_vidsInfo->biHeight);
+  m_bottomUp = (m_coder.m_layout == LayBGR) && (m_frameHeight > 0);
+  if ( m_frameHeight < 0 ){
+    m_frameHeight = -m_frameHeight;
+  }
+  m_frameBytes = 0;
+  for ( SInt c = 0 ; c < m_coder.m_colors ; ++c ){
+    SInt hStep = m_coder.m_hSampling[c];
+    SInt vStep = m_coder.m_vSampling[c];
+    if ( (m_frameWidth <= 0) || (m_frameHeight <= 0) ||
+         (m_frameWidth % hStep) || (m_frameHeight % vStep) ){
+      m_coder.m_type = VidUnknown;
+      CpyError("unable to handle video image size!");
+      return False;
+    }
+    m_frameBytes += (m_frameWidth/hStep)*(m_frameHeight/vStep);
+  }
+  if ( m_coder.m_layout == LayBGR ){
+    m_frameBytes = (((3*m_frameWidth)+3) & ~3)*m_frameHeight;
   }
   return True;
 }
@@ -610,6 +1197,34 @@ HeatWaveAVIReader::GetCharacters(SInt len, char * str)
   return True;
 }
 
+Bool
+HeatWaveAVIReader::GetBytes(SInt off, SInt len, char * str)
+{
+  ASSERT ( (off >= 0) && (len >= 0) );
+  if ( len > HEATWAVEAVIBLOCK ){
+    return ( (fseek(m_fileHandle,off,SEEK_SET) == 0) &&
+             ((SInt)fread(str,1,len,m_fileHandle) == len) );
+  }
+  if ( (off < m_blockOfs) || ((off+len) > (m_blockOfs+m_blockN)) ){
+    if ( m_block == NULL ){
+      m_block = new char[HEATWAVEAVIBLOCK];
+      LEAVEONNULL(m_block);
+      HeatWaveMemory::AddBytes(MemAVI, HEATWAVEAVIBLOCK);
+    }
+    m_blockN = 0;
+    if ( fseek(m_fileHandle,off,SEEK_SET) ){
+      return False;
+    }
+    m_blockOfs = off;
+    m_blockN = (SInt)fread(m_block,1,HEATWAVEAVIBLOCK,m_fileHandle);
+    if ( (off+len) > (m_blockOfs+m_blockN) ){
+      return False;
+    }
+  }
+  memcpy(str,m_block+(off-m_blockOfs),len);
+  return True;
+}
+
 SInt 
 HeatWaveAVIReader::GetFileSize() const
 {
@@ -0,0 +1,477 @@
+/****************************************************************************/
+/**
+ ** @file HeatWaveAVIWriter.cpp
+ ** @brief Contains class HeatWaveAVIWriter's function definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveAVIWriter.hpp"
+
+HeatWaveAVIWriter::HeatWaveAVIWriter()
+{
+  memset((char*)&m_coder,0,sizeof(StructCodingType));
+  m_coder.m_type = VidUnknown;
+  m_coef = False;
+  m_failed = False;
+  m_frameSize = 0;
+  m_buf = NULL;
+  m_bufn = 0;
+  m_pos = 0;
+  m_avihPos = 0;
+  m_strhPos = 0;
+  m_moviPos = 0;
+  m_idxa = NULL;
+  m_idxn = 0;
+  m_idxLen = 0;
+}
+
+HeatWaveAVIWriter::~HeatWaveAVIWriter()
+{
+  if ( m_fileHandle ){
+    CloseFile();
+  }
+  delete [] m_buf;
+  delete [] m_idxa;
+}
+
+Bool
+HeatWaveAVIWriter::OpenFile(const char * str, EnumVideoType type, SInt width,
+                            SInt height, SInt rate, Bool coef)
+{
+  if ( m_fileHandle ){
+    CpyError("file all ready open");
+    return False;
+  }
+  if ( (type < 0) || (type >= VidTotal) ){
+    CpyError("unknown video type");
+    return False;
+  }
+  if ( !coef && (CODEING_TYPES[type].m_layout != LayPlanar) ){
+    CpyError("only planar video types can be written");
+    return False;
+  }
+  m_coder = CODEING_TYPES[type];
+  m_frameSize = 0;
+  for ( SInt c = 0 ; c < m_coder.m_colors ; ++c ){
+    if ( (width <= 0) || (height <= 0) ||
+         (width % m_coder.m_hSampling[c]) ||
+         (height % m_coder.m_vSampling[c]) ){
+      m_coder.m_type = VidUnknown;
+      CpyError("unable to handle video image size!");
+      return False;
+    }
+    m_frameSize += (width/m_coder.m_hSampling[c])*
+      (height/m_coder.m_vSampling[c]);
+  }
+  m_coef = coef;
+  if ( m_coef ){
+    m_frameSize *= 2;
+  }
+  if ( rate < 1 ){
+    rate = 1;
+  }
+
+  CpyFileName(str);
+  m_fileHandle = fopen(m_fileName,"wb");
+  if ( !m_fileHandle ){
+    const char * format = "unable to create file : %s";
+    char * error = new char[strlen(m_fileName)+strlen(format)+10];
+    LEAVEONNULL(error);
+    sprintf(error,format,m_fileName);
+    SetError(error);
+    return False;
+  }
+  if ( m_buf == NULL ){
+    m_buf = new char[HEATWAVEAVIBUFFER];
+    LEAVEONNULL(m_buf);
+  }
+  m_bufn = 0;
+  m_pos = 0;
+  m_idxn = 0;
+  m_failed = False;
+
+  // the headers are kept to be fixed and rewritten on closing
+  delete m_avih;
+  delete m_vids;
+  delete m_vidsInfo;
+  m_avih = new HeatWaveAVIHeader;
+  LEAVEONNULL(m_avih);
+  m_vids = new HeatWaveAVIStreamHeader;
+  LEAVEONNULL(m_vids);
+  m_vidsInfo = new HeatWaveAVIBitmapHeader;
+  LEAVEONNULL(m_vidsInfo);
+  memset((char*)m_avih,0,sizeof(HeatWaveAVIHeader));
+  memset((char*)m_vids,0,sizeof(HeatWaveAVIStreamHeader));
+  memset((char*)m_vidsInfo,0,sizeof(HeatWaveAVIBitmapHeader));
+
+  m_avih->dwMicroSecPerFrame = 1000000/rate;
+  m_avih->dwMaxBytesPerSec = m_frameSize*rate;
+  m_avih->dwFlags = AVIF_HASINDEX;
+  m_avih->dwStreams = 1;
+  m_avih->dwSuggestedBufferSize = m_frameSize+CHUNK_HEADER;
+  m_avih->dwWidth = width;
+  m_avih->dwHeight = height;
+
+  const char * handler = m_coef ? HEATWAVEAVICOEF : VideoTypeName(type);
+  memmove(m_vids->fccType,STREAM_VIDS,FOUR_CC);
+  memmove(m_vids->fccHandler,handler,FOUR_CC);
+  m_vids->dwScale = 1;
+  m_vids->dwRate = rate;
+  m_vids->dwSuggestedBufferSize = m_frameSize;
+  m_vids->dwQuality = (UInt)-1;
+  m_vids->rcFrame.right = width;
+  m_vids->rcFrame.bottom = height;
+
+  m_vidsInfo->biSize = sizeof(HeatWaveAVIBitmapHeader);
+  m_vidsInfo->biWidth = width;
+  m_vidsInfo->biHeight = height;
+  m_vidsInfo->biPlanes = 1;
+  m_vidsInfo->biBitCount = (8*m_frameSize)/(width*height);
+  memmove(&(m_vidsInfo->biCompression),handler,FOUR_CC);
+  m_vidsInfo->biSizeImage = m_frameSize;
+  m_vidsPriority = 0;
+
+  if ( !DoWriteHeaders() ){
+    fclose(m_fileHandle);
+    m_fileHandle = NULL;
+    return False;
+  }
+  return True;
+}
+
+Bool
+HeatWaveAVIWriter::AddFrame(const HeatWaveImage & img)
+{
+  if ( m_fileHandle == NULL ){
+    CpyError("no file open");
+    return False;
+  }
+  if ( m_failed ){
+    return False;
+  }
+  if ( (img.GetWidth() != (SInt)(m_avih->dwWidth)) ||
+       (img.GetHeight() != (SInt)(m_avih->dwHeight)) ){
+    CpyError("frame size differs from the video size");
+    m_failed = True;
+    return False;
+  }
+  // the chunk, its index entry and the idx1 header must fit as well
+  SInt64 end = (SInt64)m_pos+CHUNK_HEADER+m_frameSize+(m_frameSize & 1)+
+    ((SInt64)(m_idxn+1)*sizeof(HeatWaveAVIIndexEntry))+CHUNK_HEADER;
+  if ( end > HEATWAVEAVIMAXSIZE ){
+    CpyError("file would exceed the AVI 1.0 size limit");
+    return False;
+  }
+  if ( IsConform(img) ){
+    m_failed = !DoWriteFrame(img);
+    return !m_failed;
+  }
+  if ( m_coef ){
+    CpyError("frame components do not match the video type");
+    m_failed = True;
+    return False;
+  }
+
+  // convert a copy, it shares the samples until changed
+  HeatWaveImage tmp(img);
+  if ( tmp.GetSpace() != m_coder.m_space ){
+    tmp.DoUnpack();
+    tmp.SetSpace(m_coder.m_space, False, -1, False);
+  }
+  for ( SInt c = 0 ; c < m_coder.m_colors ; ++c ){
+    SInt num = GetPlane(tmp, c);
+    if ( num >= 0 ){
+      tmp.GetComponent(num).SetHStep(m_coder.m_hSampling[c], True);
+      tmp.GetComponent(num).SetVStep(m_coder.m_vSampling[c], True);
+    }
+  }
+  if ( !IsConform(tmp) ){
+    CpyError("unable to convert frame to the video type");
+    m_failed = True;
+    return False;
+  }
+  m_failed = !DoWriteFrame(tmp);
+  return !m_failed;
+}
+
+Bool
+HeatWaveAVIWriter::SaveVideo(const HeatWaveVideo & vid)
+{
+  for ( SInt i = 0 ; i < vid.GetImageN() ; ++i ){
+    if ( !AddFrame(vid.GetImage(i)) ){
+      return False;
+    }
+  }
+  return True;
+}
+
+SInt
+HeatWaveAVIWriter::GetFrameN() const
+{
+  return m_idxn;
+}
+
+Bool
+HeatWaveAVIWriter::CloseFile()
+{
+  if ( m_fileHandle == NULL ){
+    CpyError("no file open");
+    return False;
+  }
+  Bool ok = True;
+  SInt idx1 = m_pos;
+  SInt size = m_idxn*sizeof(HeatWaveAVIIndexEntry);
+  ok = ok && DoWriteHeader(CHUNK_IDX1, size);
+  ok = ok && DoWrite(m_idxa, size);
+  ok = ok && DoFlushBuffer();
+
+  // the sizes are only known now
+  UInt riff = m_pos-CHUNK_HEADER;
+  UInt movi = idx1-(m_moviPos+CHUNK_HEADER);
+  m_avih->dwTotalFrames = m_idxn;
+  m_vids->dwLength = m_idxn;
+  ok = ok && DoPatch(FOUR_CC, &riff, sizeof(UInt));
+  ok = ok && DoPatch(m_moviPos+FOUR_CC, &movi, sizeof(UInt));
+  ok = ok && DoPatch(m_avihPos, m_avih, sizeof(HeatWaveAVIHeader));
+  ok = ok && DoPatch(m_strhPos, m_vids, sizeof(HeatWaveAVIStreamHeader));
+
+  if ( fclose(m_fileHandle) == EOF ){
+    ok = False;
+  }
+  m_fileHandle = NULL;
+  if ( !ok ){
+    CpyError("failed to finish file");
+  }
+  return ok;
+}
+
+Bool
+HeatWaveAVIWriter::DoWriteHeaders()
+{
+  SInt strd = m_coef ? (CHUNK_HEADER+FOUR_CC) : 0;
+  SInt strl = CHUNK_HEADER+sizeof(HeatWaveAVIStreamHeader)+
+    CHUNK_HEADER+sizeof(HeatWaveAVIBitmapHeader)+strd;
+  SInt hdrl = CHUNK_HEADER+sizeof(HeatWaveAVIHeader)+LIST_HEADER+strl;
+  Bool ok = True;
+
+  // RIFF size is fixed on closing
+  ok = ok && DoWriteHeader(LIST_RIFF, 0, LIST_AVI_);
+  ok = ok && DoWriteHeader(LIST_LIST, hdrl, LIST_HDRL);
+  ok = ok && DoWriteHeader(CHUNK_AVIH, sizeof(HeatWaveAVIHeader));
+  m_avihPos = m_pos;
+  ok = ok && DoWrite(m_avih, sizeof(HeatWaveAVIHeader));
+  ok = ok && DoWriteHeader(LIST_LIST, strl, LIST_STRL);
+  ok = ok && DoWriteHeader(CHUNK_STRH, sizeof(HeatWaveAVIStreamHeader));
+  m_strhPos = m_pos;
+  ok = ok && DoWrite(m_vids, sizeof(HeatWaveAVIStreamHeader));
+  ok = ok && DoWriteHeader(CHUNK_STRF, sizeof(HeatWaveAVIBitmapHeader));
+  ok = ok && DoWrite(m_vidsInfo, sizeof(HeatWaveAVIBitmapHeader));
+  if ( m_coef ){
+    // the plane layout of the coefficients
+    ok = ok && DoWriteHeader(CHUNK_STRD, FOUR_CC);
+    ok = ok && DoWrite(VideoTypeName(m_coder.m_type), FOUR_CC);
+  }
+
+  // pad the header so that the frames start on AVI_HEADERSIZE
+  SInt junk = AVI_HEADERSIZE-(m_pos+CHUNK_HEADER+LIST_HEADER);
+  if ( junk >= 0 ){
+    char zero[AVI_HEADERSIZE];
+    memset(zero,0,junk);
+    ok = ok && DoWriteHeader(CHUNK_JUNK, junk);
+    ok = ok && DoWrite(zero, junk);
+  }
+
+  // movi size is fixed on closing
+  m_moviPos = m_pos;
+  ok = ok && DoWriteHeader(LIST_LIST, 0, LIST_MOVI);
+  if ( !ok ){
+    CpyError("failed to write file headers");
+  }
+  return ok;
+}
+
+Bool
+HeatWaveAVIWriter::DoWriteHeader(const char * name, SInt size,
+                                 const char * type)
+{
+  UInt len = size;
+  if ( type ){
+    len += FOUR_CC;
+  }
+  if ( !DoWrite(name, FOUR_CC) || !DoWrite(&len, sizeof(UInt)) ){
+    return False;
+  }
+  if ( type ){
+    return DoWrite(type, FOUR_CC);
+  }
+  return True;
+}
+
+Bool
+HeatWaveAVIWriter::DoWriteFrame(const HeatWaveImage & img)
+{
+  char frame_id[FOUR_CC+1];
+  sprintf(frame_id,"%02d%s",m_vidsPriority,m_coef ? "dc" : "db");
+
+  if ( m_coef ){
+    // check first, a frame is written whole or not at all
+    for ( SInt c = 0 ; c < m_coder.m_colors ; ++c ){
+      Smpl min, max;
+      SInt total;
+      img.GetComponent(GetPlane(img, c)).GetView().GetBasicStats(min, max,
+                                                                 total);
+      if ( ((SInt)min < -32768) || ((SInt)max > 32767) ){
+        CpyError("coefficient does not fit into 16-bits");
+        return False;
+      }
+    }
+  }
+
+  if ( m_idxn == m_idxLen ){
+    SInt len = (m_idxLen > 0) ? (m_idxLen*2) : HEATWAVEVECTORGROWTH;
+    HeatWaveAVIIndexEntry * tmp = new HeatWaveAVIIndexEntry[len];
+    LEAVEONNULL(tmp);
+    if ( m_idxn > 0 ){
+      memmove(tmp,m_idxa,m_idxn*sizeof(HeatWaveAVIIndexEntry));
+    }
+    delete [] m_idxa;
+    m_idxa = tmp;
+    m_idxLen = len;
+  }
+  HeatWaveAVIIndexEntry & ent = m_idxa[m_idxn];
+  memmove(&(ent.ckid),frame_id,FOUR_CC);
+  ent.dwFlags = AVIIF_KEYFRAME;
+  ent.dwChunkOffset = m_pos-(m_moviPos+CHUNK_HEADER);
+  ent.dwChunkLength = m_frameSize;
+
+  if ( !DoWriteHeader(frame_id, m_frameSize) ){
+    goto io_problem;
+  }
+  for ( SInt c = 0 ; c < m_coder.m_colors ; ++c ){
+    HeatWaveView view = img.GetComponent(GetPlane(img, c)).GetView();
+    SInt width = view.GetWidth();
+    SInt bpp = m_coef ? 2 : 1;
+    Smpl * buf = new Smpl[width];
+    LEAVEONNULL(buf);
+    UInt8 * line = new UInt8[width*bpp];
+    LEAVEONNULL(line);
+    Bool ok = True;
+    for ( SInt y = 0 ; ok && (y < view.GetHeight()) ; ++y ){
+      const Smpl * row = view.GetRow(y, buf);
+      if ( m_coef ){
+        for ( SInt x = 0 ; x < width ; ++x ){
+          UInt16 val = (UInt16)(SInt16)row[x];
+          line[2*x] = (UInt8)(val & 0xff);
+          line[(2*x)+1] = (UInt8)(val >> 8);
+        }
+      }
+      else{
+        for ( SInt x = 0 ; x < width ; ++x ){
+          SInt val = (SInt)row[x];
+          line[x] = (UInt8)((val < 0) ? 0 : ((val > 255) ? 255 : val));
+        }
+      }
+      ok = DoWrite(line, width*bpp);
+    }
+    delete [] line;
+    delete [] buf;
+    if ( !ok ){
+      goto io_problem;
+    }
+  }
+  if ( m_frameSize & 1 ){
+    // chunks are word aligned
+    if ( !DoWrite("", 1) ){
+      goto io_problem;
+    }
+  }
+  ++m_idxn;
+  return True;
+
+ io_problem:
+  CpyError("failed to write frame");
+  return False;
+}
+
+Bool
+HeatWaveAVIWriter::DoWrite(const void * ptr, SInt len)
+{
+  if ( (m_bufn+len) > HEATWAVEAVIBUFFER ){
+    if ( !DoFlushBuffer() ){
+      return False;
+    }
+  }
+  if ( len >= HEATWAVEAVIBUFFER ){
+    if ( fwrite(ptr, 1, len, m_fileHandle) != (size_t)len ){
+      return False;
+    }
+  }
+  else if ( len > 0 ){
+    memmove(m_buf+m_bufn, ptr, len);
+    m_bufn += len;
+  }
+  m_pos += len;
+  return True;
+}
+
+Bool
+HeatWaveAVIWriter::DoFlushBuffer()
+{
+  if ( m_bufn > 0 ){
+    if ( fwrite(m_buf, 1, m_bufn, m_fileHandle) != (size_t)m_bufn ){
+      return False;
+    }
+    m_bufn = 0;
+  }
+  return True;
+}
+
+Bool
+HeatWaveAVIWriter::DoPatch(SInt off, const void * ptr, SInt len)
+{
+  ASSERT ( m_bufn == 0 );
+  if ( fseek(m_fileHandle, off, SEEK_SET) ){
+    return False;
+  }
+  if ( fwrite(ptr, 1, len, m_fileHandle) != (size_t)len ){
+    return False;
+  }
+  return (fseek(m_fileHandle, m_pos, SEEK_SET) == 0);
+}
+
+SInt
+HeatWaveAVIWriter::GetPlane(const HeatWaveImage & img, SInt num) const
+{
+  ASSERT ( (num >= 0) && (num < m_coder.m_colors) );
+  for ( SInt i = 0 ; i < img.GetComponentN() ; ++i ){
+    if ( img.GetComponent(i).GetColor() == m_coder.m_order[num] ){
+      return i;
+    }
+  }
+  // else by position, e.g. a grey component for the Y plane
+  if ( num < img.GetComponentN() ){
+    return num;
+  }
+  return -1;
+}
+
+Bool
+HeatWaveAVIWriter::IsConform(const HeatWaveImage & img) const
+{
+  if ( !m_coef && (img.GetSpace() != m_coder.m_space) ){
+    return False;
+  }
+  for ( SInt c = 0 ; c < m_coder.m_colors ; ++c ){
+    SInt num = GetPlane(img, c);
+    if ( num < 0 ){
+      return False;
+    }
+    const HeatWaveComponent & cmp = img.GetComponent(num);
+    if ( (cmp.GetWidth() != (SInt)(m_avih->dwWidth/m_coder.m_hSampling[c])) ||
+         (cmp.GetHeight() != (SInt)(m_avih->dwHeight/m_coder.m_vSampling[c])) ){
+      return False;
+    }
+  }
+  return True;
+}
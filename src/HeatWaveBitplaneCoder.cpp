@@ -0,0 +1,556 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveBitplaneCoder.cpp
+ ** @brief  Contains the HeatWaveBitplaneCoder class definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveBitplaneCoder.hpp"
+#include "HeatWaveProfiler.hpp"
+
+/** The first bytes of a stream, the last is the format version. */
+static const Char glob_bitplaneMagic[4] = {'H','W','B','1'};
+
+/****************************************************************************/
+
+static void
+DoPutU32(UInt8 * ptr, UInt32 val)
+{
+  ptr[0] = (UInt8)val;
+  ptr[1] = (UInt8)(val >> 8);
+  ptr[2] = (UInt8)(val >> 16);
+  ptr[3] = (UInt8)(val >> 24);
+}
+
+static UInt32
+GetU32(const UInt8 * ptr)
+{
+  return ((UInt32)ptr[0]) | ((UInt32)ptr[1] << 8) |
+    ((UInt32)ptr[2] << 16) | ((UInt32)ptr[3] << 24);
+}
+
+/**
+ *
+ * Append to a list, growing it when full.
+ *
+ **/
+
+template <class T>
+static void
+DoPush(T *& list, SInt & num, SInt & cap, T val)
+{
+  if ( num == cap ){
+    cap = (cap < 64) ? 64 : cap*2;
+    T * tmp = new T[cap];
+    LEAVEONNULL(tmp);
+    if ( num ){
+      memcpy(tmp, list, num*sizeof(T));
+    }
+    delete [] list;
+    list = tmp;
+  }
+  list[num++] = val;
+}
+
+/****************************************************************************/
+
+HeatWaveBitplaneCoder::HeatWaveBitplaneCoder()
+{
+  m_width = 0;
+  m_height = 0;
+  m_bands = NULL;
+  m_bandn = 0;
+  m_band = NULL;
+  m_mag = NULL;
+  m_sgn = NULL;
+  m_maxD = NULL;
+  m_maxL = NULL;
+  m_plane = NULL;
+  m_data = NULL;
+  m_cap = 0;
+  m_read = NULL;
+  m_bit = 0;
+  m_end = 0;
+}
+
+HeatWaveBitplaneCoder::~HeatWaveBitplaneCoder()
+{
+  DoClear();
+  delete [] m_data;
+}
+
+void
+HeatWaveBitplaneCoder::DoClear()
+{
+  delete [] m_bands;
+  delete [] m_band;
+  delete [] m_mag;
+  delete [] m_sgn;
+  delete [] m_maxD;
+  delete [] m_maxL;
+  delete [] m_plane;
+  m_bands = NULL;
+  m_bandn = 0;
+  m_band = NULL;
+  m_mag = NULL;
+  m_sgn = NULL;
+  m_maxD = NULL;
+  m_maxL = NULL;
+  m_plane = NULL;
+  m_read = NULL;
+}
+
+const UInt8 *
+HeatWaveBitplaneCoder::GetStream() const
+{
+  return m_data;
+}
+
+SInt
+HeatWaveBitplaneCoder::GetStreamSize() const
+{
+  return (m_data == NULL) ? 0 : (SInt)((m_bit+7) >> 3);
+}
+
+SInt
+HeatWaveBitplaneCoder::DoEncode(HeatWaveComponent & cmp, SInt budget)
+{
+  DoClear();
+  delete [] m_data;
+  m_data = NULL;
+  m_cap = 0;
+  m_bit = 0;
+  if ( (budget > 0) && (budget < HEATWAVEBITPLANEHEADER) ){
+    return -1;
+  }
+
+  SInt lev = cmp.GetTransformLevel();
+  m_width = cmp.GetWidth();
+  m_height = cmp.GetHeight();
+  SInt size = m_width*m_height;
+  if ( !DoBands(cmp, lev) ){
+    // not a layout the trees can follow, code each tile as one band
+    DoClear();
+    DoBands(cmp, 0);
+  }
+
+  m_mag = new UInt32[size];
+  LEAVEONNULL(m_mag);
+  m_sgn = new UInt8[size];
+  LEAVEONNULL(m_sgn);
+  HeatWaveView view = cmp.GetView();
+  Smpl * buf = new Smpl[m_width];
+  LEAVEONNULL(buf);
+  UInt32 all = 0;
+  for ( SInt y = 0 ; y < m_height ; ++y ){
+    const Smpl * row = view.GetRow(y, buf);
+    for ( SInt x = 0 ; x < m_width ; ++x ){
+      SInt64 val = (SInt64)row[x];
+      SInt pos = y*m_width+x;
+      m_sgn[pos] = (val < 0) ? 1 : 0;
+      m_mag[pos] = (UInt32)((val < 0) ? -val : val);
+      all |= m_mag[pos];
+    }
+  }
+  delete [] buf;
+  SInt top = 0;
+  while ( (top < 32) && (all >> top) ){
+    ++top;
+  }
+
+  m_maxD = new UInt32[size];
+  LEAVEONNULL(m_maxD);
+  m_maxL = new UInt32[size];
+  LEAVEONNULL(m_maxL);
+  DoMaxima();
+
+  m_cap = HEATWAVEBITPLANEHEADER + size/4 + 64;
+  if ( (budget > 0) && (budget < m_cap) ){
+    m_cap = budget;
+  }
+  m_data = new UInt8[m_cap];
+  LEAVEONNULL(m_data);
+  memcpy(m_data, glob_bitplaneMagic, 4);
+  DoPutU32(m_data+4, (UInt32)m_width);
+  DoPutU32(m_data+8, (UInt32)m_height);
+  DoPutU32(m_data+12, (UInt32)lev);
+  DoPutU32(m_data+16, (UInt32)cmp.GetTransformType());
+  DoPutU32(m_data+20, (UInt32)cmp.GetPrec());
+  DoPutU32(m_data+24, cmp.GetSgnd() ? 1 : 0);
+  DoPutU32(m_data+28, (UInt32)cmp.GetTileWidth());
+  DoPutU32(m_data+32, (UInt32)cmp.GetTileHeight());
+  DoPutU32(m_data+36, (UInt32)top);
+  m_bit = HEATWAVEBITPLANEHEADER*8;
+  m_end = (budget > 0) ? (SInt64)budget*8 : (((SInt64)1) << 62);
+
+  HEATWAVEPROFILE(PrfBitplane, size, (SInt64)size*sizeof(Smpl));
+  DoPasses(True, top);
+
+  DoClear();
+  return GetStreamSize();
+}
+
+Bool
+HeatWaveBitplaneCoder::DoDecode(const UInt8 * data, SInt size,
+                                HeatWaveComponent & cmp)
+{
+  DoClear();
+  if ( (data == NULL) || (size < HEATWAVEBITPLANEHEADER) ||
+       (memcmp(data, glob_bitplaneMagic, 4) != 0) ){
+    return False;
+  }
+  m_width = (SInt)GetU32(data+4);
+  m_height = (SInt)GetU32(data+8);
+  SInt lev = (SInt)GetU32(data+12);
+  SInt top = (SInt)GetU32(data+36);
+  if ( (m_width != cmp.GetWidth()) || (m_height != cmp.GetHeight()) ||
+       ((SInt)GetU32(data+28) != cmp.GetTileWidth()) ||
+       ((SInt)GetU32(data+32) != cmp.GetTileHeight()) ||
+       (lev < 0) || (lev > 32) || (top < 0) || (top > 32) ){
+    return False;
+  }
+  SInt pix = m_width*m_height;
+  if ( !DoBands(cmp, lev) ){
+    // the encoder did the same
+    DoClear();
+    DoBands(cmp, 0);
+  }
+
+  m_mag = new UInt32[pix];
+  LEAVEONNULL(m_mag);
+  m_sgn = new UInt8[pix];
+  LEAVEONNULL(m_sgn);
+  m_plane = new SInt8[pix];
+  LEAVEONNULL(m_plane);
+  memset(m_mag, 0, pix*sizeof(UInt32));
+  memset(m_sgn, 0, pix);
+  memset(m_plane, 0, pix);
+
+  SInt64 bit = m_bit;
+  m_read = data;
+  m_bit = HEATWAVEBITPLANEHEADER*8;
+  m_end = (SInt64)size*8;
+  HEATWAVEPROFILE(PrfBitplane, pix, (SInt64)pix*sizeof(Smpl));
+  DoPasses(False, top);
+  m_bit = bit;
+
+  if ( cmp.IsPacked() ){
+    cmp.DoUnpack();
+  }
+  Smpl ** rows = cmp.GetRows();
+  for ( SInt y = 0 ; y < m_height ; ++y ){
+    for ( SInt x = 0 ; x < m_width ; ++x ){
+      SInt pos = y*m_width+x;
+      UInt32 mag = m_mag[pos];
+      if ( mag && (m_plane[pos] > 0) ){
+        // middle of what is left open
+        mag += ((UInt32)1) << (m_plane[pos]-1);
+      }
+      rows[y][x] = (Smpl)(m_sgn[pos] ? -(SInt64)mag : (SInt64)mag);
+    }
+  }
+  cmp.SetTransformLevel((SInt)GetU32(data+12));
+  cmp.SetTransformType((EnumTransform)GetU32(data+16));
+  cmp.SetPrec((SInt)GetU32(data+20));
+  cmp.SetSgnd(GetU32(data+24) != 0);
+
+  DoClear();
+  return True;
+}
+
+Bool
+HeatWaveBitplaneCoder::DoBands(const HeatWaveComponent & cmp, SInt lev)
+{
+  SInt size = m_width*m_height;
+  SInt tiles = cmp.GetTileCount();
+  SInt tlx = cmp.GetTLX();
+  SInt tly = cmp.GetTLY();
+  m_bands = new Band[tiles*(1+3*lev)];
+  LEAVEONNULL(m_bands);
+  m_bandn = 0;
+  m_band = new SInt[size];
+  LEAVEONNULL(m_band);
+  for ( SInt i = 0 ; i < size ; ++i ){
+    m_band[i] = -1;
+  }
+
+  static const EnumSubband subs[3] = {SubHL, SubLH, SubHH};
+  SInt x, y, w, h, count = 0;
+  for ( SInt t = 0 ; t < tiles ; ++t ){
+    if ( !cmp.GetTileInfo(t, x, y, w, h) ){
+      return False;
+    }
+    // small tiles stop early, as in the transform
+    SInt deep = 0;
+    while ( (deep < lev) &&
+            cmp.GetSubbandInfo(t, deep+1, SubLL, x, y, w, h) ){
+      ++deep;
+    }
+    SInt first = m_bandn;
+    for ( SInt r = deep ; r >= ((deep > 0) ? 1 : 0) ; --r ){
+      for ( SInt s = ((r == deep) ? -1 : 0) ; s < 3 ; ++s ){
+        Band & band = m_bands[m_bandn];
+        if ( !cmp.GetSubbandInfo(t, r, (s < 0) ? SubLL : subs[s], x, y, w,
+                                 h) ){
+          return False;
+        }
+        band.x = x-tlx;
+        band.y = y-tly;
+        band.w = w;
+        band.h = h;
+        band.root = (s < 0);
+        for ( SInt k = 0 ; k < 3 ; ++k ){
+          band.kids[k] = -1;
+        }
+        if ( band.root && (deep > 0) ){
+          for ( SInt k = 0 ; k < 3 ; ++k ){
+            band.kids[k] = first+1+k;
+          }
+        }
+        else if ( !band.root && (r > 1) ){
+          band.kids[0] = m_bandn+3;
+        }
+        for ( SInt j = band.y ; j < band.y+band.h ; ++j ){
+          for ( SInt i = band.x ; i < band.x+band.w ; ++i ){
+            if ( (i < 0) || (j < 0) || (i >= m_width) || (j >= m_height) ||
+                 (m_band[j*m_width+i] >= 0) ){
+              return False;
+            }
+            m_band[j*m_width+i] = m_bandn;
+          }
+        }
+        count += band.w*band.h;
+        ++m_bandn;
+        if ( r == 0 ){
+          break;
+        }
+      }
+    }
+  }
+  return ( count == size );
+}
+
+SInt
+HeatWaveBitplaneCoder::GetKids(SInt pos, SInt * kids) const
+{
+  const Band & band = m_bands[m_band[pos]];
+  SInt x = pos%m_width - band.x;
+  SInt y = pos/m_width - band.y;
+  SInt num = 0;
+  if ( band.root ){
+    for ( SInt k = 0 ; (k < 3) && (band.kids[k] >= 0) ; ++k ){
+      const Band & kid = m_bands[band.kids[k]];
+      if ( (x < kid.w) && (y < kid.h) ){
+        kids[num++] = (kid.y+y)*m_width + kid.x+x;
+      }
+    }
+    return num;
+  }
+  if ( band.kids[0] < 0 ){
+    return 0;
+  }
+  const Band & kid = m_bands[band.kids[0]];
+  SInt x1 = (x == band.w-1) ? kid.w : 2*x+2;
+  SInt y1 = (y == band.h-1) ? kid.h : 2*y+2;
+  for ( SInt j = 2*y ; j < y1 && j < kid.h ; ++j ){
+    for ( SInt i = 2*x ; i < x1 && i < kid.w ; ++i ){
+      kids[num++] = (kid.y+j)*m_width + kid.x+i;
+    }
+  }
+  return num;
+}
+
+void
+HeatWaveBitplaneCoder::DoMaxima()
+{
+  SInt kids[9];
+  // bands are kept coarsest first within a tile
+  for ( SInt b = m_bandn-1 ; b >= 0 ; --b ){
+    const Band & band = m_bands[b];
+    for ( SInt j = band.y ; j < band.y+band.h ; ++j ){
+      for ( SInt i = band.x ; i < band.x+band.w ; ++i ){
+        SInt pos = j*m_width+i;
+        SInt num = GetKids(pos, kids);
+        UInt32 desc = 0;
+        UInt32 grand = 0;
+        for ( SInt k = 0 ; k < num ; ++k ){
+          desc |= m_mag[kids[k]] | m_maxD[kids[k]];
+          grand |= m_maxD[kids[k]];
+        }
+        m_maxD[pos] = desc;
+        m_maxL[pos] = grand;
+      }
+    }
+  }
+}
+
+Bool
+HeatWaveBitplaneCoder::DoBit(Bool enc, Bool & bit)
+{
+  if ( m_bit >= m_end ){
+    return False;
+  }
+  SInt byte = (SInt)(m_bit >> 3);
+  SInt shift = 7 - (SInt)(m_bit & 7);
+  if ( enc ){
+    if ( byte == m_cap ){
+      SInt cap = m_cap*2;
+      if ( (SInt64)cap > (m_end >> 3) ){
+        cap = (SInt)(m_end >> 3);
+      }
+      UInt8 * tmp = new UInt8[cap];
+      LEAVEONNULL(tmp);
+      memcpy(tmp, m_data, m_cap);
+      delete [] m_data;
+      m_data = tmp;
+      m_cap = cap;
+    }
+    if ( shift == 7 ){
+      m_data[byte] = 0;
+    }
+    if ( bit ){
+      m_data[byte] |= (UInt8)(1 << shift);
+    }
+  }
+  else {
+    bit = ( (m_read[byte] >> shift) & 1 ) != 0;
+  }
+  ++m_bit;
+  return True;
+}
+
+void
+HeatWaveBitplaneCoder::DoPasses(Bool enc, SInt top)
+{
+  // list of insignificant pixels, significant pixels and insignificant
+  // sets, the sets are the descendants (A) or grand descendants (B)
+  SInt * lip = NULL;
+  SInt * lsp = NULL;
+  SInt * lis = NULL;
+  UInt8 * lisB = NULL;
+  SInt lipn = 0, lipc = 0, lspn = 0, lspc = 0, lisn = 0, lisc = 0, lisBc = 0;
+  SInt kids[9];
+
+  for ( SInt b = 0 ; b < m_bandn ; ++b ){
+    const Band & band = m_bands[b];
+    if ( !band.root ){
+      continue;
+    }
+    for ( SInt j = band.y ; j < band.y+band.h ; ++j ){
+      for ( SInt i = band.x ; i < band.x+band.w ; ++i ){
+        SInt pos = j*m_width+i;
+        DoPush(lip, lipn, lipc, pos);
+        if ( GetKids(pos, kids) > 0 ){
+          SInt num = lisn;
+          DoPush(lis, lisn, lisc, pos);
+          DoPush(lisB, num, lisBc, (UInt8)0);
+        }
+      }
+    }
+  }
+
+  Bool bit = False;
+  Bool more = True;
+  for ( SInt n = top-1 ; more && (n >= 0) ; --n ){
+    SInt old = lspn;
+
+    // sorting pass, insignificant pixels
+    SInt keep = 0;
+    for ( SInt l = 0 ; l < lipn ; ++l ){
+      SInt pos = lip[l];
+      bit = enc && ((m_mag[pos] >> n) & 1);
+      if ( more && (more = DoBit(enc, bit)) && bit ){
+        bit = enc && m_sgn[pos];
+        if ( (more = DoBit(enc, bit)) ){
+          if ( !enc ){
+            m_sgn[pos] = bit ? 1 : 0;
+            m_mag[pos] = ((UInt32)1) << n;
+            m_plane[pos] = (SInt8)n;
+          }
+          DoPush(lsp, lspn, lspc, pos);
+          continue;
+        }
+      }
+      lip[keep++] = pos;
+    }
+    lipn = keep;
+
+    // sorting pass, insignificant sets, new sets are appended and handled
+    // in the same pass
+    keep = 0;
+    for ( SInt l = 0 ; more && (l < lisn) ; ++l ){
+      SInt pos = lis[l];
+      Bool type = ( lisB[l] != 0 );
+      if ( !type ){
+        bit = enc && ((m_maxD[pos] >> n) != 0);
+        if ( !(more = DoBit(enc, bit)) ){
+          break;
+        }
+        if ( !bit ){
+          lis[keep] = pos;
+          lisB[keep++] = 0;
+          continue;
+        }
+        SInt num = GetKids(pos, kids);
+        for ( SInt k = 0 ; more && (k < num) ; ++k ){
+          SInt kid = kids[k];
+          bit = enc && ((m_mag[kid] >> n) & 1);
+          if ( (more = DoBit(enc, bit)) && bit ){
+            bit = enc && m_sgn[kid];
+            if ( (more = DoBit(enc, bit)) ){
+              if ( !enc ){
+                m_sgn[kid] = bit ? 1 : 0;
+                m_mag[kid] = ((UInt32)1) << n;
+                m_plane[kid] = (SInt8)n;
+              }
+              DoPush(lsp, lspn, lspc, kid);
+            }
+          }
+          else if ( more ){
+            DoPush(lip, lipn, lipc, kid);
+          }
+        }
+        // the children all have children or none have
+        if ( (num > 0) && (m_bands[m_band[kids[0]]].kids[0] >= 0) ){
+          SInt tmp = lisn;
+          DoPush(lis, lisn, lisc, pos);
+          DoPush(lisB, tmp, lisBc, (UInt8)1);
+        }
+      }
+      else {
+        bit = enc && ((m_maxL[pos] >> n) != 0);
+        if ( !(more = DoBit(enc, bit)) ){
+          break;
+        }
+        if ( !bit ){
+          lis[keep] = pos;
+          lisB[keep++] = 1;
+          continue;
+        }
+        SInt num = GetKids(pos, kids);
+        for ( SInt k = 0 ; k < num ; ++k ){
+          SInt tmp = lisn;
+          DoPush(lis, lisn, lisc, kids[k]);
+          DoPush(lisB, tmp, lisBc, (UInt8)0);
+        }
+      }
+    }
+    lisn = keep;
+
+    // refinement pass, of the pixels significant before this plane
+    for ( SInt l = 0 ; more && (l < old) ; ++l ){
+      SInt pos = lsp[l];
+      bit = enc && ((m_mag[pos] >> n) & 1);
+      if ( (more = DoBit(enc, bit)) && !enc ){
+        m_mag[pos] |= ((UInt32)bit) << n;
+        m_plane[pos] = (SInt8)n;
+      }
+    }
+  }
+
+  delete [] lip;
+  delete [] lsp;
+  delete [] lis;
+  delete [] lisB;
+}
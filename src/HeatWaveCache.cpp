@@ -0,0 +1,417 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveCache.cpp
+ ** @brief  Contains the HeatWaveCache class definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveCache.hpp"
+#include "HeatWaveDigest.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define HEATWAVECACHEPID() ((SInt)getpid())
+#elif defined(_WIN32) && !defined(_WIN32_WCE)
+#include <process.h>
+#define HEATWAVECACHEPID() ((SInt)_getpid())
+#else
+// no process id, temporary names are only unique within the process
+#define HEATWAVECACHEPID() 0
+#endif
+
+/** The first bytes of a cache file, the last is the format version. */
+static const Char glob_cacheMagic[8] = {'H','W','C','A','C','H','E','1'};
+
+/** The second seed of the keys, the first is 0. */
+static const UInt64 glob_cacheSeed = 0x5EED;
+
+/****************************************************************************/
+
+static void
+DoPutU32(UInt8 * ptr, UInt32 val)
+{
+  ptr[0] = (UInt8)val;
+  ptr[1] = (UInt8)(val >> 8);
+  ptr[2] = (UInt8)(val >> 16);
+  ptr[3] = (UInt8)(val >> 24);
+}
+
+static UInt32
+GetU32(const UInt8 * ptr)
+{
+  return ((UInt32)ptr[0]) | ((UInt32)ptr[1] << 8) |
+    ((UInt32)ptr[2] << 16) | ((UInt32)ptr[3] << 24);
+}
+
+/****************************************************************************/
+
+HeatWaveCache::HeatWaveCache(const Char * dir)
+{
+  ASSERT ( dir != NULL );
+  m_dir = new Char[strlen(dir)+1];
+  LEAVEONNULL(m_dir);
+  strcpy(m_dir, dir);
+  m_hits = 0;
+  m_misses = 0;
+  m_tmpn = 0;
+}
+
+HeatWaveCache::~HeatWaveCache()
+{
+  delete [] m_dir;
+}
+
+const Char *
+HeatWaveCache::GetDirectory() const
+{
+  return m_dir;
+}
+
+SInt
+HeatWaveCache::GetHits() const
+{
+  return AtomicAdd(const_cast<SInt*>(&m_hits), 0);
+}
+
+SInt
+HeatWaveCache::GetMisses() const
+{
+  return AtomicAdd(const_cast<SInt*>(&m_misses), 0);
+}
+
+SInt
+HeatWaveCache::DoPyramidTransform(HeatWaveComponent & cmp, EnumTransform trn,
+                                  SInt lev, Bool fwd, SInt cur)
+{
+  UInt64 key[2];
+  DoKeyStart(key, 0, trn, lev, fwd, cur);
+  DoKeyAdd(key, cmp);
+  HeatWaveComponent * cmpa = &cmp;
+  SInt ret = 0, rlev = 0, rtrn = 0;
+  if ( DoRead(key, &cmpa, 1, ret, rlev, rtrn) ){
+    AtomicAdd(&m_hits, 1);
+    return ret;
+  }
+  AtomicAdd(&m_misses, 1);
+  ret = cmp.DoPyramidTransform(trn, lev, fwd, cur);
+  DoWrite(key, &cmpa, 1, ret, cmp.GetTransformLevel(),
+          cmp.GetTransformType());
+  return ret;
+}
+
+SInt
+HeatWaveCache::DoSpatialTransform(HeatWaveVideo & vid, EnumTransform trn,
+                                  SInt lev, Bool fwd, SInt cur)
+{
+  SInt ret = 0;
+  for ( SInt i = 0 ; i < vid.GetImageN() ; ++i ){
+    HeatWaveImage & img = vid.GetImage(i);
+    for ( SInt c = 0 ; c < img.GetComponentN() ; ++c ){
+      ret = DoPyramidTransform(img.GetComponent(c), trn, lev, fwd, cur);
+    }
+  }
+  return ret;
+}
+
+SInt
+HeatWaveCache::DoTemporalTransform(HeatWaveVideo & vid, EnumTransform trn,
+                                   SInt lev, Bool fwd, SInt cur)
+{
+  if ( !vid.IsSpatiallyComparable() || (vid.GetImageN() < 2) ){
+    return vid.DoTemporalTransform(trn, lev, fwd, cur);
+  }
+  UInt64 key[2];
+  DoKeyStart(key, 1, trn, lev, fwd, cur);
+  SInt vals[3] = {vid.GetTransformLevel(), vid.GetTransformType(),
+                  vid.GetGroupCount()};
+  DoKeyAdd(key, vals, 3);
+  for ( SInt g = 0 ; g < vals[2] ; ++g ){
+    SInt grp[2] = {0, 0};
+    vid.GetGroupInfo(g, grp[0], grp[1]);
+    DoKeyAdd(key, grp, 2);
+  }
+  SInt cmpn = 0;
+  for ( SInt i = 0 ; i < vid.GetImageN() ; ++i ){
+    cmpn += vid.GetImage(i).GetComponentN();
+  }
+  HeatWaveComponent ** cmpa = new HeatWaveComponent*[cmpn > 0 ? cmpn : 1];
+  LEAVEONNULL(cmpa);
+  cmpn = 0;
+  for ( SInt i = 0 ; i < vid.GetImageN() ; ++i ){
+    HeatWaveImage & img = vid.GetImage(i);
+    for ( SInt c = 0 ; c < img.GetComponentN() ; ++c ){
+      cmpa[cmpn] = &img.GetComponent(c);
+      DoKeyAdd(key, *cmpa[cmpn]);
+      ++cmpn;
+    }
+  }
+
+  SInt ret = 0, rlev = 0, rtrn = 0;
+  if ( DoRead(key, cmpa, cmpn, ret, rlev, rtrn) ){
+    AtomicAdd(&m_hits, 1);
+    vid.SetTransformLevel(rlev);
+    vid.SetTransformType((EnumTransform)rtrn);
+  }
+  else {
+    AtomicAdd(&m_misses, 1);
+    ret = vid.DoTemporalTransform(trn, lev, fwd, cur);
+    if ( ret >= 0 ){
+      DoWrite(key, cmpa, cmpn, ret, vid.GetTransformLevel(),
+              vid.GetTransformType());
+    }
+  }
+  delete [] cmpa;
+  return ret;
+}
+
+/****************************************************************************/
+
+void
+HeatWaveCache::DoKeyStart(UInt64 * key, SInt kind, EnumTransform trn,
+                          SInt lev, Bool fwd, SInt cur)
+{
+  key[0] = 0;
+  key[1] = glob_cacheSeed;
+  SInt vals[7] = {HEATWAVECACHEVERSION, kind, (SInt)sizeof(Smpl), trn, lev,
+                  fwd ? 1 : 0, cur};
+  DoKeyAdd(key, vals, 7);
+}
+
+void
+HeatWaveCache::DoKeyAdd(UInt64 * key, const SInt * vals, SInt num)
+{
+  UInt8 buf[4*16];
+  ASSERT ( num <= 16 );
+  for ( SInt i = 0 ; i < num ; ++i ){
+    DoPutU32(buf+4*i, (UInt32)vals[i]);
+  }
+  key[0] = HeatWaveDigest::GetXXH64(buf, 4*num, key[0]);
+  key[1] = HeatWaveDigest::GetXXH64(buf, 4*num, key[1]);
+}
+
+void
+HeatWaveCache::DoKeyAdd(UInt64 * key, HeatWaveComponent & cmp)
+{
+  SInt vals[12] = {cmp.GetTLX(), cmp.GetTLY(), cmp.GetWidth(),
+                   cmp.GetHeight(), cmp.GetHStep(), cmp.GetVStep(),
+                   cmp.GetPrec(), cmp.GetSgnd() ? 1 : 0,
+                   cmp.GetTransformLevel(), cmp.GetTransformType(),
+                   cmp.GetTileWidth(), cmp.GetTileHeight()};
+  DoKeyAdd(key, vals, 12);
+  if ( (cmp.GetWidth() <= 0) || (cmp.GetHeight() <= 0) ){
+    return;
+  }
+  // each row is hashed seeded with the hash so far, read through a view so
+  // that shared samples are not copied
+  HeatWaveView view = cmp.GetView();
+  Smpl * buf = new Smpl[view.GetWidth()];
+  LEAVEONNULL(buf);
+  SInt len = view.GetWidth()*sizeof(Smpl);
+  for ( SInt y = 0 ; y < view.GetHeight() ; ++y ){
+    const UInt8 * row = (const UInt8*)view.GetRow(y, buf);
+    key[0] = HeatWaveDigest::GetXXH64(row, len, key[0]);
+    key[1] = HeatWaveDigest::GetXXH64(row, len, key[1]);
+  }
+  delete [] buf;
+}
+
+Char *
+HeatWaveCache::GetFileName(const UInt64 * key, Bool tmp) const
+{
+  UInt8 dig[16];
+  for ( SInt i = 0 ; i < 8 ; ++i ){
+    dig[i] = (UInt8)(key[0] >> (56-8*i));
+    dig[8+i] = (UInt8)(key[1] >> (56-8*i));
+  }
+  Char * name = new Char[strlen(m_dir)+80];
+  LEAVEONNULL(name);
+  strcpy(name, m_dir);
+  strcat(name, "/");
+  HeatWaveDigest::GetHex(dig, 16, name+strlen(name));
+  if ( tmp ){
+    SInt num = AtomicAdd(const_cast<SInt*>(&m_tmpn), 1);
+    sprintf(name+strlen(name), ".%d.%d.tmp", HEATWAVECACHEPID(), num);
+  }
+  else {
+    strcat(name, ".hwc");
+  }
+  return name;
+}
+
+Bool
+HeatWaveCache::DoRead(const UInt64 * key, HeatWaveComponent ** cmpa,
+                      SInt cmpn, SInt & ret, SInt & lev, SInt & trn)
+{
+  Char * name = GetFileName(key, False);
+  FILE * file = fopen(name, "rb");
+  delete [] name;
+  if ( file == NULL ){
+    return False;
+  }
+
+  // check the header and the size before changing anything
+  const SInt head = 8+16+16;
+  const SInt plane = 32;
+  UInt8 buf[8+16+16];
+  Bool ok = ( fread(buf, 1, head, file) == (size_t)head );
+  ok = ok && ( memcmp(buf, glob_cacheMagic, 8) == 0 );
+  for ( SInt i = 0 ; ok && (i < 8) ; ++i ){
+    ok = ( (buf[8+i] == (UInt8)(key[0] >> (56-8*i))) &&
+           (buf[16+i] == (UInt8)(key[1] >> (56-8*i))) );
+  }
+  ok = ok && ( (SInt)GetU32(buf+24) == cmpn );
+  UInt8 * planes = NULL;
+  if ( ok ){
+    ret = (SInt)GetU32(buf+28);
+    lev = (SInt)GetU32(buf+32);
+    trn = (SInt)GetU32(buf+36);
+    planes = new UInt8[(cmpn > 0 ? cmpn : 1)*plane];
+    LEAVEONNULL(planes);
+    ok = ( fread(planes, 1, cmpn*plane, file) == (size_t)(cmpn*plane) );
+  }
+  long size = head+cmpn*plane;
+  for ( SInt c = 0 ; ok && (c < cmpn) ; ++c ){
+    const UInt8 * p = planes+c*plane;
+    SInt bps = (SInt)GetU32(p+24);
+    ok = ( ((SInt)GetU32(p) == cmpa[c]->GetWidth()) &&
+           ((SInt)GetU32(p+4) == cmpa[c]->GetHeight()) &&
+           ((bps == 1) || (bps == 2) || (bps == 4)) );
+    size += (long)cmpa[c]->GetWidth()*cmpa[c]->GetHeight()*bps;
+  }
+  ok = ok && ( fseek(file, 0, SEEK_END) == 0 ) && ( ftell(file) == size ) &&
+    ( fseek(file, head+cmpn*plane, SEEK_SET) == 0 );
+
+  UInt8 * row = NULL;
+  for ( SInt c = 0 ; ok && (c < cmpn) ; ++c ){
+    const UInt8 * p = planes+c*plane;
+    HeatWaveComponent & cmp = *cmpa[c];
+    SInt bps = (SInt)GetU32(p+24);
+    UInt32 min = GetU32(p+28);
+    if ( cmp.IsPacked() ){
+      cmp.DoUnpack();
+    }
+    Smpl ** rows = cmp.GetRows();
+    delete [] row;
+    row = new UInt8[cmp.GetWidth()*bps];
+    LEAVEONNULL(row);
+    for ( SInt y = 0 ; ok && (y < cmp.GetHeight()) ; ++y ){
+      ok = ( fread(row, bps, cmp.GetWidth(), file) ==
+             (size_t)cmp.GetWidth() );
+      for ( SInt x = 0 ; ok && (x < cmp.GetWidth()) ; ++x ){
+        UInt32 val = row[x*bps];
+        if ( bps > 1 ){
+          val |= (UInt32)row[x*bps+1] << 8;
+        }
+        if ( bps > 2 ){
+          val |= ((UInt32)row[x*bps+2] << 16) | ((UInt32)row[x*bps+3] << 24);
+        }
+        rows[y][x] = (Smpl)(SInt32)(min+val);
+      }
+    }
+    cmp.SetTransformLevel((SInt)GetU32(p+8));
+    cmp.SetTransformType((EnumTransform)GetU32(p+12));
+    cmp.SetPrec((SInt)GetU32(p+16));
+    cmp.SetSgnd(GetU32(p+20) != 0);
+  }
+  delete [] row;
+  delete [] planes;
+  fclose(file);
+  // the size was checked, so only a failing disk gets here half read
+  return ok;
+}
+
+Bool
+HeatWaveCache::DoWrite(const UInt64 * key, HeatWaveComponent ** cmpa,
+                       SInt cmpn, SInt ret, SInt lev, SInt trn)
+{
+  Char * tmp = GetFileName(key, True);
+  FILE * file = fopen(tmp, "wb");
+  if ( file == NULL ){
+    delete [] tmp;
+    return False;
+  }
+  UInt8 buf[8+16+16];
+  memcpy(buf, glob_cacheMagic, 8);
+  for ( SInt i = 0 ; i < 8 ; ++i ){
+    buf[8+i] = (UInt8)(key[0] >> (56-8*i));
+    buf[16+i] = (UInt8)(key[1] >> (56-8*i));
+  }
+  DoPutU32(buf+24, cmpn);
+  DoPutU32(buf+28, ret);
+  DoPutU32(buf+32, lev);
+  DoPutU32(buf+36, trn);
+  Bool ok = ( fwrite(buf, 1, sizeof(buf), file) == sizeof(buf) );
+
+  // the plane headers, with the smallest sample and bytes per sample
+  SInt * bpsa = new SInt[cmpn > 0 ? cmpn : 1];
+  UInt32 * mina = new UInt32[cmpn > 0 ? cmpn : 1];
+  LEAVEONNULL(bpsa);
+  LEAVEONNULL(mina);
+  for ( SInt c = 0 ; ok && (c < cmpn) ; ++c ){
+    HeatWaveComponent & cmp = *cmpa[c];
+    SInt64 min = 0, max = 0;
+    if ( (cmp.GetWidth() > 0) && (cmp.GetHeight() > 0) ){
+      HeatWaveView view = cmp.GetView();
+      Smpl lo, hi;
+      SInt total;
+      view.GetBasicStats(lo, hi, total);
+      min = lo;
+      max = hi;
+    }
+    UInt64 range = (UInt64)(max-min);
+    bpsa[c] = (range < 0x100) ? 1 : ((range < 0x10000) ? 2 : 4);
+    mina[c] = (UInt32)(SInt32)min;
+    UInt8 p[32];
+    DoPutU32(p, cmp.GetWidth());
+    DoPutU32(p+4, cmp.GetHeight());
+    DoPutU32(p+8, cmp.GetTransformLevel());
+    DoPutU32(p+12, cmp.GetTransformType());
+    DoPutU32(p+16, cmp.GetPrec());
+    DoPutU32(p+20, cmp.GetSgnd() ? 1 : 0);
+    DoPutU32(p+24, bpsa[c]);
+    DoPutU32(p+28, mina[c]);
+    ok = ( fwrite(p, 1, sizeof(p), file) == sizeof(p) );
+  }
+
+  // and the samples, from the smallest up
+  for ( SInt c = 0 ; ok && (c < cmpn) ; ++c ){
+    HeatWaveComponent & cmp = *cmpa[c];
+    if ( (cmp.GetWidth() <= 0) || (cmp.GetHeight() <= 0) ){
+      continue;
+    }
+    HeatWaveView view = cmp.GetView();
+    SInt bps = bpsa[c];
+    Smpl * smpl = new Smpl[view.GetWidth()];
+    UInt8 * row = new UInt8[view.GetWidth()*bps];
+    LEAVEONNULL(smpl);
+    LEAVEONNULL(row);
+    for ( SInt y = 0 ; ok && (y < view.GetHeight()) ; ++y ){
+      const Smpl * src = view.GetRow(y, smpl);
+      for ( SInt x = 0 ; x < view.GetWidth() ; ++x ){
+        UInt32 val = (UInt32)(SInt32)src[x] - mina[c];
+        for ( SInt b = 0 ; b < bps ; ++b ){
+          row[x*bps+b] = (UInt8)(val >> (8*b));
+        }
+      }
+      ok = ( fwrite(row, bps, view.GetWidth(), file) ==
+             (size_t)view.GetWidth() );
+    }
+    delete [] smpl;
+    delete [] row;
+  }
+  delete [] bpsa;
+  delete [] mina;
+
+  ok = ( fclose(file) == 0 ) && ok;
+  if ( ok ){
+    Char * name = GetFileName(key, False);
+    ok = ( rename(tmp, name) == 0 );
+    delete [] name;
+  }
+  if ( !ok ){
+    remove(tmp);
+  }
+  delete [] tmp;
+  return ok;
+}
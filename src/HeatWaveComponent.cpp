@@ -7,6 +7,9 @@
  **/
 
 #include "HeatWaveComponent.hpp"
+#include "HeatWaveResampler.hpp"
+#include "HeatWaveProfiler.hpp"
+#include "HeatWaveMemory.hpp"
 
 HeatWaveComponent::HeatWaveComponent()
 {
@@ -23,6 +26,13 @@ HeatWaveComponent::HeatWaveComponent()
   m_lev = 0;
   m_data = NULL;
   m_rows = NULL;
+  m_pack = NULL;
+  m_refs = NULL;
+  m_capacity = 0;
+  m_rowCapacity = 0;
+  m_tileW = 0;
+  m_tileH = 0;
+  m_pool = NULL;
   m_desMem = True;
   m_size = 0;
 }
@@ -40,6 +50,13 @@ HeatWaveComponent::HeatWaveComponent(SInt tlx, SInt tly, SInt hstep,
   m_clr = clr;
   m_data = NULL;
   m_rows = NULL;
+  m_pack = NULL;
+  m_refs = NULL;
+  m_capacity = 0;
+  m_rowCapacity = 0;
+  m_tileW = 0;
+  m_tileH = 0;
+  m_pool = NULL;
   m_desMem = True;
   m_size = width*height;
   m_width = 0;
@@ -67,6 +84,13 @@ HeatWaveComponent::HeatWaveComponent(SInt tlx, SInt tly,
   m_clr = clr;
   m_data = data;
   m_rows = rows;
+  m_pack = NULL;
+  m_refs = NULL;
+  m_capacity = 0;
+  m_rowCapacity = 0;
+  m_tileW = 0;
+  m_tileH = 0;
+  m_pool = NULL;
   m_desMem = desMem;
   m_size = width*height;
   
@@ -133,35 +157,11 @@ void
 HeatWaveComponent::SetHStep(SInt hstep, Bool rsze, EnumTransform trns)
 {
   ASSERT ( hstep >= 1 );
-  if ( (!rsze) ){
-    m_hstep = hstep;
-  }
-  else{
-    //SetMinPrecSgn();
-    //SInt prec = GetPrec();
-    if ( hstep > m_hstep ){
-      // reduce size
-      for ( SInt i = (hstep-m_hstep); i > 0 ; --i){
-        DoTransform(true, trns, m_tlx, m_tly, m_width, m_height, true, true,
-                    false, true, true);
-        SInt x, y, width, height; // only width nb!
-        GetSubbandInfo ( 1, SubLL, x, y, width, height);  
-        ASSERT ( width == (m_width/2) ); // might be a issue later?
-        DoResize(width, m_height ,true ,0 , m_desMem);
-      }
-    }
-    else if ( hstep < m_hstep ){
-      // increase size
-      for ( SInt i = 0; i < (m_hstep-hstep); ++i){
-        DoResize(m_width*2, m_height ,true ,0 , m_desMem);
-        // m_width now changed ...
-        DoTransform(false, trns, m_tlx, m_tly, m_width, m_height, true, true,
-                    false, true, true);
-      }
-    }
-    //SetMinPrecSgn();
-    //ASSERT( prec == GetPrec() );
+  if ( rsze && (hstep != m_hstep) ){
+    HeatWaveResampler rsmp(trns);
+    rsmp.DoResample(*this, GetOctaves(m_hstep, hstep), 0);
   }
+  m_hstep = hstep;
 }
 
 
@@ -175,31 +175,10 @@ void
 HeatWaveComponent::SetVStep(SInt vstep, Bool rsze, EnumTransform trns)
 {
   ASSERT ( vstep >= 1 );
-  if ( (!rsze) ){
-    m_vstep = vstep;
+  if ( rsze && (vstep != m_vstep) ){
+    HeatWaveResampler rsmp(trns);
+    rsmp.DoResample(*this, 0, GetOctaves(m_vstep, vstep));
   }
-  else{
-    if ( vstep > m_vstep ){
-      // reduce size
-      for ( SInt i = (vstep-m_vstep); i > 0 ; --i){
-        DoTransform(true, trns, m_tlx, m_tly, m_width, m_height, true, true,
-                    true, false, true);
-        SInt x, y, width, height; // only height nb!
-        GetSubbandInfo ( 1, SubLL, x, y, width, height);  
-        ASSERT ( height == (m_height/2) ); // might be a issue later?
-        DoResize(m_width, height ,true ,0 , m_desMem);
-      }
-    }
-    else if ( vstep < m_vstep ){
-      // increase size
-      for ( SInt i = 0; i < (m_vstep-vstep); ++i){
-        DoResize(m_width, m_height*2 ,true ,0 , m_desMem);
-        // m_width now changed ...
-        DoTransform(false, trns, m_tlx, m_tly, m_width, m_height, true, true,
-                    true, false, true);
-      }
-    }
-  }  
   m_vstep = vstep;
 }
 
@@ -242,15 +221,29 @@ HeatWaveComponent::SetSize(SInt width, SInt height, Smpl def, Bool desMem)
 }
 
 Smpl * 
+HeatWaveComponent::GetData()
+{
+  ASSERT ( m_pack == NULL );
+  // the data may be written to
+  DoUnshare();
+  return m_data;
+}
+
+const Smpl *
 HeatWaveComponent::GetData() const
 {
+  ASSERT ( m_pack == NULL );
   return m_data;
 }
 
 void
 HeatWaveComponent::SetData(Smpl * data)
 {
+  ASSERT ( m_pack == NULL );
+  DoUnshare();
+  HeatWaveMemory::SubBytes(MemPlanes, (SInt64)m_capacity*sizeof(Smpl));
   m_data = data;
+  m_capacity = 0;
 }
 
 Bool 
@@ -290,7 +283,7 @@ HeatWaveComponent::SetPrec(SInt prec)
 }
 
 SInt 
-HeatWaveComponent::GetPrec()
+HeatWaveComponent::GetPrec() const
 {
   return m_prec;
 }
@@ -302,7 +295,9 @@ HeatWaveComponent::GetMinPrecSgn(SInt tlx, SInt tly, SInt width, SInt height,
 {
   ASSERT ( min_prec >= 0 );
   
-  Smpl min, max, range_min, range_max, dummy;
+  Smpl min, max, dummy;
+  // wider than a sample, the full sample range needs (1 << 32)
+  SInt64 range_min, range_max;
   
   if (GetBasicStats(tlx, tly, width, height, min, max, dummy) < 0){
     return False;
@@ -313,7 +308,7 @@ HeatWaveComponent::GetMinPrecSgn(SInt tlx, SInt tly, SInt width, SInt height,
   sgnd = ((min < 0) || min_sgnd);
   
   for (;;){
-    range_max = ((1 << prec)-1);
+    range_max = (((SInt64)1 << prec)-1);
     range_min = 0;
     if ( sgnd ) {
       range_max = range_max >> 1;
@@ -411,7 +406,10 @@ HeatWaveComponent::SetNewPrecSgn(SInt prec, Bool sgnd)
 void 
 HeatWaveComponent::DoPixelise(SInt prec, Bool sgnd)
 {
-  if ( m_lev ){
+  if ( m_lev && (GetTileCount() > 1) ){
+    DoPixeliseTiles(prec, sgnd);
+  }
+  else if ( m_lev ){
     SInt tlx, tly , width, height, r_prec, l_prec, max_prec;
     Bool r_sgnd = False, l_sgnd= False , or_sgnd;
     GetSubbandInfo(m_lev, SubLL ,tlx, tly, width, height);
@@ -441,9 +439,51 @@ HeatWaveComponent::DoPixelise(SInt prec, Bool sgnd)
   }
 }
 
+void
+HeatWaveComponent::DoPixeliseTiles(SInt prec, Bool sgnd)
+{
+  // the high passes of all tiles share a range, as they do untiled
+  SInt max_prec = 0;
+  Bool or_sgnd = False;
+  for ( SInt pass = 0 ; pass < 2 ; ++pass ){
+    for ( SInt t = 0 ; t < GetTileCount() ; ++t ){
+      SInt tlx, tly, wid, hei, x, y, width, height;
+      GetTileInfo(t, tlx, tly, wid, hei);
+      GetSubbandArea(tlx, tly, wid, hei, GetTileLevel(t, m_lev), SubLL, x, y,
+                     width, height);
+      // right of and below the LL
+      SInt ax[2] = {x+width, x};
+      SInt ay[2] = {y, y+height};
+      SInt aw[2] = {(tlx+wid)-(x+width), width};
+      SInt ah[2] = {hei, (tly+hei)-(y+height)};
+      if ( pass == 1 ){
+        SetNewPrecSgn(x, y, width, height, prec, sgnd);
+      }
+      for ( SInt a = 0 ; a < 2 ; ++a ){
+        if ( (aw[a] <= 0) || (ah[a] <= 0) ){
+          continue;
+        }
+        if ( pass == 1 ){
+          SetNewPrecSgn(ax[a], ay[a], aw[a], ah[a], prec, sgnd, True,
+                        max_prec, or_sgnd);
+          continue;
+        }
+        SInt a_prec;
+        Bool a_sgnd = False;
+        if ( GetMinPrecSgn(ax[a], ay[a], aw[a], ah[a], a_prec, a_sgnd) ){
+          max_prec = HeatWaveMath::Max(max_prec, a_prec);
+          or_sgnd = (or_sgnd || a_sgnd);
+        }
+      }
+    }
+  }
+}
+
 void
 HeatWaveComponent::DoCapData(SInt min, SInt max, Bool set)
 {
+  DoUnpack();
+  DoUnshare();
   for ( SInt i = 0 ; i < m_size ; ++i ){
     if ( this->m_data[i] > max ){
       this->m_data[i] = max;
@@ -471,6 +511,8 @@ HeatWaveComponent::DoCapDataToPrec(){
 
 void 
 HeatWaveComponent::DoClear(SInt rplc){
+  DoUnpack();
+  DoUnshare();
   for ( SInt i = 0 ; i < m_size ; ++i ){
     this->m_data[i] = rplc;
   } 
@@ -486,24 +528,7 @@ HeatWaveComponent::GetBasicStats(SInt tlx, SInt tly, SInt width, SInt height,
     return -1;
   }
   
-  SInt size = (width*height);
-  min = 0;
-  max = 0;
-  total = 0;
-  
-  if ( m_size > 0 ){
-    min = max = GetSmpl(tlx,tly);
-    for ( SInt x = tlx ; x < (tlx+width) ; ++x ){
-      for ( SInt y = tly ; y < (tly+height) ; ++y ){
-        min = HeatWaveMath::Min(min,GetSmpl(x,y));
-        max = HeatWaveMath::Max(max,GetSmpl(x,y));
-        total += GetSmpl(x,y);
-        ++size;
-      }
-    }
-  }
-  
-  return size;
+  return GetView(tlx,tly,width,height).GetBasicStats(min,max,total);
 }
 
 SInt 
@@ -524,43 +549,8 @@ HeatWaveComponent::GetStats(SInt tlx, SInt tly, SInt width, SInt height,
     return False;
   }
   
-  register Smpl tmp_smpl = 0;
-  register SFloat64 tmp_flt = 0;
-  total = 0;
-  min = max = GetSmpl(tlx,tly);
-
-  for ( SInt y = tly ; y < (tly+height) ; ++ y ){
-    for ( SInt x = tlx ; x < (tlx+width) ; ++ x ){
-      tmp_smpl = GetSmpl(x,y);
-      if ( tmp_smpl < min ){
-        min = tmp_smpl;
-      }
-      else if ( tmp_smpl > max ){
-        max = tmp_smpl;
-      }
-      total += tmp_smpl;
-    }
-  }
-  
-  SFloat64 size = width*height;
-  SFloat64 flt_total = total;
-  mean = flt_total/size;
-  std_dev = 0;
- 
-  for ( SInt y = tly ; y < (tly+height) ; ++ y ){
-    for ( SInt x = tlx ; x < (tlx+width) ; ++ x ){
-      tmp_flt = GetSmpl(x,y); 
-      tmp_flt -= mean;
-      tmp_flt = pow(tmp_flt,2);
-      std_dev += tmp_flt;
-    }
-  }
-  
-  std_dev = sqrt(std_dev/size);
-  std_err = std_dev/sqrt(size);
-  rms = sqrt(pow(mean,2)+pow(std_dev,2));
-  
-  return True;
+  return GetView(tlx,tly,width,height).GetStats(min, max, total, mean, 
+                                                std_dev, std_err, rms);
 }
 
 void 
@@ -595,6 +585,10 @@ HeatWaveComponent::GetSmpl(const SInt x, const SInt y) const
   }
   ASSERT(ValidateCoords(x,y));
   
+  if ( m_pack ){
+    return m_pack[((y-m_tly)*m_width)+(x-m_tlx)];
+  }
+  
   /* NB! leave y infront! */
   return m_rows[y-m_tly][x-m_tlx]; 
 }
@@ -604,6 +598,16 @@ HeatWaveComponent::SetSmpl(const SInt x, const SInt y, const Smpl val)
 {
   ASSERT(ValidateCoords(x,y));
   ASSERT(ValidateSample(val));
+  DoUnshare();
+  
+  if ( m_pack ){
+    if ( (val >= SMPL16MIN) && (val <= SMPL16MAX) ){
+      m_pack[((y-m_tly)*m_width)+(x-m_tlx)] = (Smpl16)val;
+      return;
+    }
+    // value needs more than 16-bits
+    DoUnpack();
+  }
   
   /* NB! leave y infront! */
   m_rows[y-m_tly][x-m_tlx] = val; 
@@ -634,15 +638,32 @@ HeatWaveComponent::SetTransformType(EnumTransform type)
 }
 
 Smpl ** 
+HeatWaveComponent::GetRows()
+{
+  ASSERT ( m_pack == NULL );
+  // the rows may be written to
+  DoUnshare();
+  return m_rows;
+}
+
+const Smpl * const *
 HeatWaveComponent::GetRows() const
 {
+  ASSERT ( m_pack == NULL );
   return m_rows;
 }
 
 void 
 HeatWaveComponent::SetRows(Smpl ** rows)
 {
+  ASSERT ( m_pack == NULL );
+  DoUnshare();
+  HeatWaveMemory::SubBytes(MemPlanes, (SInt64)m_capacity*sizeof(Smpl));
+  HeatWaveMemory::SubBytes(MemRows, (SInt64)m_rowCapacity*sizeof(Smpl*));
   m_rows = rows;
+  // the rows may not follow the data any more
+  m_capacity = 0;
+  m_rowCapacity = 0;
 }
 
 void 
@@ -657,6 +678,206 @@ HeatWaveComponent::GetDesMem() const
   return m_desMem;
 }
 
+Bool
+HeatWaveComponent::GetPackable(SInt tlx, SInt tly, SInt width, SInt height,
+                               EnumTransform trn, SInt lev) const
+{
+  SInt prec;
+  Bool sgnd;
+  SFloat64 bits, low, high;
+  
+  if ( !GetMinPrecSgn(tlx, tly, width, height, prec, sgnd, False, 1) ){
+    return False;
+  }
+  
+  // precision needed as a signed sample
+  bits = prec + (sgnd ? 0 : 1);
+  
+  if ( lev > 0 ){
+    m_lift.GetGains(trn, low, high);
+    if ( high < low ){
+      high = low;
+    }
+    // the LL grows with every level, the last level also has high passes
+    bits += ((2*(lev-1)*log(low)) + (2*log(high)))/log(2.0);
+  }
+  
+  return ( bits <= SMPL16PRECISION );
+}
+
+Bool
+HeatWaveComponent::GetPackable(EnumTransform trn, SInt lev) const
+{
+  SInt x, y, width, height;
+  
+  if ( m_size <= 0 ){
+    return False;
+  }
+  if ( !GetPackable(m_tlx, m_tly, m_width, m_height, Trn0_0, 0) ){
+    return False;
+  }
+  if ( lev <= 0 ){
+    return True;
+  }
+  if ( GetTileCount() > 1 ){
+    // each tile goes on from its own LL
+    for ( SInt t = 0 ; t < GetTileCount() ; ++t ){
+      SInt tlx, tly, wid, hei;
+      GetTileInfo(t, tlx, tly, wid, hei);
+      GetSubbandArea(tlx, tly, wid, hei, GetTileLevel(t, m_lev), SubLL, x,
+                     y, width, height);
+      if ( !GetPackable(x, y, width, height, trn, lev) ){
+        return False;
+      }
+    }
+    return True;
+  }
+  if ( !GetSubbandInfo(m_lev, SubLL, x, y, width, height) ){
+    // no further levels possible
+    return True;
+  }
+  return GetPackable(x, y, width, height, trn, lev);
+}
+
+Bool
+HeatWaveComponent::DoPack(EnumTransform trn, SInt lev)
+{
+  if ( m_pack ){
+    return True;
+  }
+  if ( !m_desMem ){
+    // memory is managed else where
+    return False;
+  }
+  if ( !GetPackable(trn, lev) ){
+    return False;
+  }
+  
+  Smpl16 * pack = new Smpl16[m_size];
+  LEAVEONNULL(pack);
+  HEATWAVECOUNT(PrfAlloc, m_size, (SInt64)m_size*sizeof(Smpl16));
+  HeatWaveMemory::AddBytes(MemPlanes, (SInt64)m_size*sizeof(Smpl16));
+  for ( SInt i = 0 ; i < m_size ; ++i ){
+    pack[i] = (Smpl16)m_data[i];
+  }
+  
+  // a copy may still use the full samples
+  DoDestroy();
+  m_pack = pack;
+  m_desMem = True;
+  return True;
+}
+
+void
+HeatWaveComponent::DoUnpack()
+{
+  if ( !m_pack ){
+    return;
+  }
+  
+  Smpl16 * pack = m_pack;
+  SInt * refs = m_refs;
+  m_pack = NULL;
+  m_refs = NULL;
+  DoCreate(m_width, m_height, False, 0, True);
+  for ( SInt i = 0 ; i < m_size ; ++i ){
+    m_data[i] = pack[i];
+  }
+  if ( DoDropRef(refs) ){
+    HeatWaveMemory::SubBytes(MemPlanes, (SInt64)m_size*sizeof(Smpl16));
+    delete [] pack;
+  }
+}
+
+Bool
+HeatWaveComponent::IsPacked() const
+{
+  return ( m_pack != NULL );
+}
+
+Bool
+HeatWaveComponent::IsShared() const
+{
+  return ( (m_refs != NULL) && (AtomicAdd(m_refs, 0) > 1) );
+}
+
+void
+HeatWaveComponent::DoUnshare()
+{
+  if ( m_refs == NULL ){
+    return;
+  }
+  if ( AtomicAdd(m_refs, 0) == 1 ){
+    // the copies are gone
+    delete m_refs;
+    m_refs = NULL;
+    return;
+  }
+  
+  Smpl * data = m_data;
+  Smpl ** rows = m_rows;
+  Smpl16 * pack = m_pack;
+  SInt * refs = m_refs;
+  SInt cap = m_capacity;
+  SInt rowCap = m_rowCapacity;
+  m_data = NULL;
+  m_rows = NULL;
+  m_pack = NULL;
+  m_refs = NULL;
+  if ( pack ){
+    m_pack = new Smpl16[m_size];
+    LEAVEONNULL(m_pack);
+    HEATWAVECOUNT(PrfAlloc, m_size, (SInt64)m_size*sizeof(Smpl16));
+    HeatWaveMemory::AddBytes(MemPlanes, (SInt64)m_size*sizeof(Smpl16));
+    memcpy((char*)m_pack,(char*)pack,m_size*sizeof(Smpl16));
+    m_desMem = True;
+  }
+  else {
+    DoCreate(m_width, m_height, False, 0, True);
+    memcpy((char*)m_data,(char*)data,m_size*sizeof(Smpl));
+  }
+  if ( DoDropRef(refs) ){
+    // the copies went meanwhile
+    if ( pack ){
+      HeatWaveMemory::SubBytes(MemPlanes, (SInt64)m_size*sizeof(Smpl16));
+    }
+    HeatWaveMemory::SubBytes(MemPlanes, (SInt64)cap*sizeof(Smpl));
+    HeatWaveMemory::SubBytes(MemRows, (SInt64)rowCap*sizeof(Smpl*));
+    delete [] pack;
+    delete [] data;
+    delete [] rows;
+  }
+}
+
+void
+HeatWaveComponent::DoSwap(HeatWaveComponent & other)
+{
+  // the storage and the lift buffer are only moved, never duplicated
+  SwapValues(m_tlx, other.m_tlx);
+  SwapValues(m_tly, other.m_tly);
+  SwapValues(m_hstep, other.m_hstep);
+  SwapValues(m_vstep, other.m_vstep);
+  SwapValues(m_width, other.m_width);
+  SwapValues(m_height, other.m_height);
+  SwapValues(m_sgnd, other.m_sgnd);
+  SwapValues(m_prec, other.m_prec);
+  SwapValues(m_clr, other.m_clr);
+  SwapValues(m_trn, other.m_trn);
+  SwapValues(m_lev, other.m_lev);
+  SwapValues(m_desMem, other.m_desMem);
+  SwapValues(m_size, other.m_size);
+  SwapValues(m_data, other.m_data);
+  SwapValues(m_rows, other.m_rows);
+  SwapValues(m_pack, other.m_pack);
+  SwapValues(m_refs, other.m_refs);
+  SwapValues(m_capacity, other.m_capacity);
+  SwapValues(m_rowCapacity, other.m_rowCapacity);
+  SwapValues(m_tileW, other.m_tileW);
+  SwapValues(m_tileH, other.m_tileH);
+  SwapValues(m_pool, other.m_pool);
+  m_lift.DoSwap(other.m_lift);
+}
+
 void
 HeatWaveComponent::DoResize(SInt width, SInt height, Bool keap, Smpl def, 
                             Bool desMem)
@@ -664,37 +885,61 @@ HeatWaveComponent::DoResize(SInt width, SInt height, Bool keap, Smpl def,
   if ( (width == m_width) && (height == m_height) ){
     return;
   }
+  ASSERT ( width >= 1 );
+  ASSERT ( height >= 1 );
+  SInt size = width*height;
     
   if ( keap && (m_width >0) && (m_height > 0) ){
+    DoUnpack();
+    DoUnshare();
     ASSERT ( ValidateSanity() );
-    ASSERT ( width >= 1 );
-    ASSERT ( height >= 1 );
-    HeatWaveComponent Temp(m_tlx, m_tly, m_hstep, m_vstep, m_width, m_height,
-                           m_sgnd, m_prec, m_clr, m_data, m_rows,
-                           m_desMem, False);
-    ASSERT ( Temp.ValidateSanity() );
-    
-    m_rows = NULL; m_data = NULL;
-    SInt minW = HeatWaveMath::Min(m_tlx+width, m_tlx+m_width);
-    SInt minH = HeatWaveMath::Min(m_tly+height, m_tly+m_height);
-    m_width = width;
-    m_height = height;
-    DoCreate(m_width, m_height, True, def, desMem);
-    
-    for ( SInt x = m_tlx ; x < minW ; ++x ){
-      for ( SInt y = m_tly ; y < minH ; ++ y){
-        SetSmpl(x,y,Temp.GetSmpl(x,y));
-      }
+    if ( m_desMem && (size <= m_capacity) ){
+      DoRelayout(width, height, def);
     }
+    else {
+      // grow by half again, so repeated resizes reuse the memory
+      DoRelocate(width, height, 
+                 HeatWaveMath::Max(size, m_capacity + (m_capacity>>1)), 
+                 def, desMem);
+    }
+    return;
   }
-  else{
+
+  if ( !IsShared() ){
+    DoUnshare();
+  }
+  if ( m_desMem && (m_refs == NULL) && (m_pack == NULL) && 
+       (size <= m_capacity) ){
+    // reuse the storage
+    m_width = 0;
+    m_height = 0;
+    DoRelayout(width, height, def);
+  }
+  else {
     DoDestroy();
     m_width = width;
     m_height = height;
     DoCreate(width, height, True, def, desMem);
-    m_width = width;
-    m_height = height;
-  } 
+  }
+  m_desMem = desMem;
+}
+
+void
+HeatWaveComponent::DoReserve(SInt size)
+{
+  if ( m_pack || !m_desMem || (m_width <= 0) || (m_height <= 0) ){
+    return;
+  }
+  DoUnshare();
+  if ( size > m_capacity ){
+    DoRelocate(m_width, m_height, size, 0, True);
+  }
+}
+
+SInt
+HeatWaveComponent::GetCapacity() const
+{
+  return m_capacity;
 }
 
 Bool 
@@ -707,19 +952,12 @@ HeatWaveComponent::DoTransform(Bool fwd, EnumTransform trn,
          (width>1)&&(height>1)) ){
     return False;
   }
-  Smpl * tmp_data = &(m_rows[tly-m_tly][tlx-m_tlx]); 
-  if ( fwd ){
-    if ( horz )
-      DoTransformInternal(fwd,trn,width,height,True,tmp_data,pred,upd);
-    if ( vert )
-      DoTransformInternal(fwd,trn,width,height,False,tmp_data,pred,upd);
-  }
-  else { // inverse
-    if ( vert )
-      DoTransformInternal(fwd,trn,width,height,False,tmp_data,pred,upd);
-    if ( horz )
-      DoTransformInternal(fwd,trn,width,height,True,tmp_data,pred,upd);
+  if ( m_pack && fwd && !GetPackable(tlx,tly,width,height,trn,1) ){
+    // coefficients could outgrow 16-bits
+    DoUnpack();
   }
+  DoUnshare();
+  DoTransformArea(m_lift,fwd,trn,tlx,tly,width,height,pred,upd,vert,horz);
   if ( range ){
     SetMinPrecSgn();
   }
@@ -727,6 +965,48 @@ HeatWaveComponent::DoTransform(Bool fwd, EnumTransform trn,
   return True;
 }
 
+void
+HeatWaveComponent::DoTransformArea(HeatWaveLift & lift, Bool fwd,
+                                   EnumTransform trn, SInt tlx, SInt tly,
+                                   SInt width, SInt height, Bool pred,
+                                   Bool upd, Bool vert, Bool horz)
+{
+  if ( m_pack ){
+    Smpl16 * tmp_pack = m_pack + ((tly-m_tly)*m_width) + (tlx-m_tlx);
+    if ( fwd ){
+      if ( horz )
+        DoTransformInternal(fwd,trn,width,height,True,tmp_pack,lift,pred,upd);
+      if ( vert )
+        DoTransformInternal(fwd,trn,width,height,False,tmp_pack,lift,pred,
+                            upd);
+    }
+    else { // inverse
+      if ( vert )
+        DoTransformInternal(fwd,trn,width,height,False,tmp_pack,lift,pred,
+                            upd);
+      if ( horz )
+        DoTransformInternal(fwd,trn,width,height,True,tmp_pack,lift,pred,upd);
+    }
+  }
+  else {
+    Smpl * tmp_data = &(m_rows[tly-m_tly][tlx-m_tlx]); 
+    if ( fwd ){
+      if ( horz )
+        DoTransformInternal(fwd,trn,width,height,True,tmp_data,lift,pred,upd);
+      if ( vert )
+        DoTransformInternal(fwd,trn,width,height,False,tmp_data,lift,pred,
+                            upd);
+    }
+    else { // inverse
+      if ( vert )
+        DoTransformInternal(fwd,trn,width,height,False,tmp_data,lift,pred,
+                            upd);
+      if ( horz )
+        DoTransformInternal(fwd,trn,width,height,True,tmp_data,lift,pred,upd);
+    }
+  }
+}
+
 SInt 
 HeatWaveComponent::DoPyramidTransform(EnumTransform trn, SInt lev, Bool fwd, 
                                       SInt cur)
@@ -739,6 +1019,10 @@ HeatWaveComponent::DoPyramidTransform(EnumTransform trn, SInt lev, Bool fwd,
     m_lev = cur;
   }
   
+  if ( m_tileW > 0 ){
+    return DoTiledTransform(trn, lev, fwd, m_pool);
+  }
+  
   if ( fwd ){
     if ( m_lev >= lev ){
       return m_lev;
@@ -965,16 +1249,42 @@ HeatWaveComponent::DoHE()
   }
 }
 
-Bool 
+Bool
 HeatWaveComponent::GetSubbandInfo ( SInt res, EnumSubband sub, 
                                     SInt & x, SInt & y, 
                                     SInt & width, SInt & height ) const
+{
+  if ( (res > 0) && (GetTileCount() > 1) ){
+    // there is a sub-band per tile
+    return False;
+  }
+  return GetSubbandArea(m_tlx, m_tly, m_width, m_height, res, sub, x, y,
+                        width, height);
+}
+
+Bool
+HeatWaveComponent::GetSubbandInfo ( SInt tile, SInt res, EnumSubband sub, 
+                                    SInt & x, SInt & y, 
+                                    SInt & width, SInt & height ) const
+{
+  SInt tlx, tly, wid, hei;
+  if ( !GetTileInfo(tile, tlx, tly, wid, hei) ){
+    return False;
+  }
+  return GetSubbandArea(tlx, tly, wid, hei, res, sub, x, y, width, height);
+}
+
+Bool
+HeatWaveComponent::GetSubbandArea(SInt tlx, SInt tly, SInt wid, SInt hei,
+                                  SInt res, EnumSubband sub, 
+                                  SInt & x, SInt & y, 
+                                  SInt & width, SInt & height)
 {
   ASSERT ( res >= 0 );
-  x = m_tlx;
-  y = m_tly;
-  width = m_width;
-  height = m_height;
+  x = tlx;
+  y = tly;
+  width = wid;
+  height = hei;
   
   if ( res == 0 ){
     return (sub == SubLL) ? True : False;
@@ -991,24 +1301,24 @@ HeatWaveComponent::GetSubbandInfo ( SInt res, EnumSubband sub,
   case SubLL:
     width = (width>>1) + (width%2);
     height = (height>>1) + (height%2);
-    x = m_tlx;
-    y = m_tly;
+    x = tlx;
+    y = tly;
     break;
   case SubHL:
-    x = m_tlx + (width>>1) + (width%2);
-    y = m_tly;
+    x = tlx + (width>>1) + (width%2);
+    y = tly;
     width = (width>>1);
     height = (height>>1) + (height%2);
     break;
   case SubLH:
-    x = m_tlx;
-    y = m_tly + (height>>1) + (height%2);
+    x = tlx;
+    y = tly + (height>>1) + (height%2);
     width = (width>>1) + (width%2);
     height = (height>>1);
     break;
   case SubHH:
-    x = m_tlx + (width>>1) + (width%2);
-    y = m_tly + (height>>1) + (height%2);
+    x = tlx + (width>>1) + (width%2);
+    y = tly + (height>>1) + (height%2);
     width = (width>>1);
     height = (height>>1);
     break;
@@ -1020,6 +1330,319 @@ HeatWaveComponent::GetSubbandInfo ( SInt res, EnumSubband sub,
   return True;
 }
 
+void
+HeatWaveComponent::SetTiling(SInt twd, SInt thg, HeatWaveWorkerPool * pool)
+{
+  if ( (twd <= 0) || (thg <= 0) ){
+    twd = thg = 0;
+  }
+  m_tileW = twd;
+  m_tileH = thg;
+  m_pool = pool;
+}
+
+SInt
+HeatWaveComponent::GetTileWidth() const
+{
+  return m_tileW;
+}
+
+SInt
+HeatWaveComponent::GetTileHeight() const
+{
+  return m_tileH;
+}
+
+SInt
+HeatWaveComponent::GetTileCount() const
+{
+  if ( m_tileW <= 0 ){
+    return 1;
+  }
+  return ( ((m_width+m_tileW-1)/m_tileW) * ((m_height+m_tileH-1)/m_tileH) );
+}
+
+Bool
+HeatWaveComponent::GetTileInfo(SInt tile, SInt & x, SInt & y, SInt & width,
+                               SInt & height) const
+{
+  if ( (tile < 0) || (tile >= GetTileCount()) ){
+    return False;
+  }
+  if ( m_tileW <= 0 ){
+    x = m_tlx;
+    y = m_tly;
+    width = m_width;
+    height = m_height;
+    return True;
+  }
+  SInt cols = (m_width+m_tileW-1)/m_tileW;
+  x = (tile%cols)*m_tileW;
+  y = (tile/cols)*m_tileH;
+  width = ((x+m_tileW) > m_width) ? (m_width-x) : m_tileW;
+  height = ((y+m_tileH) > m_height) ? (m_height-y) : m_tileH;
+  x += m_tlx;
+  y += m_tly;
+  return True;
+}
+
+Bool
+HeatWaveComponent::GetResolution(SInt res, HeatWaveComponent & out) const
+{
+  SInt x, y, width, height;
+  if ( (res < 0) || (res > m_lev) || 
+       !GetSubbandInfo(res, SubLL, x, y, width, height) ){
+    return False;
+  }
+  return GetRegion(res, m_tlx, m_tly, width, height, out);
+}
+
+Bool
+HeatWaveComponent::GetRegion(SInt res, SInt tlx, SInt tly, SInt width, 
+                             SInt height, HeatWaveComponent & out) const
+{
+  SInt x, y, llw, llh;
+  if ( (m_tileW > 0) || (res < 0) || (res > m_lev) || (width <= 0) || 
+       (height <= 0) || !GetSubbandInfo(res, SubLL, x, y, llw, llh) ){
+    return False;
+  }
+  tlx -= m_tlx;
+  tly -= m_tly;
+  if ( (tlx < 0) || (tly < 0) || ((tlx+width) > llw) || 
+       ((tly+height) > llh) ){
+    return False;
+  }
+  
+  // the windows needed at each level, top down
+  SInt levs = m_lev-res;
+  SInt * win = new SInt[(4*levs)+1];
+  LEAVEONNULL(win);
+  SInt xs = tlx, xe = tlx+width, ys = tly, ye = tly+height;
+  for ( SInt l = 0 ; l < levs ; ++l ){
+    GetSubbandInfo(res+l, SubLL, x, y, llw, llh);
+    xs = (xs > HEATWAVEROIMARGIN) ? (xs-HEATWAVEROIMARGIN) : 0;
+    ys = (ys > HEATWAVEROIMARGIN) ? (ys-HEATWAVEROIMARGIN) : 0;
+    xs -= (xs%2);
+    ys -= (ys%2);
+    xe = ((xe+HEATWAVEROIMARGIN) < llw) ? (xe+HEATWAVEROIMARGIN) : llw;
+    ye = ((ye+HEATWAVEROIMARGIN) < llh) ? (ye+HEATWAVEROIMARGIN) : llh;
+    win[(4*l)+0] = xs;
+    win[(4*l)+1] = ys;
+    win[(4*l)+2] = xe;
+    win[(4*l)+3] = ye;
+    // low pass samples needed by the next level
+    xs = xs>>1;
+    ys = ys>>1;
+    xe = (xe+1)>>1;
+    ye = (ye+1)>>1;
+  }
+  
+  // the LL samples of the deepest level
+  HeatWaveComponent * cur = new HeatWaveComponent(xs, ys, 1, 1, xe-xs, 
+                                                  ye-ys, True, m_prec, m_clr);
+  LEAVEONNULL(cur);
+  for ( SInt j = ys ; j < ye ; ++j ){
+    for ( SInt i = xs ; i < xe ; ++i ){
+      cur->SetSmpl(i, j, GetSmpl(m_tlx+i, m_tly+j));
+    }
+  }
+  
+  // inverse transform the windows, bottom up
+  for ( SInt l = levs-1 ; l >= 0 ; --l ){
+    SInt hlx, hly, lhx, lhy, hhx, hhy;
+    GetSubbandInfo(res+l+1, SubHL, hlx, hly, llw, llh);
+    GetSubbandInfo(res+l+1, SubLH, lhx, lhy, llw, llh);
+    GetSubbandInfo(res+l+1, SubHH, hhx, hhy, llw, llh);
+    xs = win[(4*l)+0];
+    ys = win[(4*l)+1];
+    xe = win[(4*l)+2];
+    ye = win[(4*l)+3];
+    SInt nlc = (xe-xs+1)>>1, nhc = (xe-xs)>>1;
+    SInt nlr = (ye-ys+1)>>1, nhr = (ye-ys)>>1;
+    SInt lx = xs>>1, ly = ys>>1;
+    
+    HeatWaveComponent * tmp = new HeatWaveComponent(xs, ys, 1, 1, xe-xs, 
+                                                    ye-ys, True, m_prec, 
+                                                    m_clr);
+    LEAVEONNULL(tmp);
+    for ( SInt j = 0 ; j < nlr ; ++j ){
+      for ( SInt i = 0 ; i < nlc ; ++i ){
+        tmp->SetSmpl(xs+i, ys+j, cur->GetSmpl(lx+i, ly+j));
+      }
+      for ( SInt i = 0 ; i < nhc ; ++i ){
+        tmp->SetSmpl(xs+nlc+i, ys+j, GetSmpl(hlx+lx+i, hly+ly+j));
+      }
+    }
+    for ( SInt j = 0 ; j < nhr ; ++j ){
+      for ( SInt i = 0 ; i < nlc ; ++i ){
+        tmp->SetSmpl(xs+i, ys+nlr+j, GetSmpl(lhx+lx+i, lhy+ly+j));
+      }
+      for ( SInt i = 0 ; i < nhc ; ++i ){
+        tmp->SetSmpl(xs+nlc+i, ys+nlr+j, GetSmpl(hhx+lx+i, hhy+ly+j));
+      }
+    }
+    tmp->DoTransform(False, m_trn, xs, ys, xe-xs, ye-ys, True, True, True, 
+                     True, False);
+    delete cur;
+    cur = tmp;
+  }
+  delete [] win;
+  
+  if ( (out.GetWidth() != width) || (out.GetHeight() != height) ){
+    out.SetSize(width, height);
+  }
+  out.SetTLX(m_tlx+tlx);
+  out.SetTLY(m_tly+tly);
+  out.SetColor(m_clr);
+  for ( SInt j = 0 ; j < height ; ++j ){
+    for ( SInt i = 0 ; i < width ; ++i ){
+      out.SetSmpl(m_tlx+tlx+i, m_tly+tly+j, cur->GetSmpl(tlx+i, tly+j));
+    }
+  }
+  delete cur;
+  out.SetTransformLevel(0);
+  out.SetMinPrecSgn();
+  return True;
+}
+
+/****************************************************************************/
+/**
+ ** Pyramid transform of a single tile, see HeatWaveComponent::DoTiledTransform.
+ **
+ **/
+
+class HeatWaveTileJob : public HeatWaveJob
+{
+public:
+  
+  void DoRun()
+  {
+    m_reached = m_cmp->DoTileTransform(m_lift, m_tile, m_trn, m_cur, m_lev, 
+                                       m_fwd);
+  }
+  
+  /** The component. */
+  HeatWaveComponent * m_cmp;
+  
+  /** The tile number. */
+  SInt m_tile;
+  
+  /** The transform type. */
+  EnumTransform m_trn;
+  
+  /** The current level. */
+  SInt m_cur;
+  
+  /** The level to transform to. */
+  SInt m_lev;
+  
+  /** Forward transform. */
+  Bool m_fwd;
+  
+  /** (Out) The level reached. */
+  SInt m_reached;
+  
+  /** Lifting buffers of this job. */
+  HeatWaveLift m_lift;
+};
+
+SInt
+HeatWaveComponent::DoTiledTransform(EnumTransform trn, SInt lev, Bool fwd,
+                                    HeatWaveWorkerPool * pool)
+{
+  if ( lev < 0 ){
+    lev = 0;
+  }
+  if ( fwd ? (m_lev >= lev) : (m_lev <= lev) ){
+    return m_lev;
+  }
+  if ( m_pack && fwd && 
+       !GetPackable(m_tlx, m_tly, m_width, m_height, trn, lev-m_lev) ){
+    // coefficients could outgrow 16-bits
+    DoUnpack();
+  }
+  // the tiles are written to from the pool threads
+  DoUnshare();
+  
+  SInt tiles = GetTileCount();
+  SInt reached = fwd ? m_lev : lev;
+  if ( pool == NULL ){
+    for ( SInt i = 0 ; i < tiles ; ++i ){
+      SInt tmp = DoTileTransform(m_lift, i, trn, m_lev, lev, fwd);
+      reached = (tmp > reached) ? tmp : reached;
+    }
+  }
+  else {
+    HeatWaveTileJob * jobs = new HeatWaveTileJob[tiles];
+    LEAVEONNULL(jobs);
+    // wait for these tiles only, this may itself be a job of the pool
+    SInt batch = 0;
+    for ( SInt i = 0 ; i < tiles ; ++i ){
+      jobs[i].m_cmp = this;
+      jobs[i].m_tile = i;
+      jobs[i].m_trn = trn;
+      jobs[i].m_cur = m_lev;
+      jobs[i].m_lev = lev;
+      jobs[i].m_fwd = fwd;
+      jobs[i].m_reached = 0;
+      pool->DoSubmit(&(jobs[i]), batch);
+    }
+    pool->DoWait(batch);
+    for ( SInt i = 0 ; i < tiles ; ++i ){
+      reached = (jobs[i].m_reached > reached) ? jobs[i].m_reached : reached;
+    }
+    delete [] jobs;
+  }
+  
+  m_lev = fwd ? reached : lev;
+  SetMinPrecSgn();
+  m_trn = trn;
+  return m_lev;
+}
+
+SInt
+HeatWaveComponent::DoTileTransform(HeatWaveLift & lift, SInt tile, 
+                                   EnumTransform trn, SInt cur, SInt lev, 
+                                   Bool fwd)
+{
+  SInt tlx, tly, wid, hei, x, y, width, height;
+  if ( !GetTileInfo(tile, tlx, tly, wid, hei) ){
+    return cur;
+  }
+  
+  if ( !fwd ){
+    cur = GetTileLevel(tile, cur);
+  }
+  
+  while ( fwd ? (cur < lev) : (cur > lev) ){
+    if ( !GetSubbandArea(tlx, tly, wid, hei, (cur-(fwd?0:1)), SubLL, x, y,
+                         width, height) || (width < 2) || (height < 2) ){
+      break;
+    }
+    DoTransformArea(lift, fwd, trn, x, y, width, height, True, True, True,
+                    True);
+    fwd ? ( ++cur ) : ( --cur );
+  }
+  return cur;
+}
+
+SInt
+HeatWaveComponent::GetTileLevel(SInt tile, SInt cur) const
+{
+  SInt tlx, tly, wid, hei, x, y, width, height;
+  if ( !GetTileInfo(tile, tlx, tly, wid, hei) ){
+    return 0;
+  }
+  // small tiles may not have reached the current level
+  SInt deep = 0;
+  while ( (deep < cur) && GetSubbandArea(tlx, tly, wid, hei, deep, SubLL,
+                                         x, y, width, height) &&
+          (width > 1) && (height > 1) ){
+    ++deep;
+  }
+  return deep;
+}
+
 HeatWaveComponent *
 HeatWaveComponent::GetClone()
 {
@@ -1042,8 +1665,6 @@ HeatWaveComponent::GetComparison(const HeatWaveComponent & other,
   SFloat64 mean = 0.0;
   SFloat64 max = 0.0;
   SFloat64 & sum = mean;
-  SFloat64 & peak = mean;
-  SFloat64 & diff = max;
   
   switch ( cmp ){
   case CmpPSNR:
@@ -1052,38 +1673,21 @@ HeatWaveComponent::GetComparison(const HeatWaveComponent & other,
     return (20.0 * log10(max/sqrt(mean)));
     break;
   case CmpMSE:   
-    for (SInt i = 0; i < m_size ;++i) {
-      diff = m_data[i] - other.m_data[i];
-      sum += (diff*diff);
-    }
+    sum = GetView().GetSquaredError(other.GetView());
     return sum / ((double) m_size);
     break;
   case CmpRMSE:
     return sqrt(GetComparison(other,CmpMSE));
     break;
   case CmpPAE:
-    for (SInt i = 0; i < m_size ;++i) {
-      diff = abs(m_data[i] - other.m_data[i]);
-      if (diff > peak) {
-        peak = diff;
-      }
-    }
-    return peak;
+    return GetView().GetPeakError(other.GetView());
     break;
   case CmpMAE:
-    for (SInt i = 0; i < m_size ;++i) {
-      diff = m_data[i] - other.m_data[i];
-      sum += fabs(diff);
-    }
+    sum = GetView().GetAbsoluteError(other.GetView());
     return sum / ((double) m_size);
     break;
   case CmpEqual:
-    for ( SInt i = 0 ; i < m_size ; ++ i ){
-      if ((m_data[i]) != (other.m_data[i])){
-        return 0;
-      }		    
-    }
-    return 1;
+    return GetView().IsEqual(other.GetView()) ? 1 : 0;
     break;
   default:
     ASSERT( False );
@@ -1093,28 +1697,45 @@ HeatWaveComponent::GetComparison(const HeatWaveComponent & other,
   return -1;
 }
 
-Smpl * 
-HeatWaveComponent::GetVector(SInt tlx, SInt tly, SInt width, SInt height) 
-  const
+HeatWaveView
+HeatWaveComponent::GetView(SInt tlx, SInt tly, SInt width, SInt height) const
 {
   if ( ! ((width > 0) && (height > 0) && 
           ValidateCoords ( tlx, tly ) && 
           ValidateCoords ( (tlx+width)-1, (tly+height)-1 ))){
-    return NULL;
+    return HeatWaveView();
   }
   
-  Smpl * ret = new Smpl[width*height];
-  LEAVEONNULL(ret);
-  
-  SInt i = 0;
-  for ( SInt y = tly ; y < (tly+height) ; ++ y ){
-    for ( SInt x = tlx ; x < (tlx+width) ; ++ x ){
-      ret[i] = GetSmpl(x,y);
-      i++;
-    }
+  SInt off = ((tly-m_tly)*m_width)+(tlx-m_tlx);
+  if ( m_pack ){
+    return HeatWaveView(m_pack+off, width, height, m_width);
   }
-  
-  return ret;
+  /* rows may not be owned, so go through them */
+  return HeatWaveView(&(m_rows[tly-m_tly][tlx-m_tlx]), width, height, 
+                      m_width);
+}
+
+HeatWaveView
+HeatWaveComponent::GetView(SInt res, EnumSubband sub) const
+{
+  SInt tlx = -1, tly = -1, width = 0, height = 0;
+  if ( !GetSubbandInfo(res,sub,tlx,tly,width,height)){
+    return HeatWaveView();
+  }
+  return GetView(tlx,tly,width,height);
+}
+
+HeatWaveView
+HeatWaveComponent::GetView() const
+{
+  return GetView(m_tlx,m_tly,m_width,m_height);
+}
+
+Smpl * 
+HeatWaveComponent::GetVector(SInt tlx, SInt tly, SInt width, SInt height) 
+  const
+{
+  return GetView(tlx,tly,width,height).GetCopy();
 }
 
 Smpl *
@@ -1154,13 +1775,7 @@ HeatWaveComponent::GetHistogram(SInt tlx, SInt tly, SInt width, SInt height,
     hist[i] = 0;
   }
 
-  for ( SInt y = tly ; y < (tly+height) ; ++ y ){
-    for ( SInt x = tlx ; x < (tlx+width) ; ++ x ){
-      //++(hist[GetSmpl(x,y)+offset]);
-      Smpl tmp = GetSmpl(x,y) + offset;
-      hist[tmp] += 1;
-    }
-  }  
+  GetView(tlx,tly,width,height).DoHistogram(hist, range, offset);
   return True;
 }
 
@@ -1180,6 +1795,7 @@ HeatWaveComponent::GetEntropy(SInt tlx, SInt tly, SInt width, SInt height)
   SInt range = 0;
   SInt shift = 0;
   SInt size = width * height;
+  HEATWAVEPROFILE(PrfEntropy, size, (SInt64)size*sizeof(Smpl));
   
   if ( !GetHistogram(tlx, tly, width, height, hist, range, shift) ){
     return -99;
@@ -1195,7 +1811,7 @@ HeatWaveComponent::GetEntropy(SInt tlx, SInt tly, SInt width, SInt height)
     }
   }
   
-  delete hist;
+  delete [] hist;
   if ( ret ){
     return -ret;
   }
@@ -1228,7 +1844,7 @@ HeatWaveComponent::WriteIII(const Char * name, FILE * file) const
   fprintf(file,IIIHEADER, width, height, ColorName(GetColor()), precision, 
           is_signed? IIITRUE : IIIFALSE);
   for ( SInt i = 0 ; i < GetSize() ; ++i ){
-    fprintf(file, IIISAMPLEOUT, (m_data[i]));
+    fprintf(file, IIISAMPLEOUT, (GetSmplAt(i)));
   }
   return file;
 }
@@ -1322,6 +1938,9 @@ HeatWaveComponent::ValidateSample(SInt dat) const
 HeatWaveComponent & 
 HeatWaveComponent::operator=(const HeatWaveComponent & rhs)
 {
+  if ( this == &rhs ){
+    return (*this);
+  }
   ASSERT ( ValidateSanity() );
   ASSERT ( rhs.ValidateSanity() );
   DoDestroy();
@@ -1353,7 +1972,7 @@ HeatWaveComponent::operator==(const HeatWaveComponent & rhs ) const
     
   if ( ret ) {
     for ( SInt i = 0 ; i < m_size ; ++ i ){
-      ret &= (m_data[i] == rhs.m_data[i]);
+      ret &= (GetSmplAt(i) == rhs.GetSmplAt(i));
     }
   }
   
@@ -1363,6 +1982,8 @@ HeatWaveComponent::operator==(const HeatWaveComponent & rhs ) const
 Smpl 
 HeatWaveComponent::operator|=(Smpl mask)
 {
+  DoUnpack();
+  DoUnshare();
   for ( SInt i = 0 ; i < m_size ; ++ i ){
     m_data[i] |= mask;
   }
@@ -1372,6 +1993,8 @@ HeatWaveComponent::operator|=(Smpl mask)
 Smpl 
 HeatWaveComponent::operator^=(Smpl mask)
 {
+  DoUnpack();
+  DoUnshare();
   for ( SInt i = 0 ; i < (m_height*m_width) ; ++ i ){
     m_data[i] ^= mask;
   }
@@ -1381,6 +2004,8 @@ HeatWaveComponent::operator^=(Smpl mask)
 Smpl 
 HeatWaveComponent::operator&=(Smpl mask)
 {
+  DoUnpack();
+  DoUnshare();
   for ( SInt i = 0 ; i < (m_height*m_width) ; ++ i ){
     m_data[i] &= mask;
   }
@@ -1390,6 +2015,8 @@ HeatWaveComponent::operator&=(Smpl mask)
 Smpl 
 HeatWaveComponent::operator+=(Smpl val)
 {
+  DoUnpack();
+  DoUnshare();
   for ( SInt i = 0 ; i < m_size ; ++ i ){
     m_data[i] += val;
   }
@@ -1399,6 +2026,8 @@ HeatWaveComponent::operator+=(Smpl val)
 Smpl 
 HeatWaveComponent::operator-=(Smpl val)
 {
+  DoUnpack();
+  DoUnshare();
   for ( SInt i = 0 ; i < m_size ; ++ i ){
     m_data[i] -= val;
   }
@@ -1422,30 +2051,41 @@ HeatWaveComponent::ValidateSanity() const
   ret &= ( m_size == (m_height*m_width) );
   ret &= ( m_height > 0 );
   ret &= ( m_width > 0 );
-  ret &= ( m_data != NULL );
-  ret &= ( m_rows != NULL );
+  ret &= ( ((m_data != NULL) && (m_rows != NULL)) || (m_pack != NULL) );
   
   if ( ret ){
     for ( SInt i = 0 ; i < m_size ; ++i ){
-      ret &= ValidateSample(m_data[i]);
+      ret &= ValidateSample(GetSmplAt(i));
     }
   }
   
   return ret;
 }
 
+Smpl
+HeatWaveComponent::GetSmplAt(SInt off) const
+{
+  ASSERT ( (off >= 0) && (off < m_size) );
+  if ( m_pack ){
+    return m_pack[off];
+  }
+  return m_data[off];
+}
+
+template <class T>
 void 
 HeatWaveComponent::DoTransformInternal(Bool fwd, EnumTransform trn, SInt wid, 
-                                       SInt hei, Bool hor, Smpl * mem, 
-                                       Bool prd, Bool upd)
+                                       SInt hei, Bool hor, T * mem, 
+                                       HeatWaveLift & lift, Bool prd, Bool upd)
 {
   SInt inter_step, intra_step, nsteps, length;
   void (HeatWaveLift::*func[HEATWAVELIFTMAXSTEPS])
-    (Smpl *, Smpl *, SInt, SInt, Bool)const;
-  Smpl * data = mem;
-  Smpl * even;
-  Smpl * odd;
+    (T *, T *, SInt, SInt, Bool)const;
+  T * data = mem;
+  T * even;
+  T * odd;
   Smpl even_len;
+  HEATWAVEPROFILE(PrfTransform, (SInt64)wid*hei, (SInt64)wid*hei*2*sizeof(T));
 
   if ( hor ){ 
     // horizontal transform
@@ -1464,24 +2104,46 @@ HeatWaveComponent::DoTransformInternal(Bool fwd, EnumTransform trn, SInt wid,
     even_len = ((hei>>1) + (hei%2))*m_width; 
   }
   
-  SInt j = m_lift.GetFuncArray(func,trn,fwd,prd,upd);
+  SInt j = lift.GetFuncArray(func,trn,fwd,prd,upd);
+
+  if ( !hor && HeatWaveLift::HasRowKernels(trn) ){
+    // lift all columns a row at a time rather than one column at a time
+    if ( fwd ){
+      lift.SplitRows(data, length, nsteps, intra_step);
+    }
+    {
+      HEATWAVEPROFILE(PrfLift, (SInt64)length*nsteps,
+                      (SInt64)length*nsteps*2*j*sizeof(T));
+      for ( SInt n = 0; n < j ; ++n ){
+        lift.DoLiftColumns(func[n], data, data+even_len, length, intra_step,
+                           nsteps, fwd);
+      }
+    }
+    if ( !fwd ){
+      lift.JoinRows(data, length, nsteps, intra_step);
+    }
+    return;
+  }
   
   // Perform the transform
   for ( SInt i = 0 ; i < nsteps ; ++ i){
     if ( fwd ){
-      m_lift.Split(data, length, intra_step, even, odd);
+      lift.Split(data, length*intra_step, intra_step, even, odd);
     }
     else{
       even = data;
       odd = data + even_len;
     }
     
-    for ( SInt n = 0; n < j ; ++n ){
-      (m_lift.*func[n])(even,odd,length,intra_step,fwd);
+    {
+      HEATWAVEPROFILE(PrfLift, length, (SInt64)length*2*j*sizeof(T));
+      for ( SInt n = 0; n < j ; ++n ){
+        (lift.*func[n])(even,odd,length,intra_step,fwd);
+      }
     }
     
     if ( !fwd ){
-      m_lift.Join(data,length,intra_step);
+      lift.Join(data,length*intra_step,intra_step);
     }
     data+=inter_step;
   }
@@ -1560,11 +2222,17 @@ HeatWaveComponent::DoCreate(SInt width, SInt height, Bool set, Smpl def,
   m_data = new Smpl[width*height];
   m_rows = new Smpl*[height];
   m_size = width*height;
+  m_capacity = m_size;
+  m_rowCapacity = height;
   m_width = width;
   m_height = height;
   
   LEAVEONNULL(m_data);
   LEAVEONNULL(m_rows);
+  HEATWAVECOUNT(PrfAlloc, m_size,
+                (SInt64)m_size*sizeof(Smpl)+height*sizeof(Smpl*));
+  HeatWaveMemory::AddBytes(MemPlanes, (SInt64)m_size*sizeof(Smpl));
+  HeatWaveMemory::AddBytes(MemRows, (SInt64)height*sizeof(Smpl*));
   
   if ( set ) {
     for ( SInt i = 0; i < m_size; ++i ){
@@ -1579,6 +2247,30 @@ HeatWaveComponent::DoCreate(SInt width, SInt height, Bool set, Smpl def,
 void 
 HeatWaveComponent::DoDestroy()
 {
+  SInt cap = m_capacity;
+  SInt rowCap = m_rowCapacity;
+  m_capacity = 0;
+  m_rowCapacity = 0;
+  if ( !DoDropRef(m_refs) ){
+    // still used by a copy
+    m_refs = NULL;
+    m_pack = NULL;
+    m_data = NULL;
+    m_rows = NULL;
+    return;
+  }
+  m_refs = NULL;
+  
+  // the packed store is always owned
+  if ( m_pack ){
+    HeatWaveMemory::SubBytes(MemPlanes, (SInt64)m_size*sizeof(Smpl16));
+  }
+  delete [] m_pack;
+  m_pack = NULL;
+  // storage not ours to delete is no longer ours to account for either
+  HeatWaveMemory::SubBytes(MemPlanes, (SInt64)cap*sizeof(Smpl));
+  HeatWaveMemory::SubBytes(MemRows, (SInt64)rowCap*sizeof(Smpl*));
+  
   if (!m_desMem){
     return;
   }
@@ -1592,11 +2284,161 @@ HeatWaveComponent::DoDestroy()
 void 
 HeatWaveComponent::DoCopy(const HeatWaveComponent & rhs)
 {  
-  memcpy((char*)this,(char*)&rhs,sizeof(HeatWaveComponent));
+  // the lift keeps its own buffer, it holds nothing between transforms
+  m_tlx = rhs.m_tlx;
+  m_tly = rhs.m_tly;
+  m_hstep = rhs.m_hstep;
+  m_vstep = rhs.m_vstep;
+  m_width = rhs.m_width;
+  m_height = rhs.m_height;
+  m_sgnd = rhs.m_sgnd;
+  m_prec = rhs.m_prec;
+  m_clr = rhs.m_clr;
+  m_trn = rhs.m_trn;
+  m_lev = rhs.m_lev;
+  m_desMem = rhs.m_desMem;
+  m_size = rhs.m_size;
+  m_data = rhs.m_data;
+  m_rows = rhs.m_rows;
+  m_pack = rhs.m_pack;
+  m_capacity = rhs.m_capacity;
+  m_rowCapacity = rhs.m_rowCapacity;
+  m_tileW = rhs.m_tileW;
+  m_tileH = rhs.m_tileH;
+  m_pool = rhs.m_pool;
+  m_refs = NULL;
+  if ( rhs.m_pack || (rhs.m_desMem && rhs.m_data) ){
+    // share the storage, the count is made on the first copy
+    HeatWaveComponent & src = const_cast<HeatWaveComponent&>(rhs);
+    if ( src.m_refs == NULL ){
+      SInt * refs = new SInt(1);
+      LEAVEONNULL(refs);
+      if ( !AtomicSwap(&(src.m_refs), (SInt*)NULL, refs) ){
+        delete refs;
+      }
+    }
+    AtomicAdd(src.m_refs, 1);
+    m_refs = src.m_refs;
+    m_desMem = True;
+    return;
+  }
   m_data = NULL;
   m_rows = NULL;
+  m_pack = NULL;
+  if ( rhs.m_data == NULL ){
+    return;
+  }
+  // memory managed else where, so copy it
   DoCreate(m_width,m_height,False,0);
   for ( SInt i = 0 ; i < (m_height*m_width) ; ++ i ){
     m_data[i] = rhs.m_data[i];
   }
 }
+
+SInt
+HeatWaveComponent::GetOctaves(SInt from, SInt to)
+{
+  SInt oct = 0;
+  for ( ; from < to ; from <<= 1 ){
+    ++oct;
+  }
+  for ( ; to < from ; to <<= 1 ){
+    --oct;
+  }
+  return oct;
+}
+
+Bool
+HeatWaveComponent::DoDropRef(SInt * refs)
+{
+  if ( refs == NULL ){
+    return True;
+  }
+  if ( AtomicAdd(refs, -1) > 0 ){
+    return False;
+  }
+  delete refs;
+  return True;
+}
+
+void
+HeatWaveComponent::DoRelayout(SInt width, SInt height, Smpl def)
+{
+  ASSERT ( m_desMem && (m_refs == NULL) && (m_pack == NULL) );
+  ASSERT ( (width*height) <= m_capacity );
+  SInt minW = HeatWaveMath::Min(width, m_width);
+  SInt minH = HeatWaveMath::Min(height, m_height);
+  SInt size = width*height;
+  
+  if ( width <= m_width ){
+    // rows move towards the start, first row first
+    for ( SInt y = 1 ; y < minH ; ++y ){
+      memmove(m_data+(y*width), m_data+(y*m_width), minW*sizeof(Smpl));
+    }
+  }
+  else {
+    // rows move towards the end, last row first
+    for ( SInt y = minH-1 ; y >= 0 ; --y ){
+      Smpl * row = m_data+(y*width);
+      memmove(row, m_data+(y*m_width), minW*sizeof(Smpl));
+      for ( SInt x = minW ; x < width ; ++x ){
+        row[x] = def;
+      }
+    }
+  }
+  for ( SInt i = (minH*width) ; i < size ; ++i ){
+    m_data[i] = def;
+  }
+  
+  if ( height > m_rowCapacity ){
+    HeatWaveMemory::SubBytes(MemRows, (SInt64)m_rowCapacity*sizeof(Smpl*));
+    delete [] m_rows;
+    m_rows = new Smpl*[height];
+    LEAVEONNULL(m_rows);
+    HeatWaveMemory::AddBytes(MemRows, (SInt64)height*sizeof(Smpl*));
+    m_rowCapacity = height;
+  }
+  m_width = width;
+  m_height = height;
+  m_size = size;
+  SetRowPtrs();
+}
+
+void
+HeatWaveComponent::DoRelocate(SInt width, SInt height, SInt cap, Smpl def,
+                              Bool desMem)
+{
+  ASSERT ( m_pack == NULL );
+  ASSERT ( cap >= (width*height) );
+  SInt minW = HeatWaveMath::Min(width, m_width);
+  SInt minH = HeatWaveMath::Min(height, m_height);
+  Smpl * data = new Smpl[cap];
+  Smpl ** rows = new Smpl*[height];
+  LEAVEONNULL(data);
+  LEAVEONNULL(rows);
+  HEATWAVECOUNT(PrfAlloc, cap, (SInt64)cap*sizeof(Smpl)+height*sizeof(Smpl*));
+  HeatWaveMemory::AddBytes(MemPlanes, (SInt64)cap*sizeof(Smpl));
+  HeatWaveMemory::AddBytes(MemRows, (SInt64)height*sizeof(Smpl*));
+  
+  for ( SInt y = 0 ; y < minH ; ++y ){
+    Smpl * row = data+(y*width);
+    memcpy(row, m_rows[y], minW*sizeof(Smpl));
+    for ( SInt x = minW ; x < width ; ++x ){
+      row[x] = def;
+    }
+  }
+  for ( SInt i = (minH*width) ; i < (width*height) ; ++i ){
+    data[i] = def;
+  }
+  
+  DoDestroy();
+  m_data = data;
+  m_rows = rows;
+  m_capacity = cap;
+  m_rowCapacity = height;
+  m_width = width;
+  m_height = height;
+  m_size = width*height;
+  m_desMem = desMem;
+  SetRowPtrs();
+}
@@ -0,0 +1,445 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveDigest.cpp
+ ** @brief  Contains the HeatWaveDigest class definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveDigest.hpp"
+#include "HeatWaveProfiler.hpp"
+
+/****************************************************************************/
+/* xxHash64, see https://github.com/Cyan4973/xxHash                          */
+
+#define XXH_P(hi,lo) ((((UInt64)(hi))<<32)|(UInt64)(lo))
+
+static const UInt64 glob_xxhP1 = XXH_P(0x9E3779B1,0x85EBCA87);
+static const UInt64 glob_xxhP2 = XXH_P(0xC2B2AE3D,0x27D4EB4F);
+static const UInt64 glob_xxhP3 = XXH_P(0x165667B1,0x9E3779F9);
+static const UInt64 glob_xxhP4 = XXH_P(0x85EBCA77,0xC2B2AE63);
+static const UInt64 glob_xxhP5 = XXH_P(0x27D4EB2F,0x165667C5);
+
+static inline UInt64
+GetRotl64(UInt64 val, SInt bits)
+{
+  return (val << bits) | (val >> (64-bits));
+}
+
+static inline UInt64
+GetRead64(const UInt8 * ptr)
+{
+  // little endian, as the reference
+  UInt64 val = 0;
+  for ( SInt i = 7 ; i >= 0 ; --i ){
+    val = (val << 8) | ptr[i];
+  }
+  return val;
+}
+
+static inline UInt32
+GetRead32(const UInt8 * ptr)
+{
+  return ((UInt32)ptr[0]) | ((UInt32)ptr[1] << 8) |
+    ((UInt32)ptr[2] << 16) | ((UInt32)ptr[3] << 24);
+}
+
+static inline UInt64
+GetXXHRound(UInt64 acc, UInt64 val)
+{
+  acc += val*glob_xxhP2;
+  acc = GetRotl64(acc,31);
+  return acc*glob_xxhP1;
+}
+
+static inline UInt64
+GetXXHMerge(UInt64 acc, UInt64 val)
+{
+  acc ^= GetXXHRound(0,val);
+  return acc*glob_xxhP1 + glob_xxhP4;
+}
+
+UInt64
+HeatWaveDigest::GetXXH64(const UInt8 * data, SInt len, UInt64 seed)
+{
+  const UInt8 * ptr = data;
+  const UInt8 * end = data+len;
+  UInt64 h = 0;
+  if ( len >= 32 ){
+    UInt64 v1 = seed + glob_xxhP1 + glob_xxhP2;
+    UInt64 v2 = seed + glob_xxhP2;
+    UInt64 v3 = seed;
+    UInt64 v4 = seed - glob_xxhP1;
+    const UInt8 * lim = end-32;
+    do {
+      v1 = GetXXHRound(v1, GetRead64(ptr));
+      v2 = GetXXHRound(v2, GetRead64(ptr+8));
+      v3 = GetXXHRound(v3, GetRead64(ptr+16));
+      v4 = GetXXHRound(v4, GetRead64(ptr+24));
+      ptr += 32;
+    } while ( ptr <= lim );
+    h = GetRotl64(v1,1) + GetRotl64(v2,7) + GetRotl64(v3,12) +
+      GetRotl64(v4,18);
+    h = GetXXHMerge(h,v1);
+    h = GetXXHMerge(h,v2);
+    h = GetXXHMerge(h,v3);
+    h = GetXXHMerge(h,v4);
+  }
+  else {
+    h = seed + glob_xxhP5;
+  }
+  h += (UInt64)len;
+  while ( (ptr+8) <= end ){
+    h ^= GetXXHRound(0, GetRead64(ptr));
+    h = GetRotl64(h,27)*glob_xxhP1 + glob_xxhP4;
+    ptr += 8;
+  }
+  if ( (ptr+4) <= end ){
+    h ^= (UInt64)GetRead32(ptr)*glob_xxhP1;
+    h = GetRotl64(h,23)*glob_xxhP2 + glob_xxhP3;
+    ptr += 4;
+  }
+  while ( ptr < end ){
+    h ^= (*ptr)*glob_xxhP5;
+    h = GetRotl64(h,11)*glob_xxhP1;
+    ++ptr;
+  }
+  h ^= h >> 33;
+  h *= glob_xxhP2;
+  h ^= h >> 29;
+  h *= glob_xxhP3;
+  h ^= h >> 32;
+  return h;
+}
+
+/****************************************************************************/
+/* CRC32C                                                                   */
+
+/** The reflected Castagnoli polynomial. */
+#define CRC32C_POLY 0x82F63B78
+
+static UInt32 glob_crcTable[256];
+static CommonOnce glob_crcOnce = COMMONONCEINIT;
+
+static void
+DoCRC32CTable()
+{
+  for ( UInt32 i = 0 ; i < 256 ; ++i ){
+    UInt32 crc = i;
+    for ( SInt b = 0 ; b < 8 ; ++b ){
+      crc = (crc & 1) ? ((crc >> 1) ^ CRC32C_POLY) : (crc >> 1);
+    }
+    glob_crcTable[i] = crc;
+  }
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HEATWAVECRC32CSSE42
+
+/** CRC32C with the SSE4.2 crc32 instruction, 8 bytes at a time. */
+__attribute__((target("sse4.2"))) static UInt32
+GetCRC32CSSE42(const UInt8 * data, SInt len, UInt32 crc)
+{
+  UInt64 c = crc;
+  while ( (len > 0) && (((size_t)data) & 7) ){
+    c = __builtin_ia32_crc32qi((UInt32)c, *data++);
+    --len;
+  }
+  while ( len >= 8 ){
+    UInt64 val;
+    memcpy(&val, data, 8);
+    c = __builtin_ia32_crc32di(c, val);
+    data += 8;
+    len -= 8;
+  }
+  while ( len > 0 ){
+    c = __builtin_ia32_crc32qi((UInt32)c, *data++);
+    --len;
+  }
+  return (UInt32)c;
+}
+
+#endif
+
+UInt32
+HeatWaveDigest::GetCRC32C(const UInt8 * data, SInt len, UInt32 crc)
+{
+  crc = ~crc;
+#ifdef HEATWAVECRC32CSSE42
+  if ( __builtin_cpu_supports("sse4.2") ){
+    return ~GetCRC32CSSE42(data, len, crc);
+  }
+#endif
+  RunOnce(&glob_crcOnce, DoCRC32CTable);
+  for ( SInt i = 0 ; i < len ; ++i ){
+    crc = glob_crcTable[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+/****************************************************************************/
+
+void
+HeatWaveDigest::DoXXH64(const UInt8 * data, SInt len, UInt8 * out)
+{
+  UInt64 h = GetXXH64(data, len);
+  for ( SInt i = 7 ; i >= 0 ; --i ){
+    out[i] = (UInt8)h;
+    h >>= 8;
+  }
+}
+
+void
+HeatWaveDigest::DoCRC32C(const UInt8 * data, SInt len, UInt8 * out)
+{
+  UInt32 crc = GetCRC32C(data, len);
+  for ( SInt i = 3 ; i >= 0 ; --i ){
+    out[i] = (UInt8)crc;
+    crc >>= 8;
+  }
+}
+
+void
+HeatWaveDigest::GetHex(const UInt8 * dig, SInt size, Char * hex)
+{
+  for ( SInt i = 0 ; i < size ; ++i ){
+    sprintf(hex+2*i,"%.2x",dig[i]);
+  }
+  hex[2*size] = '\0';
+}
+
+/****************************************************************************/
+
+/** The bytes each sample is hashed as, a little endian 32 bit integer. */
+static const SInt glob_digestSmplBytes = 4;
+
+/** The bytes of the header hashed with the leaves of a component. */
+static const SInt glob_digestHeadBytes = 32;
+
+static void
+DoPutLE32(UInt8 * ptr, UInt32 val)
+{
+  ptr[0] = (UInt8)val;
+  ptr[1] = (UInt8)(val >> 8);
+  ptr[2] = (UInt8)(val >> 16);
+  ptr[3] = (UInt8)(val >> 24);
+}
+
+/** True if the samples are held as they are hashed. */
+static Bool
+IsHashOrder()
+{
+  const UInt32 one = 1;
+  return ( (sizeof(Smpl) == 4) && (*(const UInt8*)&one == 1) );
+}
+
+/****************************************************************************/
+/**
+ ** Hashes one leaf, a band of rows of a component.
+ **
+ **/
+
+class HeatWaveLeafJob : public HeatWaveJob
+{
+public:
+
+  HeatWaveLeafJob()
+  {
+  }
+
+  void DoRun()
+  {
+    HEATWAVEPROFILE(PrfDigest, m_rows*m_view.GetWidth(),
+                    (SInt64)m_rows*m_view.GetWidth()*sizeof(Smpl));
+    SInt width = m_view.GetWidth();
+    SInt rowb = width*glob_digestSmplBytes;
+    if ( IsHashOrder() && !m_view.IsPacked() && (m_view.GetPitch() == width) ){
+      // the band is in one piece, as it is hashed
+      m_fn((const UInt8*)m_view.GetRow(m_y), m_rows*rowb, m_out);
+      return;
+    }
+    UInt8 * buf = new UInt8[m_rows*rowb];
+    Smpl * smpl = new Smpl[width];
+    LEAVEONNULL(buf);
+    LEAVEONNULL(smpl);
+    for ( SInt y = 0 ; y < m_rows ; ++y ){
+      const Smpl * row = m_view.GetRow(m_y+y, smpl);
+      UInt8 * out = buf+y*rowb;
+      for ( SInt x = 0 ; x < width ; ++x ){
+        DoPutLE32(out+x*glob_digestSmplBytes, (UInt32)(SInt32)row[x]);
+      }
+    }
+    m_fn(buf, m_rows*rowb, m_out);
+    delete [] smpl;
+    delete [] buf;
+  }
+
+  /** The samples of the component. */
+  HeatWaveView m_view;
+
+  /** The first row. */
+  SInt m_y;
+
+  /** The number of rows. */
+  SInt m_rows;
+
+  /** The hash function. */
+  HeatWaveHashFunction m_fn;
+
+  /** The digest. */
+  UInt8 * m_out;
+};
+
+/****************************************************************************/
+
+HeatWaveDigest::HeatWaveDigest(HeatWaveHashFunction fn, SInt size,
+                               SInt chunk)
+{
+  ASSERT ( (fn != NULL) && (size > 0) && (chunk > 0) );
+  m_fn = fn;
+  m_size = size;
+  m_chunk = chunk;
+  m_frames = NULL;
+  m_framen = 0;
+  m_root = new UInt8[size];
+  LEAVEONNULL(m_root);
+  memset((char*)m_root,0,size);
+}
+
+HeatWaveDigest::~HeatWaveDigest()
+{
+  delete [] m_frames;
+  delete [] m_root;
+}
+
+void
+HeatWaveDigest::DoDigest(const HeatWaveVideo & vid, HeatWaveWorkerPool * pool)
+{
+  delete [] m_frames;
+  m_framen = vid.GetImageN();
+  m_frames = new UInt8[(m_framen > 0 ? m_framen : 1)*m_size];
+  LEAVEONNULL(m_frames);
+
+  // count the leaves, at least one row each
+  SInt leafn = 0, cmpn = 0;
+  for ( SInt i = 0 ; i < m_framen ; ++i ){
+    HeatWaveImage & img = vid.GetImage(i);
+    for ( SInt c = 0 ; c < img.GetComponentN() ; ++c ){
+      HeatWaveComponent & cmp = img.GetComponent(c);
+      SInt rowb = cmp.GetWidth()*glob_digestSmplBytes;
+      SInt rows = (rowb > 0) ? ((m_chunk/rowb > 0) ? m_chunk/rowb : 1) : 1;
+      leafn += (cmp.GetHeight()+rows-1)/rows;
+      ++cmpn;
+    }
+  }
+  HeatWaveLeafJob * jobs = new HeatWaveLeafJob[leafn > 0 ? leafn : 1];
+  UInt8 * leaves = new UInt8[(leafn > 0 ? leafn : 1)*m_size];
+  UInt8 * cmps = new UInt8[(cmpn > 0 ? cmpn : 1)*m_size];
+  LEAVEONNULL(jobs);
+  LEAVEONNULL(leaves);
+  LEAVEONNULL(cmps);
+
+  // hash the leaves, the video is only read
+  SInt leaf = 0;
+  for ( SInt i = 0 ; i < m_framen ; ++i ){
+    HeatWaveImage & img = vid.GetImage(i);
+    for ( SInt c = 0 ; c < img.GetComponentN() ; ++c ){
+      const HeatWaveComponent & cmp = img.GetComponent(c);
+      if ( (cmp.GetWidth() <= 0) || (cmp.GetHeight() <= 0) ){
+        continue;
+      }
+      SInt rowb = cmp.GetWidth()*glob_digestSmplBytes;
+      SInt rows = (m_chunk/rowb > 0) ? m_chunk/rowb : 1;
+      HeatWaveView view = cmp.GetView();
+      for ( SInt y = 0 ; y < cmp.GetHeight() ; y += rows ){
+        HeatWaveLeafJob & job = jobs[leaf];
+        job.m_view = view;
+        job.m_y = y;
+        job.m_rows = ((y+rows) <= cmp.GetHeight()) ? rows : cmp.GetHeight()-y;
+        job.m_fn = m_fn;
+        job.m_out = leaves+leaf*m_size;
+        if ( pool ){
+          pool->DoSubmit(&job);
+        }
+        else {
+          job.DoRun();
+        }
+        ++leaf;
+      }
+    }
+  }
+  if ( pool ){
+    pool->DoWait();
+  }
+
+  // and combine them up to the root
+  leaf = 0;
+  for ( SInt i = 0 ; i < m_framen ; ++i ){
+    HeatWaveImage & img = vid.GetImage(i);
+    for ( SInt c = 0 ; c < img.GetComponentN() ; ++c ){
+      const HeatWaveComponent & cmp = img.GetComponent(c);
+      SInt num = 0;
+      if ( (cmp.GetWidth() > 0) && (cmp.GetHeight() > 0) ){
+        SInt rowb = cmp.GetWidth()*glob_digestSmplBytes;
+        SInt rows = (m_chunk/rowb > 0) ? m_chunk/rowb : 1;
+        num = (cmp.GetHeight()+rows-1)/rows;
+      }
+      DoCombine(cmp, leaves+leaf*m_size, num, cmps+c*m_size);
+      leaf += num;
+    }
+    DoCombine(cmps, img.GetComponentN(), m_frames+i*m_size);
+  }
+  DoCombine(m_frames, m_framen, m_root);
+
+  delete [] jobs;
+  delete [] leaves;
+  delete [] cmps;
+}
+
+void
+HeatWaveDigest::DoCombine(const UInt8 * digs, SInt num, UInt8 * out) const
+{
+  m_fn(digs, num*m_size, out);
+}
+
+void
+HeatWaveDigest::DoCombine(const HeatWaveComponent & cmp, const UInt8 * digs,
+                          SInt num, UInt8 * out) const
+{
+  UInt8 * buf = new UInt8[glob_digestHeadBytes+num*m_size];
+  LEAVEONNULL(buf);
+  SInt vals[8] = {cmp.GetTLX(), cmp.GetTLY(), cmp.GetWidth(),
+                  cmp.GetHeight(), cmp.GetHStep(), cmp.GetVStep(),
+                  cmp.GetPrec(), cmp.GetSgnd() ? 1 : 0};
+  for ( SInt i = 0 ; i < 8 ; ++i ){
+    DoPutLE32(buf+4*i, (UInt32)vals[i]);
+  }
+  memcpy(buf+glob_digestHeadBytes, digs, num*m_size);
+  m_fn(buf, glob_digestHeadBytes+num*m_size, out);
+  delete [] buf;
+}
+
+SInt
+HeatWaveDigest::GetSize() const
+{
+  return m_size;
+}
+
+SInt
+HeatWaveDigest::GetFrameN() const
+{
+  return m_framen;
+}
+
+const UInt8 *
+HeatWaveDigest::GetFrame(SInt num) const
+{
+  ASSERT ( (num >= 0) && (num < m_framen) );
+  return m_frames+num*m_size;
+}
+
+const UInt8 *
+HeatWaveDigest::GetRoot() const
+{
+  return m_root;
+}
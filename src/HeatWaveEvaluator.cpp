@@ -0,0 +1,541 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveEvaluator.cpp
+ ** @brief  Contains the HeatWaveEvaluator class definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveEvaluator.hpp"
+#include "HeatWaveProfiler.hpp"
+
+/****************************************************************************/
+/**
+ ** Transforms a copy of one component with one transform up to the highest
+ ** level, scoring the sub-bands at each step on the way.
+ **
+ **/
+
+class HeatWaveScoreJob : public HeatWaveJob
+{
+public:
+
+  HeatWaveScoreJob(const HeatWaveComponent & cmp, SInt trn, SInt cmpn,
+                   EnumTransform type, SInt levMax, SInt stpn,
+                   const SFloat64 * steps, const SFloat64 * norms)
+  {
+    // shares the samples until the transform writes
+    m_cmp = new HeatWaveComponent(cmp);
+    LEAVEONNULL(m_cmp);
+    m_trn = trn;
+    m_cmpn = cmpn;
+    m_type = type;
+    m_levMax = levMax;
+    m_stpn = stpn;
+    m_steps = steps;
+    m_norms = norms;
+    m_reached = -1;
+    m_ll = new HeatWaveScore[stpn*(levMax+1)];
+    LEAVEONNULL(m_ll);
+    memset((char*)m_ll,0,stpn*(levMax+1)*sizeof(HeatWaveScore));
+    m_det = new HeatWaveScore[stpn*((3*levMax)+1)];
+    LEAVEONNULL(m_det);
+    memset((char*)m_det,0,stpn*((3*levMax)+1)*sizeof(HeatWaveScore));
+  }
+
+  ~HeatWaveScoreJob()
+  {
+    delete m_cmp;
+    delete [] m_ll;
+    delete [] m_det;
+  }
+
+  void DoRun()
+  {
+    HeatWaveComponent & cmp = *m_cmp;
+    if ( cmp.GetTransformLevel() > 0 ){
+      cmp.DoPyramidTransform(cmp.GetTransformType(), 0, False);
+    }
+    cmp.SetTiling(0, 0);
+    DoScore(0, SubLL, m_ll, m_levMax+1);
+    m_reached = 0;
+    for ( SInt lev = 1 ; lev <= m_levMax ; ++lev ){
+      if ( cmp.DoPyramidTransform(m_type, lev) != lev ){
+        break;
+      }
+      for ( SInt s = SubHL ; s <= SubHH ; ++s ){
+        DoScore(lev, (EnumSubband)s, m_det+(3*(lev-1))+(s-SubHL),
+                (3*m_levMax)+1);
+      }
+      DoScore(lev, SubLL, m_ll+lev, m_levMax+1);
+      m_reached = lev;
+    }
+    // the copy is no longer needed, free it before the other jobs run
+    delete m_cmp;
+    m_cmp = NULL;
+  }
+
+  /**
+   *
+   * Score a sub-band of the copy at each step.
+   *
+   * @param res The resolution level.
+   * @param sub The sub-band.
+   * @param out (out) The score of the first step.
+   * @param skip The distance to the score of the next step.
+   *
+   **/
+
+  void DoScore(SInt res, EnumSubband sub, HeatWaveScore * out,
+               SInt skip) const
+  {
+    HeatWaveView view = m_cmp->GetView(res, sub);
+    if ( !view.IsValid() ){
+      return;
+    }
+    SInt width = view.GetWidth();
+    SInt height = view.GetHeight();
+    Smpl * quant = NULL;
+    for ( SInt k = 0 ; k < m_stpn ; ++k ){
+      SFloat64 step = m_steps[(((k*(m_levMax+1))+res)*SubTotal)+sub];
+      if ( step == 1.0 ){
+        DoScore(view, out[k*skip]);
+        continue;
+      }
+      // the indices are scored, then put back to measure the error
+      if ( quant == NULL ){
+        quant = new Smpl[width*height];
+        LEAVEONNULL(quant);
+      }
+      for ( SInt y = 0 ; y < height ; ++y ){
+        const Smpl * row = view.GetRow(y, quant+(y*width));
+        if ( row != (quant+(y*width)) ){
+          memcpy(quant+(y*width), row, width*sizeof(Smpl));
+        }
+      }
+      HeatWaveView qview(quant, width, height, width);
+      HeatWaveQuantizer::DoQuantize(quant, width, height, width, step);
+      DoScore(qview, out[k*skip]);
+      HeatWaveQuantizer::DoDequantize(quant, width, height, width, step);
+      SFloat64 norm = m_norms[(res*SubTotal)+sub];
+      out[k*skip].m_distortion += view.GetSquaredError(qview)*norm*norm;
+    }
+    delete [] quant;
+  }
+
+  /**
+   *
+   * Score samples.
+   *
+   * @param view The samples.
+   * @param out (out) The score.
+   *
+   **/
+
+  void DoScore(const HeatWaveView & view, HeatWaveScore & out) const
+  {
+    Smpl min, max;
+    SInt total;
+    view.GetBasicStats(min, max, total);
+    SInt range = (max-min)+1;
+    Smpl * hist = new Smpl[range];
+    LEAVEONNULL(hist);
+    memset((char*)hist,0,range*sizeof(Smpl));
+    view.DoHistogram(hist, range, -min);
+
+    // n.log2(n) - sum c.log2(c), the entropy times the samples
+    SFloat64 size = view.GetSize();
+    SFloat64 bits = size*(log(size)/log(2.0));
+    {
+      HEATWAVEPROFILE(PrfEntropy, view.GetSize(), range*sizeof(Smpl));
+      for ( SInt i = 0 ; i < range ; ++i ){
+        if ( hist[i] ){
+          bits -= hist[i]*(log((SFloat64)hist[i])/log(2.0));
+        }
+      }
+    }
+    out.m_samples += size;
+    out.m_entropy += (bits > 0.0) ? bits : 0.0;
+    out.m_huffman += HeatWaveEvaluator::GetHuffmanBits(hist, range);
+    delete [] hist;
+  }
+
+  /** The copy, NULL once run. */
+  HeatWaveComponent * m_cmp;
+
+  /** The transform number. */
+  SInt m_trn;
+
+  /** The component number. */
+  SInt m_cmpn;
+
+  /** The transform. */
+  EnumTransform m_type;
+
+  /** The highest level. */
+  SInt m_levMax;
+
+  /** The number of steps. */
+  SInt m_stpn;
+
+  /** The step of each sub-band for each base step, resolution level and
+   ** sub-band. */
+  const SFloat64 * m_steps;
+
+  /** The norm of each sub-band, for each resolution level and sub-band. */
+  const SFloat64 * m_norms;
+
+  /** (Out) The level reached. */
+  SInt m_reached;
+
+  /** (Out) The LL sub-band of each level, for each step. */
+  HeatWaveScore * m_ll;
+
+  /** (Out) The HL, LH and HH sub-bands of each resolution from 1, for each
+   ** step. */
+  HeatWaveScore * m_det;
+};
+
+/**
+ *
+ * Ascending order of histogram counts, for qsort().
+ *
+ **/
+
+static int
+CompareCount(const void * a, const void * b)
+{
+  SFloat64 x = *(const SFloat64 *)a;
+  SFloat64 y = *(const SFloat64 *)b;
+  return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+/****************************************************************************/
+
+HeatWaveEvaluator::HeatWaveEvaluator()
+{
+  m_trna = NULL;
+  m_trnn = 0;
+  m_leva = NULL;
+  m_levn = 0;
+  m_levMax = 0;
+  m_stpa = NULL;
+  m_stpn = 0;
+  m_scorea = NULL;
+  m_scoren = 0;
+  m_cmpn = 0;
+}
+
+HeatWaveEvaluator::~HeatWaveEvaluator()
+{
+  delete [] m_trna;
+  delete [] m_leva;
+  delete [] m_stpa;
+  delete [] m_scorea;
+}
+
+void
+HeatWaveEvaluator::AddTransform(EnumTransform trn)
+{
+  ASSERT ( (trn >= Trn0_0) && (trn < TrnTotal) );
+  DoClear();
+  EnumTransform * tmp = new EnumTransform[m_trnn+1];
+  LEAVEONNULL(tmp);
+  for ( SInt i = 0 ; i < m_trnn ; ++i ){
+    tmp[i] = m_trna[i];
+  }
+  tmp[m_trnn++] = trn;
+  delete [] m_trna;
+  m_trna = tmp;
+}
+
+void
+HeatWaveEvaluator::AddLevel(SInt lev)
+{
+  ASSERT ( lev >= 0 );
+  DoClear();
+  SInt * tmp = new SInt[m_levn+1];
+  LEAVEONNULL(tmp);
+  for ( SInt i = 0 ; i < m_levn ; ++i ){
+    tmp[i] = m_leva[i];
+  }
+  tmp[m_levn++] = lev;
+  delete [] m_leva;
+  m_leva = tmp;
+  m_levMax = HeatWaveMath::Max(m_levMax, lev);
+}
+
+void
+HeatWaveEvaluator::AddStep(SFloat64 step)
+{
+  DoClear();
+  SFloat64 * tmp = new SFloat64[m_stpn+1];
+  LEAVEONNULL(tmp);
+  for ( SInt i = 0 ; i < m_stpn ; ++i ){
+    tmp[i] = m_stpa[i];
+  }
+  tmp[m_stpn++] = (step > 1.0) ? step : 1.0;
+  delete [] m_stpa;
+  m_stpa = tmp;
+}
+
+SInt
+HeatWaveEvaluator::GetStepN() const
+{
+  return (m_stpn > 0) ? m_stpn : 1;
+}
+
+SFloat64
+HeatWaveEvaluator::GetStepAt(SInt stp) const
+{
+  ASSERT ( (stp >= 0) && (stp < GetStepN()) );
+  return (m_stpn > 0) ? m_stpa[stp] : 1.0;
+}
+
+void
+HeatWaveEvaluator::DoEvaluate(const HeatWaveImage & img,
+                              HeatWaveWorkerPool * pool)
+{
+  const HeatWaveImage * imga = &img;
+  DoEvaluate(&imga, 1, pool);
+}
+
+void
+HeatWaveEvaluator::DoEvaluate(const HeatWaveVideo & vid,
+                              HeatWaveWorkerPool * pool)
+{
+  if ( vid.GetImageN() < 1 ){
+    return;
+  }
+  const HeatWaveImage ** imga = new const HeatWaveImage*[vid.GetImageN()];
+  LEAVEONNULL(imga);
+  for ( SInt i = 0 ; i < vid.GetImageN() ; ++i ){
+    imga[i] = &(vid.GetImage(i));
+  }
+  DoEvaluate(imga, vid.GetImageN(), pool);
+  delete [] imga;
+}
+
+void
+HeatWaveEvaluator::DoEvaluate(const HeatWaveImage * const * imga, SInt imgn,
+                              HeatWaveWorkerPool * pool)
+{
+  SInt jobn = 0;
+  for ( SInt i = 0 ; i < imgn ; ++i ){
+    jobn += m_trnn*imga[i]->GetComponentN();
+  }
+  if ( (jobn == 0) || (m_levn == 0) ){
+    return;
+  }
+
+  // the sub-band steps and norms of each transform, measured here as the
+  // quantizer is not thread safe
+  SInt stpn = GetStepN();
+  SInt tbl = (m_levMax+1)*SubTotal;
+  SFloat64 * steps = new SFloat64[m_trnn*stpn*tbl];
+  LEAVEONNULL(steps);
+  SFloat64 * norms = new SFloat64[m_trnn*tbl];
+  LEAVEONNULL(norms);
+  for ( SInt t = 0 ; t < m_trnn ; ++t ){
+    for ( SInt k = 0 ; k < stpn ; ++k ){
+      m_qnt.SetStep(GetStepAt(k));
+      for ( SInt i = 0 ; i < tbl ; ++i ){
+        SInt res = i/SubTotal;
+        EnumSubband sub = (EnumSubband)(i%SubTotal);
+        steps[(((t*stpn)+k)*tbl)+i] = m_qnt.GetStep(m_trna[t], res, sub);
+        norms[(t*tbl)+i] = m_qnt.GetNorm(m_trna[t], res, sub);
+      }
+    }
+  }
+
+  // the copies are made here, so only the jobs write
+  HeatWaveScoreJob ** jobs = new HeatWaveScoreJob*[jobn];
+  LEAVEONNULL(jobs);
+  SInt j = 0;
+  for ( SInt i = 0 ; i < imgn ; ++i ){
+    for ( SInt t = 0 ; t < m_trnn ; ++t ){
+      for ( SInt c = 0 ; c < imga[i]->GetComponentN() ; ++c ){
+        jobs[j] = new HeatWaveScoreJob(imga[i]->GetComponent(c), t, c,
+                                       m_trna[t], m_levMax, stpn,
+                                       steps+(t*stpn*tbl), norms+(t*tbl));
+        LEAVEONNULL(jobs[j]);
+        if ( pool ){
+          pool->DoSubmit(jobs[j]);
+        }
+        else{
+          jobs[j]->DoRun();
+        }
+        ++j;
+      }
+    }
+  }
+  if ( pool ){
+    pool->DoWait();
+  }
+
+  // each job kept its own scores, add them up
+  for ( j = 0 ; j < jobn ; ++j ){
+    const HeatWaveScoreJob & job = *jobs[j];
+    for ( SInt s = 0 ; s < stpn ; ++s ){
+      const HeatWaveScore * det = job.m_det+(s*((3*m_levMax)+1));
+      const HeatWaveScore * ll = job.m_ll+(s*(m_levMax+1));
+      for ( SInt l = 0 ; l < m_levn ; ++l ){
+        SInt lev = m_leva[l];
+        if ( lev > job.m_reached ){
+          continue;
+        }
+        // the table may be laid out again, take m_scorea after
+        SInt at = GetScoreAt(job.m_trn, s, l, job.m_cmpn);
+        HeatWaveScore * out = m_scorea+at;
+        for ( SInt k = 0 ; k <= (3*lev) ; ++k ){
+          const HeatWaveScore & in = (k < (3*lev)) ? det[k] : ll[lev];
+          out[k].m_samples += in.m_samples;
+          out[k].m_entropy += in.m_entropy;
+          out[k].m_huffman += in.m_huffman;
+          out[k].m_distortion += in.m_distortion;
+        }
+      }
+    }
+    delete jobs[j];
+  }
+  delete [] jobs;
+  delete [] steps;
+  delete [] norms;
+}
+
+SInt
+HeatWaveEvaluator::GetScoreN() const
+{
+  return m_scoren;
+}
+
+const HeatWaveScore &
+HeatWaveEvaluator::GetScore(SInt num) const
+{
+  ASSERT ( (num >= 0) && (num < m_scoren) );
+  return m_scorea[num];
+}
+
+void
+HeatWaveEvaluator::DoClear()
+{
+  delete [] m_scorea;
+  m_scorea = NULL;
+  m_scoren = 0;
+  m_cmpn = 0;
+}
+
+SFloat64
+HeatWaveEvaluator::GetHuffmanBits(const Smpl * hist, SInt range)
+{
+  HEATWAVEPROFILE(PrfHuffman, range, range*sizeof(Smpl));
+  SInt n = 0;
+  for ( SInt i = 0 ; i < range ; ++i ){
+    if ( hist[i] > 0 ){
+      ++n;
+    }
+  }
+  if ( n == 0 ){
+    return 0.0;
+  }
+  SFloat64 * leaf = new SFloat64[n];
+  LEAVEONNULL(leaf);
+  n = 0;
+  for ( SInt i = 0 ; i < range ; ++i ){
+    if ( hist[i] > 0 ){
+      leaf[n++] = hist[i];
+    }
+  }
+  if ( n == 1 ){
+    // a single symbol still takes a bit
+    SFloat64 ret = leaf[0];
+    delete [] leaf;
+    return ret;
+  }
+
+  // merging the leaves in order of weight, the new nodes come out in
+  // order too, so two queues replace a heap; each merge adds a bit to all
+  // the samples below it
+  qsort(leaf, n, sizeof(SFloat64), CompareCount);
+  SFloat64 * node = new SFloat64[n];
+  LEAVEONNULL(node);
+  SInt li = 0;
+  SInt ni = 0;
+  SInt nn = 0;
+  SFloat64 bits = 0.0;
+  for ( SInt m = 0 ; m < (n-1) ; ++m ){
+    SFloat64 sum = 0.0;
+    for ( SInt k = 0 ; k < 2 ; ++k ){
+      if ( (li < n) && ((ni == nn) || (leaf[li] <= node[ni])) ){
+        sum += leaf[li++];
+      }
+      else{
+        sum += node[ni++];
+      }
+    }
+    node[nn++] = sum;
+    bits += sum;
+  }
+  delete [] leaf;
+  delete [] node;
+  return bits;
+}
+
+SInt
+HeatWaveEvaluator::GetScoreAt(SInt trn, SInt stp, SInt lev, SInt cmp)
+{
+  SInt stpn = GetStepN();
+  if ( cmp >= m_cmpn ){
+    // lay the table out again for more components, keeping the scores
+    SInt cmpn = cmp+1;
+    SInt blk = 0;
+    for ( SInt l = 0 ; l < m_levn ; ++l ){
+      blk += (3*m_leva[l])+1;
+    }
+    HeatWaveScore * tmp = new HeatWaveScore[m_trnn*stpn*cmpn*blk];
+    LEAVEONNULL(tmp);
+    SInt k = 0;
+    for ( SInt t = 0 ; t < m_trnn ; ++t ){
+      for ( SInt s = 0 ; s < stpn ; ++s ){
+        for ( SInt l = 0 ; l < m_levn ; ++l ){
+          for ( SInt c = 0 ; c < cmpn ; ++c ){
+            SInt old = (c < m_cmpn) ? GetScoreAt(t, s, l, c) : -1;
+            for ( SInt r = 0 ; r <= (3*m_leva[l]) ; ++r, ++k ){
+              if ( old >= 0 ){
+                tmp[k] = m_scorea[old+r];
+                continue;
+              }
+              tmp[k].m_trn = m_trna[t];
+              tmp[k].m_step = GetStepAt(s);
+              tmp[k].m_lev = m_leva[l];
+              tmp[k].m_cmp = c;
+              tmp[k].m_res = (r < (3*m_leva[l])) ? ((r/3)+1) : m_leva[l];
+              tmp[k].m_sub = (r < (3*m_leva[l])) ?
+                (EnumSubband)(SubHL+(r%3)) : SubLL;
+              tmp[k].m_samples = 0.0;
+              tmp[k].m_entropy = 0.0;
+              tmp[k].m_huffman = 0.0;
+              tmp[k].m_distortion = 0.0;
+            }
+          }
+        }
+      }
+    }
+    delete [] m_scorea;
+    m_scorea = tmp;
+    m_scoren = k;
+    m_cmpn = cmpn;
+  }
+
+  // the transform blocks, then the step blocks, then the level blocks,
+  // then the components
+  SInt ret = 0;
+  for ( SInt l = 0 ; l < m_levn ; ++l ){
+    SInt len = m_cmpn*((3*m_leva[l])+1);
+    ret += (((trn*stpn)+stp)*len);
+    if ( l < lev ){
+      ret += len;
+    }
+  }
+  return ret+(cmp*((3*m_leva[lev])+1));
+}
@@ -0,0 +1,426 @@
+/****************************************************************************/
+/**
+ ** @file HeatWaveFloatComponent.cpp
+ ** @brief Contains the HeatWaveFloatComponent class definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveFloatComponent.hpp"
+#include "HeatWaveProfiler.hpp"
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#include <emmintrin.h>
+#define HEATWAVEFLOATSSE2
+#endif
+
+/****************************************************************************/
+// Lifting steps, samples are interleaved (even, odd, even, ...)
+
+/** Lift x[i], x[i+2], ... by c times the sum of their neighbours, four
+ ** samples at a time while all neighbours are within len. The sums are
+ ** formed in the same order as the scalar loops, so both round the same.
+ ** @return The first sample left for the scalar loop. **/
+static SInt
+LiftRun(SFloat32 * x, SInt i, SInt len, SFloat32 c)
+{
+#ifdef HEATWAVEFLOATSSE2
+  const __m128 cof = _mm_set1_ps(c);
+  for ( ; (i+8) < len ; i += 8 ){
+    // v holds the neighbours to the left of and the samples themselves,
+    // w the neighbours to the right
+    __m128 v0 = _mm_loadu_ps(x+i-1);
+    __m128 v1 = _mm_loadu_ps(x+i+3);
+    __m128 w0 = _mm_loadu_ps(x+i+1);
+    __m128 w1 = _mm_loadu_ps(x+i+5);
+    __m128 lft = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2,0,2,0));
+    __m128 smp = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3,1,3,1));
+    __m128 rgt = _mm_shuffle_ps(w0, w1, _MM_SHUFFLE(2,0,2,0));
+    smp = _mm_add_ps(smp, _mm_mul_ps(cof, _mm_add_ps(lft, rgt)));
+    _mm_storeu_ps(x+i-1, _mm_unpacklo_ps(lft, smp));
+    _mm_storeu_ps(x+i+3, _mm_unpackhi_ps(lft, smp));
+  }
+#endif
+  return i;
+}
+
+/** Add c times the sum of both (even) neighbours to the odd samples. **/
+static void
+LiftOdd(SFloat32 * x, SInt len, SFloat32 c)
+{
+  SInt i;
+  for ( i = LiftRun(x, 1, len, c) ; (i+1) < len ; i += 2 ){
+    x[i] += c*(x[i-1] + x[i+1]);
+  }
+  if ( (len%2) == 0 ){
+    // mirror at the right end
+    x[len-1] += 2*c*x[len-2];
+  }
+}
+
+/** Add c times the sum of both (odd) neighbours to the even samples. **/
+static void
+LiftEven(SFloat32 * x, SInt len, SFloat32 c)
+{
+  SInt i;
+  // mirror at the left end
+  x[0] += 2*c*x[1];
+  for ( i = LiftRun(x, 2, len, c) ; (i+1) < len ; i += 2 ){
+    x[i] += c*(x[i-1] + x[i+1]);
+  }
+  if ( (len%2) == 1 ){
+    // mirror at the right end
+    x[len-1] += 2*c*x[len-2];
+  }
+}
+
+/** Scale even samples by evn and odd samples by odd. **/
+static void
+LiftScale(SFloat32 * x, SInt len, SFloat32 evn, SFloat32 odd)
+{
+  SInt i = 0;
+#ifdef HEATWAVEFLOATSSE2
+  const __m128 scl = _mm_setr_ps(evn, odd, evn, odd);
+  for ( ; (i+4) <= len ; i += 4 ){
+    _mm_storeu_ps(x+i, _mm_mul_ps(_mm_loadu_ps(x+i), scl));
+  }
+#endif
+  for ( ; i < len ; ++i ){
+    x[i] *= ((i%2) == 0) ? evn : odd;
+  }
+}
+
+/****************************************************************************/
+
+HeatWaveFloatComponent::HeatWaveFloatComponent()
+{
+  m_tlx = 0;
+  m_tly = 0;
+  m_width = 0;
+  m_height = 0;
+  m_size = 0;
+  m_lev = 0;
+  m_data = NULL;
+  m_buffer = NULL;
+}
+
+HeatWaveFloatComponent::HeatWaveFloatComponent(const HeatWaveComponent & cmp)
+{
+  m_width = 0;
+  m_height = 0;
+  m_size = 0;
+  m_data = NULL;
+  m_buffer = NULL;
+  SetComponent(cmp);
+}
+
+HeatWaveFloatComponent::HeatWaveFloatComponent
+(const HeatWaveFloatComponent & oth)
+{
+  DoCopy(oth);
+}
+
+HeatWaveFloatComponent::~HeatWaveFloatComponent()
+{
+  DoDestroy();
+}
+
+SInt
+HeatWaveFloatComponent::GetTLX() const
+{
+  return m_tlx;
+}
+
+SInt
+HeatWaveFloatComponent::GetTLY() const
+{
+  return m_tly;
+}
+
+SInt
+HeatWaveFloatComponent::GetWidth() const
+{
+  return m_width;
+}
+
+SInt
+HeatWaveFloatComponent::GetHeight() const
+{
+  return m_height;
+}
+
+SInt
+HeatWaveFloatComponent::GetSize() const
+{
+  return m_size;
+}
+
+SInt
+HeatWaveFloatComponent::GetTransformLevel() const
+{
+  return m_lev;
+}
+
+void
+HeatWaveFloatComponent::SetTransformLevel(SInt lev)
+{
+  m_lev = lev;
+}
+
+SFloat32 *
+HeatWaveFloatComponent::GetData() const
+{
+  return m_data;
+}
+
+SFloat32
+HeatWaveFloatComponent::GetSmpl(const SInt x, const SInt y) const
+{
+  ASSERT(ValidateCoords(x,y));
+  return m_data[((y-m_tly)*m_width)+(x-m_tlx)];
+}
+
+void
+HeatWaveFloatComponent::SetSmpl(const SInt x, const SInt y,
+                                const SFloat32 val)
+{
+  ASSERT(ValidateCoords(x,y));
+  m_data[((y-m_tly)*m_width)+(x-m_tlx)] = val;
+}
+
+void
+HeatWaveFloatComponent::SetComponent(const HeatWaveComponent & cmp)
+{
+  DoDestroy();
+  m_tlx = cmp.GetTLX();
+  m_tly = cmp.GetTLY();
+  m_lev = cmp.GetTransformLevel();
+  DoCreate(cmp.GetWidth(), cmp.GetHeight());
+
+  SInt i = 0;
+  for ( SInt y = 0 ; y < m_height ; ++y ){
+    for ( SInt x = 0 ; x < m_width ; ++x ){
+      m_data[i++] = (SFloat32)cmp.GetSmpl(m_tlx+x, m_tly+y);
+    }
+  }
+}
+
+void
+HeatWaveFloatComponent::GetComponent(HeatWaveComponent & cmp) const
+{
+  if ( m_size <= 0 ){
+    return;
+  }
+  if ( (cmp.GetWidth() != m_width) || (cmp.GetHeight() != m_height) ){
+    cmp.SetSize(m_width, m_height);
+  }
+  cmp.SetTLX(m_tlx);
+  cmp.SetTLY(m_tly);
+
+  SInt i = 0;
+  for ( SInt y = 0 ; y < m_height ; ++y ){
+    for ( SInt x = 0 ; x < m_width ; ++x ){
+      SFloat64 val = floor(m_data[i++] + 0.5);
+      if ( val > SMPLMAX ){
+        val = SMPLMAX;
+      }
+      else if ( val < SMPLMIN ){
+        val = SMPLMIN;
+      }
+      cmp.SetSmpl(m_tlx+x, m_tly+y, (Smpl)val);
+    }
+  }
+  cmp.SetTransformLevel(m_lev);
+  cmp.SetTransformType(Trn9m7);
+  cmp.SetMinPrecSgn();
+}
+
+Bool
+HeatWaveFloatComponent::DoTransform(Bool fwd, SInt tlx, SInt tly,
+                                    SInt width, SInt height)
+{
+  if ( !(ValidateCoords(tlx,tly)&&ValidateCoords(tlx+width-1,tly+height-1)&&
+         (width>1)&&(height>1)) ){
+    return False;
+  }
+  SFloat32 * tmp_data = m_data + ((tly-m_tly)*m_width) + (tlx-m_tlx);
+  if ( fwd ){
+    DoTransformInternal(fwd,width,height,True,tmp_data);
+    DoTransformInternal(fwd,width,height,False,tmp_data);
+  }
+  else { // inverse
+    DoTransformInternal(fwd,width,height,False,tmp_data);
+    DoTransformInternal(fwd,width,height,True,tmp_data);
+  }
+  return True;
+}
+
+SInt
+HeatWaveFloatComponent::DoPyramidTransform(SInt lev, Bool fwd)
+{
+  if ( lev < 0 ){
+    lev = 0;
+  }
+
+  while ( fwd ? (m_lev < lev) : (m_lev > lev) ){
+    SInt x, y, width, height;
+    if ( !GetSubbandInfo((m_lev-(fwd?0:1)), SubLL, x, y, width, height) ){
+      break;
+    }
+    if ( !DoTransform(fwd, x, y, width, height) ){
+      break;
+    }
+    fwd ? ( ++m_lev ) : ( --m_lev );
+  }
+  return m_lev;
+}
+
+Bool
+HeatWaveFloatComponent::GetSubbandInfo(SInt res, EnumSubband sub,
+                                       SInt & x, SInt & y,
+                                       SInt & width, SInt & height) const
+{
+  return HeatWaveComponent::GetSubbandArea(m_tlx, m_tly, m_width, m_height,
+                                           res, sub, x, y, width, height);
+}
+
+Bool
+HeatWaveFloatComponent::ValidateCoords(SInt x, SInt y) const
+{
+  Bool ret = True;
+  ret &= (x >= m_tlx);
+  ret &= (y >= m_tly);
+  ret &= (x < (m_tlx+m_width));
+  ret &= (y < (m_tly+m_height));
+  return ret;
+}
+
+HeatWaveFloatComponent &
+HeatWaveFloatComponent::operator=(const HeatWaveFloatComponent & rhs)
+{
+  if ( this != &rhs ){
+    DoDestroy();
+    DoCopy(rhs);
+  }
+  return (*this);
+}
+
+void
+HeatWaveFloatComponent::DoLiftLine(SFloat32 * x, SInt len, Bool fwd)
+{
+  if ( len < 2 ){
+    return;
+  }
+  HEATWAVEPROFILE(PrfLift, len, (SInt64)len*2*5*sizeof(SFloat32));
+  if ( fwd ){
+    LiftOdd (x, len, HEATWAVEF97ALPHA);
+    LiftEven(x, len, HEATWAVEF97BETA);
+    LiftOdd (x, len, HEATWAVEF97GAMMA);
+    LiftEven(x, len, HEATWAVEF97DELTA);
+    LiftScale(x, len, 1.0f/HEATWAVEF97K, HEATWAVEF97K);
+  }
+  else {
+    LiftScale(x, len, HEATWAVEF97K, 1.0f/HEATWAVEF97K);
+    LiftEven(x, len, -HEATWAVEF97DELTA);
+    LiftOdd (x, len, -HEATWAVEF97GAMMA);
+    LiftEven(x, len, -HEATWAVEF97BETA);
+    LiftOdd (x, len, -HEATWAVEF97ALPHA);
+  }
+}
+
+void
+HeatWaveFloatComponent::DoTransformInternal(Bool fwd, SInt wid, SInt hei,
+                                            Bool hor, SFloat32 * mem)
+{
+  SInt inter_step, intra_step, nsteps, length, even_len;
+  SFloat32 * data = mem;
+  HEATWAVEPROFILE(PrfTransform, (SInt64)wid*hei,
+                  (SInt64)wid*hei*2*sizeof(SFloat32));
+
+  if ( hor ){
+    // horizontal transform
+    intra_step = 1;
+    inter_step = m_width;
+    nsteps = hei;
+    length = wid;
+  }
+  else {
+    // vertical transform
+    intra_step = m_width;
+    inter_step = 1;
+    nsteps = wid;
+    length = hei;
+  }
+  even_len = ((length>>1) + (length%2));
+
+  for ( SInt i = 0 ; i < nsteps ; ++i ){
+    if ( fwd ){
+      for ( SInt n = 0 ; n < length ; ++n ){
+        m_buffer[n] = data[n*intra_step];
+      }
+      DoLiftLine(m_buffer, length, fwd);
+      // low pass first, then high pass
+      for ( SInt n = 0 ; n < even_len ; ++n ){
+        data[n*intra_step] = m_buffer[n*2];
+      }
+      for ( SInt n = even_len ; n < length ; ++n ){
+        data[n*intra_step] = m_buffer[((n-even_len)*2)+1];
+      }
+    }
+    else {
+      for ( SInt n = 0 ; n < even_len ; ++n ){
+        m_buffer[n*2] = data[n*intra_step];
+      }
+      for ( SInt n = even_len ; n < length ; ++n ){
+        m_buffer[((n-even_len)*2)+1] = data[n*intra_step];
+      }
+      DoLiftLine(m_buffer, length, fwd);
+      for ( SInt n = 0 ; n < length ; ++n ){
+        data[n*intra_step] = m_buffer[n];
+      }
+    }
+    data += inter_step;
+  }
+}
+
+void
+HeatWaveFloatComponent::DoCreate(SInt width, SInt height)
+{
+  ASSERT ( m_data == NULL );
+  ASSERT ( m_buffer == NULL );
+  m_width = width;
+  m_height = height;
+  m_size = width*height;
+  if ( m_size <= 0 ){
+    m_width = m_height = m_size = 0;
+    return;
+  }
+  m_data = new SFloat32[m_size];
+  LEAVEONNULL(m_data);
+  m_buffer = new SFloat32[(width > height) ? width : height];
+  LEAVEONNULL(m_buffer);
+}
+
+void
+HeatWaveFloatComponent::DoDestroy()
+{
+  delete [] m_data;
+  m_data = NULL;
+  delete [] m_buffer;
+  m_buffer = NULL;
+  m_width = m_height = m_size = 0;
+}
+
+void
+HeatWaveFloatComponent::DoCopy(const HeatWaveFloatComponent & rhs)
+{
+  m_tlx = rhs.m_tlx;
+  m_tly = rhs.m_tly;
+  m_lev = rhs.m_lev;
+  m_data = NULL;
+  m_buffer = NULL;
+  DoCreate(rhs.m_width, rhs.m_height);
+  for ( SInt i = 0 ; i < m_size ; ++i ){
+    m_data[i] = rhs.m_data[i];
+  }
+}
@@ -7,12 +7,23 @@
  **/
 
 #include "HeatWaveImage.hpp"
+#include "HeatWaveProfiler.hpp"
 
 HeatWaveImage::HeatWaveImage()
 {
-  memset((char*)this,0,sizeof(HeatWaveImage));
+  // not memset, that would clear the constructed lift too
+  m_tlx = 0;
+  m_tly = 0;
+  m_width = 0;
+  m_height = 0;
+  m_trn = Trn0_0;
+  m_lev = 0;
   m_desMem = True;
+  m_size = 0;
   m_space = SpcUnknown;
+  m_compn = 0;
+  m_compa = NULL;
+  m_sceneSwitch = False;
 }
 
 HeatWaveImage::HeatWaveImage(SInt tlx, SInt tly, SInt width, SInt height, 
@@ -62,7 +73,10 @@ HeatWaveImage::HeatWaveImage(SInt tlx, SInt tly, SInt width, SInt height,
 
 HeatWaveImage::HeatWaveImage(const HeatWaveImage & rhs)
 {
-  memset((char*)this,'\0',sizeof(HeatWaveImage));
+  // nothing to destroy yet
+  m_desMem = False;
+  m_compn = 0;
+  m_compa = NULL;
   DoCopy(rhs);
 }
     
@@ -165,13 +179,18 @@ HeatWaveImage::SetSpace(EnumSpace schm, Bool fast, SInt grey_choice,
   
   if ( m_space == SpcGrey ){
     // grey to RGB/YUV
+    // the copies share the grey samples until written to
     HeatWaveComponent ** m_temp = new HeatWaveComponent*[MAXCOLORSINANYSPACE];
-    for (SInt i = 0 ; i < MAXCOLORSINANYSPACE ; ++i){
+    LEAVEONNULL(m_temp);
+    m_temp[0] = m_compa[0];
+    for (SInt i = 1 ; i < MAXCOLORSINANYSPACE ; ++i){
       m_temp[i] = new HeatWaveComponent(*m_compa[0]);
+      LEAVEONNULL(m_temp[i]);
     }
     m_compa[0] = NULL;
-    delete m_compa;
+    delete [] m_compa;
     m_compa = m_temp;
+    m_compn = MAXCOLORSINANYSPACE;
     if ( schm == SpcYUV ){
       m_compa[0]->SetColor(ClrY);
       m_compa[1]->SetColor(ClrU);
@@ -367,6 +386,25 @@ HeatWaveImage::GetClone() const
   return ret;
 }
 
+void
+HeatWaveImage::DoSwap(HeatWaveImage & other)
+{
+  // the components and the lift buffer are only moved, never duplicated
+  SwapValues(m_tlx, other.m_tlx);
+  SwapValues(m_tly, other.m_tly);
+  SwapValues(m_width, other.m_width);
+  SwapValues(m_height, other.m_height);
+  SwapValues(m_trn, other.m_trn);
+  SwapValues(m_lev, other.m_lev);
+  SwapValues(m_desMem, other.m_desMem);
+  SwapValues(m_size, other.m_size);
+  SwapValues(m_space, other.m_space);
+  SwapValues(m_compn, other.m_compn);
+  SwapValues(m_compa, other.m_compa);
+  SwapValues(m_sceneSwitch, other.m_sceneSwitch);
+  m_lift.DoSwap(other.m_lift);
+}
+
 Bool 
 HeatWaveImage::IsComparable(const HeatWaveImage & other)
 {
@@ -487,6 +525,32 @@ HeatWaveImage::DoPyramidTransform(EnumTransform trn, SInt lev,
   return ret;
 }
 
+Bool
+HeatWaveImage::DoPack(EnumTransform trn, SInt lev)
+{
+  Bool ret = True;
+  for ( SInt i = 0; i < m_compn ; ++i ){
+    ret &= (m_compa[i]->DoPack(trn,lev));
+  }
+  return ret;
+}
+
+void
+HeatWaveImage::SetTiling(SInt twd, SInt thg, HeatWaveWorkerPool * pool)
+{
+  for ( SInt i = 0; i < m_compn ; ++i ){
+    m_compa[i]->SetTiling(twd,thg,pool);
+  }
+}
+
+void
+HeatWaveImage::DoUnpack()
+{
+  for ( SInt i = 0; i < m_compn ; ++i ){
+    m_compa[i]->DoUnpack();
+  }
+}
+
 
 /*
   Bool 
@@ -553,6 +617,15 @@ HeatWaveImage::AllComponentsRelate() const
   return same_memb;
 }
 
+HeatWaveImage& 
+HeatWaveImage::operator=(const HeatWaveImage& rhs)
+{
+  if ( this != &rhs ){
+    DoCopy(rhs);
+  }
+  return (*this);
+}
+
 Bool 
 HeatWaveImage::operator==(const HeatWaveImage & rhs ) const
 {
@@ -592,6 +665,8 @@ HeatWaveImage::DoSpectralTransform(Bool fwd, EnumTransform trn,
   Smpl * even;
   Smpl * odd;
   SInt steps = m_lift.GetFuncArray(func, trn, fwd, prd, upd);
+  HEATWAVEPROFILE(PrfSpectral, (SInt64)width*height*len,
+                  (SInt64)width*height*len*2*sizeof(Smpl));
   for ( SInt x = tlx; x < (tlx + width); ++x ){
     for ( SInt y = tly; y < (tly + height); ++y ){
       GetSpectralVector(strt, len ,x, y, data);
@@ -721,6 +796,8 @@ HeatWaveImage::DoCrctClrOrd()
 void 
 HeatWaveImage::DoRCT_RGBtoYUV()
 {
+  HEATWAVEPROFILE(PrfColor, (SInt64)3*m_compa[0]->GetSize(),
+                  (SInt64)3*2*m_compa[0]->GetSize()*sizeof(Smpl));
   SInt c_y,c_u,c_v,c_r,c_g,c_b;
   SInt comp_tlx = m_compa[0]->GetTLX();
   SInt comp_tly = m_compa[0]->GetTLY();
@@ -754,6 +831,8 @@ HeatWaveImage::DoRCT_RGBtoYUV()
 void 
 HeatWaveImage::DoRCT_YUVtoRGB()
 {
+  HEATWAVEPROFILE(PrfColor, (SInt64)3*m_compa[0]->GetSize(),
+                  (SInt64)3*2*m_compa[0]->GetSize()*sizeof(Smpl));
   SInt c_y,c_u,c_v,c_r,c_g,c_b;
   SInt comp_tlx = m_compa[0]->GetTLX();
   SInt comp_tly = m_compa[0]->GetTLY();
@@ -796,6 +875,8 @@ void
 HeatWaveImage::DoICT_RGBtoYUV()
 {
   ASSERT(CanCT());
+  HEATWAVEPROFILE(PrfColor, (SInt64)3*m_compa[0]->GetSize(),
+                  (SInt64)3*2*m_compa[0]->GetSize()*sizeof(Smpl));
   enum { red = 0, green, blue};
   enum { Y = 0, Cb, Cr}; 
   SInt c_r, c_g, c_b, c_y, c_u, c_v;
@@ -834,6 +915,8 @@ void
 HeatWaveImage::DoICT_YUVtoRGB()
 {
   ASSERT(CanCT());
+  HEATWAVEPROFILE(PrfColor, (SInt64)3*m_compa[0]->GetSize(),
+                  (SInt64)3*2*m_compa[0]->GetSize()*sizeof(Smpl));
   enum { red = 0, green, blue};
   enum { Y = 0, Cb, Cr}; 
   SInt c_y, c_u, c_v, c_r, c_g, c_b;
@@ -1059,9 +1142,18 @@ void
 HeatWaveImage::DoCopy(const HeatWaveImage & rhs)
 {
   DoDestroy();
-  memcpy((char*)this,(char*)&rhs,sizeof(HeatWaveImage));
-  m_compa = NULL;
+  // the lift keeps its own buffer, it holds nothing between transforms
+  m_tlx = rhs.m_tlx;
+  m_tly = rhs.m_tly;
+  m_width = rhs.m_width;
+  m_height = rhs.m_height;
+  m_trn = rhs.m_trn;
+  m_lev = rhs.m_lev;
+  m_size = rhs.m_size;
+  m_space = rhs.m_space;
+  m_sceneSwitch = rhs.m_sceneSwitch;
   m_compa = NULL;
+  m_desMem = True;
   DoCompCopy(rhs.m_compn,rhs.m_compa);
 }
 
@@ -0,0 +1,598 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveImageFile.cpp
+ ** @brief  Contains the HeatWaveImageFile class definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveImageFile.hpp"
+#include "HeatWaveProfiler.hpp"
+#include <ctype.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define HEATWAVEIMAGEFILEMMAP
+#endif
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#include <emmintrin.h>
+#define HEATWAVEIMAGEFILESSE2
+#endif
+
+/****************************************************************************/
+
+/** Widen 8 bit samples. */
+static void
+DoWiden8(const UInt8 * src, Smpl * dst, SInt num)
+{
+  SInt x = 0;
+#ifdef HEATWAVEIMAGEFILESSE2
+  if ( sizeof(Smpl) == 4 ){
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; x+16 <= num ; x += 16 ){
+      __m128i val = _mm_loadu_si128((const __m128i*)(src+x));
+      __m128i lo = _mm_unpacklo_epi8(val, zero);
+      __m128i hi = _mm_unpackhi_epi8(val, zero);
+      _mm_storeu_si128((__m128i*)(dst+x), _mm_unpacklo_epi16(lo, zero));
+      _mm_storeu_si128((__m128i*)(dst+x+4), _mm_unpackhi_epi16(lo, zero));
+      _mm_storeu_si128((__m128i*)(dst+x+8), _mm_unpacklo_epi16(hi, zero));
+      _mm_storeu_si128((__m128i*)(dst+x+12), _mm_unpackhi_epi16(hi, zero));
+    }
+  }
+#endif
+  for ( ; x < num ; ++x ){
+    dst[x] = src[x];
+  }
+}
+
+/** Widen big endian 16 bit samples. */
+static void
+DoWiden16(const UInt8 * src, Smpl * dst, SInt num)
+{
+  SInt x = 0;
+#ifdef HEATWAVEIMAGEFILESSE2
+  if ( sizeof(Smpl) == 4 ){
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; x+8 <= num ; x += 8 ){
+      __m128i val = _mm_loadu_si128((const __m128i*)(src+2*x));
+      val = _mm_or_si128(_mm_slli_epi16(val, 8), _mm_srli_epi16(val, 8));
+      _mm_storeu_si128((__m128i*)(dst+x), _mm_unpacklo_epi16(val, zero));
+      _mm_storeu_si128((__m128i*)(dst+x+4), _mm_unpackhi_epi16(val, zero));
+    }
+  }
+#endif
+  for ( ; x < num ; ++x ){
+    dst[x] = (src[2*x] << 8) | src[2*x+1];
+  }
+}
+
+/** Narrow samples to 8 bits, clipped to [0,max]. */
+static void
+DoNarrow8(const Smpl * src, UInt8 * dst, SInt num, SInt max)
+{
+  SInt x = 0;
+#ifdef HEATWAVEIMAGEFILESSE2
+  if ( (sizeof(Smpl) == 4) && (max == 255) ){
+    for ( ; x+16 <= num ; x += 16 ){
+      __m128i a = _mm_loadu_si128((const __m128i*)(src+x));
+      __m128i b = _mm_loadu_si128((const __m128i*)(src+x+4));
+      __m128i c = _mm_loadu_si128((const __m128i*)(src+x+8));
+      __m128i d = _mm_loadu_si128((const __m128i*)(src+x+12));
+      __m128i val = _mm_packus_epi16(_mm_packs_epi32(a, b),
+                                     _mm_packs_epi32(c, d));
+      _mm_storeu_si128((__m128i*)(dst+x), val);
+    }
+  }
+#endif
+  for ( ; x < num ; ++x ){
+    dst[x] = (UInt8)((src[x] < 0) ? 0 : ((src[x] > max) ? max : src[x]));
+  }
+}
+
+/** A image of unsigned grey or RGB components. */
+static HeatWaveImage *
+GetNewImage(SInt width, SInt height, SInt num, SInt prec)
+{
+  HeatWaveImage * img = new HeatWaveImage(0, 0, width, height,
+                                          (num == 1) ? SpcGrey : SpcRGB,
+                                          num, True);
+  LEAVEONNULL(img);
+  const EnumColor grey[1] = {ClrGrey};
+  const EnumColor rgb[3] = {ClrRed, ClrGreen, ClrBlue};
+  HeatWaveComponent ** cmpa = img->GetComponentA();
+  for ( SInt i = 0 ; i < num ; ++i ){
+    cmpa[i] = new HeatWaveComponent(0, 0, 1, 1, width, height, False, prec,
+                                    (num == 1) ? grey[i] : rgb[i]);
+    LEAVEONNULL(cmpa[i]);
+  }
+  return img;
+}
+
+static UInt32
+GetLE(const UInt8 * ptr, SInt len)
+{
+  UInt32 val = 0;
+  for ( SInt i = len-1 ; i >= 0 ; --i ){
+    val = (val << 8) | ptr[i];
+  }
+  return val;
+}
+
+static void
+DoPutLE(UInt8 * ptr, UInt32 val, SInt len)
+{
+  for ( SInt i = 0 ; i < len ; ++i ){
+    ptr[i] = (UInt8)(val >> (8*i));
+  }
+}
+
+/** Read a PNM header number, skipping white space and comments. */
+static Bool
+GetPNMNumber(const UInt8 * data, SInt64 size, SInt64 & pos, SInt & val)
+{
+  while ( pos < size ){
+    if ( data[pos] == '#' ){
+      while ( (pos < size) && (data[pos] != '\n') ){
+        ++pos;
+      }
+    }
+    else if ( isspace(data[pos]) ){
+      ++pos;
+    }
+    else {
+      break;
+    }
+  }
+  if ( (pos >= size) || !isdigit(data[pos]) ){
+    return False;
+  }
+  val = 0;
+  while ( (pos < size) && isdigit(data[pos]) ){
+    if ( val > 100000000 ){
+      return False;
+    }
+    val = val*10+(data[pos++]-'0');
+  }
+  return True;
+}
+
+/** Compare names ignoring case. */
+static Bool
+IsSameName(const Char * a, const Char * b)
+{
+  while ( (*a != '\0') && (tolower((UInt8)*a) == tolower((UInt8)*b)) ){
+    ++a;
+    ++b;
+  }
+  return ( tolower((UInt8)*a) == tolower((UInt8)*b) );
+}
+
+/****************************************************************************/
+
+HeatWaveImage *
+HeatWaveImageFile::DoRead(const Char * file, const Char * form,
+                          const Char *& errm)
+{
+  errm = NULL;
+  if ( (file == NULL) || (form && (GetFormat(NULL, form) == FmtNone)) ){
+    return NULL;
+  }
+#ifdef HEATWAVEIMAGEFILEMMAP
+  SInt fd = open(file, O_RDONLY);
+  if ( fd < 0 ){
+    return NULL;
+  }
+  struct stat st;
+  if ( (fstat(fd, &st) != 0) || !S_ISREG(st.st_mode) || (st.st_size < 2) ){
+    close(fd);
+    return NULL;
+  }
+  void * map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if ( map == MAP_FAILED ){
+    return NULL;
+  }
+  HeatWaveImage * img = DoReadData((const UInt8*)map, st.st_size, errm);
+  munmap(map, st.st_size);
+  return img;
+#else
+  // no memory maps, read the whole file instead
+  FILE * in = fopen(file, "rb");
+  if ( in == NULL ){
+    return NULL;
+  }
+  long size = -1;
+  if ( fseek(in, 0, SEEK_END) == 0 ){
+    size = ftell(in);
+    rewind(in);
+  }
+  if ( size < 2 ){
+    fclose(in);
+    return NULL;
+  }
+  UInt8 * data = new UInt8[size];
+  LEAVEONNULL(data);
+  HeatWaveImage * img = NULL;
+  if ( fread(data, 1, size, in) == (size_t)size ){
+    img = DoReadData(data, size, errm);
+  }
+  fclose(in);
+  delete [] data;
+  return img;
+#endif
+}
+
+HeatWaveImage *
+HeatWaveImageFile::DoReadData(const UInt8 * data, SInt64 size,
+                              const Char *& errm)
+{
+  if ( (data[0] == 'B') && (data[1] == 'M') ){
+    return DoReadBMP(data, size, errm);
+  }
+  if ( (data[0] == 'P') && ((data[1] == '5') || (data[1] == '6')) ){
+    return DoReadPNM(data, size, errm);
+  }
+  return NULL;
+}
+
+HeatWaveImage *
+HeatWaveImageFile::DoReadBMP(const UInt8 * data, SInt64 size,
+                             const Char *& errm)
+{
+  if ( (size >= 18) && (GetLE(data+14, 4) < 40) ){
+    // the old OS/2 headers are left to others
+    return NULL;
+  }
+  if ( size < 54 ){
+    errm = "truncated BMP header";
+    return NULL;
+  }
+  SInt64 offs = GetLE(data+10, 4);
+  SInt64 head = 14+(SInt64)GetLE(data+14, 4);
+  SInt width = (SInt)GetLE(data+18, 4);
+  SInt height = (SInt)GetLE(data+22, 4);
+  SInt bpp = GetLE(data+28, 2);
+  UInt32 comp = GetLE(data+30, 4);
+  if ( (comp != 0) || ((bpp != 8) && (bpp != 24) && (bpp != 32)) ){
+    return NULL;
+  }
+  Bool flip = ( height > 0 );
+  if ( height < 0 ){
+    height = -height;
+  }
+  SInt64 pitch = (((SInt64)width*bpp+31)/32)*4;
+  if ( (width <= 0) || (height <= 0) || (width > 0x1000000) ||
+       (head > offs) || (offs+pitch*height > size) ){
+    errm = "truncated or corrupt BMP file";
+    return NULL;
+  }
+
+  // a 8 bit palette of greys gives a grey image, else RGB
+  UInt8 pal[256][3];
+  Bool grey = False;
+  if ( bpp == 8 ){
+    SInt64 used = GetLE(data+46, 4);
+    if ( (used == 0) || (used > 256) ){
+      used = 256;
+    }
+    if ( head+4*used > offs ){
+      errm = "truncated or corrupt BMP palette";
+      return NULL;
+    }
+    memset(pal, 0, sizeof(pal));
+    grey = True;
+    for ( SInt i = 0 ; i < used ; ++i ){
+      pal[i][0] = data[head+4*i+2];
+      pal[i][1] = data[head+4*i+1];
+      pal[i][2] = data[head+4*i];
+      grey = grey && (pal[i][0] == pal[i][1]) && (pal[i][1] == pal[i][2]);
+    }
+  }
+  SInt num = grey ? 1 : 3;
+  HeatWaveImage * img = GetNewImage(width, height, num, 8);
+  HEATWAVEPROFILE(PrfImageIO, (SInt64)width*height*num, pitch*height);
+  Smpl ** rows[3] = {NULL, NULL, NULL};
+  for ( SInt c = 0 ; c < num ; ++c ){
+    rows[c] = img->GetComponent(c).GetRows();
+  }
+  Bool ident = grey;
+  for ( SInt i = 0 ; ident && (i < 256) ; ++i ){
+    ident = ( pal[i][0] == i );
+  }
+  SInt step = bpp/8;
+  for ( SInt y = 0 ; y < height ; ++y ){
+    const UInt8 * src = data+offs+pitch*(flip ? (height-1-y) : y);
+    if ( ident ){
+      DoWiden8(src, rows[0][y], width);
+    }
+    else if ( grey ){
+      Smpl * dst = rows[0][y];
+      for ( SInt x = 0 ; x < width ; ++x ){
+        dst[x] = pal[src[x]][0];
+      }
+    }
+    else if ( bpp == 8 ){
+      Smpl * r = rows[0][y], * g = rows[1][y], * b = rows[2][y];
+      for ( SInt x = 0 ; x < width ; ++x ){
+        r[x] = pal[src[x]][0];
+        g[x] = pal[src[x]][1];
+        b[x] = pal[src[x]][2];
+      }
+    }
+    else {
+      Smpl * r = rows[0][y], * g = rows[1][y], * b = rows[2][y];
+      for ( SInt x = 0 ; x < width ; ++x, src += step ){
+        b[x] = src[0];
+        g[x] = src[1];
+        r[x] = src[2];
+      }
+    }
+  }
+  return img;
+}
+
+HeatWaveImage *
+HeatWaveImageFile::DoReadPNM(const UInt8 * data, SInt64 size,
+                             const Char *& errm)
+{
+  SInt num = (data[1] == '5') ? 1 : 3;
+  SInt64 pos = 2;
+  SInt width = 0, height = 0, max = 0;
+  if ( !GetPNMNumber(data, size, pos, width) ||
+       !GetPNMNumber(data, size, pos, height) ||
+       !GetPNMNumber(data, size, pos, max) || (pos >= size) ||
+       !isspace(data[pos]) ){
+    errm = "corrupt PNM header";
+    return NULL;
+  }
+  ++pos;
+  SInt bps = (max < 256) ? 1 : 2;
+  if ( (width <= 0) || (height <= 0) || (max <= 0) || (max > 65535) ||
+       (pos+(SInt64)width*height*num*bps > size) ){
+    errm = "truncated or corrupt PNM file";
+    return NULL;
+  }
+  SInt prec = 1;
+  while ( (1 << prec) <= max ){
+    ++prec;
+  }
+  HeatWaveImage * img = GetNewImage(width, height, num, prec);
+  HEATWAVEPROFILE(PrfImageIO, (SInt64)width*height*num,
+                  (SInt64)width*height*num*bps);
+  Smpl ** rows[3] = {NULL, NULL, NULL};
+  for ( SInt c = 0 ; c < num ; ++c ){
+    rows[c] = img->GetComponent(c).GetRows();
+  }
+  const UInt8 * src = data+pos;
+  for ( SInt y = 0 ; y < height ; ++y ){
+    if ( num == 1 ){
+      if ( bps == 1 ){
+        DoWiden8(src, rows[0][y], width);
+      }
+      else {
+        DoWiden16(src, rows[0][y], width);
+      }
+      src += width*bps;
+      continue;
+    }
+    Smpl * r = rows[0][y], * g = rows[1][y], * b = rows[2][y];
+    if ( bps == 1 ){
+      for ( SInt x = 0 ; x < width ; ++x, src += 3 ){
+        r[x] = src[0];
+        g[x] = src[1];
+        b[x] = src[2];
+      }
+    }
+    else {
+      for ( SInt x = 0 ; x < width ; ++x, src += 6 ){
+        r[x] = (src[0] << 8) | src[1];
+        g[x] = (src[2] << 8) | src[3];
+        b[x] = (src[4] << 8) | src[5];
+      }
+    }
+  }
+  return img;
+}
+
+/****************************************************************************/
+
+Bool
+HeatWaveImageFile::IsWritable(const HeatWaveImage & img, const Char * file,
+                              const Char * form)
+{
+  EnumFormat fmt = GetFormat(file, form);
+  SInt num = img.GetComponentN();
+  if ( (fmt == FmtNone) || (file == NULL) || ((num != 1) && (num != 3)) ||
+       (img.GetWidth() <= 0) || (img.GetHeight() <= 0) ){
+    return False;
+  }
+  for ( SInt c = 0 ; c < num ; ++c ){
+    HeatWaveComponent & cmp = img.GetComponent(c);
+    if ( (cmp.GetWidth() != img.GetWidth()) ||
+         (cmp.GetHeight() != img.GetHeight()) ||
+         (cmp.GetHStep() != 1) || (cmp.GetVStep() != 1) || cmp.GetSgnd() ||
+         (cmp.GetPrec() != img.GetComponent(0).GetPrec()) ||
+         (cmp.GetPrec() > ((fmt == FmtBMP) ? 8 : 16)) ){
+      return False;
+    }
+  }
+  return True;
+}
+
+Bool
+HeatWaveImageFile::DoWrite(const HeatWaveImage & img, const Char * file,
+                           const Char * form, const Char *& errm)
+{
+  errm = NULL;
+  if ( !IsWritable(img, file, form) ){
+    errm = "image can not be written natively";
+    return False;
+  }
+  FILE * out = fopen(file, "wb");
+  if ( out == NULL ){
+    errm = "unable to open file";
+    return False;
+  }
+  HEATWAVEPROFILE(PrfImageIO,
+                  (SInt64)img.GetWidth()*img.GetHeight()*img.GetComponentN(),
+                  0);
+  Bool ok = ( GetFormat(file, form) == FmtBMP ) ? DoWriteBMP(img, out) :
+    DoWritePNM(img, out);
+  ok = ( fclose(out) == 0 ) && ok;
+  if ( !ok ){
+    errm = "failed writing image";
+    remove(file);
+  }
+  return ok;
+}
+
+Bool
+HeatWaveImageFile::DoWriteBMP(const HeatWaveImage & img, FILE * out)
+{
+  SInt num = img.GetComponentN();
+  SInt width = img.GetWidth();
+  SInt height = img.GetHeight();
+  SInt pitch = ((width*8*num+31)/32)*4;
+  SInt offs = 54+((num == 1) ? 1024 : 0);
+  UInt8 head[54];
+  memset(head, 0, sizeof(head));
+  head[0] = 'B';
+  head[1] = 'M';
+  DoPutLE(head+2, offs+pitch*height, 4);
+  DoPutLE(head+10, offs, 4);
+  DoPutLE(head+14, 40, 4);
+  DoPutLE(head+18, width, 4);
+  DoPutLE(head+22, height, 4);
+  DoPutLE(head+26, 1, 2);
+  DoPutLE(head+28, 8*num, 2);
+  DoPutLE(head+34, pitch*height, 4);
+  DoPutLE(head+46, (num == 1) ? 256 : 0, 4);
+  Bool ok = ( fwrite(head, 1, sizeof(head), out) == sizeof(head) );
+  if ( num == 1 ){
+    UInt8 pal[1024];
+    for ( SInt i = 0 ; i < 256 ; ++i ){
+      pal[4*i] = pal[4*i+1] = pal[4*i+2] = (UInt8)i;
+      pal[4*i+3] = 0;
+    }
+    ok = ok && ( fwrite(pal, 1, sizeof(pal), out) == sizeof(pal) );
+  }
+
+  // bottom up, BGR
+  HeatWaveView view[3];
+  for ( SInt c = 0 ; c < num ; ++c ){
+    view[c] = img.GetComponent(c).GetView();
+  }
+  SInt max = (1 << img.GetComponent(0).GetPrec())-1;
+  Smpl * smpl = new Smpl[width];
+  UInt8 * cmp = new UInt8[3*width];
+  UInt8 * row = new UInt8[pitch];
+  LEAVEONNULL(smpl);
+  LEAVEONNULL(cmp);
+  LEAVEONNULL(row);
+  memset(row, 0, pitch);
+  for ( SInt y = height-1 ; ok && (y >= 0) ; --y ){
+    if ( num == 1 ){
+      DoNarrow8(view[0].GetRow(y, smpl), row, width, max);
+    }
+    else {
+      for ( SInt c = 0 ; c < 3 ; ++c ){
+        DoNarrow8(view[c].GetRow(y, smpl), cmp+c*width, width, max);
+      }
+      for ( SInt x = 0 ; x < width ; ++x ){
+        row[3*x] = cmp[2*width+x];
+        row[3*x+1] = cmp[width+x];
+        row[3*x+2] = cmp[x];
+      }
+    }
+    ok = ( fwrite(row, 1, pitch, out) == (size_t)pitch );
+  }
+  delete [] smpl;
+  delete [] cmp;
+  delete [] row;
+  return ok;
+}
+
+Bool
+HeatWaveImageFile::DoWritePNM(const HeatWaveImage & img, FILE * out)
+{
+  SInt num = img.GetComponentN();
+  SInt width = img.GetWidth();
+  SInt height = img.GetHeight();
+  SInt max = (1 << img.GetComponent(0).GetPrec())-1;
+  SInt bps = (max < 256) ? 1 : 2;
+  Bool ok = ( fprintf(out, "P%c\n%d %d\n%d\n", (num == 1) ? '5' : '6',
+                      width, height, max) > 0 );
+  HeatWaveView view[3];
+  for ( SInt c = 0 ; c < num ; ++c ){
+    view[c] = img.GetComponent(c).GetView();
+  }
+  Smpl * smpl = new Smpl[width];
+  UInt8 * cmp = new UInt8[3*width];
+  UInt8 * row = new UInt8[width*num*bps];
+  LEAVEONNULL(smpl);
+  LEAVEONNULL(cmp);
+  LEAVEONNULL(row);
+  for ( SInt y = 0 ; ok && (y < height) ; ++y ){
+    if ( bps == 1 ){
+      if ( num == 1 ){
+        DoNarrow8(view[0].GetRow(y, smpl), row, width, max);
+      }
+      else {
+        for ( SInt c = 0 ; c < 3 ; ++c ){
+          DoNarrow8(view[c].GetRow(y, smpl), cmp+c*width, width, max);
+        }
+        for ( SInt x = 0 ; x < width ; ++x ){
+          row[3*x] = cmp[x];
+          row[3*x+1] = cmp[width+x];
+          row[3*x+2] = cmp[2*width+x];
+        }
+      }
+    }
+    else {
+      for ( SInt c = 0 ; c < num ; ++c ){
+        const Smpl * src = view[c].GetRow(y, smpl);
+        UInt8 * dst = row+2*c;
+        for ( SInt x = 0 ; x < width ; ++x, dst += 2*num ){
+          SInt val = (src[x] < 0) ? 0 : ((src[x] > max) ? max : src[x]);
+          dst[0] = (UInt8)(val >> 8);
+          dst[1] = (UInt8)val;
+        }
+      }
+    }
+    ok = ( fwrite(row, num*bps, width, out) == (size_t)width );
+  }
+  delete [] smpl;
+  delete [] cmp;
+  delete [] row;
+  return ok;
+}
+
+/****************************************************************************/
+
+HeatWaveImageFile::EnumFormat
+HeatWaveImageFile::GetFormat(const Char * file, const Char * form)
+{
+  const Char * name = form;
+  if ( (name == NULL) && (file != NULL) ){
+    name = strrchr(file, '.');
+    if ( name == NULL ){
+      return FmtNone;
+    }
+    ++name;
+  }
+  if ( name == NULL ){
+    return FmtNone;
+  }
+  if ( IsSameName(name, "bmp") ){
+    return FmtBMP;
+  }
+  if ( IsSameName(name, "pnm") || IsSameName(name, "pgm") ||
+       IsSameName(name, "ppm") ){
+    return FmtPNM;
+  }
+  return FmtNone;
+}
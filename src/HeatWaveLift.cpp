@@ -7,8 +7,92 @@
  **/
 
 #include "HeatWaveLift.hpp"
+#include "HeatWaveMemory.hpp"
 #define MOD_FOR_NOW 256
 
+#if defined(__GNUC__) && defined(__SSE2__)
+#include <emmintrin.h>
+#define HEATWAVELIFTSSE2
+#endif
+
+/****************************************************************************/
+
+/** No vector kernel for the sample type, nothing done. */
+template <class T>
+static SInt
+DoRun2_2(const T *, T *, const T *, SInt, Bool, Bool)
+{
+  return 0;
+}
+
+#ifdef HEATWAVELIFTSSE2
+/** The (2,2) step on 8 samples at a time, see DoRow2_2(). The sums are
+ ** averaged with a bias, which is exact where a+c does not fit 16 bits, and
+ ** the results wrap as the scalar kernel's do. Returns the samples done. */
+static SInt
+DoRun2_2(const Smpl16 * a, Smpl16 * b, const Smpl16 * c, SInt num, 
+         Bool prd, Bool fwd)
+{
+  const __m128i bias = _mm_set1_epi16((short)0x8000);
+  const __m128i one = _mm_set1_epi16(1);
+  Bool sub = (prd == fwd);
+  SInt i = 0;
+  for ( ; i+8 <= num ; i += 8 ){
+    __m128i va = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a+i)), bias);
+    __m128i vc = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(c+i)), bias);
+    // (a+c+1)>>1
+    __m128i val = _mm_avg_epu16(va, vc);
+    if ( !prd ){
+      // ((a+c)>>1)+1)>>1, the same as (a+c+2)>>2
+      val = _mm_sub_epi16(val, _mm_and_si128(_mm_xor_si128(va, vc), one));
+      val = _mm_avg_epu16(val, bias);
+    }
+    val = _mm_xor_si128(val, bias);
+    __m128i vb = _mm_loadu_si128((const __m128i*)(b+i));
+    vb = sub ? _mm_sub_epi16(vb, val) : _mm_add_epi16(vb, val);
+    _mm_storeu_si128((__m128i*)(b+i), vb);
+  }
+  return i;
+}
+
+/** The (2,2) step on 4 samples at a time, see DoRow2_2(). The sums wrap as
+ ** the scalar kernel's do. Returns the samples done. */
+static SInt
+DoRun2_2(const Smpl * a, Smpl * b, const Smpl * c, SInt num, Bool prd, 
+         Bool fwd)
+{
+  const __m128i bias = _mm_set1_epi32(prd ? 1 : 2);
+  Bool sub = (prd == fwd);
+  SInt i = 0;
+  for ( ; i+4 <= num ; i += 4 ){
+    __m128i va = _mm_loadu_si128((const __m128i*)(a+i));
+    __m128i vc = _mm_loadu_si128((const __m128i*)(c+i));
+    __m128i val = _mm_add_epi32(_mm_add_epi32(va, vc), bias);
+    val = prd ? _mm_srai_epi32(val, 1) : _mm_srai_epi32(val, 2);
+    __m128i vb = _mm_loadu_si128((const __m128i*)(b+i));
+    vb = sub ? _mm_sub_epi32(vb, val) : _mm_add_epi32(vb, val);
+    _mm_storeu_si128((__m128i*)(b+i), vb);
+  }
+  return i;
+}
+#endif
+
+/** The (2,2) predict (b -= (a+c+1)>>1) or update (b += (a+c+2)>>2) step,
+ ** as Trn2_2PrdFwd() and Trn2_2UpdFwd() or their inverse, over a run of
+ ** samples. */
+template <class T>
+static void
+DoRow2_2(const T * a, T * b, const T * c, SInt num, Bool prd, Bool fwd)
+{
+  Bool sub = (prd == fwd);
+  for ( SInt i = DoRun2_2(a, b, c, num, prd, fwd) ; i < num ; ++i ){
+    SInt val = prd ? (((a[i]+c[i])+1)>>1) : (((a[i]+c[i])+2)>>2);
+    b[i] = (T)(sub ? (b[i]-val) : (b[i]+val));
+  }
+}
+
+/****************************************************************************/
+
 HeatWaveLift::HeatWaveLift()
 {
   memset((char*)this,'\0',sizeof(HeatWaveLift));
@@ -36,9 +120,10 @@ HeatWaveLift::~HeatWaveLift()
   DoRelease();
 }
  
+template <class T>
 void
-HeatWaveLift::Split(Smpl * data, SInt len, SInt step,
-                    Smpl* & even, Smpl* & odd)
+HeatWaveLift::Split(T * data, SInt len, SInt step,
+                    T* & even, T* & odd)
 {
   ASSERT ( len >= 0 );
   ASSERT ( step > 0 );
@@ -63,8 +148,9 @@ HeatWaveLift::Split(Smpl * data, SInt len, SInt step,
   odd  = data+(even_len*step);
 }
 
+template <class T>
 void 
-HeatWaveLift::Join(Smpl * data, SInt len, SInt step)
+HeatWaveLift::Join(T * data, SInt len, SInt step)
 {
   ASSERT ( len >= 0 );
   ASSERT ( step > 0 );
@@ -87,6 +173,53 @@ HeatWaveLift::Join(Smpl * data, SInt len, SInt step)
   }
 }
 
+template <class T>
+void
+HeatWaveLift::SplitRows(T * data, SInt len, SInt num, SInt step)
+{
+  ASSERT ( (num > 0) && (step >= num) );
+  if ( len <= 1 ){
+    return;
+  }
+  SInt even_len, odd_len;
+  FindLengths(len, even_len, odd_len);
+  // the buffer holds the odd rows, in samples of its own type
+  DoAllocate(((odd_len*num*sizeof(T))+sizeof(Smpl)-1)/sizeof(Smpl));
+  T * buf = (T*)m_buffer;
+  for ( SInt i = 0 ; i < odd_len ; ++i ){
+    memcpy(buf+(i*num), data+(((i*2)+1)*step), num*sizeof(T));
+  }
+  for ( SInt i = 1 ; i < even_len ; ++i ){
+    memcpy(data+(i*step), data+((i*2)*step), num*sizeof(T));
+  }
+  for ( SInt i = 0 ; i < odd_len ; ++i ){
+    memcpy(data+((even_len+i)*step), buf+(i*num), num*sizeof(T));
+  }
+}
+
+template <class T>
+void
+HeatWaveLift::JoinRows(T * data, SInt len, SInt num, SInt step)
+{
+  ASSERT ( (num > 0) && (step >= num) );
+  if ( len <= 1 ){
+    return;
+  }
+  SInt even_len, odd_len;
+  FindLengths(len, even_len, odd_len);
+  DoAllocate(((odd_len*num*sizeof(T))+sizeof(Smpl)-1)/sizeof(Smpl));
+  T * buf = (T*)m_buffer;
+  for ( SInt i = 0 ; i < odd_len ; ++i ){
+    memcpy(buf+(i*num), data+((even_len+i)*step), num*sizeof(T));
+  }
+  for ( SInt i = even_len-1 ; i >= 1 ; --i ){
+    memcpy(data+((i*2)*step), data+(i*step), num*sizeof(T));
+  }
+  for ( SInt i = 0 ; i < odd_len ; ++i ){
+    memcpy(data+(((i*2)+1)*step), buf+(i*num), num*sizeof(T));
+  }
+}
+
 void
 HeatWaveLift::SplitOpt(Smpl * data, SInt len, SInt step,
                        Smpl* & even, Smpl* & odd)
@@ -428,11 +561,13 @@ HeatWaveLift::JoinVideo(HeatWaveImage ** imgs, SInt ilen)
   delete tmp;
 }
 
+template <class T>
 SInt
-HeatWaveLift::GetFuncArray(HeatWaveLift::m_lftFunction * func,  
+HeatWaveLift::GetFuncArray(void (HeatWaveLift::** func)(T *, T *, SInt, SInt,
+                                                         Bool) const,
                            EnumTransform tran, Bool dirs, Bool prd, Bool upd)
 {
-  memset((char*)func,'\0',HEATWAVELIFTMAXSTEPS*sizeof(m_lftFunction));
+  memset((char*)func,'\0',HEATWAVELIFTMAXSTEPS*sizeof(*func));
   int j = 0;
   switch ( tran ){
   case Trn0_0: // The (0,0) transform
@@ -569,7 +704,7 @@ HeatWaveLift::GetFuncArray(HeatWaveLift::m_lftFunction * func,
   }
   if ( (!dirs) && (j>1) ){
     // Reverse the functions.
-    void (HeatWaveLift::*func_tmp[HEATWAVELIFTMAXSTEPS])(Smpl *, Smpl *, SInt, 
+    void (HeatWaveLift::*func_tmp[HEATWAVELIFTMAXSTEPS])(T *, T *, SInt, 
                                                          SInt, Bool) const;
     for ( SInt i = 0 ; i < j ; ++ i ){
       func_tmp[(j-1)-i] = func[i];
@@ -584,35 +719,40 @@ HeatWaveLift::GetFuncArray(HeatWaveLift::m_lftFunction * func,
 /****************************************************************************/
 /*                             Transform (1,1)                              */
 
+template <class T>
 void 
-HeatWaveLift::Trn1_1PrdFwd(const Smpl & a, Smpl & b) const
+HeatWaveLift::Trn1_1PrdFwd(const T & a, T & b) const
 {
   b -= a;
 }
 
+template <class T>
 void
-HeatWaveLift::Trn1_1UpdFwd(Smpl & a, const Smpl & b) const
+HeatWaveLift::Trn1_1UpdFwd(T & a, const T & b) const
 {
   a += b >> 1;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn1_1UpdRev(Smpl & a, const Smpl & b) const
+HeatWaveLift::Trn1_1UpdRev(T & a, const T & b) const
 {
   a -= b >> 1;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn1_1PrdRev(const Smpl & a, Smpl & b) const
+HeatWaveLift::Trn1_1PrdRev(const T & a, T & b) const
 {
   b += a;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn1_1Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn1_1Prd(T * even, T * odd, SInt len, SInt step, 
                         Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, Smpl & b) const;
+  void (HeatWaveLift::*fnc) (const T & a, T & b) const;
   SInt odd_len = len >> 1;
   ASSERT ( step >= 1 );
   
@@ -632,11 +772,12 @@ HeatWaveLift::Trn1_1Prd(Smpl * even, Smpl * odd, SInt len, SInt step,
   }
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn1_1Upd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn1_1Upd(T * even, T * odd, SInt len, SInt step, 
                         Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (Smpl & a, const Smpl & b) const;
+  void (HeatWaveLift::*fnc) (T & a, const T & b) const;
   SInt odd_len = len >> 1;
   ASSERT ( step >= 1 );
   
@@ -659,43 +800,48 @@ HeatWaveLift::Trn1_1Upd(Smpl * even, Smpl * odd, SInt len, SInt step,
 /****************************************************************************/
 /*                             Transform (1,1)+PPP                          */
 
+template <class T>
 void 
-HeatWaveLift::Trn1_1mPrdFwd(const Smpl & a, Smpl & b) const
+HeatWaveLift::Trn1_1mPrdFwd(const T & a, T & b) const
 {
   b = (m_mod+(b-a))%m_mod;
   ASSERT(b >= 0);
   ASSERT(b < m_mod);
 }
 
+template <class T>
 void
-HeatWaveLift::Trn1_1mUpdFwd(Smpl & a, const Smpl & b) const
+HeatWaveLift::Trn1_1mUpdFwd(T & a, const T & b) const
 {
   a = ((m_mod-a)+((m_mod<<1)-b))%m_mod;
   ASSERT(a >= 0);
   ASSERT(a < m_mod);
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn1_1mUpdRev(Smpl & a, const Smpl & b) const
+HeatWaveLift::Trn1_1mUpdRev(T & a, const T & b) const
 {
   a = ((((m_mod+1)>>1)*a)+(((m_mod+1)>>1*b)))%m_mod;
   ASSERT(a >= 0);
   ASSERT(a < m_mod);
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn1_1mPrdRev(const Smpl & a, Smpl & b) const
+HeatWaveLift::Trn1_1mPrdRev(const T & a, T & b) const
 {
   b = (a+b)%m_mod;
   ASSERT(b >= 0);
   ASSERT(b < m_mod);
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn1_1mPrd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn1_1mPrd(T * even, T * odd, SInt len, SInt step, 
                          Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, Smpl & b) const;
+  void (HeatWaveLift::*fnc) (const T & a, T & b) const;
   SInt odd_len = len >> 1;
   ASSERT ( step >= 1 );
   
@@ -715,11 +861,12 @@ HeatWaveLift::Trn1_1mPrd(Smpl * even, Smpl * odd, SInt len, SInt step,
   }
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn1_1mUpd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn1_1mUpd(T * even, T * odd, SInt len, SInt step, 
                          Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (Smpl & a, const Smpl & b) const;
+  void (HeatWaveLift::*fnc) (T & a, const T & b) const;
   SInt odd_len = len >> 1;
   ASSERT ( step >= 1 );
   
@@ -742,35 +889,40 @@ HeatWaveLift::Trn1_1mUpd(Smpl * even, Smpl * odd, SInt len, SInt step,
 /****************************************************************************/
 /*                             Transform (2,2)                              */
 
+template <class T>
 void 
-HeatWaveLift::Trn2_2PrdFwd(const Smpl & a, Smpl & b, const Smpl & c) const
+HeatWaveLift::Trn2_2PrdFwd(const T & a, T & b, const T & c) const
 {
   b -= (((a+c)+1)>>1);
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn2_2UpdFwd(const Smpl & a, Smpl & b, const Smpl & c) const
+HeatWaveLift::Trn2_2UpdFwd(const T & a, T & b, const T & c) const
 {
   b += (((a+c)+2)>>2);
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn2_2UpdRev(const Smpl & a, Smpl & b, const Smpl & c) const
+HeatWaveLift::Trn2_2UpdRev(const T & a, T & b, const T & c) const
 {
   b -= (((a+c)+2)>>2);
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn2_2PrdRev(const Smpl & a, Smpl & b, const Smpl & c) const
+HeatWaveLift::Trn2_2PrdRev(const T & a, T & b, const T & c) const
 {
   b += (((a+c)+1)>>1);
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn2_2Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn2_2Prd(T * even, T * odd, SInt len, SInt step, 
                         Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, Smpl & b, const Smpl & c) const;
+  void (HeatWaveLift::*fnc) (const T & a, T & b, const T & c) const;
   Bool is_even = (len%2==0);
   Smpl odd_len = len >> 1;
   ASSERT ( odd_len >= 1 );
@@ -789,6 +941,11 @@ HeatWaveLift::Trn2_2Prd(Smpl * even, Smpl * odd, SInt len, SInt step,
   
   SInt i = 0;
   
+  if ( step == 1 ){
+    // contiguous samples, all but the edge at once
+    i = odd_len-(is_even?1:0);
+    DoRow2_2(even, odd, even+1, i, True, forward);
+  }
   for ( ; i < (odd_len-(is_even?1:0)) ; ++i ){
     (this->*fnc)(even[i*step],odd[i*step],even[(i+1)*step]);
   }
@@ -799,11 +956,12 @@ HeatWaveLift::Trn2_2Prd(Smpl * even, Smpl * odd, SInt len, SInt step,
   }
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn2_2Upd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn2_2Upd(T * even, T * odd, SInt len, SInt step, 
                         Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, Smpl & b, const Smpl & c) const;
+  void (HeatWaveLift::*fnc) (const T & a, T & b, const T & c) const;
   Bool is_even = (len%2==0);
   Smpl even_len = (len+1) >> 1;
   
@@ -825,6 +983,11 @@ HeatWaveLift::Trn2_2Upd(Smpl * even, Smpl * odd, SInt len, SInt step,
   (this->*fnc)(odd[(i+0)*step], even[(i)*step], odd[(i+0)*step]);
   i++;
   
+  if ( step == 1 ){
+    // contiguous samples, all but the edges at once
+    DoRow2_2(odd, even+1, odd+1, even_len-(is_even?0:1)-1, False, forward);
+    i = even_len-(is_even?0:1);
+  }
   for ( ; i < even_len-(is_even?0:1) ; ++i ){
     (this->*fnc)(odd[(i-1)*step], even[i*step], odd[i*step]);
   }
@@ -835,29 +998,80 @@ HeatWaveLift::Trn2_2Upd(Smpl * even, Smpl * odd, SInt len, SInt step,
   }
 }
 
+Bool
+HeatWaveLift::HasRowKernels(EnumTransform tran)
+{
+  return ( tran == Trn2_2 );
+}
+
+template <class T>
+void
+HeatWaveLift::DoLiftColumns(void (HeatWaveLift::* func)(T *, T *, SInt, SInt,
+                                                        Bool) const,
+                            T * even, T * odd, SInt len, SInt step, SInt num,
+                            Bool forward) const
+{
+  Bool prd = (func == &HeatWaveLift::Trn2_2Prd<T>);
+  Bool upd = (func == &HeatWaveLift::Trn2_2Upd<T>);
+  if ( !(prd || upd) || (len < 4) ){
+    for ( SInt k = 0 ; k < num ; ++k ){
+      (this->*func)(even+k, odd+k, len, step, forward);
+    }
+    return;
+  }
+  // as Trn2_2Prd() and Trn2_2Upd(), a row of all signals at a time
+  Bool is_even = (len%2==0);
+  SInt i = 0;
+  if ( prd ){
+    SInt odd_len = len >> 1;
+    for ( ; i < (odd_len-(is_even?1:0)) ; ++i ){
+      DoRow2_2(even+(i*step), odd+(i*step), even+((i+1)*step), num, True,
+               forward);
+    }
+    if ( is_even ){
+      DoRow2_2(even+(i*step), odd+(i*step), even+(i*step), num, True,
+               forward);
+    }
+    return;
+  }
+  SInt even_len = (len+1) >> 1;
+  DoRow2_2(odd, even, odd, num, False, forward);
+  for ( i = 1 ; i < even_len-(is_even?0:1) ; ++i ){
+    DoRow2_2(odd+((i-1)*step), even+(i*step), odd+(i*step), num, False,
+             forward);
+  }
+  if ( !is_even ){
+    DoRow2_2(odd+((i-1)*step), even+(i*step), odd+((i-1)*step), num, False,
+             forward);
+  }
+}
+
 /****************************************************************************/
 /*                             Transform (2+2,2)                            */
 
+template <class T>
 void 
-HeatWaveLift::Trn2p2_2PrdFwd(const Smpl & a, const Smpl & b, Smpl & c, 
-                             const Smpl & d, const Smpl & e) const
+HeatWaveLift::Trn2p2_2PrdFwd(const T & a, const T & b, T & c, 
+                             const T & d, const T & e) const
 {  
   c += ((a + e) - (d + b) + 8) >> 4;
 }
 
+template <class T>
 void
-HeatWaveLift::Trn2p2_2PrdRev(const Smpl & a, const Smpl & b, Smpl & c, 
-                             const Smpl & d, const Smpl & e) const
+HeatWaveLift::Trn2p2_2PrdRev(const T & a, const T & b, T & c, 
+                             const T & d, const T & e) const
 {
   c -= ((a + e) - (d + b) + 8) >> 4;
 }
 
+template <class T>
 void
-HeatWaveLift::Trn2p2_2Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn2p2_2Prd(T * even, T * odd, SInt len, SInt step, 
                           Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, const Smpl & b, Smpl & c, 
-                             const Smpl & d, const Smpl & e) const;
+  void (HeatWaveLift::*fnc) (const T & a, const T & b, T & c, 
+                             const T & d, const T & e) const;
   Bool is_even = (len%2==0);
   Smpl odd_len = len >> 1;
   ASSERT ( odd_len >= 1 );
@@ -900,54 +1114,61 @@ HeatWaveLift::Trn2p2_2Prd(Smpl * even, Smpl * odd, SInt len, SInt step,
 /****************************************************************************/
 /*                             Transform (4,4)                              */
 
+template <class T>
 void 
-HeatWaveLift::Trn4_4PrdFwd(const Smpl & a, const Smpl & b, Smpl & c, 
-                           const Smpl & d, const Smpl & e) const
+HeatWaveLift::Trn4_4PrdFwd(const T & a, const T & b, T & c, 
+                           const T & d, const T & e) const
 {
   c -= ((9*(b+d))-(1*(a+e))+8) >> 4;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn4_4UpdFwd(const Smpl & a, const Smpl & b, Smpl & c, 
-                           const Smpl & d, const Smpl & e) const
+HeatWaveLift::Trn4_4UpdFwd(const T & a, const T & b, T & c, 
+                           const T & d, const T & e) const
 {
   c += ((9*(b+d))-(1*(a+e))+16) >> 5;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn4_4UpdRev(const Smpl & a, const Smpl & b, Smpl & c, 
-                           const Smpl & d, const Smpl & e) const
+HeatWaveLift::Trn4_4UpdRev(const T & a, const T & b, T & c, 
+                           const T & d, const T & e) const
 {
   c -= ((9*(b+d))-(1*(a+e))+16) >> 5;
 }
 
+template <class T>
 void
-HeatWaveLift::Trn4_4PrdRev(const Smpl & a, const Smpl & b, Smpl & c, 
-                           const Smpl & d, const Smpl & e) const
+HeatWaveLift::Trn4_4PrdRev(const T & a, const T & b, T & c, 
+                           const T & d, const T & e) const
 {
   c += ((9*(b+d))-(1*(a+e))+8) >> 4;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn4_4BUpdFwd(const Smpl & a, const Smpl & b, Smpl & c, 
-                            const Smpl & d, const Smpl & e) const
+HeatWaveLift::Trn4_4BUpdFwd(const T & a, const T & b, T & c, 
+                            const T & d, const T & e) const
 {
   c += ((19*(b+d))-(3*(a+e))+32) >> 6;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn4_4BUpdRev(const Smpl & a, const Smpl & b, Smpl & c, 
-                            const Smpl & d, const Smpl & e) const
+HeatWaveLift::Trn4_4BUpdRev(const T & a, const T & b, T & c, 
+                            const T & d, const T & e) const
 {
   c -= ((19*(b+d))-(3*(a+e))+32) >> 6;
 }
 
+template <class T>
 void
-HeatWaveLift::Trn4_4Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn4_4Prd(T * even, T * odd, SInt len, SInt step, 
                         Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, const Smpl & b, Smpl & c, 
-                             const Smpl & d, const Smpl & e) const;
+  void (HeatWaveLift::*fnc) (const T & a, const T & b, T & c, 
+                             const T & d, const T & e) const;
   Bool is_even = (len%2==0);
   Smpl odd_len = len >> 1;
   ASSERT ( odd_len >= 1 );
@@ -988,12 +1209,13 @@ HeatWaveLift::Trn4_4Prd(Smpl * even, Smpl * odd, SInt len, SInt step,
   }
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn4_4Upd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn4_4Upd(T * even, T * odd, SInt len, SInt step, 
                         Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, const Smpl & b, Smpl & c, 
-                             const Smpl & d, const Smpl & e) const;
+  void (HeatWaveLift::*fnc) (const T & a, const T & b, T & c, 
+                             const T & d, const T & e) const;
   Bool is_even = (len%2==0);
   Smpl even_len = (len+1) >> 1;
   
@@ -1038,12 +1260,13 @@ HeatWaveLift::Trn4_4Upd(Smpl * even, Smpl * odd, SInt len, SInt step,
   }
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn4_4BUpd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn4_4BUpd(T * even, T * odd, SInt len, SInt step, 
                          Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, const Smpl & b, Smpl & c, 
-                             const Smpl & d, const Smpl & e) const;
+  void (HeatWaveLift::*fnc) (const T & a, const T & b, T & c, 
+                             const T & d, const T & e) const;
   Bool is_even = (len%2==0);
   Smpl even_len = (len+1) >> 1;
   
@@ -1091,45 +1314,50 @@ HeatWaveLift::Trn4_4BUpd(Smpl * even, Smpl * odd, SInt len, SInt step,
 /****************************************************************************/
 /*                             Transform (6,6)                              */
 
+template <class T>
 void 
-HeatWaveLift::Trn6_6PrdFwd(const Smpl & a, const Smpl & b, const Smpl & c, 
-                           Smpl & d, const Smpl & e, const Smpl & f,
-                           const Smpl & g) const
+HeatWaveLift::Trn6_6PrdFwd(const T & a, const T & b, const T & c, 
+                           T & d, const T & e, const T & f,
+                           const T & g) const
 {
   d -= (150*(c+e)-25*(b+f)+3*(a+g)+128)>>8;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn6_6UpdFwd(const Smpl & a, const Smpl & b, const Smpl & c, 
-                           Smpl & d, const Smpl & e, const Smpl & f,
-                           const Smpl & g) const
+HeatWaveLift::Trn6_6UpdFwd(const T & a, const T & b, const T & c, 
+                           T & d, const T & e, const T & f,
+                           const T & g) const
 {
   d += (150*(c+e)-25*(b+f)+3*(a+g)+256)>>9;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn6_6UpdRev(const Smpl & a, const Smpl & b, const Smpl & c, 
-                           Smpl & d, const Smpl & e, const Smpl & f,
-                           const Smpl & g) const
+HeatWaveLift::Trn6_6UpdRev(const T & a, const T & b, const T & c, 
+                           T & d, const T & e, const T & f,
+                           const T & g) const
 {
   d -= (150*(c+e)-25*(b+f)+3*(a+g)+256)>>9;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn6_6PrdRev(const Smpl & a, const Smpl & b, const Smpl & c, 
-                           Smpl & d, const Smpl & e, const Smpl & f,
-                           const Smpl & g) const
+HeatWaveLift::Trn6_6PrdRev(const T & a, const T & b, const T & c, 
+                           T & d, const T & e, const T & f,
+                           const T & g) const
 {
   d += (150*(c+e)-25*(b+f)+3*(a+g)+128)>>8;
 }
 
+template <class T>
 void
-HeatWaveLift::Trn6_6Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn6_6Prd(T * even, T * odd, SInt len, SInt step, 
                         Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, const Smpl & b, const Smpl & c, 
-                             Smpl & d, const Smpl & e, const Smpl & f,
-                             const Smpl & g) const;
+  void (HeatWaveLift::*fnc) (const T & a, const T & b, const T & c, 
+                             T & d, const T & e, const T & f,
+                             const T & g) const;
   Bool is_even = (len%2==0);
   Smpl odd_len = len >> 1;
   ASSERT ( odd_len >= 1 );
@@ -1186,13 +1414,14 @@ HeatWaveLift::Trn6_6Prd(Smpl * even, Smpl * odd, SInt len, SInt step,
   }
 }
 
+template <class T>
 void
-HeatWaveLift::Trn6_6Upd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn6_6Upd(T * even, T * odd, SInt len, SInt step, 
                         Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, const Smpl & b, const Smpl & c, 
-                             Smpl & d, const Smpl & e, const Smpl & f,
-                             const Smpl & g) const;
+  void (HeatWaveLift::*fnc) (const T & a, const T & b, const T & c, 
+                             T & d, const T & e, const T & f,
+                             const T & g) const;
   Bool is_even = (len%2==0);
   Smpl even_len = (len+1) >> 1;
   
@@ -1257,47 +1486,54 @@ HeatWaveLift::Trn6_6Upd(Smpl * even, Smpl * odd, SInt len, SInt step,
 /****************************************************************************/
 /*                             Transform (D4)                               */
 
+template <class T>
 void 
-HeatWaveLift::TrnD4_1PrdFwd(const Smpl & a, Smpl & b) const
+HeatWaveLift::TrnD4_1PrdFwd(const T & a, T & b) const
 {
   b -= ((111*a)+32) >> 6;
 }
 
+template <class T>
 void 
-HeatWaveLift::TrnD4_UpdFwd(const Smpl & a, Smpl & b, const Smpl & c) const
+HeatWaveLift::TrnD4_UpdFwd(const T & a, T & b, const T & c) const
 {
   b += (((111*c)-(17*a))+128) >> 8;
 }
 
+template <class T>
 void
-HeatWaveLift::TrnD4_2PrdFwd(const Smpl & a, Smpl & b) const
+HeatWaveLift::TrnD4_2PrdFwd(const T & a, T & b) const
 {
   b += a;
 }
 
+template <class T>
 void
-HeatWaveLift::TrnD4_2PrdRev(const Smpl & a, Smpl & b) const
+HeatWaveLift::TrnD4_2PrdRev(const T & a, T & b) const
 {
   b -= a;
 }
 
+template <class T>
 void 
-HeatWaveLift::TrnD4_UpdRev(const Smpl & a, Smpl & b, const Smpl & c) const
+HeatWaveLift::TrnD4_UpdRev(const T & a, T & b, const T & c) const
 {
   b -= (((111*c)-(17*a))+128) >> 8;
 }
 
+template <class T>
 void 
-HeatWaveLift::TrnD4_1PrdRev(const Smpl & a, Smpl & b) const
+HeatWaveLift::TrnD4_1PrdRev(const T & a, T & b) const
 {
   b += ((111*a)+32) >> 6;
 }
 
+template <class T>
 void 
-HeatWaveLift::TrnD4_1Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::TrnD4_1Prd(T * even, T * odd, SInt len, SInt step, 
                          Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, Smpl & b) const;
+  void (HeatWaveLift::*fnc) (const T & a, T & b) const;
   SInt odd_len = len >> 1;
   ASSERT ( step >= 1 );
   
@@ -1317,11 +1553,12 @@ HeatWaveLift::TrnD4_1Prd(Smpl * even, Smpl * odd, SInt len, SInt step,
   }
 }
 
+template <class T>
 void 
-HeatWaveLift::TrnD4_Upd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::TrnD4_Upd(T * even, T * odd, SInt len, SInt step, 
                         Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, Smpl & b, const Smpl & c) const;
+  void (HeatWaveLift::*fnc) (const T & a, T & b, const T & c) const;
   Bool is_even = (len%2==0);
   Smpl even_len = (len+1) >> 1;
   
@@ -1352,11 +1589,12 @@ HeatWaveLift::TrnD4_Upd(Smpl * even, Smpl * odd, SInt len, SInt step,
   }
 }
 
+template <class T>
 void 
-HeatWaveLift::TrnD4_2Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::TrnD4_2Prd(T * even, T * odd, SInt len, SInt step, 
                          Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, Smpl & b) const;
+  void (HeatWaveLift::*fnc) (const T & a, T & b) const;
   SInt even_len = (len+1) >> 1;
   ASSERT ( step >= 1 );
   
@@ -1379,59 +1617,68 @@ HeatWaveLift::TrnD4_2Prd(Smpl * even, Smpl * odd, SInt len, SInt step,
 /****************************************************************************/
 /*                             Transform (9-7)                              */
 
+template <class T>
 void 
-HeatWaveLift::Trn97_1PrdFwd(const Smpl & a, Smpl & b, const Smpl & c) const
+HeatWaveLift::Trn97_1PrdFwd(const T & a, T & b, const T & c) const
 {
   b -= ((203*(a+c))+64) >> 7;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn97_1UpdFwd(const Smpl & a, Smpl & b, const Smpl & c) const
+HeatWaveLift::Trn97_1UpdFwd(const T & a, T & b, const T & c) const
 {
   b -= ((217*(a+c))+2048) >> 12;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn97_2PrdFwd(const Smpl & a, Smpl & b, const Smpl & c) const
+HeatWaveLift::Trn97_2PrdFwd(const T & a, T & b, const T & c) const
 {
   b += ((113*(a+c))+64) >> 7;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn97_2UpdFwd(const Smpl & a, Smpl & b, const Smpl & c) const
+HeatWaveLift::Trn97_2UpdFwd(const T & a, T & b, const T & c) const
 {
   b += ((1817*(a+c))+2048) >> 12;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn97_2UpdRev(const Smpl & a, Smpl & b, const Smpl & c) const
+HeatWaveLift::Trn97_2UpdRev(const T & a, T & b, const T & c) const
 {
   b -= ((1817*(a+c))+2048) >> 12;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn97_2PrdRev(const Smpl & a, Smpl & b, const Smpl & c) const
+HeatWaveLift::Trn97_2PrdRev(const T & a, T & b, const T & c) const
 {
   b -= ((113*(a+c))+64) >> 7;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn97_1UpdRev(const Smpl & a, Smpl & b, const Smpl & c) const
+HeatWaveLift::Trn97_1UpdRev(const T & a, T & b, const T & c) const
 {
   b += ((217*(a+c))+2048) >> 12;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn97_1PrdRev(const Smpl & a, Smpl & b, const Smpl & c) const
+HeatWaveLift::Trn97_1PrdRev(const T & a, T & b, const T & c) const
 {
   b += ((203*(a+c))+64) >> 7;
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn97_1Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn97_1Prd(T * even, T * odd, SInt len, SInt step, 
                          Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, Smpl & b, const Smpl & c) const;
+  void (HeatWaveLift::*fnc) (const T & a, T & b, const T & c) const;
   Bool is_even = (len%2==0);
   Smpl odd_len = len >> 1;
   ASSERT ( odd_len >= 1 );
@@ -1459,11 +1706,12 @@ HeatWaveLift::Trn97_1Prd(Smpl * even, Smpl * odd, SInt len, SInt step,
   }
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn97_1Upd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn97_1Upd(T * even, T * odd, SInt len, SInt step, 
                          Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, Smpl & b, const Smpl & c) const;
+  void (HeatWaveLift::*fnc) (const T & a, T & b, const T & c) const;
   Bool is_even = (len%2==0);
   Smpl even_len = (len+1) >> 1;
   
@@ -1494,11 +1742,12 @@ HeatWaveLift::Trn97_1Upd(Smpl * even, Smpl * odd, SInt len, SInt step,
   }
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn97_2Prd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn97_2Prd(T * even, T * odd, SInt len, SInt step, 
                          Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, Smpl & b, const Smpl & c) const;
+  void (HeatWaveLift::*fnc) (const T & a, T & b, const T & c) const;
   Bool is_even = (len%2==0);
   Smpl odd_len = len >> 1;
   ASSERT ( odd_len >= 1 );
@@ -1526,11 +1775,12 @@ HeatWaveLift::Trn97_2Prd(Smpl * even, Smpl * odd, SInt len, SInt step,
   }
 }
 
+template <class T>
 void 
-HeatWaveLift::Trn97_2Upd(Smpl * even, Smpl * odd, SInt len, SInt step, 
+HeatWaveLift::Trn97_2Upd(T * even, T * odd, SInt len, SInt step, 
                          Bool forward) const
 {
-  void (HeatWaveLift::*fnc) (const Smpl & a, Smpl & b, const Smpl & c) const;
+  void (HeatWaveLift::*fnc) (const T & a, T & b, const T & c) const;
   Bool is_even = (len%2==0);
   Smpl even_len = (len+1) >> 1;
   
@@ -1576,6 +1826,56 @@ HeatWaveLift::SetBufferSize(SInt siz)
   DoAllocate(siz);
 }
 
+void
+HeatWaveLift::GetGains(EnumTransform tran, SFloat64 & low, 
+                       SFloat64 & high) const
+{
+  const SInt len = 32;        // impulse response length
+  const SInt mid = len >> 2;  // sample measured, well away from the edges
+  const Smpl scl = 1 << 12;   // impulse height, keeps rounding negligible
+  HeatWaveLift lift(len);
+  m_lftFunction func[HEATWAVELIFTMAXSTEPS];
+  SFloat64 lsum[HEATWAVELIFTMAXSTEPS];
+  SFloat64 hsum[HEATWAVELIFTMAXSTEPS];
+  Smpl sig[len];
+  Smpl * even, * odd;
+
+  low = 1.0;
+  high = 1.0;
+  if ( tran == Trn1_1m ){
+    // modulo arithmetic, the range never grows
+    return;
+  }
+  
+  SInt steps = lift.GetFuncArray(func, tran, True);
+  for ( SInt s = 0 ; s < steps ; ++s ){
+    lsum[s] = 0.0;
+    hsum[s] = 0.0;
+  }
+  
+  for ( SInt n = 0 ; n < len ; ++n ){
+    memset((char*)sig,'\0',len*sizeof(Smpl));
+    sig[n] = scl;
+    lift.Split(sig, len, 1, even, odd);
+    for ( SInt s = 0 ; s < steps ; ++s ){
+      (lift.*func[s])(even, odd, len, 1, True);
+      lsum[s] += abs(even[mid]);
+      hsum[s] += abs(odd[mid]);
+    }
+  }
+  
+  for ( SInt s = 0 ; s < steps ; ++s ){
+    if ( (lsum[s]/scl) > low ){
+      low = lsum[s]/scl;
+    }
+    if ( (hsum[s]/scl) > high ){
+      high = hsum[s]/scl;
+    }
+  }
+
+}
+
+
 Bool 
 HeatWaveLift::operator==(const HeatWaveLift & oth) const
 {
@@ -1589,6 +1889,14 @@ HeatWaveLift::operator=(const HeatWaveLift & oth)
   return (*this);
 }
 
+void
+HeatWaveLift::DoSwap(HeatWaveLift & oth)
+{
+  SwapValues(m_mod, oth.m_mod);
+  SwapValues(m_buffer, oth.m_buffer);
+  SwapValues(m_bufferLen, oth.m_bufferLen);
+}
+
 void 
 HeatWaveLift::DoAllocate(SInt len)
 {
@@ -1605,11 +1913,61 @@ HeatWaveLift::DoAllocate(SInt len)
   m_bufferLen = len;
   m_buffer = new Smpl[m_bufferLen];
   LEAVEONNULL(m_buffer);
+  HeatWaveMemory::AddBytes(MemLift, (SInt64)m_bufferLen*sizeof(Smpl));
 }
 
 void 
 HeatWaveLift::DoRelease()
 {
+  if ( m_buffer ){
+    HeatWaveMemory::SubBytes(MemLift, (SInt64)m_bufferLen*sizeof(Smpl));
+  }
   delete [] m_buffer;
   m_buffer = NULL;
+  m_bufferLen = 0;
 }
+
+/****************************************************************************/
+/*                             Sample type instances                        */
+
+/** 
+ ** The lifting kernels are templates on the sample type, instantiate them for
+ ** the normal (Smpl) and the 16-bit storage (Smpl16) sample types.
+ **/
+
+#define HEATWAVELIFT_KERNEL(T,name)                                         \
+  template void HeatWaveLift::name<T>(T *, T *, SInt, SInt, Bool) const;
+
+#define HEATWAVELIFT_INSTANTIATE(T)                                         \
+  template void HeatWaveLift::Split<T>(T *, SInt, SInt, T* &, T* &);        \
+  template void HeatWaveLift::Join<T>(T *, SInt, SInt);                     \
+  template void HeatWaveLift::SplitRows<T>(T *, SInt, SInt, SInt);          \
+  template void HeatWaveLift::JoinRows<T>(T *, SInt, SInt, SInt);           \
+  template SInt HeatWaveLift::GetFuncArray<T>                               \
+  (void (HeatWaveLift::**)(T *, T *, SInt, SInt, Bool) const,               \
+   EnumTransform, Bool, Bool, Bool);                                        \
+  template void HeatWaveLift::DoLiftColumns<T>                              \
+  (void (HeatWaveLift::*)(T *, T *, SInt, SInt, Bool) const,                \
+   T *, T *, SInt, SInt, SInt, Bool) const;                                 \
+  HEATWAVELIFT_KERNEL(T,Trn1_1Prd)                                          \
+  HEATWAVELIFT_KERNEL(T,Trn1_1Upd)                                          \
+  HEATWAVELIFT_KERNEL(T,Trn1_1mPrd)                                         \
+  HEATWAVELIFT_KERNEL(T,Trn1_1mUpd)                                         \
+  HEATWAVELIFT_KERNEL(T,Trn2_2Prd)                                          \
+  HEATWAVELIFT_KERNEL(T,Trn2_2Upd)                                          \
+  HEATWAVELIFT_KERNEL(T,Trn2p2_2Prd)                                        \
+  HEATWAVELIFT_KERNEL(T,Trn4_4Prd)                                          \
+  HEATWAVELIFT_KERNEL(T,Trn4_4Upd)                                          \
+  HEATWAVELIFT_KERNEL(T,Trn4_4BUpd)                                         \
+  HEATWAVELIFT_KERNEL(T,Trn6_6Prd)                                          \
+  HEATWAVELIFT_KERNEL(T,Trn6_6Upd)                                          \
+  HEATWAVELIFT_KERNEL(T,Trn97_1Prd)                                         \
+  HEATWAVELIFT_KERNEL(T,Trn97_1Upd)                                         \
+  HEATWAVELIFT_KERNEL(T,Trn97_2Prd)                                         \
+  HEATWAVELIFT_KERNEL(T,Trn97_2Upd)                                         \
+  HEATWAVELIFT_KERNEL(T,TrnD4_1Prd)                                         \
+  HEATWAVELIFT_KERNEL(T,TrnD4_Upd)                                          \
+  HEATWAVELIFT_KERNEL(T,TrnD4_2Prd)
+
+HEATWAVELIFT_INSTANTIATE(Smpl)
+HEATWAVELIFT_INSTANTIATE(Smpl16)
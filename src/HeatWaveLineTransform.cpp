@@ -0,0 +1,236 @@
+/****************************************************************************/
+/**
+ ** @file HeatWaveLineTransform.cpp
+ ** @brief Contains the HeatWaveLineTransform class definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveLineTransform.hpp"
+
+/** Add c times the sum of rows a and b to row dst. **/
+static void
+LiftRow(SFloat32 * dst, const SFloat32 * a, const SFloat32 * b, SFloat32 c,
+        SInt len)
+{
+  for ( SInt i = 0 ; i < len ; ++i ){
+    dst[i] += c*(a[i] + b[i]);
+  }
+}
+
+/****************************************************************************/
+
+HeatWaveLineSink::~HeatWaveLineSink()
+{
+}
+
+/****************************************************************************/
+
+HeatWaveLineComponentSink::HeatWaveLineComponentSink
+(HeatWaveFloatComponent & cmp) : m_cmp(cmp)
+{
+}
+
+void
+HeatWaveLineComponentSink::PutRow(SInt x, SInt y, SInt width,
+                                  const SFloat32 * row)
+{
+  x += m_cmp.GetTLX();
+  y += m_cmp.GetTLY();
+  for ( SInt i = 0 ; i < width ; ++i ){
+    m_cmp.SetSmpl(x+i, y, row[i]);
+  }
+}
+
+/****************************************************************************/
+
+HeatWaveLineTransform::HeatWaveLineTransform(SInt width, SInt height,
+                                             SInt lev,
+                                             HeatWaveLineSink * sink)
+{
+  ASSERT ( sink != NULL );
+  m_width = width;
+  m_height = height;
+  m_evw = (width>>1) + (width%2);
+  m_evh = (height>>1) + (height%2);
+  m_have = 0;
+  m_p1 = 1;
+  m_p2 = 0;
+  m_p3 = 1;
+  m_p4 = 0;
+  m_trn = ( (lev > 0) && (width > 1) && (height > 1) );
+  m_rows = NULL;
+  m_next = NULL;
+  m_sink = sink;
+
+  m_line = new SFloat32[(width > 0) ? width : 1];
+  LEAVEONNULL(m_line);
+  if ( m_trn ){
+    m_rows = new SFloat32[HEATWAVELINEROWS*width];
+    LEAVEONNULL(m_rows);
+    m_next = new HeatWaveLineTransform(m_evw, m_evh, lev-1, sink);
+    LEAVEONNULL(m_next);
+  }
+}
+
+HeatWaveLineTransform::~HeatWaveLineTransform()
+{
+  delete m_next;
+  delete [] m_rows;
+  delete [] m_line;
+}
+
+Bool
+HeatWaveLineTransform::Push(const SFloat32 * row)
+{
+  if ( m_have >= m_height ){
+    return False;
+  }
+  for ( SInt i = 0 ; i < m_width ; ++i ){
+    m_line[i] = row[i];
+  }
+  DoPushLine();
+  return True;
+}
+
+Bool
+HeatWaveLineTransform::Push(const Smpl * row)
+{
+  if ( m_have >= m_height ){
+    return False;
+  }
+  for ( SInt i = 0 ; i < m_width ; ++i ){
+    m_line[i] = (SFloat32)row[i];
+  }
+  DoPushLine();
+  return True;
+}
+
+SInt
+HeatWaveLineTransform::GetLevels() const
+{
+  return m_trn ? (1 + m_next->GetLevels()) : 0;
+}
+
+Bool
+HeatWaveLineTransform::IsDone() const
+{
+  if ( m_have < m_height ){
+    return False;
+  }
+  if ( !m_trn ){
+    return True;
+  }
+  return ( (m_p3 >= m_height) && (m_p4 >= m_height) && m_next->IsDone() );
+}
+
+void
+HeatWaveLineTransform::DoPushLine()
+{
+  if ( !m_trn ){
+    m_sink->PutRow(0, m_have++, m_width, m_line);
+    return;
+  }
+
+#ifdef DEBUG
+  // the row leaving the ring must be finished with
+  SInt old = m_have - HEATWAVELINEROWS;
+  if ( old >= 0 ){
+    if ( old%2 ){
+      ASSERT ( ((old+1) >= m_height) || ((old+1) < m_p4) );
+    }
+    else {
+      ASSERT ( old < m_p4 );
+    }
+  }
+#endif
+
+  // horizontal lifting, low pass first then high pass
+  SFloat32 * row = GetRow(m_have);
+  HeatWaveFloatComponent::DoLiftLine(m_line, m_width, True);
+  for ( SInt i = 0 ; i < m_evw ; ++i ){
+    row[i] = m_line[i*2];
+  }
+  for ( SInt i = m_evw ; i < m_width ; ++i ){
+    row[i] = m_line[((i-m_evw)*2)+1];
+  }
+  ++m_have;
+  DoAdvance();
+}
+
+void
+HeatWaveLineTransform::DoAdvance()
+{
+  Bool prog = True;
+  while ( prog ){
+    prog = False;
+
+    // first predict, needs the even neighbours
+    if ( (m_p1 < m_height) && (m_p1 < m_have) &&
+         (GetMirror(m_p1+1) < m_have) ){
+      LiftRow(GetRow(m_p1), GetRow(m_p1-1), GetRow(GetMirror(m_p1+1)),
+              HEATWAVEF97ALPHA, m_width);
+      m_p1 += 2;
+      prog = True;
+    }
+
+    // first update, needs the predicted odd neighbours
+    if ( (m_p2 < m_height) && (m_p2 < m_have) &&
+         (GetMirror(m_p2-1) < m_p1) && (GetMirror(m_p2+1) < m_p1) ){
+      LiftRow(GetRow(m_p2), GetRow(GetMirror(m_p2-1)),
+              GetRow(GetMirror(m_p2+1)), HEATWAVEF97BETA, m_width);
+      m_p2 += 2;
+      prog = True;
+    }
+
+    // second predict, the odd row is then final
+    if ( (m_p3 < m_height) && (m_p3 < m_p1) &&
+         (GetMirror(m_p3+1) < m_p2) ){
+      SFloat32 * row = GetRow(m_p3);
+      LiftRow(row, GetRow(m_p3-1), GetRow(GetMirror(m_p3+1)),
+              HEATWAVEF97GAMMA, m_width);
+      for ( SInt i = 0 ; i < m_width ; ++i ){
+        m_line[i] = row[i]*HEATWAVEF97K;
+      }
+      m_sink->PutRow(0, m_evh+(m_p3>>1), m_width, m_line);
+      m_p3 += 2;
+      prog = True;
+    }
+
+    // second update, the even row is then final
+    if ( (m_p4 < m_height) && (m_p4 < m_p2) &&
+         (GetMirror(m_p4-1) < m_p3) && (GetMirror(m_p4+1) < m_p3) ){
+      SFloat32 * row = GetRow(m_p4);
+      LiftRow(row, GetRow(GetMirror(m_p4-1)), GetRow(GetMirror(m_p4+1)),
+              HEATWAVEF97DELTA, m_width);
+      for ( SInt i = 0 ; i < m_width ; ++i ){
+        row[i] *= (1.0f/HEATWAVEF97K);
+      }
+      if ( m_width > m_evw ){
+        m_sink->PutRow(m_evw, (m_p4>>1), m_width-m_evw, row+m_evw);
+      }
+      // the LL part feeds the next level
+      m_next->Push(row);
+      m_p4 += 2;
+      prog = True;
+    }
+  }
+}
+
+SInt
+HeatWaveLineTransform::GetMirror(SInt n) const
+{
+  if ( n < 0 ){
+    return -n;
+  }
+  if ( n >= m_height ){
+    return (2*(m_height-1)) - n;
+  }
+  return n;
+}
+
+SFloat32 *
+HeatWaveLineTransform::GetRow(SInt n) const
+{
+  return m_rows + ((n%HEATWAVELINEROWS)*m_width);
+}
@@ -0,0 +1,82 @@
+/****************************************************************************/
+/**
+ ** @file HeatWaveMemory.cpp
+ ** @brief Contains the HeatWaveMemory class function definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveMemory.hpp"
+
+SInt64 HeatWaveMemory::m_current[MemTotal+1];
+SInt64 HeatWaveMemory::m_peak[MemTotal+1];
+
+/****************************************************************************/
+
+void
+HeatWaveMemory::AddBytes(EnumMemory mem, SInt64 byte)
+{
+  ASSERT ( (mem >= 0) && (mem < MemTotal) );
+  if ( byte <= 0 ){
+    return;
+  }
+  DoRaise(m_peak+mem, AtomicAdd(m_current+mem, byte));
+  DoRaise(m_peak+MemTotal, AtomicAdd(m_current+MemTotal, byte));
+}
+
+void
+HeatWaveMemory::SubBytes(EnumMemory mem, SInt64 byte)
+{
+  ASSERT ( (mem >= 0) && (mem < MemTotal) );
+  if ( byte <= 0 ){
+    return;
+  }
+  AtomicAdd(m_current+mem, -byte);
+  AtomicAdd(m_current+MemTotal, -byte);
+}
+
+SInt64
+HeatWaveMemory::GetCurrent(EnumMemory mem)
+{
+  return AtomicAdd(m_current+mem, (SInt64)0);
+}
+
+SInt64
+HeatWaveMemory::GetPeak(EnumMemory mem)
+{
+  return AtomicAdd(m_peak+mem, (SInt64)0);
+}
+
+void
+HeatWaveMemory::DoResetPeak()
+{
+  for ( SInt i = 0 ; i <= MemTotal ; ++i ){
+    SInt64 old = GetPeak((EnumMemory)i);
+    // a allocation meanwhile may raise it again, which is fine
+    AtomicSwap(m_peak+i, old, GetCurrent((EnumMemory)i));
+  }
+}
+
+void
+HeatWaveMemory::DoReport(FILE * out, const char * pre)
+{
+  fprintf(out,"%s%-10s %12s %12s\n", pre, "memory", "live(MiB)",
+          "peak(MiB)");
+  for ( SInt i = 0 ; i <= MemTotal ; ++i ){
+    EnumMemory mem = (EnumMemory)i;
+    fprintf(out,"%s%-10s %12.3f %12.3f\n", pre, MemoryName(mem),
+            GetCurrent(mem)/1048576.0, GetPeak(mem)/1048576.0);
+  }
+}
+
+void
+HeatWaveMemory::DoRaise(SInt64 * peak, SInt64 val)
+{
+  SInt64 old = AtomicAdd(peak, (SInt64)0);
+  while ( old < val ){
+    if ( AtomicSwap(peak, old, val) ){
+      return;
+    }
+    old = AtomicAdd(peak, (SInt64)0);
+  }
+}
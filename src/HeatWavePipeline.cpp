@@ -0,0 +1,316 @@
+/****************************************************************************/
+/**
+ ** @file HeatWavePipeline.cpp
+ ** @brief Contains the HeatWaveFrameQueue, HeatWaveSource, HeatWaveStage and
+ **        HeatWavePipeline class definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWavePipeline.hpp"
+
+HeatWaveFrameQueue::HeatWaveFrameQueue(SInt depth, Bool grow)
+{
+  if ( depth < 1 ){
+    depth = 1;
+  }
+  m_depth = depth;
+  m_head = 0;
+  m_imgn = 0;
+  m_closed = False;
+  m_grow = grow;
+  m_imga = new HeatWaveImage*[m_depth];
+  LEAVEONNULL(m_imga);
+  InitMutex(&m_mutex);
+  InitCond(&m_notEmpty);
+  InitCond(&m_notFull);
+}
+
+HeatWaveFrameQueue::~HeatWaveFrameQueue()
+{
+  for ( SInt i = 0 ; i < m_imgn ; ++i ){
+    delete m_imga[(m_head+i)%m_depth];
+  }
+  delete [] m_imga;
+  FreeCond(&m_notFull);
+  FreeCond(&m_notEmpty);
+  FreeMutex(&m_mutex);
+}
+
+Bool
+HeatWaveFrameQueue::DoPush(HeatWaveImage * img)
+{
+  ASSERT ( img != NULL );
+  LockMutex(&m_mutex);
+  if ( m_grow && (m_imgn == m_depth) ){
+    // double the ring, keeping the order
+    HeatWaveImage ** imga = new HeatWaveImage*[2*m_depth];
+    LEAVEONNULL(imga);
+    for ( SInt i = 0 ; i < m_imgn ; ++i ){
+      imga[i] = m_imga[(m_head+i)%m_depth];
+    }
+    delete [] m_imga;
+    m_imga = imga;
+    m_head = 0;
+    m_depth *= 2;
+  }
+  while ( (m_imgn == m_depth) && !m_closed ){
+    WaitCond(&m_notFull, &m_mutex);
+  }
+  if ( m_closed ){
+    UnlockMutex(&m_mutex);
+    delete img;
+    return False;
+  }
+  m_imga[(m_head+m_imgn)%m_depth] = img;
+  ++m_imgn;
+  SignalCond(&m_notEmpty);
+  UnlockMutex(&m_mutex);
+  return True;
+}
+
+HeatWaveImage *
+HeatWaveFrameQueue::DoPop()
+{
+  HeatWaveImage * ret = NULL;
+  LockMutex(&m_mutex);
+  while ( (m_imgn == 0) && !m_closed ){
+    WaitCond(&m_notEmpty, &m_mutex);
+  }
+  if ( m_imgn > 0 ){
+    ret = m_imga[m_head];
+    m_head = (m_head+1)%m_depth;
+    --m_imgn;
+    SignalCond(&m_notFull);
+  }
+  UnlockMutex(&m_mutex);
+  return ret;
+}
+
+void
+HeatWaveFrameQueue::DoClose()
+{
+  LockMutex(&m_mutex);
+  m_closed = True;
+  BroadcastCond(&m_notEmpty);
+  BroadcastCond(&m_notFull);
+  UnlockMutex(&m_mutex);
+}
+
+SInt
+HeatWaveFrameQueue::GetDepth() const
+{
+  return m_depth;
+}
+
+SInt
+HeatWaveFrameQueue::GetFrameN()
+{
+  LockMutex(&m_mutex);
+  SInt ret = m_imgn;
+  UnlockMutex(&m_mutex);
+  return ret;
+}
+
+/****************************************************************************/
+
+HeatWaveSource::~HeatWaveSource()
+{
+}
+
+/****************************************************************************/
+
+HeatWaveStage::~HeatWaveStage()
+{
+}
+
+void
+HeatWaveStage::DoFlush(HeatWaveFrameQueue &)
+{
+}
+
+/****************************************************************************/
+
+HeatWavePipeline::HeatWavePipeline(SInt depth)
+{
+  m_src = NULL;
+  m_stga = NULL;
+  m_stgn = 0;
+  m_depth = (depth < 1) ? 1 : depth;
+  m_frames = 0;
+}
+
+HeatWavePipeline::~HeatWavePipeline()
+{
+  delete [] m_stga;
+}
+
+void
+HeatWavePipeline::SetSource(HeatWaveSource * src)
+{
+  m_src = src;
+}
+
+void
+HeatWavePipeline::AddStage(HeatWaveStage * stg)
+{
+  if ( stg == NULL ){
+    return;
+  }
+  HeatWaveStage ** tmp = new HeatWaveStage*[m_stgn+1];
+  LEAVEONNULL(tmp);
+  for ( SInt i = 0 ; i < m_stgn ; ++i ){
+    tmp[i] = m_stga[i];
+  }
+  tmp[m_stgn] = stg;
+  delete [] m_stga;
+  m_stga = tmp;
+  ++m_stgn;
+}
+
+SInt
+HeatWavePipeline::GetStageN() const
+{
+  return m_stgn;
+}
+
+SInt
+HeatWavePipeline::DoRun()
+{
+  if ( m_src == NULL ){
+    return -1;
+  }
+  m_frames = 0;
+#ifdef HEATWAVENOTHREADS
+  return DoSerial();
+#else
+
+  // link i feeds queue i, the source is link 0
+  SInt linkn = m_stgn+1;
+  HeatWaveFrameQueue ** queues = new HeatWaveFrameQueue*[linkn];
+  LEAVEONNULL(queues);
+  Link * links = new Link[linkn];
+  LEAVEONNULL(links);
+  CommonThread * threads = new CommonThread[linkn];
+  LEAVEONNULL(threads);
+  for ( SInt i = 0 ; i < linkn ; ++i ){
+    queues[i] = new HeatWaveFrameQueue(m_depth);
+    LEAVEONNULL(queues[i]);
+  }
+  for ( SInt i = 0 ; i < linkn ; ++i ){
+    links[i].m_pipe = this;
+    links[i].m_stage = (i == 0) ? NULL : m_stga[i-1];
+    links[i].m_in = (i == 0) ? NULL : queues[i-1];
+    links[i].m_out = queues[i];
+  }
+
+  SInt started = 0;
+  for ( ; started < linkn ; ++started ){
+    if ( !StartThread(&(threads[started]), ThreadMain, &(links[started])) ){
+      break;
+    }
+  }
+  if ( started < linkn ){
+    // without every thread the queues would fill up, so give up
+    for ( SInt i = 0 ; i < linkn ; ++i ){
+      queues[i]->DoClose();
+    }
+  }
+
+  // whatever comes out of the last stage is done with
+  HeatWaveImage * img = NULL;
+  while ( (img = queues[linkn-1]->DoPop()) != NULL ){
+    delete img;
+  }
+
+  for ( SInt i = 0 ; i < started ; ++i ){
+    JoinThread(threads[i]);
+  }
+  if ( started < linkn ){
+    m_frames = -1;
+  }
+  for ( SInt i = 0 ; i < linkn ; ++i ){
+    delete queues[i];
+  }
+  delete [] threads;
+  delete [] links;
+  delete [] queues;
+  return m_frames;
+#endif
+}
+
+void *
+HeatWavePipeline::ThreadMain(void * arg)
+{
+  Link * lnk = (Link*)arg;
+  lnk->m_pipe->DoLink(*lnk);
+  return NULL;
+}
+
+void
+HeatWavePipeline::DoLink(Link & lnk)
+{
+  HeatWaveImage * img = NULL;
+  if ( lnk.m_stage == NULL ){
+    while ( (img = m_src->GetNextFrame()) != NULL ){
+      ++m_frames;
+      if ( !lnk.m_out->DoPush(img) ){
+        break;
+      }
+    }
+  }
+  else{
+    while ( (img = lnk.m_in->DoPop()) != NULL ){
+      lnk.m_stage->DoFrame(img, *(lnk.m_out));
+    }
+    lnk.m_stage->DoFlush(*(lnk.m_out));
+  }
+  lnk.m_out->DoClose();
+}
+
+SInt
+HeatWavePipeline::DoSerial()
+{
+  // a stage may push more frames than a queue holds
+  SInt linkn = m_stgn+1;
+  HeatWaveFrameQueue ** queues = new HeatWaveFrameQueue*[linkn];
+  LEAVEONNULL(queues);
+  for ( SInt i = 0 ; i < linkn ; ++i ){
+    queues[i] = new HeatWaveFrameQueue(m_depth, True);
+    LEAVEONNULL(queues[i]);
+  }
+
+  HeatWaveImage * img = NULL;
+  while ( (img = m_src->GetNextFrame()) != NULL ){
+    ++m_frames;
+    queues[0]->DoPush(img);
+    DoDrain(queues, 0);
+  }
+  for ( SInt i = 0 ; i < m_stgn ; ++i ){
+    m_stga[i]->DoFlush(*(queues[i+1]));
+    DoDrain(queues, i+1);
+  }
+
+  for ( SInt i = 0 ; i < linkn ; ++i ){
+    delete queues[i];
+  }
+  delete [] queues;
+  return m_frames;
+}
+
+void
+HeatWavePipeline::DoDrain(HeatWaveFrameQueue ** queues, SInt from)
+{
+  for ( SInt i = from ; i <= m_stgn ; ++i ){
+    while ( queues[i]->GetFrameN() > 0 ){
+      HeatWaveImage * img = queues[i]->DoPop();
+      if ( i == m_stgn ){
+        // out of the last stage
+        delete img;
+      }
+      else{
+        m_stga[i]->DoFrame(img, *(queues[i+1]));
+      }
+    }
+  }
+}
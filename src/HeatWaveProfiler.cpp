@@ -0,0 +1,152 @@
+/****************************************************************************/
+/**
+ ** @file HeatWaveProfiler.cpp
+ ** @brief Contains the HeatWaveProfiler and HeatWaveProfileTimer classes.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveProfiler.hpp"
+#include <time.h>
+
+volatile SInt HeatWaveProfiler::m_enabled = 0;
+SInt64 HeatWaveProfiler::m_calls[PrfTotal];
+SInt64 HeatWaveProfiler::m_nsecs[PrfTotal];
+SInt64 HeatWaveProfiler::m_smpls[PrfTotal];
+SInt64 HeatWaveProfiler::m_bytes[PrfTotal];
+
+/****************************************************************************/
+
+void
+HeatWaveProfiler::SetEnabled(Bool on)
+{
+  m_enabled = on ? 1 : 0;
+}
+
+Bool
+HeatWaveProfiler::IsEnabled()
+{
+  return ( m_enabled != 0 );
+}
+
+Bool
+HeatWaveProfiler::IsCompiled()
+{
+#ifdef HEATWAVEPROFILING
+  return True;
+#else
+  return False;
+#endif
+}
+
+void
+HeatWaveProfiler::AddCall(EnumProfile prf, SInt64 nsec, SInt64 smpl,
+                          SInt64 byte)
+{
+  ASSERT ( (prf >= 0) && (prf < PrfTotal) );
+  AtomicAdd(m_calls+prf, (SInt64)1);
+  AtomicAdd(m_nsecs+prf, nsec);
+  AtomicAdd(m_smpls+prf, smpl);
+  AtomicAdd(m_bytes+prf, byte);
+}
+
+void
+HeatWaveProfiler::DoReset()
+{
+  for ( SInt i = 0 ; i < PrfTotal ; ++i ){
+    AtomicSet(m_calls+i, 0);
+    AtomicSet(m_nsecs+i, 0);
+    AtomicSet(m_smpls+i, 0);
+    AtomicSet(m_bytes+i, 0);
+  }
+}
+
+SInt64
+HeatWaveProfiler::GetCalls(EnumProfile prf)
+{
+  return AtomicAdd(m_calls+prf, (SInt64)0);
+}
+
+SInt64
+HeatWaveProfiler::GetTime(EnumProfile prf)
+{
+  return AtomicAdd(m_nsecs+prf, (SInt64)0);
+}
+
+SInt64
+HeatWaveProfiler::GetSamples(EnumProfile prf)
+{
+  return AtomicAdd(m_smpls+prf, (SInt64)0);
+}
+
+SInt64
+HeatWaveProfiler::GetBytes(EnumProfile prf)
+{
+  return AtomicAdd(m_bytes+prf, (SInt64)0);
+}
+
+SInt64
+HeatWaveProfiler::GetClock()
+{
+#if defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (SInt64)ts.tv_sec*1000000000 + ts.tv_nsec;
+#elif defined(_WIN32_WCE)
+  return (SInt64)GetTickCount()*1000000;
+#else
+  // processor time, coarse but everywhere
+  return ((SInt64)clock()*1000000000)/CLOCKS_PER_SEC;
+#endif
+}
+
+void
+HeatWaveProfiler::DoReport(FILE * out, const char * pre)
+{
+  fprintf(out,"%s%-10s %10s %12s %14s %10s %8s\n", pre, "stage", "calls",
+          "time(ms)", "samples", "ns/sample", "GB/s");
+  for ( SInt i = 0 ; i < PrfTotal ; ++i ){
+    EnumProfile prf = (EnumProfile)i;
+    SInt64 calls = GetCalls(prf);
+    if ( calls == 0 ){
+      continue;
+    }
+    SInt64 nsec = GetTime(prf);
+    SInt64 smpl = GetSamples(prf);
+    SInt64 byte = GetBytes(prf);
+    fprintf(out,"%s%-10s %10.0f %12.3f %14.0f ", pre, ProfileName(prf),
+            (SFloat64)calls, nsec/1e6, (SFloat64)smpl);
+    if ( (nsec > 0) && (smpl > 0) ){
+      fprintf(out,"%10.3f ", (SFloat64)nsec/smpl);
+    }
+    else {
+      fprintf(out,"%10s ", "-");
+    }
+    if ( (nsec > 0) && (byte > 0) ){
+      // bytes per nanosecond are GB/s
+      fprintf(out,"%8.3f\n", (SFloat64)byte/nsec);
+    }
+    else {
+      fprintf(out,"%8s\n", "-");
+    }
+  }
+}
+
+/****************************************************************************/
+
+HeatWaveProfileTimer::HeatWaveProfileTimer(EnumProfile prf, SInt64 smpl,
+                                           SInt64 byte)
+  :m_prf(prf), m_start(-1), m_smpl(smpl), m_byte(byte)
+{
+  if ( HeatWaveProfiler::IsEnabled() ){
+    m_start = HeatWaveProfiler::GetClock();
+  }
+}
+
+HeatWaveProfileTimer::~HeatWaveProfileTimer()
+{
+  if ( m_start >= 0 ){
+    HeatWaveProfiler::AddCall(m_prf, HeatWaveProfiler::GetClock()-m_start,
+                              m_smpl, m_byte);
+  }
+}
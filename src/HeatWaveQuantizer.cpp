@@ -0,0 +1,258 @@
+/****************************************************************************/
+/**
+ ** @file   HeatWaveQuantizer.cpp
+ ** @brief  Contains the HeatWaveQuantizer class definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveQuantizer.hpp"
+#include "HeatWaveProfiler.hpp"
+#include <math.h>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#include <emmintrin.h>
+#define HEATWAVEQUANTIZERSSE2
+#endif
+
+/****************************************************************************/
+
+/** Quantize a row, the vector and scalar paths round the same. The
+ ** magnitudes are divided by the step, multiplying by its reciprocal would
+ ** put exact multiples of the step in the bin below. */
+static void
+DoQuantizeRow(Smpl * row, SInt num, SFloat64 step)
+{
+  SInt x = 0;
+#ifdef HEATWAVEQUANTIZERSSE2
+  if ( (sizeof(Smpl) == 4) && ((Smpl)-1 < 0) ){
+    const __m128d div = _mm_set1_pd(step);
+    for ( ; x+4 <= num ; x += 4 ){
+      __m128i val = _mm_loadu_si128((const __m128i*)(row+x));
+      __m128i sgn = _mm_srai_epi32(val, 31);
+      __m128i mag = _mm_sub_epi32(_mm_xor_si128(val, sgn), sgn);
+      __m128d lo = _mm_cvtepi32_pd(mag);
+      __m128d hi = _mm_cvtepi32_pd(_mm_shuffle_epi32(mag, 0x4E));
+      mag = _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_div_pd(lo, div)),
+                               _mm_cvttpd_epi32(_mm_div_pd(hi, div)));
+      _mm_storeu_si128((__m128i*)(row+x),
+                       _mm_sub_epi32(_mm_xor_si128(mag, sgn), sgn));
+    }
+  }
+#endif
+  for ( ; x < num ; ++x ){
+    SFloat64 mag = (row[x] < 0) ? -(SFloat64)row[x] : (SFloat64)row[x];
+    SInt32 val = (SInt32)(mag/step);
+    row[x] = (Smpl)((row[x] < 0) ? -val : val);
+  }
+}
+
+/** Reconstruct a row at the middle of the bins. */
+static void
+DoDequantizeRow(Smpl * row, SInt num, SFloat64 step)
+{
+  SInt x = 0;
+#ifdef HEATWAVEQUANTIZERSSE2
+  if ( (sizeof(Smpl) == 4) && ((Smpl)-1 < 0) ){
+    const __m128d mul = _mm_set1_pd(step);
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; x+4 <= num ; x += 4 ){
+      __m128i val = _mm_loadu_si128((const __m128i*)(row+x));
+      __m128i sgn = _mm_srai_epi32(val, 31);
+      __m128i mag = _mm_sub_epi32(_mm_xor_si128(val, sgn), sgn);
+      __m128d lo = _mm_add_pd(_mm_cvtepi32_pd(mag), half);
+      __m128d hi = _mm_add_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(mag, 0x4E)),
+                              half);
+      __m128i rec = _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_mul_pd(lo, mul)),
+                                       _mm_cvttpd_epi32(_mm_mul_pd(hi, mul)));
+      rec = _mm_andnot_si128(_mm_cmpeq_epi32(val, zero), rec);
+      _mm_storeu_si128((__m128i*)(row+x),
+                       _mm_sub_epi32(_mm_xor_si128(rec, sgn), sgn));
+    }
+  }
+#endif
+  for ( ; x < num ; ++x ){
+    if ( row[x] == 0 ){
+      continue;
+    }
+    SFloat64 mag = (row[x] < 0) ? -(SFloat64)row[x] : (SFloat64)row[x];
+    SInt32 val = (SInt32)((mag+0.5)*step);
+    row[x] = (Smpl)((row[x] < 0) ? -val : val);
+  }
+}
+
+/****************************************************************************/
+
+HeatWaveQuantizer::HeatWaveQuantizer(SFloat64 step)
+{
+  m_step = 1.0;
+  SetStep(step);
+  for ( SInt i = 0 ; i < TrnTotal ; ++i ){
+    m_norms[i] = NULL;
+  }
+}
+
+HeatWaveQuantizer::~HeatWaveQuantizer()
+{
+  for ( SInt i = 0 ; i < TrnTotal ; ++i ){
+    delete [] m_norms[i];
+  }
+}
+
+void
+HeatWaveQuantizer::SetStep(SFloat64 step)
+{
+  m_step = (step > 1.0) ? step : 1.0;
+}
+
+SFloat64
+HeatWaveQuantizer::GetStep() const
+{
+  return m_step;
+}
+
+SFloat64
+HeatWaveQuantizer::GetStep(EnumTransform trn, SInt res, EnumSubband sub)
+{
+  if ( m_step <= 1.0 ){
+    return 1.0;
+  }
+  SFloat64 step = m_step/GetNorm(trn, res, sub);
+  return (step > 1.0) ? step : 1.0;
+}
+
+SFloat64
+HeatWaveQuantizer::GetNorm(EnumTransform trn, SInt res, EnumSubband sub)
+{
+  ASSERT ( (trn >= Trn0_0) && (trn < TrnTotal) );
+  ASSERT ( (sub >= SubLL) && (sub < SubTotal) );
+  if ( (res <= 0) || (trn == Trn0_0) || (trn == Trn1_1m) ){
+    // nothing to scale, modulo arithmetic is not quantized meaningfully
+    return 1.0;
+  }
+  if ( m_norms[trn] == NULL ){
+    DoMeasure(trn);
+  }
+  const SFloat64 * norms = m_norms[trn];
+  const SInt top = HEATWAVEQUANTIZERLEVELS;
+  if ( res <= top ){
+    return norms[(4*(res-1))+sub];
+  }
+  // the norms grow by a fixed ratio per level once the support is wide
+  SFloat64 ratio = norms[4*(top-1)]/norms[4*(top-2)];
+  return norms[(4*(top-1))+sub]*pow(ratio, (SFloat64)(res-top));
+}
+
+void
+HeatWaveQuantizer::DoMeasure(EnumTransform trn)
+{
+  const Smpl amp = 1 << 12;  // impulse height, keeps rounding negligible
+  const SInt top = HEATWAVEQUANTIZERLEVELS;
+  SFloat64 * norms = new SFloat64[4*top];
+  LEAVEONNULL(norms);
+  for ( SInt res = 1 ; res <= top ; ++res ){
+    // wide enough that the edges hardly touch the basis
+    SInt size = 16 << res;
+    for ( SInt s = SubLL ; s < SubTotal ; ++s ){
+      HeatWaveComponent cmp(0, 0, 1, 1, size, size, True, 30, ClrY);
+      SInt x, y, w, h;
+      cmp.GetSubbandInfo(res, (EnumSubband)s, x, y, w, h);
+      Smpl * data = cmp.GetData();
+      memset((char*)data, 0, size*size*sizeof(Smpl));
+      data[((y+(h/2))*size)+x+(w/2)] = amp;
+      cmp.SetTransformLevel(res);
+      cmp.SetTransformType(trn);
+      cmp.DoPyramidTransform(trn, 0, False);
+      SFloat64 sum = 0.0;
+      for ( SInt i = 0 ; i < size*size ; ++i ){
+        sum += (SFloat64)data[i]*data[i];
+      }
+      norms[(4*(res-1))+s] = (sum > 0.0) ? sqrt(sum)/amp : 1.0;
+    }
+  }
+  m_norms[trn] = norms;
+}
+
+void
+HeatWaveQuantizer::DoQuantize(HeatWaveComponent & cmp)
+{
+  DoBands(cmp, True);
+}
+
+void
+HeatWaveQuantizer::DoDequantize(HeatWaveComponent & cmp)
+{
+  DoBands(cmp, False);
+}
+
+void
+HeatWaveQuantizer::DoBands(HeatWaveComponent & cmp, Bool fwd)
+{
+  if ( cmp.IsPacked() ){
+    cmp.DoUnpack();
+  }
+  EnumTransform trn = cmp.GetTransformType();
+  SInt lev = cmp.GetTransformLevel();
+  Smpl * data = cmp.GetData();
+  SInt pitch = cmp.GetWidth();
+  SInt tlx = cmp.GetTLX();
+  SInt tly = cmp.GetTLY();
+  SInt x, y, w, h;
+  for ( SInt t = 0 ; t < cmp.GetTileCount() ; ++t ){
+    // small tiles stop early, as in the transform
+    SInt deep = 0;
+    while ( (deep < lev) &&
+            cmp.GetSubbandInfo(t, deep+1, SubLL, x, y, w, h) ){
+      ++deep;
+    }
+    for ( SInt r = deep ; r >= ((deep > 0) ? 1 : 0) ; --r ){
+      for ( SInt s = ((r == deep) ? SubLL : SubHL) ; s < SubTotal ; ++s ){
+        if ( !cmp.GetSubbandInfo(t, r, (EnumSubband)s, x, y, w, h) ){
+          continue;
+        }
+        SFloat64 step = GetStep(trn, r, (EnumSubband)s);
+        Smpl * org = data+((y-tly)*pitch)+(x-tlx);
+        if ( fwd ){
+          DoQuantize(org, w, h, pitch, step);
+        }
+        else {
+          DoDequantize(org, w, h, pitch, step);
+        }
+        if ( r == 0 ){
+          break;
+        }
+      }
+    }
+  }
+}
+
+void
+HeatWaveQuantizer::DoQuantize(Smpl * org, SInt width, SInt height,
+                              SInt pitch, SFloat64 step)
+{
+  ASSERT ( step >= 1.0 );
+  if ( step == 1.0 ){
+    return;
+  }
+  HEATWAVEPROFILE(PrfQuantize, (SInt64)width*height,
+                  (SInt64)width*height*sizeof(Smpl));
+  for ( SInt y = 0 ; y < height ; ++y ){
+    DoQuantizeRow(org+(y*pitch), width, step);
+  }
+}
+
+void
+HeatWaveQuantizer::DoDequantize(Smpl * org, SInt width, SInt height,
+                                SInt pitch, SFloat64 step)
+{
+  ASSERT ( step >= 1.0 );
+  if ( step == 1.0 ){
+    return;
+  }
+  HEATWAVEPROFILE(PrfQuantize, (SInt64)width*height,
+                  (SInt64)width*height*sizeof(Smpl));
+  for ( SInt y = 0 ; y < height ; ++y ){
+    DoDequantizeRow(org+(y*pitch), width, step);
+  }
+}
@@ -0,0 +1,152 @@
+/****************************************************************************/
+/**
+ ** @file HeatWaveResampler.cpp
+ ** @brief Contains the HeatWaveResampler class definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveResampler.hpp"
+
+HeatWaveResampler::HeatWaveResampler(EnumTransform trn)
+{
+  m_trn = trn;
+}
+
+HeatWaveResampler::~HeatWaveResampler()
+{
+}
+
+void
+HeatWaveResampler::DoResample(HeatWaveComponent & cmp, SInt hoct, SInt voct)
+{
+  cmp.DoUnpack();
+  SInt width = cmp.GetWidth();
+  SInt height = cmp.GetHeight();
+  SInt nwidth = GetLength(width, hoct);
+  SInt nheight = GetLength(height, voct);
+  Bool desMem = cmp.GetDesMem();
+  Smpl ** rows = NULL;
+
+  // the rows are contiguous, so they are done in place
+  if ( nwidth < width ){
+    rows = cmp.GetRows();
+    for ( SInt y = 0 ; y < height ; ++y ){
+      DoReduce(rows[y], width, hoct);
+    }
+    cmp.DoResize(nwidth, height, True, 0, desMem);
+  }
+  else if ( nwidth > width ){
+    cmp.DoResize(nwidth, height, True, 0, desMem);
+    rows = cmp.GetRows();
+    for ( SInt y = 0 ; y < height ; ++y ){
+      DoIncrease(rows[y], width, -hoct);
+    }
+  }
+
+  // the columns a row of all of them at a time
+  if ( nheight < height ){
+    rows = cmp.GetRows();
+    DoReduceColumns(rows[0], height, nwidth, voct);
+    cmp.DoResize(nwidth, nheight, True, 0, desMem);
+  }
+  else if ( nheight > height ){
+    cmp.DoResize(nwidth, nheight, True, 0, desMem);
+    rows = cmp.GetRows();
+    DoIncreaseColumns(rows[0], height, nwidth, -voct);
+  }
+
+  cmp.SetMinPrecSgn();
+  cmp.SetTransformType(m_trn);
+}
+
+SInt
+HeatWaveResampler::DoReduce(Smpl * line, SInt len, SInt oct)
+{
+  void (HeatWaveLift::*func[HEATWAVELIFTMAXSTEPS])
+    (Smpl *, Smpl *, SInt, SInt, Bool)const;
+  SInt j = m_lift.GetFuncArray(func, m_trn, True);
+  Smpl * even;
+  Smpl * odd;
+
+  for ( SInt i = 0 ; (i < oct) && (len > 1) ; ++i ){
+    m_lift.Split(line, len, 1, even, odd);
+    for ( SInt n = 0 ; n < j ; ++n ){
+      (m_lift.*func[n])(even, odd, len, 1, True);
+    }
+    len = (len>>1) + (len%2);
+  }
+  return len;
+}
+
+SInt
+HeatWaveResampler::DoIncrease(Smpl * line, SInt len, SInt oct)
+{
+  void (HeatWaveLift::*func[HEATWAVELIFTMAXSTEPS])
+    (Smpl *, Smpl *, SInt, SInt, Bool)const;
+  SInt j = m_lift.GetFuncArray(func, m_trn, False);
+
+  for ( SInt i = 0 ; i < oct ; ++i ){
+    // zero high pass
+    for ( SInt n = len ; n < (len*2) ; ++n ){
+      line[n] = 0;
+    }
+    for ( SInt n = 0 ; n < j ; ++n ){
+      (m_lift.*func[n])(line, line+len, len*2, 1, False);
+    }
+    m_lift.Join(line, len*2, 1);
+    len *= 2;
+  }
+  return len;
+}
+
+SInt
+HeatWaveResampler::GetLength(SInt len, SInt oct)
+{
+  for ( ; (oct > 0) && (len > 1) ; --oct ){
+    len = (len>>1) + (len%2);
+  }
+  for ( ; oct < 0 ; ++oct ){
+    len *= 2;
+  }
+  return len;
+}
+
+SInt
+HeatWaveResampler::DoReduceColumns(Smpl * data, SInt len, SInt num, SInt oct)
+{
+  void (HeatWaveLift::*func[HEATWAVELIFTMAXSTEPS])
+    (Smpl *, Smpl *, SInt, SInt, Bool)const;
+  SInt j = m_lift.GetFuncArray(func, m_trn, True);
+
+  for ( SInt i = 0 ; (i < oct) && (len > 1) ; ++i ){
+    m_lift.SplitRows(data, len, num, num);
+    Smpl * odd = data+(((len+1)>>1)*num);
+    for ( SInt n = 0 ; n < j ; ++n ){
+      m_lift.DoLiftColumns(func[n], data, odd, len, num, num, True);
+    }
+    len = (len>>1) + (len%2);
+  }
+  return len;
+}
+
+SInt
+HeatWaveResampler::DoIncreaseColumns(Smpl * data, SInt len, SInt num, 
+                                     SInt oct)
+{
+  void (HeatWaveLift::*func[HEATWAVELIFTMAXSTEPS])
+    (Smpl *, Smpl *, SInt, SInt, Bool)const;
+  SInt j = m_lift.GetFuncArray(func, m_trn, False);
+
+  for ( SInt i = 0 ; i < oct ; ++i ){
+    // zero high pass
+    memset(data+(len*num), 0, len*num*sizeof(Smpl));
+    for ( SInt n = 0 ; n < j ; ++n ){
+      m_lift.DoLiftColumns(func[n], data, data+(len*num), len*2, num, num,
+                           False);
+    }
+    m_lift.JoinRows(data, len*2, num, num);
+    len *= 2;
+  }
+  return len;
+}
@@ -0,0 +1,200 @@
+/****************************************************************************/
+/**
+ ** @file HeatWaveStages.cpp
+ ** @brief Contains the sources and stages for a HeatWavePipeline.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveStages.hpp"
+
+HeatWaveAVISource::HeatWaveAVISource(HeatWaveAVIReader & rdr)
+  : m_reader(rdr)
+{
+  m_next = 0;
+  m_total = 0;
+  if ( m_reader.GetVideoHeader() ){
+    m_total = m_reader.GetVideoHeader()->dwLength;
+  }
+}
+
+HeatWaveImage *
+HeatWaveAVISource::GetNextFrame()
+{
+  if ( m_next >= m_total ){
+    return NULL;
+  }
+  return m_reader.LoadFrame(m_next++);
+}
+
+/****************************************************************************/
+
+HeatWaveColorStage::HeatWaveColorStage(EnumSpace spc, Bool lsls)
+{
+  m_space = spc;
+  m_lsls = lsls;
+}
+
+void
+HeatWaveColorStage::DoFrame(HeatWaveImage * img, HeatWaveFrameQueue & out)
+{
+  img->SetSpace(m_space, False, -1, m_lsls);
+  out.DoPush(img);
+}
+
+/****************************************************************************/
+
+HeatWaveSpatialStage::HeatWaveSpatialStage(EnumTransform trn, SInt lev,
+                                           Bool fwd)
+{
+  m_trn = trn;
+  m_lev = lev;
+  m_fwd = fwd;
+}
+
+void
+HeatWaveSpatialStage::DoFrame(HeatWaveImage * img, HeatWaveFrameQueue & out)
+{
+  img->DoPyramidTransform(m_trn, m_lev, m_fwd);
+  out.DoPush(img);
+}
+
+/****************************************************************************/
+
+HeatWaveTemporalStage::HeatWaveTemporalStage(EnumTransform trn, SInt lev,
+                                             Bool fwd, SInt gop)
+{
+  m_trn = trn;
+  m_lev = lev;
+  m_fwd = fwd;
+  m_gop = gop;
+  m_imga = NULL;
+  m_imgn = 0;
+  m_imgLen = 0;
+}
+
+HeatWaveTemporalStage::~HeatWaveTemporalStage()
+{
+  for ( SInt i = 0 ; i < m_imgn ; ++i ){
+    delete m_imga[i];
+  }
+  delete [] m_imga;
+}
+
+void
+HeatWaveTemporalStage::DoFrame(HeatWaveImage * img, HeatWaveFrameQueue & out)
+{
+  if ( m_imgn == m_imgLen ){
+    SInt len = (m_imgLen > 0) ? (m_imgLen*2) : HEATWAVEVECTORGROWTH;
+    if ( (m_gop > 0) && (len > m_gop) ){
+      len = m_gop;
+    }
+    HeatWaveImage ** tmp = new HeatWaveImage*[len];
+    LEAVEONNULL(tmp);
+    for ( SInt i = 0 ; i < m_imgn ; ++i ){
+      tmp[i] = m_imga[i];
+    }
+    delete [] m_imga;
+    m_imga = tmp;
+    m_imgLen = len;
+  }
+  m_imga[m_imgn++] = img;
+  if ( m_imgn == m_gop ){
+    DoGroup(out);
+  }
+}
+
+void
+HeatWaveTemporalStage::DoFlush(HeatWaveFrameQueue & out)
+{
+  DoGroup(out);
+}
+
+void
+HeatWaveTemporalStage::DoGroup(HeatWaveFrameQueue & out)
+{
+  if ( m_imgn == 0 ){
+    return;
+  }
+  if ( m_imgn > 1 ){
+    // the video only borrows the frames
+    HeatWaveVideo vid(m_imga[0]->GetWidth(), m_imga[0]->GetHeight(),
+                      m_imga[0]->GetSpace(), NULL, NULL, m_imgn, m_imga,
+                      False, False);
+    vid.DoTemporalTransform(m_trn, m_fwd ? m_lev : 0, m_fwd,
+                            m_fwd ? 0 : m_lev);
+    vid.SetMinPrecSgn();
+  }
+  for ( SInt i = 0 ; i < m_imgn ; ++i ){
+    out.DoPush(m_imga[i]);
+    m_imga[i] = NULL;
+  }
+  m_imgn = 0;
+}
+
+/****************************************************************************/
+
+HeatWaveEntropyStage::HeatWaveEntropyStage()
+{
+  m_bits = 0.0;
+  m_smpln = 0.0;
+  m_frmn = 0;
+}
+
+void
+HeatWaveEntropyStage::DoFrame(HeatWaveImage * img, HeatWaveFrameQueue & out)
+{
+  for ( SInt c = 0 ; c < img->GetComponentN() ; ++c ){
+    const HeatWaveComponent & cmp = img->GetComponent(c);
+    m_bits += cmp.GetEntropy()*cmp.GetSize();
+    m_smpln += cmp.GetSize();
+  }
+  ++m_frmn;
+  out.DoPush(img);
+}
+
+SFloat64
+HeatWaveEntropyStage::GetBits() const
+{
+  return m_bits;
+}
+
+SFloat64
+HeatWaveEntropyStage::GetSampleN() const
+{
+  return m_smpln;
+}
+
+SInt
+HeatWaveEntropyStage::GetFrameN() const
+{
+  return m_frmn;
+}
+
+/****************************************************************************/
+
+HeatWaveVideoSink::HeatWaveVideoSink(HeatWaveVideo & vid)
+  : m_video(vid)
+{
+}
+
+void
+HeatWaveVideoSink::DoFrame(HeatWaveImage * img, HeatWaveFrameQueue &)
+{
+  m_video.AddImage(img);
+}
+
+/****************************************************************************/
+
+HeatWaveAVISink::HeatWaveAVISink(HeatWaveAVIWriter & wrt)
+  : m_writer(wrt)
+{
+}
+
+void
+HeatWaveAVISink::DoFrame(HeatWaveImage * img, HeatWaveFrameQueue &)
+{
+  // a failure is kept by the writer, see HeatWaveAVIWriter::GetError()
+  m_writer.AddFrame(*img);
+  delete img;
+}
@@ -7,6 +7,7 @@
  **/
 
 #include "HeatWaveVideo.hpp"
+#include "HeatWaveProfiler.hpp"
 
 HeatWaveVideo::HeatWaveVideo()
 {
@@ -20,6 +21,10 @@ HeatWaveVideo::HeatWaveVideo()
     m_vsp[i]=1;
   }
   m_desMem = True;
+  m_scene = 0;
+  m_pool = NULL;
+  m_lev = 0;
+  m_trn = TrnUnknown;
 }
 
 HeatWaveVideo::HeatWaveVideo(SInt wid, SInt hei, SInt img, EnumSpace spc, 
@@ -35,6 +40,10 @@ HeatWaveVideo::HeatWaveVideo(SInt wid, SInt hei, SInt img, EnumSpace spc,
     m_vsp[i]=1;
   }
   m_desMem = True;
+  m_scene = 0;
+  m_pool = NULL;
+  m_lev = 0;
+  m_trn = TrnUnknown;
   SetWidth(wid);
   SetHeight(hei);
   SetSpace(spc);
@@ -57,6 +66,10 @@ HeatWaveVideo::HeatWaveVideo(SInt wid, SInt hei, EnumSpace spc, SInt * hsp,
     m_vsp[i]=1;
   }
   m_desMem = des;
+  m_scene = 0;
+  m_pool = NULL;
+  m_lev = 0;
+  m_trn = TrnUnknown;
   SetWidth(wid);
   SetHeight(hei);
   SetSpace(spc);
@@ -210,7 +223,7 @@ HeatWaveVideo::AddImage(HeatWaveImage * imge)
     m_imga= new HeatWaveImage*[m_imgn+HEATWAVEVECTORGROWTH];
     LEAVEONNULL(m_imga);
     memcpy(m_imga,tmp,m_imgn*sizeof(HeatWaveImage*));
-    delete tmp;
+    delete [] tmp;
   }
   
   m_imga[m_imgn] = imge;
@@ -296,6 +309,27 @@ HeatWaveVideo::GetClone() const
   return ret;
 }
 
+void
+HeatWaveVideo::DoSwap(HeatWaveVideo & other)
+{
+  // the images and the lift buffer are only moved, never duplicated
+  SwapValues(m_width, other.m_width);
+  SwapValues(m_height, other.m_height);
+  SwapValues(m_space, other.m_space);
+  SwapValues(m_imgn, other.m_imgn);
+  SwapValues(m_imga, other.m_imga);
+  for ( SInt i = 0 ; i < MAXCOLORSINANYSPACE ; ++i ){
+    SwapValues(m_hsp[i], other.m_hsp[i]);
+    SwapValues(m_vsp[i], other.m_vsp[i]);
+  }
+  SwapValues(m_desMem, other.m_desMem);
+  SwapValues(m_scene, other.m_scene);
+  SwapValues(m_pool, other.m_pool);
+  SwapValues(m_lev, other.m_lev);
+  SwapValues(m_trn, other.m_trn);
+  m_lift.DoSwap(other.m_lift);
+}
+
 Bool 
 HeatWaveVideo::IsComparable(const HeatWaveVideo & other)
 {
@@ -325,6 +359,149 @@ HeatWaveVideo::DoSpatialTransform(EnumTransform trn, SInt lev, Bool fwd,
   return ret;
 }
 
+Bool
+HeatWaveVideo::DoPack(EnumTransform trn, SInt lev)
+{
+  Bool ret = True;
+  for ( SInt i = 0 ; i < m_imgn ; ++i ){
+    ret &= GetImage(i).DoPack(trn,lev);
+  }
+  return ret;
+}
+
+void
+HeatWaveVideo::SetTiling(SInt twd, SInt thg, HeatWaveWorkerPool * pool)
+{
+  for ( SInt i = 0 ; i < m_imgn ; ++i ){
+    GetImage(i).SetTiling(twd,thg,pool);
+  }
+}
+
+void
+HeatWaveVideo::DoUnpack()
+{
+  for ( SInt i = 0 ; i < m_imgn ; ++i ){
+    GetImage(i).DoUnpack();
+  }
+}
+
+SInt
+HeatWaveVideo::DoSceneDetection(SFloat64 thr, SInt lev)
+{
+  if ( m_imgn == 0 ){
+    return 0;
+  }
+  SFloat64 * prev = new SFloat64[HEATWAVESCENEBINS];
+  LEAVEONNULL(prev);
+  SFloat64 * hist = new SFloat64[HEATWAVESCENEBINS];
+  LEAVEONNULL(hist);
+  SInt ret = 1;
+  GetSceneHistogram(0, lev, prev);
+  m_imga[0]->SetSceneSwitch(True);
+  for ( SInt i = 1 ; i < m_imgn ; ++i ){
+    GetSceneHistogram(i, lev, hist);
+    SFloat64 diff = 0.0;
+    for ( SInt b = 0 ; b < HEATWAVESCENEBINS ; ++b ){
+      diff += fabs(hist[b] - prev[b]);
+    }
+    // half the L1 distance is the fraction of samples that changed bin
+    Bool cut = ( (diff/2.0) > thr );
+    m_imga[i]->SetSceneSwitch(cut);
+    if ( cut ){
+      ++ret;
+    }
+    SFloat64 * tmp = prev;
+    prev = hist;
+    hist = tmp;
+  }
+  delete [] hist;
+  delete [] prev;
+  return ret;
+}
+
+void
+HeatWaveVideo::SetGrouping(SInt len, HeatWaveWorkerPool * pool)
+{
+  m_scene = (len > 0) ? len : 0;
+  m_pool = pool;
+}
+
+SInt
+HeatWaveVideo::GetGroupLength() const
+{
+  return m_scene;
+}
+
+SInt
+HeatWaveVideo::GetGroupCount() const
+{
+  SInt ret = 0;
+  SInt strt = 0;
+  SInt len = 0;
+  while ( GetGroupInfo(ret, strt, len) ){
+    ++ret;
+  }
+  return ret;
+}
+
+Bool
+HeatWaveVideo::GetGroupInfo(SInt num, SInt & strt, SInt & len) const
+{
+  if ( num < 0 ){
+    return False;
+  }
+  strt = 0;
+  len = 0;
+  for ( SInt i = 0 ; i < m_imgn ; ++i ){
+    if ( (len > 0) && 
+         (m_imga[i]->GetSceneSwitch() || ((m_scene > 0) && (len == m_scene))) ){
+      if ( num == 0 ){
+        return True;
+      }
+      --num;
+      strt = i;
+      len = 0;
+    }
+    ++len;
+  }
+  return ( (num == 0) && (len > 0) );
+}
+
+/****************************************************************************/
+/**
+ ** Temporal transform of a single group, see
+ ** HeatWaveVideo::DoTemporalTransform.
+ **
+ **/
+
+class HeatWaveGroupJob : public HeatWaveJob
+{
+public:
+  
+  void DoRun()
+  {
+    m_reached = m_vid->DoTemporalTransform(m_trn, m_lev, m_fwd, m_cur);
+  }
+  
+  /** The group, borrowing the images. */
+  HeatWaveVideo * m_vid;
+  
+  /** The transform type. */
+  EnumTransform m_trn;
+  
+  /** The current level. */
+  SInt m_cur;
+  
+  /** The level to transform to. */
+  SInt m_lev;
+  
+  /** Forward transform. */
+  Bool m_fwd;
+  
+  /** (Out) The level reached. */
+  SInt m_reached;
+};
+
 SInt 
 HeatWaveVideo::DoTemporalTransform(EnumTransform trn, SInt lev, Bool fwd, 
                                    SInt cur)
@@ -332,12 +509,65 @@ HeatWaveVideo::DoTemporalTransform(EnumTransform trn, SInt lev, Bool fwd,
   if ( !IsSpatiallyComparable() || (m_imgn < 2) ){
     return -1;
   }
-  SInt ret;
-  for ( SInt i = 0 ; i < GetImage(0).GetComponentN() ; ++i ){
-    ret = DoComponentTransform(GetImage(0).GetComponent(i).GetColor(),
-                               trn,lev,fwd,cur);
+  if ( lev < 0 ){
+    lev = 0;
   }
-  return ret;
+  if ( cur < 0 ){
+    cur = m_lev;
+  }
+  SInt groups = GetGroupCount();
+  if ( groups <= 1 ){
+    // every component starts from the same level
+    SInt ret = cur;
+    for ( SInt i = 0 ; i < GetImage(0).GetComponentN() ; ++i ){
+      ret = DoComponentTransform(GetImage(0).GetComponent(i).GetColor(),
+                                 trn,lev,fwd,cur);
+    }
+    m_trn = trn;
+    return ret;
+  }
+
+  HeatWaveVideo ** vids = new HeatWaveVideo*[groups];
+  LEAVEONNULL(vids);
+  HeatWaveGroupJob * jobs = new HeatWaveGroupJob[groups];
+  LEAVEONNULL(jobs);
+  for ( SInt g = 0 ; g < groups ; ++g ){
+    SInt strt = 0;
+    SInt len = 0;
+    GetGroupInfo(g, strt, len);
+    vids[g] = new HeatWaveVideo(m_width, m_height, m_space, m_hsp, m_vsp, 
+                                len, m_imga+strt, False, False);
+    LEAVEONNULL(vids[g]);
+    jobs[g].m_vid = vids[g];
+    jobs[g].m_trn = trn;
+    // short groups may not have reached the current level
+    jobs[g].m_cur = HeatWaveMath::Min(cur, GetMaxLevel(len));
+    jobs[g].m_lev = lev;
+    jobs[g].m_fwd = fwd;
+    jobs[g].m_reached = 0;
+    if ( m_pool ){
+      m_pool->DoSubmit(&(jobs[g]));
+    }
+    else {
+      jobs[g].DoRun();
+    }
+  }
+  if ( m_pool ){
+    m_pool->DoWait();
+  }
+  
+  SInt reached = fwd ? cur : lev;
+  for ( SInt g = 0 ; g < groups ; ++g ){
+    if ( fwd && (jobs[g].m_reached > reached) ){
+      reached = jobs[g].m_reached;
+    }
+    delete vids[g];
+  }
+  delete [] jobs;
+  delete [] vids;
+  m_lev = reached;
+  m_trn = trn;
+  return m_lev;
 }
 
 SInt 
@@ -463,6 +693,9 @@ HeatWaveVideo::GetFusedImage()
 HeatWaveVideo& 
 HeatWaveVideo::operator=(const HeatWaveVideo& rhs)
 {
+  if ( this == &rhs ){
+    return (*this);
+  }
   DoCopy(rhs);
   return (*this);
 }
@@ -526,6 +759,8 @@ HeatWaveVideo::DoTemporalTransform(SInt cmp, Bool fwd, EnumTransform trn,
   SInt tly = m_imga[0]->GetComponent(cmp).GetTLY();
   SInt width = m_imga[0]->GetComponent(cmp).GetWidth();
   SInt height = m_imga[0]->GetComponent(cmp).GetHeight();
+  HEATWAVEPROFILE(PrfTemporal, (SInt64)width*height*len,
+                  (SInt64)width*height*len*2*sizeof(Smpl));
   for ( SInt x = tlx; x < (tlx+width); ++x ){
     for ( SInt y = tly; y < (tly+height); ++y ){
       GetTemporalVector(cmp,strt,len,x,y,data);
@@ -545,7 +780,7 @@ HeatWaveVideo::DoTemporalTransform(SInt cmp, Bool fwd, EnumTransform trn,
       SetTemporalVector(cmp,strt,len,x,y,data);
     }
   }
-  delete data;
+  delete [] data;
   return True;
 }
 
@@ -574,6 +809,68 @@ HeatWaveVideo::SetTemporalVector(SInt cmp, SInt strt, SInt len,
   }
 }
 
+void
+HeatWaveVideo::GetSceneHistogram(SInt num, SInt lev, SFloat64 * hist) const
+{
+  for ( SInt b = 0 ; b < HEATWAVESCENEBINS ; ++b ){
+    hist[b] = 0.0;
+  }
+  HeatWaveComponent & cmp = m_imga[num]->GetComponent(0);
+  HeatWaveView view = (cmp.GetTransformLevel() > 0) ?
+    cmp.GetView(cmp.GetTransformLevel(), SubLL) : cmp.GetView();
+  if ( !view.IsValid() ){
+    return;
+  }
+  SInt prec = HeatWaveMath::Max(cmp.GetPrec(), 1);
+  Smpl offset = cmp.GetSgnd() ? (1<<(prec-1)) : 0;
+  SFloat64 scale = ((SFloat64)HEATWAVESCENEBINS)/(1<<prec);
+  SInt blk = 1 << ((lev > 0) ? lev : 0);
+  SInt width = view.GetWidth();
+  SInt height = view.GetHeight();
+  Smpl * buf = view.IsPacked() ? new Smpl[width] : NULL;
+  Smpl * sum = new Smpl[(width+blk-1)/blk];
+  LEAVEONNULL(sum);
+  SInt total = 0;
+  for ( SInt by = 0 ; by < height ; by += blk ){
+    SInt bh = HeatWaveMath::Min(blk, height-by);
+    memset((Char*)sum, '\0', ((width+blk-1)/blk)*sizeof(Smpl));
+    for ( SInt y = by ; y < (by+bh) ; ++y ){
+      const Smpl * row = view.GetRow(y, buf);
+      for ( SInt x = 0 ; x < width ; ++x ){
+        sum[x/blk] += row[x];
+      }
+    }
+    for ( SInt bx = 0 ; bx < width ; bx += blk ){
+      SInt bw = HeatWaveMath::Min(blk, width-bx);
+      // split between the two nearest bins, so small changes stay small
+      SFloat64 pos = (((SFloat64)sum[bx/blk])/(bw*bh) + offset) * scale - 0.5;
+      SInt bin = (SInt)floor(pos);
+      SFloat64 frac = pos - bin;
+      hist[HeatWaveMath::Max(0, HeatWaveMath::Min(bin, HEATWAVESCENEBINS-1))]
+        += (1.0 - frac);
+      hist[HeatWaveMath::Max(0, HeatWaveMath::Min(bin+1, HEATWAVESCENEBINS-1))]
+        += frac;
+      ++total;
+    }
+  }
+  delete [] sum;
+  delete [] buf;
+  for ( SInt b = 0 ; b < HEATWAVESCENEBINS ; ++b ){
+    hist[b] /= total;
+  }
+}
+
+SInt
+HeatWaveVideo::GetMaxLevel(SInt len)
+{
+  SInt ret = 0;
+  while ( len > 1 ){
+    len = (len/2) + (len%2);
+    ++ret;
+  }
+  return ret;
+}
+
 SInt 
 HeatWaveVideo::GetLowBandLength(SInt levl)
 {
@@ -654,14 +951,20 @@ void
 HeatWaveVideo::DoCopy(const HeatWaveVideo & rhs)
 {
   ASSERT(rhs.ValidateSamplingPeriods());
+  DoDestroy();
   m_width = rhs.m_width;
   m_height = rhs.m_height;
-  m_desMem = rhs.m_desMem;
+  // the images are cloned, so always owned
+  m_desMem = True;
   m_space = rhs.m_space;
+  m_scene = rhs.m_scene;
+  m_pool = rhs.m_pool;
+  m_lev = rhs.m_lev;
+  m_trn = rhs.m_trn;
   for ( SInt i = 0 ; i < MAXCOLORSINANYSPACE ; ++i ){
     m_hsp[i] = rhs.m_hsp[i];
+    m_vsp[i] = rhs.m_vsp[i];
   }
-  DoDestroy();
   DoImageCopy(rhs.m_imgn,rhs.m_imga);
 }
 
@@ -693,4 +996,5 @@ void HeatWaveVideo::DoDestroy()
   else{
     m_imga = NULL;
   }
+  m_imgn = 0;
 }
@@ -0,0 +1,297 @@
+/****************************************************************************/
+/**
+ ** @file HeatWaveView.cpp
+ ** @brief Contains the HeatWaveView class definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveView.hpp"
+#include "HeatWaveProfiler.hpp"
+
+HeatWaveView::HeatWaveView()
+{
+  m_org = NULL;
+  m_pack = NULL;
+  m_width = 0;
+  m_height = 0;
+  m_pitch = 0;
+}
+
+HeatWaveView::HeatWaveView(const Smpl * org, SInt width, SInt height,
+                           SInt pitch)
+{
+  ASSERT ( (org != NULL) && (width > 0) && (height > 0) && (pitch >= width) );
+  m_org = org;
+  m_pack = NULL;
+  m_width = width;
+  m_height = height;
+  m_pitch = pitch;
+}
+
+HeatWaveView::HeatWaveView(const Smpl16 * org, SInt width, SInt height,
+                           SInt pitch)
+{
+  ASSERT ( (org != NULL) && (width > 0) && (height > 0) && (pitch >= width) );
+  m_org = NULL;
+  m_pack = org;
+  m_width = width;
+  m_height = height;
+  m_pitch = pitch;
+}
+
+Bool
+HeatWaveView::IsValid() const
+{
+  return ( (m_org != NULL) || (m_pack != NULL) );
+}
+
+Bool
+HeatWaveView::IsPacked() const
+{
+  return ( m_pack != NULL );
+}
+
+SInt
+HeatWaveView::GetWidth() const
+{
+  return m_width;
+}
+
+SInt
+HeatWaveView::GetHeight() const
+{
+  return m_height;
+}
+
+SInt
+HeatWaveView::GetPitch() const
+{
+  return m_pitch;
+}
+
+SInt
+HeatWaveView::GetSize() const
+{
+  return m_width*m_height;
+}
+
+Smpl
+HeatWaveView::GetSmpl(SInt x, SInt y) const
+{
+  ASSERT ( (x >= 0) && (x < m_width) && (y >= 0) && (y < m_height) );
+  if ( m_pack ){
+    return m_pack[(y*m_pitch)+x];
+  }
+  return m_org[(y*m_pitch)+x];
+}
+
+const Smpl *
+HeatWaveView::GetRow(SInt y) const
+{
+  ASSERT ( (m_org != NULL) && (y >= 0) && (y < m_height) );
+  return m_org + (y*m_pitch);
+}
+
+const Smpl *
+HeatWaveView::GetRow(SInt y, Smpl * buf) const
+{
+  ASSERT ( (y >= 0) && (y < m_height) );
+  if ( m_org ){
+    return m_org + (y*m_pitch);
+  }
+  ASSERT ( buf != NULL );
+  const Smpl16 * row = m_pack + (y*m_pitch);
+  for ( SInt x = 0 ; x < m_width ; ++x ){
+    buf[x] = row[x];
+  }
+  return buf;
+}
+
+HeatWaveView
+HeatWaveView::GetView(SInt x, SInt y, SInt width, SInt height) const
+{
+  if ( !((width > 0) && (height > 0) && (x >= 0) && (y >= 0) &&
+         ((x+width) <= m_width) && ((y+height) <= m_height)) ){
+    return HeatWaveView();
+  }
+  if ( m_pack ){
+    return HeatWaveView(m_pack+(y*m_pitch)+x, width, height, m_pitch);
+  }
+  return HeatWaveView(m_org+(y*m_pitch)+x, width, height, m_pitch);
+}
+
+Smpl *
+HeatWaveView::GetCopy() const
+{
+  if ( !IsValid() ){
+    return NULL;
+  }
+  Smpl * ret = new Smpl[m_width*m_height];
+  LEAVEONNULL(ret);
+  for ( SInt y = 0 ; y < m_height ; ++y ){
+    Smpl * dst = ret + (y*m_width);
+    const Smpl * row = GetRow(y, dst);
+    if ( row != dst ){
+      memcpy(dst, row, m_width*sizeof(Smpl));
+    }
+  }
+  return ret;
+}
+
+SInt
+HeatWaveView::GetBasicStats(Smpl & min, Smpl & max, SInt & total) const
+{
+  min = 0;
+  max = 0;
+  total = 0;
+  if ( !IsValid() ){
+    return 0;
+  }
+
+  Smpl * buf = m_pack ? new Smpl[m_width] : NULL;
+  min = max = GetSmpl(0,0);
+  for ( SInt y = 0 ; y < m_height ; ++y ){
+    const Smpl * row = GetRow(y, buf);
+    for ( SInt x = 0 ; x < m_width ; ++x ){
+      if ( row[x] < min ){
+        min = row[x];
+      }
+      else if ( row[x] > max ){
+        max = row[x];
+      }
+      total += row[x];
+    }
+  }
+  delete [] buf;
+  return GetSize();
+}
+
+Bool
+HeatWaveView::GetStats(Smpl & min, Smpl & max, SInt & total, SFloat64 & mean,
+                       SFloat64 & std_dev, SFloat64 & std_err,
+                       SFloat64 & rms) const
+{
+  if ( !IsValid() ){
+    return False;
+  }
+
+  GetBasicStats(min, max, total);
+  SFloat64 size = GetSize();
+  mean = ((SFloat64)total)/size;
+  std_dev = 0;
+
+  Smpl * buf = m_pack ? new Smpl[m_width] : NULL;
+  for ( SInt y = 0 ; y < m_height ; ++y ){
+    const Smpl * row = GetRow(y, buf);
+    for ( SInt x = 0 ; x < m_width ; ++x ){
+      SFloat64 tmp = row[x] - mean;
+      std_dev += (tmp*tmp);
+    }
+  }
+  delete [] buf;
+
+  std_dev = sqrt(std_dev/size);
+  std_err = std_dev/sqrt(size);
+  rms = sqrt(pow(mean,2)+pow(std_dev,2));
+  return True;
+}
+
+void
+HeatWaveView::DoHistogram(Smpl * hist, SInt range, SInt offset) const
+{
+  ASSERT ( hist != NULL );
+  HEATWAVEPROFILE(PrfHistogram, (SInt64)m_width*m_height,
+                  (SInt64)m_width*m_height*(m_pack?sizeof(Smpl16):sizeof(Smpl)));
+  Smpl * buf = m_pack ? new Smpl[m_width] : NULL;
+  for ( SInt y = 0 ; y < m_height ; ++y ){
+    const Smpl * row = GetRow(y, buf);
+    for ( SInt x = 0 ; x < m_width ; ++x ){
+      Smpl bin = row[x] + offset;
+      if ( (bin >= 0) && (bin < range) ){
+        ++(hist[bin]);
+      }
+    }
+  }
+  delete [] buf;
+}
+
+SFloat64
+HeatWaveView::GetSquaredError(const HeatWaveView & other) const
+{
+  ASSERT ( (m_width == other.m_width) && (m_height == other.m_height) );
+  SFloat64 sum = 0.0;
+  Smpl * buf = m_pack ? new Smpl[m_width] : NULL;
+  Smpl * obuf = other.m_pack ? new Smpl[m_width] : NULL;
+  for ( SInt y = 0 ; y < m_height ; ++y ){
+    const Smpl * row = GetRow(y, buf);
+    const Smpl * orow = other.GetRow(y, obuf);
+    for ( SInt x = 0 ; x < m_width ; ++x ){
+      SFloat64 diff = row[x] - orow[x];
+      sum += (diff*diff);
+    }
+  }
+  delete [] obuf;
+  delete [] buf;
+  return sum;
+}
+
+SFloat64
+HeatWaveView::GetAbsoluteError(const HeatWaveView & other) const
+{
+  ASSERT ( (m_width == other.m_width) && (m_height == other.m_height) );
+  SFloat64 sum = 0.0;
+  Smpl * buf = m_pack ? new Smpl[m_width] : NULL;
+  Smpl * obuf = other.m_pack ? new Smpl[m_width] : NULL;
+  for ( SInt y = 0 ; y < m_height ; ++y ){
+    const Smpl * row = GetRow(y, buf);
+    const Smpl * orow = other.GetRow(y, obuf);
+    for ( SInt x = 0 ; x < m_width ; ++x ){
+      sum += abs(row[x] - orow[x]);
+    }
+  }
+  delete [] obuf;
+  delete [] buf;
+  return sum;
+}
+
+SFloat64
+HeatWaveView::GetPeakError(const HeatWaveView & other) const
+{
+  ASSERT ( (m_width == other.m_width) && (m_height == other.m_height) );
+  Smpl peak = 0;
+  Smpl * buf = m_pack ? new Smpl[m_width] : NULL;
+  Smpl * obuf = other.m_pack ? new Smpl[m_width] : NULL;
+  for ( SInt y = 0 ; y < m_height ; ++y ){
+    const Smpl * row = GetRow(y, buf);
+    const Smpl * orow = other.GetRow(y, obuf);
+    for ( SInt x = 0 ; x < m_width ; ++x ){
+      Smpl diff = abs(row[x] - orow[x]);
+      if ( diff > peak ){
+        peak = diff;
+      }
+    }
+  }
+  delete [] obuf;
+  delete [] buf;
+  return peak;
+}
+
+Bool
+HeatWaveView::IsEqual(const HeatWaveView & other) const
+{
+  if ( (m_width != other.m_width) || (m_height != other.m_height) ){
+    return False;
+  }
+  Bool ret = True;
+  Smpl * buf = m_pack ? new Smpl[m_width] : NULL;
+  Smpl * obuf = other.m_pack ? new Smpl[m_width] : NULL;
+  for ( SInt y = 0 ; ret && (y < m_height) ; ++y ){
+    const Smpl * row = GetRow(y, buf);
+    const Smpl * orow = other.GetRow(y, obuf);
+    ret = ( memcmp(row, orow, m_width*sizeof(Smpl)) == 0 );
+  }
+  delete [] obuf;
+  delete [] buf;
+  return ret;
+}
@@ -0,0 +1,227 @@
+/****************************************************************************/
+/**
+ ** @file HeatWaveWorkerPool.cpp
+ ** @brief Contains the HeatWaveJob and HeatWaveWorkerPool class definitions.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "HeatWaveWorkerPool.hpp"
+#ifndef HEATWAVENOTHREADS
+#include <unistd.h>
+#endif
+
+/** Initial capacity of the job ring. **/
+#define HEATWAVEPOOLJOBS 64
+
+HeatWaveJob::HeatWaveJob()
+{
+  m_batch = NULL;
+}
+
+HeatWaveJob::~HeatWaveJob()
+{
+}
+
+/****************************************************************************/
+
+HeatWaveWorkerPool::HeatWaveWorkerPool(SInt threads)
+{
+  if ( threads <= 0 ){
+    threads = GetProcessors();
+  }
+#ifdef HEATWAVENOTHREADS
+  threads = 1;
+#endif
+  m_threads = NULL;
+  m_threadn = threads;
+  m_jobsLen = HEATWAVEPOOLJOBS;
+  m_jobsHead = 0;
+  m_jobsn = 0;
+  m_busy = 0;
+  m_quit = False;
+  m_jobs = new HeatWaveJob*[m_jobsLen];
+  LEAVEONNULL(m_jobs);
+
+  if ( m_threadn == 1 ){
+    return;
+  }
+
+  InitMutex(&m_mutex);
+  InitCond(&m_work);
+  InitCond(&m_idle);
+  m_threads = new CommonThread[m_threadn];
+  LEAVEONNULL(m_threads);
+  for ( SInt i = 0 ; i < m_threadn ; ++i ){
+    if ( !StartThread(&(m_threads[i]), ThreadMain, this) ){
+      // run with the threads we have
+      m_threadn = i;
+      break;
+    }
+  }
+}
+
+HeatWaveWorkerPool::~HeatWaveWorkerPool()
+{
+  if ( m_threads ){
+    LockMutex(&m_mutex);
+    m_quit = True;
+    BroadcastCond(&m_work);
+    UnlockMutex(&m_mutex);
+    for ( SInt i = 0 ; i < m_threadn ; ++i ){
+      JoinThread(m_threads[i]);
+    }
+    delete [] m_threads;
+    FreeCond(&m_idle);
+    FreeCond(&m_work);
+    FreeMutex(&m_mutex);
+  }
+  delete [] m_jobs;
+}
+
+SInt
+HeatWaveWorkerPool::GetThreads() const
+{
+  return ( m_threads && (m_threadn > 0) ) ? m_threadn : 1;
+}
+
+void
+HeatWaveWorkerPool::DoSubmit(HeatWaveJob * job)
+{
+  ASSERT ( job != NULL );
+  if ( (m_threads == NULL) || (m_threadn == 0) ){
+    job->DoRun();
+    return;
+  }
+
+  LockMutex(&m_mutex);
+  job->m_batch = NULL;
+  DoQueue(job);
+  UnlockMutex(&m_mutex);
+}
+
+void
+HeatWaveWorkerPool::DoSubmit(HeatWaveJob * job, SInt & batch)
+{
+  ASSERT ( job != NULL );
+  if ( (m_threads == NULL) || (m_threadn == 0) ){
+    job->DoRun();
+    return;
+  }
+
+  LockMutex(&m_mutex);
+  job->m_batch = &batch;
+  ++batch;
+  DoQueue(job);
+  UnlockMutex(&m_mutex);
+}
+
+void
+HeatWaveWorkerPool::DoQueue(HeatWaveJob * job)
+{
+  if ( m_jobsn == m_jobsLen ){
+    // grow the ring, keeping the order
+    HeatWaveJob ** jobs = new HeatWaveJob*[m_jobsLen*2];
+    LEAVEONNULL(jobs);
+    for ( SInt i = 0 ; i < m_jobsn ; ++i ){
+      jobs[i] = m_jobs[(m_jobsHead+i)%m_jobsLen];
+    }
+    delete [] m_jobs;
+    m_jobs = jobs;
+    m_jobsLen *= 2;
+    m_jobsHead = 0;
+  }
+  m_jobs[(m_jobsHead+m_jobsn)%m_jobsLen] = job;
+  ++m_jobsn;
+  SignalCond(&m_work);
+}
+
+void
+HeatWaveWorkerPool::DoWait()
+{
+  if ( m_threads == NULL ){
+    return;
+  }
+  LockMutex(&m_mutex);
+  while ( (m_jobsn > 0) || (m_busy > 0) ){
+    WaitCond(&m_idle, &m_mutex);
+  }
+  UnlockMutex(&m_mutex);
+}
+
+void
+HeatWaveWorkerPool::DoWait(SInt & batch)
+{
+  if ( m_threads == NULL ){
+    return;
+  }
+  LockMutex(&m_mutex);
+  while ( batch > 0 ){
+    if ( m_jobsn > 0 ){
+      // help rather than block, the threads may all be waiting like this
+      DoRunNext();
+    }
+    else {
+      WaitCond(&m_idle, &m_mutex);
+    }
+  }
+  UnlockMutex(&m_mutex);
+}
+
+SInt
+HeatWaveWorkerPool::GetProcessors()
+{
+#ifndef HEATWAVENOTHREADS
+  long num = sysconf(_SC_NPROCESSORS_ONLN);
+  return (num > 0) ? (SInt)num : 1;
+#else
+  return 1;
+#endif
+}
+
+void *
+HeatWaveWorkerPool::ThreadMain(void * arg)
+{
+  ((HeatWaveWorkerPool*)arg)->DoWork();
+  return NULL;
+}
+
+void
+HeatWaveWorkerPool::DoWork()
+{
+  LockMutex(&m_mutex);
+  while ( True ){
+    while ( (m_jobsn == 0) && !m_quit ){
+      WaitCond(&m_work, &m_mutex);
+    }
+    if ( m_jobsn == 0 ){
+      // quit once the queue is empty
+      break;
+    }
+    DoRunNext();
+  }
+  UnlockMutex(&m_mutex);
+}
+
+void
+HeatWaveWorkerPool::DoRunNext()
+{
+  HeatWaveJob * job = m_jobs[m_jobsHead];
+  m_jobsHead = (m_jobsHead+1)%m_jobsLen;
+  --m_jobsn;
+  ++m_busy;
+  // the job may be gone once its batch is done
+  SInt * batch = job->m_batch;
+  UnlockMutex(&m_mutex);
+
+  job->DoRun();
+
+  LockMutex(&m_mutex);
+  --m_busy;
+  if ( (batch != NULL) && (--(*batch) == 0) ){
+    BroadcastCond(&m_idle);
+  }
+  else if ( (m_jobsn == 0) && (m_busy == 0) ){
+    BroadcastCond(&m_idle);
+  }
+}
@@ -44,6 +44,8 @@ MiscCmdLTool::MiscCmdLTool(const Char ** nams, const Char ** vers,
   m_timeCompiled = time;
   m_maxColumns = cols;
   m_verbose = verb; 
+  m_stdI = m_stdO = m_stdE = NULL;
+  m_stdIFile = m_stdOFile = m_stdEFile = NULL;
   SetStdInput(stdI);
   SetStdOutput(stdO);
   SetErrOutput(stdE);
@@ -53,6 +55,18 @@ MiscCmdLTool::MiscCmdLTool(const Char ** nams, const Char ** vers,
 MiscCmdLTool::~MiscCmdLTool()
 {
   DoCleanUp();
+  // a batch creates a tool per file, so do not leave the handlers behind
+  delete [] m_handlers;
+  // and close the files opened by name in place of the standard streams
+  if ( m_stdIFile ){
+    fclose(m_stdI);
+  }
+  if ( m_stdOFile ){
+    fclose(m_stdO);
+  }
+  if ( m_stdEFile ){
+    fclose(m_stdE);
+  }
 }
 
 MiscCmdLTool & 
@@ -290,11 +304,11 @@ MiscCmdLTool::DoOpenIOFile(FILE *& open, const Char * name,
                            const Char * mode, FILE * dflt, 
                            Bool exit)
 {
+  if ( open && (open != dflt) ){
+    fclose ( open );
+    // should we care if above fails?
+  }
   if ( name ){
-    if ( open ){
-      fclose ( open );
-      // should we care if above fails?
-    }
     open = fopen( name, mode );
     if ( open == NULL ){
       if ( exit ){
@@ -477,7 +491,7 @@ MiscCmdLTool::DoArgumentRegistration(m_argFunction fn)
     m_handlers = new m_argFunction[m_handlersTotal+VEC_GROWTH];
     LEAVEONNULL(m_handlers);
     memcpy(m_handlers, m_tmp, m_handlersTotal*sizeof(m_argFunction));
-    delete m_tmp;
+    delete [] m_tmp;
   }
   
   m_handlers[m_handlersTotal] = fn;
@@ -799,7 +813,7 @@ Bool
 MiscCmdLTool::IsSubArgument(const Char * name, MiscArgInfo & info)
 {
   for ( SInt i = 0 ; i < info.subNum ; ++i ){
-    if ( info.flag & ( Att_TO | Att_TR ) ){
+    if ( info.subFlag[i] & ( Att_TO | Att_TR ) ){
       ASSERT ( info.subName[i] != NULL );
       if (strncmp(info.subName[i], name, strlen(info.subName[i])) == 0){
         return True;
@@ -7,6 +7,87 @@
  **/
 
 #include "MiscImageTool.hpp"
+#include <setjmp.h>
+#include <jpeglib.h>
+
+/** Serialises the JasPer codecs, which are not documented to be reentrant,
+ ** between the tools of a batch. */
+static CommonMutex glob_jasMutex = COMMONMUTEXINIT;
+
+#if JPEG_LIB_VERSION >= 70
+#define MISCJPEGHSIZE(c) ((c)->DCT_h_scaled_size)
+#define MISCJPEGVSIZE(c) ((c)->DCT_v_scaled_size)
+#define MISCJPEGMINHSIZE(d) ((d).min_DCT_h_scaled_size)
+#define MISCJPEGMINVSIZE(d) ((d).min_DCT_v_scaled_size)
+#else
+#define MISCJPEGHSIZE(c) ((c)->DCT_scaled_size)
+#define MISCJPEGVSIZE(c) ((c)->DCT_scaled_size)
+#define MISCJPEGMINHSIZE(d) ((d).min_DCT_scaled_size)
+#define MISCJPEGMINVSIZE(d) ((d).min_DCT_scaled_size)
+#endif
+
+/** A libjpeg error manager that returns to the reader. */
+struct MiscJpegError
+{
+  struct jpeg_error_mgr pub;
+  jmp_buf jump;
+  char msg[JMSG_LENGTH_MAX];
+};
+
+static void
+DoJpegErrorExit(j_common_ptr cinfo)
+{
+  MiscJpegError * err = (MiscJpegError*)cinfo->err;
+  (*cinfo->err->format_message)(cinfo, err->msg);
+  longjmp(err->jump, 1);
+}
+
+static void
+DoJpegMessage(j_common_ptr cinfo)
+{
+  // warnings are not printed, a corrupt image fails in DoJpegErrorExit
+}
+
+/** True if named or starting like a JPEG file. */
+static Bool
+IsJPEG(const Char * file, const Char * form)
+{
+  if ( form ){
+    return ( (strcasecmp(form, "jpg") == 0) ||
+             (strcasecmp(form, "jpeg") == 0) );
+  }
+  if ( file == NULL ){
+    return False;
+  }
+  FILE * in = fopen(file, "rb");
+  if ( in == NULL ){
+    return False;
+  }
+  UInt8 mark[3] = {0, 0, 0};
+  Bool ret = ( (fread(mark, 1, 3, in) == 3) && (mark[0] == 0xff) &&
+               (mark[1] == 0xd8) && (mark[2] == 0xff) );
+  fclose(in);
+  return ret;
+}
+
+/** Find a word of a option string, the text after the name or NULL. */
+static const Char *
+GetOption(const Char * opts, const Char * name)
+{
+  SInt len = strlen(name);
+  while ( opts && *opts ){
+    while ( isspace(*opts) ){
+      ++opts;
+    }
+    if ( strncmp(opts, name, len) == 0 ){
+      return opts+len;
+    }
+    while ( *opts && !isspace(*opts) ){
+      ++opts;
+    }
+  }
+  return NULL;
+}
 
 MiscImageTool::MiscImageTool()
 {
@@ -73,7 +154,8 @@ MiscImageTool::GetJasperFromHeat(const HeatWaveImage * image) const
   SInt ncomp = image->GetComponentN();
   HeatWaveComponent ** acomp = image->GetComponentA();
   jas_image_cmptparm_t parm;
-  jas_matrix_t matrix;
+  jas_matrix_t * matrix = NULL;
+  Smpl * smpl = NULL;
   
   for ( SInt i = 0 ; i < ncomp ; ++i){
     parm.tlx = acomp[i]->GetTLX();
@@ -84,29 +166,30 @@ MiscImageTool::GetJasperFromHeat(const HeatWaveImage * image) const
     parm.height = acomp[i]->GetHeight();
     parm.prec = acomp[i]->GetPrec();
     parm.sgnd = acomp[i]->GetSgnd();
-    matrix.flags_ = 0;
-    matrix.xstart_ = acomp[i]->GetTLX();
-    matrix.ystart_ = acomp[i]->GetTLY();
-    matrix.xend_ = acomp[i]->GetTLX() + acomp[i]->GetWidth();
-    matrix.yend_ = acomp[i]->GetTLY() + acomp[i]->GetHeight();
-    matrix.numrows_ = acomp[i]->GetHeight();
-    matrix.numcols_ = acomp[i]->GetWidth();
-    matrix.rows_ = (jas_seqent_t**)acomp[i]->GetRows();
-    matrix.maxrows_ = acomp[i]->GetHeight();
-    matrix.data_ = (jas_seqent_t*)acomp[i]->GetData();
-    matrix.datasize_ = acomp[i]->GetSize();
     if(jas_image_addcmpt(ret,i,&parm)){
       SInt * dummy = NULL;
       LEAVEONNULL(dummy);
     };
-    if(jas_image_writecmpt(ret,i,parm.tlx,parm.tly,parm.width,parm.height,
-                           &matrix)){
-      ASSERT(False);
-      SInt * dummy = NULL;
-      LEAVEONNULL(dummy);
+    // read a row at a time through a view, the component may be packed or
+    // shared and jas_seqent_t need not be a Smpl
+    const HeatWaveComponent & cmp = *(acomp[i]);
+    HeatWaveView view = cmp.GetView();
+    matrix = jas_matrix_create(1, parm.width);
+    LEAVEONNULL(matrix);
+    NEW_ARRAY(smpl, Smpl, parm.width);
+    for ( SInt y = 0 ; y < (SInt)parm.height ; ++y ){
+      const Smpl * row = view.GetRow(y, smpl);
+      for ( SInt x = 0 ; x < (SInt)parm.width ; ++x ){
+        jas_matrix_set(matrix, 0, x, row[x]);
+      }
+      if(jas_image_writecmpt(ret,i,0,y,parm.width,1,matrix)){
+        ASSERT(False);
+        SInt * dummy = NULL;
+        LEAVEONNULL(dummy);
+      }
     }
-    ASSERT(matrix.data_ == (jas_seqent_t*)acomp[i]->GetData());
-    ASSERT(matrix.rows_ == (jas_seqent_t**)acomp[i]->GetRows());
+    DEL_ARRAY(smpl);
+    jas_matrix_destroy(matrix);
     jas_image_setcmpttype(ret,i,GetColorJasperFromHeat(acomp[i]->GetColor()));
   }
   
@@ -257,7 +340,22 @@ MiscImageTool::ReadImage(const Char * file, const Char * form, const Char * opts
   Char * inOpts = NULL;
   HeatWaveImage * tmp = NULL;
   Char * temp_str = NULL;
+  const Char * errm = NULL;
   
+  // the simple formats are read natively, else by JasPer
+  tmp = HeatWaveImageFile::DoRead(file, form, errm);
+  if ( tmp || errm ){
+    if ( errm ){
+      CpyLastErrorMessage(errm);
+    }
+    return tmp;
+  }
+  // and JPEG by libjpeg, which can scale and skip the color convertion
+  if ( IsJPEG(file, form) ){
+    const Char * scale = GetOption(opts, "scale=");
+    return ReadJPEG(file, scale ? atoi(scale) : 1,
+                    GetOption(opts, "raw") != NULL);
+  }
   if ( file ){
     if (!(in = jas_stream_fopen(file,"rb"))){
       CpyLastErrorMessage("failed to open file");
@@ -286,7 +384,10 @@ MiscImageTool::ReadImage(const Char * file, const Char * form, const Char * opts
       goto clean_up;
     }
   }      
-  if (!(image = jas_image_decode(in, inFmt, inOpts))) {
+  LockMutex(&glob_jasMutex);
+  image = jas_image_decode(in, inFmt, inOpts);
+  UnlockMutex(&glob_jasMutex);
+  if (!image) {
     CpyLastErrorMessage("failed while decoding image");
     goto clean_up;
   }
@@ -303,6 +404,145 @@ MiscImageTool::ReadImage(const Char * file, const Char * form, const Char * opts
   return tmp;
 }
 
+HeatWaveImage *
+MiscImageTool::ReadJPEG(const Char * file, SInt scale, Bool raw)
+{
+  if ( (scale != 1) && (scale != 2) && (scale != 4) && (scale != 8) ){
+    CpyLastErrorMessage("JPEG scale must be 1, 2, 4 or 8");
+    return NULL;
+  }
+  FILE * in = file ? fopen(file, "rb") : stdin;
+  if ( in == NULL ){
+    CpyLastErrorMessage("failed to open file");
+    return NULL;
+  }
+  struct jpeg_decompress_struct cinfo;
+  MiscJpegError jerr;
+  HeatWaveImage * volatile img = NULL;
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = DoJpegErrorExit;
+  jerr.pub.output_message = DoJpegMessage;
+  if ( setjmp(jerr.jump) ){
+    CpyLastErrorMessage(jerr.msg);
+    jpeg_destroy_decompress(&cinfo);
+    if ( file ){
+      fclose(in);
+    }
+    delete img;
+    return NULL;
+  }
+  jpeg_create_decompress(&cinfo);
+  jpeg_stdio_src(&cinfo, in);
+  jpeg_read_header(&cinfo, TRUE);
+  cinfo.scale_num = 1;
+  cinfo.scale_denom = scale;
+  jpeg_calc_output_dimensions(&cinfo);
+
+  // raw samples only for grey and YCbCr of whole sampling ratios, which
+  // depend on the scaling as chroma may be scaled less than luma
+  SInt num = cinfo.num_components;
+  SInt hsta[3] = {1, 1, 1};
+  SInt vsta[3] = {1, 1, 1};
+  if ( raw ){
+    raw = ( ((cinfo.jpeg_color_space == JCS_YCbCr) && (num == 3)) ||
+            ((cinfo.jpeg_color_space == JCS_GRAYSCALE) && (num == 1)) );
+    for ( SInt c = 0 ; raw && (c < num) ; ++c ){
+      jpeg_component_info * cmp = cinfo.comp_info+c;
+      SInt hnum = cinfo.max_h_samp_factor*MISCJPEGMINHSIZE(cinfo);
+      SInt hden = cmp->h_samp_factor*MISCJPEGHSIZE(cmp);
+      SInt vnum = cinfo.max_v_samp_factor*MISCJPEGMINVSIZE(cinfo);
+      SInt vden = cmp->v_samp_factor*MISCJPEGVSIZE(cmp);
+      raw = ( (hnum % hden == 0) && (vnum % vden == 0) );
+      hsta[c] = hnum/hden;
+      vsta[c] = vnum/vden;
+    }
+  }
+  if ( raw ){
+    cinfo.raw_data_out = TRUE;
+    cinfo.out_color_space = cinfo.jpeg_color_space;
+  }
+  else {
+    cinfo.out_color_space = (num == 1) ? JCS_GRAYSCALE : JCS_RGB;
+  }
+  jpeg_start_decompress(&cinfo);
+  num = cinfo.out_color_components;
+  SInt width = cinfo.output_width;
+  SInt height = cinfo.output_height;
+  EnumSpace spc = (num == 1) ? SpcGrey : (raw ? SpcYUV : SpcRGB);
+  const EnumColor clrs[2][3] = {{ClrRed, ClrGreen, ClrBlue},
+                                {ClrY, ClrU, ClrV}};
+  img = new HeatWaveImage(0, 0, width, height, spc, num, True);
+  LEAVEONNULL(img);
+  HeatWaveComponent ** cmpa = img->GetComponentA();
+  Smpl ** rows[3] = {NULL, NULL, NULL};
+  for ( SInt c = 0 ; c < num ; ++c ){
+    SInt hst = 1, vst = 1, cwid = width, chei = height;
+    if ( raw ){
+      jpeg_component_info * cmp = cinfo.comp_info+c;
+      hst = hsta[c];
+      vst = vsta[c];
+      cwid = cmp->downsampled_width;
+      chei = cmp->downsampled_height;
+    }
+    cmpa[c] = new HeatWaveComponent(0, 0, hst, vst, cwid, chei, False,
+                                    BITS_IN_JSAMPLE,
+                                    (num == 1) ? ClrGrey : clrs[raw][c]);
+    LEAVEONNULL(cmpa[c]);
+    rows[c] = cmpa[c]->GetRows();
+  }
+
+  if ( raw ){
+    // a row of blocks (iMCU) of each component at a time
+    JSAMPARRAY bufs[3];
+    SInt cy[3] = {0, 0, 0};
+    for ( SInt c = 0 ; c < num ; ++c ){
+      jpeg_component_info * cmp = cinfo.comp_info+c;
+      bufs[c] = (*cinfo.mem->alloc_sarray)
+        ((j_common_ptr)&cinfo, JPOOL_IMAGE,
+         cmp->width_in_blocks*MISCJPEGHSIZE(cmp),
+         cmp->v_samp_factor*MISCJPEGVSIZE(cmp));
+    }
+    SInt lines = cinfo.max_v_samp_factor*MISCJPEGMINVSIZE(cinfo);
+    while ( cinfo.output_scanline < cinfo.output_height ){
+      jpeg_read_raw_data(&cinfo, bufs, lines);
+      for ( SInt c = 0 ; c < num ; ++c ){
+        jpeg_component_info * cmp = cinfo.comp_info+c;
+        SInt n = cmp->v_samp_factor*MISCJPEGVSIZE(cmp);
+        SInt cwid = cmpa[c]->GetWidth();
+        for ( SInt y = 0 ; (y < n) && (cy[c] < cmpa[c]->GetHeight()) ;
+              ++y, ++cy[c] ){
+          const JSAMPLE * src = bufs[c][y];
+          Smpl * dst = rows[c][cy[c]];
+          for ( SInt x = 0 ; x < cwid ; ++x ){
+            dst[x] = GETJSAMPLE(src[x]);
+          }
+        }
+      }
+    }
+  }
+  else {
+    JSAMPARRAY buf = (*cinfo.mem->alloc_sarray)
+      ((j_common_ptr)&cinfo, JPOOL_IMAGE, width*num, 1);
+    while ( cinfo.output_scanline < cinfo.output_height ){
+      SInt y = cinfo.output_scanline;
+      jpeg_read_scanlines(&cinfo, buf, 1);
+      for ( SInt c = 0 ; c < num ; ++c ){
+        const JSAMPLE * src = buf[0]+c;
+        Smpl * dst = rows[c][y];
+        for ( SInt x = 0 ; x < width ; ++x, src += num ){
+          dst[x] = GETJSAMPLE(*src);
+        }
+      }
+    }
+  }
+  jpeg_finish_decompress(&cinfo);
+  jpeg_destroy_decompress(&cinfo);
+  if ( file ){
+    fclose(in);
+  }
+  return img;
+}
+
 Bool
 MiscImageTool::WriteImage(const HeatWaveImage & imgs, const Char * file, 
                           const Char * form, const Char * opts, Bool pixl)
@@ -313,6 +553,23 @@ MiscImageTool::WriteImage(const HeatWaveImage & imgs, const Char * file,
   SInt outfmt = -1;
   Bool ret = True;
   Char * temp_str = NULL;
+  SInt state = 0;
+  const Char * errm = NULL;
+
+  if ( pixl ){
+    tmpimg = imgs.GetClone();
+    tmpimg->DoPixelise();
+  }
+  const HeatWaveImage & srcimg = tmpimg ? *tmpimg : imgs;
+
+  // the simple formats are written natively, else by JasPer
+  if ( HeatWaveImageFile::IsWritable(srcimg, file, form) ){
+    ret = HeatWaveImageFile::DoWrite(srcimg, file, form, errm);
+    if ( !ret ){
+      CpyLastErrorMessage(errm);
+    }
+    goto clean_up;
+  }
 
   // Check image type. 
   if (form){
@@ -322,7 +579,8 @@ MiscImageTool::WriteImage(const HeatWaveImage & imgs, const Char * file,
     DEL_ARRAY(temp_str);
     if ( outfmt < 0 ){
       CpyLastErrorMessage("unrecognized image format");
-      return False;
+      ret = False;
+      goto clean_up;
     }
   }
   if (outfmt < 0){
@@ -332,7 +590,8 @@ MiscImageTool::WriteImage(const HeatWaveImage & imgs, const Char * file,
     DEL_ARRAY(temp_str);
     if ( outfmt < 0 ){
       CpyLastErrorMessage("unable to get format from name");
-      return False;
+      ret = False;
+      goto clean_up;
     }
   }
 
@@ -341,32 +600,30 @@ MiscImageTool::WriteImage(const HeatWaveImage & imgs, const Char * file,
     // The output image is to be written to a file.
     if (!(out = jas_stream_fopen(file, "w+b"))) {
       CpyLastErrorMessage("unable to open file");
-      return False;
+      ret = False;
+      goto clean_up;
     }
   } 
   else {
     // The output image is to be written to standard output.
     if (!(out = jas_stream_fdopen(1, "w+b"))) {
       CpyLastErrorMessage("unable to use standard output");
-      return False;
+      ret = False;
+      goto clean_up;
     }
   }
   
-  if ( pixl ){
-    tmpimg = imgs.GetClone();
-    tmpimg->DoPixelise();
-    jasimg = GetJasperFromHeat(tmpimg);
-  }
-  else{
-    jasimg = GetJasperFromHeat(&(imgs));
-  }
+  jasimg = GetJasperFromHeat(&srcimg);
   
   if ( opts ){
     NEW_ARRAY(temp_str, Char, (strlen(opts)+1));
     strcpy(temp_str, opts);
   }
   
-  if ((jas_image_encode(jasimg, out, outfmt, temp_str))) {
+  LockMutex(&glob_jasMutex);
+  state = jas_image_encode(jasimg, out, outfmt, temp_str);
+  UnlockMutex(&glob_jasMutex);
+  if ( state ) {
     CpyLastErrorMessage("image encoding failed");
     ret = False;
     goto clean_up;
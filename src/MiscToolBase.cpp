@@ -8,6 +8,15 @@
 
 #include "MiscTool.hpp"
 
+/** Initialises JasPer once, however many tools a batch creates. */
+static CommonOnce glob_jasOnce = COMMONONCEINIT;
+
+static void
+DoJasInit()
+{
+  jas_init();
+}
+
 MiscTool::MiscTool(const Char ** nams, const Char ** vers,
                    const Char ** hist, const Char ** auth,
                    const Char ** copy, const Char * date, 
@@ -15,10 +24,12 @@ MiscTool::MiscTool(const Char ** nams, const Char ** vers,
                    SInt cols, Bool verb, const Char * stdI, 
                    const Char * stdO, const Char * stdE)
   :MiscCmdLTool(nams, vers, hist, auth, copy, date, time, aMin, 
-                aNte, cols, verb, stdI, stdO, stdE)
+                aNte, cols, verb, stdI, stdO, stdE),
+   m_batched(False),
+   m_cache(NULL)
 {
   DoGroupRegistration();
-  jas_init();
+  RunOnce(&glob_jasOnce, DoJasInit);
 }
 
 MiscTool::~MiscTool()
@@ -29,7 +40,20 @@ MiscTool::~MiscTool()
 void 
 MiscTool::DoCleanUp()
 {
-  
+  if ( !m_batched && HeatWaveProfiler::IsEnabled() ){
+    fprintf(m_stdO,"%s profile (times summed over threads):\n",RES_M);
+    HeatWaveProfiler::DoReport(m_stdO, RES_M " ");
+    HeatWaveMemory::DoReport(m_stdO, RES_M " ");
+    HeatWaveProfiler::SetEnabled(False);
+  }
+  if ( m_cache != NULL ){
+    if ( m_verbose ){
+      fprintf(m_stdE,"%s cache %d hit(s) and %d miss(es)\n", VRB_M,
+              m_cache->GetHits(), m_cache->GetMisses());
+    }
+    delete m_cache;
+    m_cache = NULL;
+  }
 }
 
 /****************************************************************************/
@@ -219,6 +243,15 @@ MiscTool::InfoAtoiRcts(MiscArgInfo & info, SInt arg_offs, SInt imgn, SInt cmpn)
       else{
         return RctA(0);
       }
+      if ( (lev > 0) && (ref.GetTileCount() > 1) ){
+        // an area for the sub-band of each tile
+        for ( SInt t = 0 ; t < ref.GetTileCount() ; ++t ){
+          if ( ref.GetSubbandInfo(t, lev, sub, rct.x, rct.y, rct.w, rct.h) ){
+            ret.PushBack(rct);
+          }
+        }
+        continue;
+      }
       if ( !ref.GetSubbandInfo(lev, sub, rct.x, rct.y, rct.w, rct.h) ){
         return RctA(0);
       }
@@ -268,6 +301,10 @@ MiscTool::DoGroupRegistration()
                                &MiscTool::DoMainImgSave);
   ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
                                &MiscTool::DoMainImgVidL);
+  ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
+                               &MiscTool::DoMainImgVidP);
+  ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
+                               &MiscTool::DoMainImgVidS);
   ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
                                &MiscTool::DoMainImgSpat);
   ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
@@ -280,6 +317,12 @@ MiscTool::DoGroupRegistration()
                                &MiscTool::DoMainImgClrT);
   ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
                                &MiscTool::DoMainImgComp);
+  ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
+                               &MiscTool::DoMainImgEval);
+  ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
+                               &MiscTool::DoMainImgBitp);
+  ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
+                               &MiscTool::DoMainImgQuan);
   ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
                                &MiscTool::DoMainImgHiEq);
   ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
@@ -290,5 +333,13 @@ MiscTool::DoGroupRegistration()
                                &MiscTool::DoMainImgHIII);
   ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
                                &MiscTool::DoMainImgPlot);
+  ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
+                               &MiscTool::DoMainProfile);
+  ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
+                               &MiscTool::DoMainMemory);
+  ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
+                               &MiscTool::DoMainBatch);
+  ok &= DoArgumentRegistration((MiscCmdLTool::m_argFunction)
+                               &MiscTool::DoMainCache);
   ASSERTALWAYS( ok );
 }
@@ -0,0 +1,644 @@
+/****************************************************************************/
+/**
+ ** @file   MiscToolBatch.cpp
+ ** @brief  Contains the argument handler for MiscTool, relating to running a
+ **         command script over many files.
+ ** @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ **
+ **/
+
+#include "MiscTool.hpp"
+#include <glob.h>
+
+/****************************************************************************/
+/**
+ ** A list of strings kept in one buffer, for the input files and the script
+ ** arguments of a batch.
+ **
+ **/
+
+class MiscStrList
+{
+public:
+
+  MiscStrList()
+    :m_buf(NULL), m_len(0), m_used(0)
+  {
+  }
+
+  ~MiscStrList()
+  {
+    DEL_ARRAY(m_buf);
+  }
+
+  /**
+   *
+   * Add a string.
+   *
+   * @param str The string.
+   * @param len The length of the string, -1 if null terminated.
+   *
+   **/
+
+  void AddStr(const Char * str, SInt len = -1)
+  {
+    if ( len < 0 ){
+      len = strlen(str);
+    }
+    if ( (m_used+len+1) > m_len ){
+      SInt nlen = (m_len*2 > (m_used+len+1)) ? m_len*2 : (m_used+len+1)*2;
+      Char * tmp = NULL;
+      NEW_ARRAY(tmp, Char, nlen);
+      if ( m_used ){
+        memcpy(tmp, m_buf, m_used);
+      }
+      DEL_ARRAY(m_buf);
+      m_buf = tmp;
+      m_len = nlen;
+    }
+    m_offs.PushBack(m_used);
+    memcpy(m_buf+m_used, str, len);
+    m_used += len;
+    m_buf[m_used++] = '\0';
+  }
+
+  /** @return The number of strings. */
+  SInt GetStrN() const
+  {
+    return m_offs.Size();
+  }
+
+  /** @return A string, valid until the next AddStr(). */
+  const Char * GetStr(SInt i) const
+  {
+    return m_buf+m_offs.Get(i);
+  }
+
+protected:
+
+  /** The strings, each null terminated. */
+  Char * m_buf;
+
+  /** The buffer length. */
+  SInt m_len;
+
+  /** The buffer used. */
+  SInt m_used;
+
+  /** Offset of each string. */
+  SIntA m_offs;
+
+private:
+
+  MiscStrList(const MiscStrList &);
+  MiscStrList & operator=(const MiscStrList &);
+};
+
+/****************************************************************************/
+/**
+ ** The state shared by the workers of a batch.
+ **
+ **/
+
+struct MiscBatch
+{
+  /** The input files. */
+  MiscStrList files;
+
+  /** The script arguments, before substitution. */
+  MiscStrList args;
+
+  /** Report as JSON rather than CSV. */
+  Bool json;
+
+  /** The report. */
+  FILE * out;
+
+  /** Guards next, done, failed and out. */
+  CommonMutex mutex;
+
+  /** The next file to take. */
+  SInt next;
+
+  /** The files reported. */
+  SInt done;
+
+  /** The files that failed. */
+  SInt failed;
+};
+
+/****************************************************************************/
+/**
+ ** A worker of a batch, taking files one at a time until none are left, so
+ ** that at most one working set per worker is alive at once.
+ **
+ **/
+
+class MiscBatchJob : public HeatWaveJob
+{
+public:
+
+  MiscBatchJob(MiscTool & tool, MiscBatch & bat)
+    :m_tool(tool), m_bat(bat)
+  {
+  }
+
+  void DoRun()
+  {
+    for (;;){
+      LockMutex(&m_bat.mutex);
+      SInt indx = m_bat.next;
+      if ( indx < m_bat.files.GetStrN() ){
+        ++m_bat.next;
+      }
+      UnlockMutex(&m_bat.mutex);
+      if ( indx >= m_bat.files.GetStrN() ){
+        return;
+      }
+      m_tool.DoBatchFile(m_bat, indx);
+    }
+  }
+
+protected:
+
+  MiscTool & m_tool;
+  MiscBatch & m_bat;
+};
+
+/****************************************************************************/
+
+/**
+ *
+ * Read a text file, or standard input, with one file name per line into a
+ * list. Empty lines and lines starting with '#' are skipped.
+ *
+ **/
+
+static Bool
+DoReadList(MiscStrList & list, const Char * name, FILE * stdI)
+{
+  FILE * in = (strcmp(name,"stdin") == 0) ? stdI : fopen(name,"rt");
+  if ( in == NULL ){
+    return False;
+  }
+  Char line[FILENAME_MAX+2];
+  while ( fgets(line, sizeof(line), in) ){
+    SInt len = strcspn(line,"\r\n");
+    if ( (len > 0) && (line[0] != '#') ){
+      list.AddStr(line, len);
+    }
+  }
+  if ( in != stdI ){
+    fclose(in);
+  }
+  return True;
+}
+
+/**
+ *
+ * Split a script into arguments on white space, where double quotes keep an
+ * argument together and '#' starts a comment up to the end of the line.
+ *
+ **/
+
+static Bool
+DoReadScript(MiscStrList & args, const Char * name)
+{
+  FILE * in = fopen(name,"rt");
+  if ( in == NULL ){
+    return False;
+  }
+  Char arg[FILENAME_MAX+2];
+  SInt len = 0, c = 0;
+  Bool quot = False, have = False, cmnt = False;
+  while ( (c = fgetc(in)) != EOF ){
+    if ( cmnt ){
+      cmnt = (c != '\n');
+      continue;
+    }
+    if ( c == '"' ){
+      quot = !quot;
+      have = True;
+    }
+    else if ( !quot && (c == '#') && !have ){
+      cmnt = True;
+    }
+    else if ( !quot && isspace(c) ){
+      if ( have ){
+        args.AddStr(arg, len);
+      }
+      len = 0;
+      have = False;
+    }
+    else if ( len < (SInt)sizeof(arg)-1 ){
+      arg[len++] = c;
+      have = True;
+    }
+  }
+  if ( have ){
+    args.AddStr(arg, len);
+  }
+  fclose(in);
+  return True;
+}
+
+/**
+ *
+ * Substitute the place holders of a script argument for a file, "%f" the
+ * file, "%b" the file name without directory and extension, "%i" the index
+ * and "%%" a single '%'.
+ *
+ **/
+
+static void
+DoSubstitute(Char * dst, SInt len, const Char * src, const Char * file,
+             SInt indx)
+{
+  const Char * base = strrchr(file,'/');
+  base = base ? base+1 : file;
+  const Char * dot = strrchr(base,'.');
+  SInt blen = dot ? (SInt)(dot-base) : (SInt)strlen(base);
+  SInt n = 0;
+  Char num[32];
+  for ( ; *src && (n < len-1) ; ++src ){
+    const Char * ins = NULL;
+    SInt ilen = 0;
+    if ( (src[0] == '%') && src[1] ){
+      switch ( src[1] ){
+      case 'f': ins = file; ilen = strlen(file); break;
+      case 'b': ins = base; ilen = blen; break;
+      case 'i':
+        sprintf(num,"%d",indx);
+        ins = num; ilen = strlen(num);
+        break;
+      case '%': ins = "%"; ilen = 1; break;
+      default: break;
+      }
+    }
+    if ( ins == NULL ){
+      dst[n++] = *src;
+      continue;
+    }
+    if ( ilen > (len-1-n) ){
+      ilen = len-1-n;
+    }
+    memcpy(dst+n, ins, ilen);
+    n += ilen;
+    ++src;
+  }
+  dst[n] = '\0';
+}
+
+/**
+ *
+ * Print a string as a CSV field, quoted if needed.
+ *
+ **/
+
+static void
+DoPrintCSV(FILE * out, const Char * str)
+{
+  if ( strpbrk(str,",\"\r\n") == NULL ){
+    fputs(str, out);
+    return;
+  }
+  fputc('"', out);
+  for ( ; *str ; ++str ){
+    if ( *str == '"' ){
+      fputc('"', out);
+    }
+    fputc(*str, out);
+  }
+  fputc('"', out);
+}
+
+/**
+ *
+ * Print a string as a JSON string.
+ *
+ **/
+
+static void
+DoPrintJSON(FILE * out, const Char * str)
+{
+  fputc('"', out);
+  for ( ; *str ; ++str ){
+    UInt8 c = (UInt8)*str;
+    if ( (c == '"') || (c == '\\') ){
+      fprintf(out,"\\%c",c);
+    }
+    else if ( c < 0x20 ){
+      fprintf(out,"\\u%04x",c);
+    }
+    else {
+      fputc(c, out);
+    }
+  }
+  fputc('"', out);
+}
+
+/**
+ *
+ * Get the next line of a captured output starting with a prefix, without
+ * the prefix, the leading white space and the line end.
+ *
+ **/
+
+static Bool
+GetCaptured(FILE * in, const Char * pre, Char * line, SInt len)
+{
+  SInt plen = strlen(pre);
+  while ( fgets(line, len, in) ){
+    if ( strncmp(line, pre, plen) != 0 ){
+      continue;
+    }
+    SInt skip = plen;
+    while ( line[skip] == ' ' ){
+      ++skip;
+    }
+    memmove(line, line+skip, strlen(line+skip)+1);
+    line[strcspn(line,"\r\n")] = '\0';
+    return True;
+  }
+  return False;
+}
+
+/****************************************************************************/
+
+Bool
+MiscTool::DoBatchFile(MiscBatch & bat, SInt indx)
+{
+  const Char * file = bat.files.GetStr(indx);
+  SInt argc = bat.args.GetStrN()+1;
+  const Char ** argv = NULL;
+  Char * argb = NULL;
+  NEW_ARRAY(argv, const Char *, argc);
+  NEW_ARRAY(argb, Char, (argc-1)*(FILENAME_MAX+2));
+  argv[0] = m_cmdName;
+  for ( SInt i = 1 ; i < argc ; ++i ){
+    Char * arg = argb+(i-1)*(FILENAME_MAX+2);
+    DoSubstitute(arg, FILENAME_MAX+2, bat.args.GetStr(i-1), file, indx);
+    argv[i] = arg;
+  }
+
+  // a tool of its own per file, its output captured for the report
+  FILE * capO = tmpfile();
+  FILE * capE = tmpfile();
+  Bool ok = False;
+  SInt imgn = 0;
+  SInt64 start = HeatWaveProfiler::GetClock();
+  if ( capO && capE ){
+    MiscTool tool(m_names, m_versions, m_history, m_authors, m_copyright,
+                  m_dateCompiled, m_timeCompiled, 1, m_argNote, m_maxColumns,
+                  m_verbose);
+    tool.m_batched = True;
+    tool.m_stdI = m_stdI;
+    tool.m_stdO = capO;
+    tool.m_stdE = capE;
+    ok = !tool.DoArguments(argc, argv);
+    imgn = tool.GetTotalImagesLoaded();
+    fflush(capO);
+    fflush(capE);
+  }
+  SFloat64 msec = (HeatWaveProfiler::GetClock()-start)/1e6;
+  DEL_ARRAY(argb);
+  DEL_ARRAY(argv);
+
+  Char line[1024];
+  Char errm[1024];
+  errm[0] = '\0';
+  if ( capE ){
+    rewind(capE);
+    GetCaptured(capE, ERR_M, errm, sizeof(errm));
+  }
+  else {
+    strcpy(errm,"unable to capture output");
+  }
+  // an error message means failure even if the arguments went through
+  ok = ok && (errm[0] == '\0');
+
+  LockMutex(&bat.mutex);
+  if ( !ok ){
+    ++bat.failed;
+  }
+  if ( bat.json ){
+    fprintf(bat.out,"%s{\"index\":%d,\"file\":", bat.done ? ",\n" : "",
+            indx);
+    DoPrintJSON(bat.out, file);
+    fprintf(bat.out,",\"status\":\"%s\",\"msec\":%.3f,\"images\":%d,"
+            "\"results\":[", ok ? "ok" : "failed", msec, imgn);
+    SInt n = 0;
+    if ( capO ){
+      rewind(capO);
+      while ( GetCaptured(capO, RES_M, line, sizeof(line)) ){
+        fprintf(bat.out,"%s", (n++ > 0) ? "," : "");
+        DoPrintJSON(bat.out, line);
+      }
+    }
+    fprintf(bat.out,"],\"error\":");
+    DoPrintJSON(bat.out, errm);
+    fprintf(bat.out,"}");
+  }
+  else {
+    fprintf(bat.out,"%d,", indx);
+    DoPrintCSV(bat.out, file);
+    fprintf(bat.out,",%s,%.3f,%d,", ok ? "ok" : "failed", msec, imgn);
+    // the result lines of a file go in one field, separated by " | "
+    Char * res = NULL;
+    SInt rlen = 0, rused = 0;
+    if ( capO ){
+      rewind(capO);
+      while ( GetCaptured(capO, RES_M, line, sizeof(line)) ){
+        SInt len = strlen(line);
+        if ( (rused+len+4) > rlen ){
+          Char * tmp = NULL;
+          rlen = (rused+len+4)*2;
+          NEW_ARRAY(tmp, Char, rlen);
+          if ( rused ){
+            memcpy(tmp, res, rused);
+          }
+          DEL_ARRAY(res);
+          res = tmp;
+        }
+        if ( rused ){
+          memcpy(res+rused," | ",3);
+          rused += 3;
+        }
+        memcpy(res+rused, line, len);
+        rused += len;
+        res[rused] = '\0';
+      }
+    }
+    DoPrintCSV(bat.out, res ? res : "");
+    DEL_ARRAY(res);
+    fprintf(bat.out,",");
+    DoPrintCSV(bat.out, errm);
+    fprintf(bat.out,"\n");
+  }
+  ++bat.done;
+  fflush(bat.out);
+  UnlockMutex(&bat.mutex);
+
+  if ( capO ){
+    fclose(capO);
+  }
+  if ( capE ){
+    fclose(capE);
+  }
+  return ok;
+}
+
+SInt
+MiscTool::DoMainBatch(EnumFunctionDuty duty, SInt argc, const Char ** argv)
+{
+  // set up a ArgInfo struct
+  enum{ arg_list = 0, arg_glob, arg_thrd, arg_frmt, arg_rprt, arg_total};
+  MiscArgInfo info(arg_total);
+  info.singleName = "-bt";
+  info.doubleName = "--batch";
+  info.description = "run a command script over many files";
+  info.descriptionLong = "run the arguments in a script file once for each"
+    " input file, on a pool of threads, each file with images of its own."
+    " In the script \"%f\" stands for the input file, \"%b\" for its name"
+    " without directory and extension, \"%i\" for its index and \"%%\" for"
+    " \"%\", for example \"-l %f -st -ev -s out/%b.jp2\". A line per file"
+    " is reported as it finishes, with its status, time, number of images,"
+    " the results printed and the first error. The batch fails if any"
+    " file fails.";
+  info.strDes = "script";
+  info.flag = Att_FR|Att_SN;
+
+  info.subName[arg_list] = "list=";
+  info.subDesc[arg_list] = "file with a input file per line, or \"stdin\"";
+  info.subFlag[arg_list] = Att_S|Att_TR|Att_SN;
+  info.subStrDes[arg_list] = "file";
+
+  info.subName[arg_glob] = "glob=";
+  info.subDesc[arg_glob] = "pattern of input files, e.g. \"in/*.jp2\"";
+  info.subFlag[arg_glob] = Att_S|Att_TR|Att_SN;
+  info.subStrDes[arg_glob] = "pattern";
+
+  info.subName[arg_thrd] = "threads=";
+  info.subDesc[arg_thrd] = "number of threads, 0 for all cores";
+  info.subFlag[arg_thrd] = Att_S|Att_TR|Att_IN;
+  info.subStrDes[arg_thrd] = "int";
+  info.subStrDef[arg_thrd] = "0";
+
+  info.subName[arg_frmt] = "format=";
+  info.subDesc[arg_frmt] = "report as \"csv\" or \"json\"";
+  info.subFlag[arg_frmt] = Att_S|Att_TR|Att_SN;
+  info.subStrDes[arg_frmt] = "fmt";
+  info.subStrDef[arg_frmt] = "csv";
+
+  info.subName[arg_rprt] = "report=";
+  info.subDesc[arg_rprt] = "file to report to, standard output by default";
+  info.subFlag[arg_rprt] = Att_S|Att_TR|Att_SN;
+  info.subStrDes[arg_rprt] = "file";
+
+  // perform the minor duty's
+  if( duty != Dty_Perform ){
+    return DoMinorDuty(duty, info, argc, argv);
+  };
+
+  // perform major duty
+  SInt ret = DoArgInfoRecognition(info, argc, argv);
+  if ( m_batched ){
+    fprintf(m_stdE,"%s a batch can not run a batch\n",ERR_M);
+    return Err_Other;
+  }
+
+  MiscBatch bat;
+  bat.next = 0;
+  bat.done = 0;
+  bat.failed = 0;
+  bat.out = m_stdO;
+  if ( strcmp(info.subStr[arg_frmt][0],"json") == 0 ){
+    bat.json = True;
+  }
+  else if ( strcmp(info.subStr[arg_frmt][0],"csv") == 0 ){
+    bat.json = False;
+  }
+  else {
+    fprintf(m_stdE,"%s unrecognized report format \"%s\"\n",ERR_M,
+            info.subStr[arg_frmt][0]);
+    return Err_Other;
+  }
+  if ( !DoReadScript(bat.args, info.str[0]) ){
+    fprintf(m_stdE,"%s unable to read script \"%s\"\n",ERR_M,info.str[0]);
+    return Err_Other;
+  }
+  if ( info.subFlag[arg_list] & Att_Set ){
+    for ( SInt i = 0 ; i < info.subStrNum[arg_list] ; ++i ){
+      if ( !DoReadList(bat.files, info.subStr[arg_list][i], m_stdI) ){
+        fprintf(m_stdE,"%s unable to read list \"%s\"\n",ERR_M,
+                info.subStr[arg_list][i]);
+        return Err_Other;
+      }
+    }
+  }
+  if ( info.subFlag[arg_glob] & Att_Set ){
+    for ( SInt i = 0 ; i < info.subStrNum[arg_glob] ; ++i ){
+      glob_t gl;
+      if ( glob(info.subStr[arg_glob][i], 0, NULL, &gl) == 0 ){
+        for ( size_t g = 0 ; g < gl.gl_pathc ; ++g ){
+          bat.files.AddStr(gl.gl_pathv[g]);
+        }
+      }
+      globfree(&gl);
+    }
+  }
+  if ( bat.files.GetStrN() == 0 ){
+    fprintf(m_stdE,"%s no input files, see \"list=\" and \"glob=\"\n",ERR_M);
+    return Err_Other;
+  }
+  if ( info.subFlag[arg_rprt] & Att_Set ){
+    bat.out = fopen(info.subStr[arg_rprt][0],"wt");
+    if ( bat.out == NULL ){
+      fprintf(m_stdE,"%s unable to open report \"%s\"\n",ERR_M,
+              info.subStr[arg_rprt][0]);
+      return Err_Other;
+    }
+  }
+
+  HeatWaveWorkerPool pool(atoi(info.subStr[arg_thrd][0]));
+  SInt jobn = (pool.GetThreads() < bat.files.GetStrN()) ?
+    pool.GetThreads() : bat.files.GetStrN();
+  if ( m_verbose ){
+    fprintf(m_stdE,"%s running %d argument(s) over %d file(s) on %d "
+            "thread(s)\n", VRB_M, bat.args.GetStrN(), bat.files.GetStrN(),
+            jobn);
+  }
+  if ( bat.json ){
+    fprintf(bat.out,"[\n");
+  }
+  else {
+    fprintf(bat.out,"index,file,status,msec,images,results,error\n");
+  }
+
+  InitMutex(&bat.mutex);
+  MiscBatchJob ** jobs = NULL;
+  NEW_ARRAY(jobs, MiscBatchJob *, jobn);
+  for ( SInt j = 0 ; j < jobn ; ++j ){
+    jobs[j] = new MiscBatchJob(*this, bat);
+    pool.DoSubmit(jobs[j]);
+  }
+  pool.DoWait();
+  for ( SInt j = 0 ; j < jobn ; ++j ){
+    delete jobs[j];
+  }
+  DEL_ARRAY(jobs);
+  FreeMutex(&bat.mutex);
+
+  if ( bat.json ){
+    fprintf(bat.out,"\n]\n");
+  }
+  if ( bat.out != m_stdO ){
+    fclose(bat.out);
+  }
+  if ( bat.failed ){
+    fprintf(m_stdE,"%s %d of %d file(s) failed\n",ERR_M,bat.failed,
+            bat.files.GetStrN());
+    ret = Err_Other;
+  }
+  return ret;
+}
@@ -13,7 +13,7 @@ SInt
 MiscTool::DoMainImgLoad(EnumFunctionDuty duty, SInt argc, const Char ** argv)
 {
   // set up a ArgInfo struct 
-  enum{ arg_type = 0, arg_total};
+  enum{ arg_type = 0, arg_scale, arg_raw, arg_total};
   MiscArgInfo info(arg_total);
   info.singleName = "-l";
   info.doubleName = "--load-image";
@@ -25,6 +25,16 @@ MiscTool::DoMainImgLoad(EnumFunctionDuty duty, SInt argc, const Char ** argv)
   info.subDesc[arg_type] = "Specify a image format; bmp, jpg etc.";
   info.subFlag[arg_type] = Att_S|Att_TR;
   info.subStrDes[arg_type] = "fmt";
+
+  info.subName[arg_scale] = "scale=";
+  info.subDesc[arg_scale] = "decode JPEG images at 1/2, 1/4 or 1/8 size";
+  info.subFlag[arg_scale] = Att_S|Att_TR|Att_IN;
+  info.subStrDes[arg_scale] = "int";
+  info.subStrDef[arg_scale] = "1";
+
+  info.subName[arg_raw] = "raw";
+  info.subDesc[arg_raw] = "keep the YCbCr planes of JPEG images as sampled";
+  info.subFlag[arg_raw] = Att_S;
   
   // perform the minor duty's  
   if( duty != Dty_Perform ){
@@ -34,6 +44,9 @@ MiscTool::DoMainImgLoad(EnumFunctionDuty duty, SInt argc, const Char ** argv)
   // perform major duty 
   SInt ret = DoArgInfoRecognition(info, argc, argv);
   const Char * type = NULL;
+  Char opts[64];
+  sprintf(opts, "scale=%d%s", atoi(info.subStr[arg_scale][0]),
+          (info.subFlag[arg_raw] & Att_Set) ? " raw" : "");
   //SInt nxt_img = 0;
   HeatWaveImage * tmp = NULL;
   
@@ -58,7 +71,7 @@ MiscTool::DoMainImgLoad(EnumFunctionDuty duty, SInt argc, const Char ** argv)
         fprintf(m_stdO,"\n");
       }
     }
-    tmp = m_imgTool.ReadImage(info.str[i], type, NULL);
+    tmp = m_imgTool.ReadImage(info.str[i], type, opts);
     if ( !tmp ){
       fprintf(m_stdO,"%s loading image \"%s\" failed: %s\n", VRB_M,
               info.str[i], m_imgTool.GetLastErrorMessage());
@@ -78,12 +91,17 @@ SInt
 MiscTool::DoMainImgVidL(EnumFunctionDuty duty, SInt argc, const Char ** argv)
 {
   // set up a ArgInfo struct ...
-  MiscArgInfo info(0);
+  enum{ arg_pack = 0, arg_total};
+  MiscArgInfo info(arg_total);
   info.singleName = "-lv";
   info.doubleName = "--load-video";
   info.description = "load a video";
   info.strDes = "file";
   info.flag = Att_FR|Att_SN;
+
+  info.subName[arg_pack] = "pack";
+  info.subDesc[arg_pack] = "keep frames in 16-bit samples, half the memory";
+  info.subFlag[arg_pack] = Att_S;
   
   // perform the minor duty's ...
   if( duty != Dty_Perform ){
@@ -102,7 +120,8 @@ MiscTool::DoMainImgVidL(EnumFunctionDuty duty, SInt argc, const Char ** argv)
     fprintf(m_stdE,"%s failed to anaylse file \"%s\"\n", ERR_M, info.str[0]);
     return Err_Other;
   }
-  video = reader.LoadVideo();
+  // packed frames unpack themselves once a transform outgrows 16-bits
+  video = reader.LoadVideo((info.subFlag[arg_pack] & Att_Set) != 0);
   ASSERT ( video != NULL );
   reader.CloseFile();
   if ( m_verbose ){
@@ -118,6 +137,305 @@ MiscTool::DoMainImgVidL(EnumFunctionDuty duty, SInt argc, const Char ** argv)
   return ret;
 }
 
+SInt
+MiscTool::DoMainImgVidP(EnumFunctionDuty duty, SInt argc, const Char ** argv)
+{
+  // set up a ArgInfo struct ...
+  enum{ arg_clr = 0, arg_ct, arg_spat, arg_temp, arg_trns, arg_gop, arg_depth,
+        arg_est, arg_save, arg_total};
+  MiscArgInfo info(arg_total);
+  info.singleName = "-pv";
+  info.doubleName = "--pipe-video";
+  info.description = "load and transform a video in a pipeline";
+  info.descriptionLong = "load a video, frame by frame, through a pipeline of"
+    " a color, a spatial and a temporal transform, each stage running in its"
+    " own thread so that the stages overlap. The result is the same as"
+    " \"-lv\" followed by \"-ct\", \"-st\" and \"-tt\", except that the"
+    " temporal transform is done in groups of frames.";
+  info.strDes = "file";
+  info.flag = Att_FR|Att_SN;
+
+  info.subName[arg_clr] = "color=";
+  info.subDesc[arg_clr] = "color transform to \"YUV\", \"RGB\" or \"grey\"";
+  info.subFlag[arg_clr] = Att_S|Att_TR|Att_SN;
+  info.subStrDes[arg_clr] = "clr";
+
+  info.subName[arg_ct] = "method=";
+  info.subDesc[arg_ct] = "One of \"RCT\" or \"ICT\"";
+  info.subFlag[arg_ct] = Att_S|Att_TR|Att_SN;
+  info.subStrDes[arg_ct] = "transform";
+  info.subStrDef[arg_ct] = "RCT";
+
+  info.subName[arg_spat] = "spatial=";
+  info.subDesc[arg_spat] = "specify a spatial transform level";
+  info.subFlag[arg_spat] = Att_S|Att_TR|Att_IN;
+  info.subStrDes[arg_spat] = "level";
+  info.subStrDef[arg_spat] = "0";
+
+  info.subName[arg_temp] = "temporal=";
+  info.subDesc[arg_temp] = "specify a temporal transform level";
+  info.subFlag[arg_temp] = Att_S|Att_TR|Att_IN;
+  info.subStrDes[arg_temp] = "level";
+  info.subStrDef[arg_temp] = "0";
+
+  info.subName[arg_trns] = "transform=";
+  info.subDesc[arg_trns] = "specify a transform type";
+  info.subFlag[arg_trns] = Att_S|Att_TR|Att_SN;
+  info.subStrDes[arg_trns] = "transform";
+  info.subStrDef[arg_trns] = "6_6";
+
+  info.subName[arg_gop] = "gop=";
+  info.subDesc[arg_gop] = "frames per temporal transform, at least 1";
+  info.subFlag[arg_gop] = Att_S|Att_TR|Att_IN;
+  info.subStrDes[arg_gop] = "int";
+  info.subStrDef[arg_gop] = "16";
+
+  info.subName[arg_depth] = "depth=";
+  info.subDesc[arg_depth] = "frames queued between stages";
+  info.subFlag[arg_depth] = Att_S|Att_TR|Att_IN;
+  info.subStrDes[arg_depth] = "int";
+  info.subStrDef[arg_depth] = "2";
+
+  info.subName[arg_est] = "estimate";
+  info.subDesc[arg_est] = "print the zero order entropy of the result";
+  info.subFlag[arg_est] = Att_S;
+
+  info.subName[arg_save] = "save=";
+  info.subDesc[arg_save] = "stream the result to a AVI file instead of the"
+    " array, as coefficients if transformed";
+  info.subFlag[arg_save] = Att_S|Att_TR|Att_SN;
+  info.subStrDes[arg_save] = "file";
+
+  // perform the minor duty's ...
+  if( duty != Dty_Perform ){
+    return DoMinorDuty(duty, info, argc, argv);
+  };
+
+  // perform major duty ...
+  SInt ret = DoArgInfoRecognition(info, argc, argv);
+  EnumTransform trn = TransformEnum(info.subStr[arg_trns][0]);
+  if ( trn == TrnUnknown ){
+    fprintf(m_stdE,"%s unrecognized transform \"%s\"\n",ERR_M,
+            info.subStr[arg_trns][0]);
+    return Err_Other;
+  }
+  SInt spat = atoi(info.subStr[arg_spat][0]);
+  SInt temp = atoi(info.subStr[arg_temp][0]);
+  SInt gop = atoi(info.subStr[arg_gop][0]);
+  SInt depth = atoi(info.subStr[arg_depth][0]);
+  if ( (spat < 0) || (temp < 0) ){
+    fprintf(m_stdE,"%s minimum transform level is 0\n",ERR_M);
+    return Err_Other;
+  }
+  if ( depth < 1 ){
+    fprintf(m_stdE,"%s minimum depth is 1\n",ERR_M);
+    return Err_Other;
+  }
+  if ( (temp > 0) && (gop < 1) ){
+    // a group of all frames would hold the whole video
+    fprintf(m_stdE,"%s minimum gop is 1\n",ERR_M);
+    return Err_Other;
+  }
+  EnumSpace space = SpcUnknown;
+  if ( info.subFlag[arg_clr] & Att_Set ){
+    space = SpaceEnum(info.subStr[arg_clr][0]);
+    if ( space == SpcUnknown ){
+      fprintf(m_stdE,"%s \"%s\" is not a recognized color space!\n",ERR_M,
+              info.subStr[arg_clr][0]);
+      return Err_Other;
+    }
+  }
+  EnumCT ct = CTEnum(info.subStr[arg_ct][0]);
+  if ( ct == UnknownCT ){
+    fprintf(m_stdE,"%s \"%s\" is not a recognized color transform!\n",ERR_M,
+            info.subStr[arg_ct][0]);
+    return Err_Other;
+  }
+
+  HeatWaveAVIReader reader;
+  if ( !reader.OpenFile(info.str[0]) ){
+    fprintf(m_stdE,"%s unable to open video \"%s\"\n", ERR_M, info.str[0]);
+    return Err_Other;
+  }
+  if ( !reader.AnalyseFile() ){
+    fprintf(m_stdE,"%s failed to anaylse file \"%s\"\n", ERR_M, info.str[0]);
+    return Err_Other;
+  }
+
+  // read the next frames while the first stage works
+  reader.SetPrefetch(depth);
+
+  HeatWaveAVIWriter writer;
+  Bool save = (info.subFlag[arg_save] & Att_Set) != 0;
+  if ( save ){
+    const HeatWaveAVIStreamHeader * hdr = reader.GetVideoHeader();
+    EnumVideoType type = (space == SpcGrey) ? VidGREY : VidIYUV;
+    SInt rate = (hdr->dwScale > 0) ? (hdr->dwRate/hdr->dwScale) : 25;
+    if ( !writer.OpenFile(info.subStr[arg_save][0], type, hdr->rcFrame.right,
+                          hdr->rcFrame.bottom, rate,
+                          (spat > 0) || (temp > 0)) ){
+      fprintf(m_stdE,"%s unable to create video \"%s\": %s\n", ERR_M,
+              info.subStr[arg_save][0], writer.GetError());
+      return Err_Other;
+    }
+  }
+
+  HeatWaveAVISource source(reader);
+  HeatWaveColorStage color(space, (ct == RCT));
+  HeatWaveSpatialStage spatial(trn, spat);
+  HeatWaveTemporalStage temporal(trn, temp, True, gop);
+  HeatWaveEntropyStage entropy;
+  HeatWaveVideo * video = new HeatWaveVideo();
+  LEAVEONNULL(video);
+  HeatWaveVideoSink sink(*video);
+  HeatWaveAVISink avi(writer);
+  HeatWavePipeline pipe(depth);
+  pipe.SetSource(&source);
+  if ( space != SpcUnknown ){
+    pipe.AddStage(&color);
+  }
+  if ( spat > 0 ){
+    pipe.AddStage(&spatial);
+  }
+  if ( temp > 0 ){
+    pipe.AddStage(&temporal);
+  }
+  if ( info.subFlag[arg_est] & Att_Set ){
+    pipe.AddStage(&entropy);
+  }
+  if ( save ){
+    pipe.AddStage(&avi);
+  }
+  else{
+    pipe.AddStage(&sink);
+  }
+  SInt frames = pipe.DoRun();
+  reader.CloseFile();
+  if ( frames < 0 ){
+    fprintf(m_stdE,"%s unable to start the pipeline\n", ERR_M);
+    delete video;
+    return Err_Other;
+  }
+  SInt done = save ? writer.GetFrameN() : video->GetImageN();
+  if ( done != frames ){
+    fprintf(m_stdE,"%s only %d of %d frames made it through\n", ERR_M,
+            done, frames);
+  }
+  if ( info.subFlag[arg_est] & Att_Set ){
+    SFloat64 smpln = entropy.GetSampleN();
+    fprintf(m_stdO,"%s %d frames, %.4f bits per sample, %.0f bytes\n", RES_M,
+            entropy.GetFrameN(),
+            (smpln > 0.0) ? (entropy.GetBits()/smpln) : 0.0,
+            entropy.GetBits()/8.0);
+  }
+  if ( save ){
+    delete video;
+    if ( !writer.CloseFile() ){
+      fprintf(m_stdE,"%s saving video \"%s\" failed: %s\n", ERR_M,
+              info.subStr[arg_save][0], writer.GetError());
+      return Err_Other;
+    }
+    if ( m_verbose ){
+      fprintf(m_stdE,"%s saved %d frames to \"%s\"\n", VRB_M, done,
+              info.subStr[arg_save][0]);
+    }
+    return ret;
+  }
+  if ( m_verbose ){
+    fprintf(m_stdE,"%s appending %d images to array from file \"%s\"\n",
+            VRB_M, video->GetImageN(), info.str[0]);
+  }
+  m_images.DoAppendVideo(video);
+  if ( m_verbose ){
+    fprintf(m_stdE,"%s internal array has a total of %d images now\n",
+            VRB_M, m_images.GetImageN());
+  }
+  return ret;
+}
+
+SInt
+MiscTool::DoMainImgVidS(EnumFunctionDuty duty, SInt argc, const Char ** argv)
+{
+  // set up a ArgInfo struct ...
+  enum{ arg_type = 0, arg_rate, arg_coef, arg_total};
+  MiscArgInfo info(arg_total);
+  info.singleName = "-sv";
+  info.doubleName = "--save-video";
+  info.description = "save the image array as a video";
+  info.descriptionLong = "save all images on the array, one frame each, to a"
+    " uncompressed AVI file. Images are converted to the color space and"
+    " sampling of the video type, samples are clipped to 8-bits. With"
+    " \"coefficients\" the samples are written as signed 16-bit values"
+    " instead, e.g. to keep transformed images, the images must then be in"
+    " the layout of the video type already.";
+  info.strDes = "file";
+  info.flag = Att_FR|Att_SN;
+
+  info.subName[arg_type] = "type=";
+  info.subDesc[arg_type] = "video type \"IYUV\" or \"GREY\"";
+  info.subFlag[arg_type] = Att_S|Att_TR|Att_SN;
+  info.subStrDes[arg_type] = "fourcc";
+  info.subStrDef[arg_type] = "IYUV";
+
+  info.subName[arg_rate] = "rate=";
+  info.subDesc[arg_rate] = "frames per second";
+  info.subFlag[arg_rate] = Att_S|Att_TR|Att_IN;
+  info.subStrDes[arg_rate] = "int";
+  info.subStrDef[arg_rate] = "25";
+
+  info.subName[arg_coef] = "coefficients";
+  info.subDesc[arg_coef] = "write signed 16-bit samples";
+  info.subFlag[arg_coef] = Att_S;
+
+  // perform the minor duty's ...
+  if( duty != Dty_Perform ){
+    return DoMinorDuty(duty, info, argc, argv);
+  };
+
+  // perform major duty ...
+  SInt ret = DoArgInfoRecognition(info, argc, argv);
+  EnumVideoType type = VideoTypeEnum(info.subStr[arg_type][0]);
+  if ( type == VidUnknown ){
+    fprintf(m_stdE,"%s \"%s\" is not a recognized video type!\n",ERR_M,
+            info.subStr[arg_type][0]);
+    return Err_Other;
+  }
+  SInt rate = atoi(info.subStr[arg_rate][0]);
+  if ( rate < 1 ){
+    fprintf(m_stdE,"%s minimum rate is 1\n",ERR_M);
+    return Err_Other;
+  }
+  if ( !CheckImgNum(0,1) ){
+    return Err_Other;
+  }
+
+  HeatWaveAVIWriter writer;
+  HeatWaveImage & first = m_images.GetImage(0);
+  if ( !writer.OpenFile(info.str[0], type, first.GetWidth(),
+                        first.GetHeight(), rate,
+                        (info.subFlag[arg_coef] & Att_Set) != 0) ){
+    fprintf(m_stdE,"%s unable to create video \"%s\": %s\n", ERR_M,
+            info.str[0], writer.GetError());
+    return Err_Other;
+  }
+  if ( !writer.SaveVideo(m_images) ){
+    fprintf(m_stdE,"%s saving frame %d failed: %s\n", ERR_M,
+            writer.GetFrameN(), writer.GetError());
+    writer.CloseFile();
+    return Err_Other;
+  }
+  if ( !writer.CloseFile() ){
+    fprintf(m_stdE,"%s saving video \"%s\" failed: %s\n", ERR_M,
+            info.str[0], writer.GetError());
+    return Err_Other;
+  }
+  if ( m_verbose ){
+    fprintf(m_stdE,"%s saved %d frames to \"%s\"\n", VRB_M,
+            writer.GetFrameN(), info.str[0]);
+  }
+  return ret;
+}
+
 SInt
 MiscTool::DoMainImgSave(EnumFunctionDuty duty, SInt argc, const Char ** argv)
 { 
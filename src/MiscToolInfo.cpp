@@ -9,20 +9,71 @@
 
 #include "MiscTool.hpp"
 
+#ifndef WIN32
+
+/**
+ *
+ * MD5 of a block of bytes with mhash, as a hash function for
+ * HeatWaveDigest.
+ *
+ **/
+
+static void
+DoMD5(const UInt8 * data, SInt len, UInt8 * out)
+{
+  MHASH td = mhash_init(MHASH_MD5);
+  ASSERTALWAYS ( td != MHASH_FAILED );
+  mhash(td, data, len);
+  UInt8 * hash = (UInt8*)mhash_end(td);
+  memcpy(out, hash, mhash_get_block_size(MHASH_MD5));
+  free(hash);
+}
+
+#endif
+
 SInt
 MiscTool::DoMainImgHash(EnumFunctionDuty duty, SInt argc, const Char ** argv)
 { 
   // set up a ArgInfo struct
-  enum{ arg_img = 0, arg_cmp, arg_total};
+  enum{ arg_hash = 0, arg_tree, arg_frms, arg_chnk, arg_thrd, arg_total};
   MiscArgInfo info(arg_total);
   info.singleName = "-sum";
   info.doubleName = "--checksum";
-  info.description = "create a combined md5 checksum";
-  /** @todo make is so we can use mutli checksums later. **/
-  //info.descriptionLong = "available checksums include: CRC32, ADLER32, "
-  //  "MD5 (default), MD4, SHA1/SHA256, HAVAL, RIPEMD160, TIGER, TIGER128, "
-  //  "TIGER160 and GHOST";
+  info.description = "create a combined checksum, md5 by default";
+  info.descriptionLong = "hash the samples of all images. By default a"
+    " single md5 over all components in turn. With \"tree\", \"frames\" or"
+    " a hash other than md5 the components are cut into chunks hashed in"
+    " parallel and combined in a tree, chunks into components, components"
+    " into frames and frames into the root. \"xxh64\" (xxHash64) and"
+    " \"crc32c\" are much faster than md5 but not cryptographic, fine for"
+    " regression checks. Tree digests only compare with the same hash and"
+    " chunk size.";
+
+  info.subName[arg_hash] = "hash=";
+  info.subDesc[arg_hash] = "\"md5\", \"xxh64\" or \"crc32c\"";
+  info.subFlag[arg_hash] = Att_S|Att_TR|Att_SN;
+  info.subStrDes[arg_hash] = "name";
+  info.subStrDef[arg_hash] = "md5";
 
+  info.subName[arg_tree] = "tree";
+  info.subDesc[arg_tree] = "hash chunks in parallel and combine them";
+  info.subFlag[arg_tree] = Att_F;
+
+  info.subName[arg_frms] = "frames";
+  info.subDesc[arg_frms] = "print the digest of each frame too (tree)";
+  info.subFlag[arg_frms] = Att_F;
+
+  info.subName[arg_chnk] = "chunk=";
+  info.subDesc[arg_chnk] = "the chunk size in KiB (tree)";
+  info.subFlag[arg_chnk] = Att_S|Att_TR|Att_IN;
+  info.subStrDes[arg_chnk] = "int";
+  info.subStrDef[arg_chnk] = "1024";
+
+  info.subName[arg_thrd] = "threads=";
+  info.subDesc[arg_thrd] = "number of threads, 0 for all cores (tree)";
+  info.subFlag[arg_thrd] = Att_S|Att_TR|Att_IN;
+  info.subStrDes[arg_thrd] = "int";
+  info.subStrDef[arg_thrd] = "0";
   
   // perform the minor duty's
   if( duty != Dty_Perform ){
@@ -34,8 +85,63 @@ MiscTool::DoMainImgHash(EnumFunctionDuty duty, SInt argc, const Char ** argv)
   if ( !CheckImgNum(0,1) ){
     return Err_Other;
   }
-  
+
+  HeatWaveHashFunction fn = NULL;
+  SInt size = 0;
+  const Char * name = info.subStr[arg_hash][0];
+  if ( strcmp(name,"xxh64") == 0 ){
+    fn = HeatWaveDigest::DoXXH64;
+    size = 8;
+  }
+  else if ( strcmp(name,"crc32c") == 0 ){
+    fn = HeatWaveDigest::DoCRC32C;
+    size = 4;
+  }
+  else if ( strcmp(name,"md5") == 0 ){
 #ifndef WIN32
+    fn = DoMD5;
+    size = mhash_get_block_size(MHASH_MD5);
+#else
+    fprintf(m_stdE,"%s md5 not yet supported on Windows\n",ERR_M);
+    return Err_Other;
+#endif
+  }
+  else {
+    fprintf(m_stdE,"%s unrecognized hash \"%s\"\n",ERR_M,name);
+    return Err_Other;
+  }
+  SInt chunk = atoi(info.subStr[arg_chnk][0]);
+  if ( chunk <= 0 ){
+    fprintf(m_stdE,"%s chunk size must be positive\n",ERR_M);
+    return Err_Other;
+  }
+
+  Char hex[2*64+1];
+  if ( (fn == HeatWaveDigest::DoXXH64) || (fn == HeatWaveDigest::DoCRC32C) ||
+       (info.subFlag[arg_tree] & Att_Set) ||
+       (info.subFlag[arg_frms] & Att_Set) ){
+    HeatWaveWorkerPool pool(atoi(info.subStr[arg_thrd][0]));
+    HeatWaveDigest dig(fn, size, chunk*1024);
+    if ( m_verbose ){
+      fprintf(m_stdO,"%s hashing %d image(s) in %d KiB chunks on %d "
+              "thread(s)\n", VRB_M, m_images.GetImageN(), chunk,
+              pool.GetThreads());
+    }
+    dig.DoDigest(m_images, &pool);
+    if ( info.subFlag[arg_frms] & Att_Set ){
+      for ( SInt i = 0 ; i < dig.GetFrameN() ; ++i ){
+        HeatWaveDigest::GetHex(dig.GetFrame(i), size, hex);
+        fprintf(m_stdO,"%s %s frame %d: %s\n",RES_M,name,i,hex);
+      }
+    }
+    HeatWaveDigest::GetHex(dig.GetRoot(), size, hex);
+    fprintf(m_stdO,"%s %s tree: %s\n",RES_M,name,hex);
+    return ret;
+  }
+
+#ifndef WIN32
+  // the one md5 over all, read through views so that neither packed nor
+  // shared components have to be unpacked or copied
   MHASH td;
   UInt8 *hash;
   td = mhash_init(MHASH_MD5);
@@ -43,21 +149,33 @@ MiscTool::DoMainImgHash(EnumFunctionDuty duty, SInt argc, const Char ** argv)
     fprintf(m_stdE,"%s mhash library failed (mhash_init())",ERR_M);
     return Err_Other;
   }
+  Smpl * buf = NULL;
+  SInt bufLen = 0;
   for ( SInt i = 0 ; i < m_images.GetImageN() ; ++i ){
     HeatWaveImage & img = m_images.GetImage(i);
     for ( SInt c = 0 ; c < img.GetComponentN() ; ++c ){
-      HeatWaveComponent & cmp = img.GetComponent(c);
-      Char * data = (Char*)cmp.GetData();
-      mhash(td,data,cmp.GetSize()*sizeof(Smpl));
+      HeatWaveView view = img.GetComponent(c).GetView();
+      if ( !view.IsValid() ){
+        continue;
+      }
+      if ( view.GetWidth() > bufLen ){
+        DEL_ARRAY(buf);
+        bufLen = view.GetWidth();
+        NEW_ARRAY(buf, Smpl, bufLen);
+      }
+      for ( SInt y = 0 ; y < view.GetHeight() ; ++y ){
+        mhash(td,view.GetRow(y,buf),view.GetWidth()*sizeof(Smpl));
+      }
     }
   }
+  DEL_ARRAY(buf);
   hash = (UInt8*)mhash_end(td);
   fprintf(m_stdO,"%s MD5 Hash: ",RES_M);
   for (SInt i = 0; i < (SInt) mhash_get_block_size(MHASH_MD5); i++) {
     fprintf(m_stdO,"%.2x", hash[i]);
   }
   fprintf(m_stdO,"\n");
-  delete hash;
+  free(hash);
   return ret;
 #else
   fprintf(m_stdO,"Option not yet supported on Windows\n");
@@ -228,3 +346,56 @@ MiscTool::DoMainImgPlot(EnumFunctionDuty duty, SInt argc, const Char ** argv)
   }
   return ret;
 }
+
+SInt
+MiscTool::DoMainProfile(EnumFunctionDuty duty, SInt argc, const Char ** argv)
+{
+  // set up a ArgInfo struct
+  MiscArgInfo info(0);
+  info.singleName = "-prof";
+  info.doubleName = "--profile";
+  info.description = "time the library stages from here on, the breakdown "
+    "is printed at exit";
+
+  // perform the minor duty's
+  if( duty != Dty_Perform ){
+    return DoMinorDuty(duty, info, argc, argv);
+  };
+
+  // perform major duty
+  SInt ret = DoArgInfoRecognition(info, argc, argv);
+  if ( !HeatWaveProfiler::IsCompiled() ){
+    fprintf(m_stdE,"%s profiling not compiled in (HEATWAVEPROFILING)\n",
+            ERR_M);
+    return Err_Other;
+  }
+  HeatWaveProfiler::DoReset();
+  HeatWaveProfiler::SetEnabled(True);
+  if ( m_verbose ){
+    fprintf(m_stdO,"%s profiling switched on\n", VRB_M);
+  }
+  return ret;
+}
+
+SInt
+MiscTool::DoMainMemory(EnumFunctionDuty duty, SInt argc, const Char ** argv)
+{
+  // set up a ArgInfo struct
+  MiscArgInfo info(0);
+  info.singleName = "-mem";
+  info.doubleName = "--memory";
+  info.description = "print the live and peak memory of the library";
+  info.descriptionLong = "print the bytes held by the library now and at "
+    "most so far, per subsystem (sample planes, row tables, lifting "
+    "buffers, AVI reading and Huffman nodes), in MiB.";
+
+  // perform the minor duty's
+  if( duty != Dty_Perform ){
+    return DoMinorDuty(duty, info, argc, argv);
+  };
+
+  // perform major duty
+  SInt ret = DoArgInfoRecognition(info, argc, argv);
+  HeatWaveMemory::DoReport(m_stdO, RES_M " ");
+  return ret;
+}
@@ -8,6 +8,7 @@
  **/
 
 #include "MiscTool.hpp"
+#include <sys/stat.h>
 
 SInt
 MiscTool::DoMainImgFuse(EnumFunctionDuty duty, SInt argc, const Char ** argv)
@@ -94,7 +95,7 @@ SInt
 MiscTool::DoMainImgSpat(EnumFunctionDuty duty, SInt argc, const Char ** argv)
 { 
   // set up a ArgInfo struct
-  enum{ arg_trns = 0, arg_inv, arg_total};
+  enum{ arg_trns = 0, arg_inv, arg_tile, arg_thrd, arg_total};
   MiscArgInfo info(arg_total);
   info.singleName = "-st";
   info.doubleName = "--spatial-transform";
@@ -112,6 +113,17 @@ MiscTool::DoMainImgSpat(EnumFunctionDuty duty, SInt argc, const Char ** argv)
   info.subName[arg_inv] = "inverse";
   info.subDesc[arg_inv] = "do inverse transform";
   info.subFlag[arg_inv] = Att_S;
+
+  info.subName[arg_tile] = "tiles=";
+  info.subDesc[arg_tile] = "transform square tiles of this size, 0 for none";
+  info.subFlag[arg_tile] = Att_S|Att_TR|Att_IN;
+  info.subStrDes[arg_tile] = "int";
+
+  info.subName[arg_thrd] = "threads=";
+  info.subDesc[arg_thrd] = "transform tiles in parallel, 0 for all cores";
+  info.subFlag[arg_thrd] = Att_S|Att_TR|Att_IN;
+  info.subStrDes[arg_thrd] = "int";
+  info.subStrDef[arg_thrd] = "1";
     
   // perform the minor duty's
   if( duty != Dty_Perform ){
@@ -137,8 +149,39 @@ MiscTool::DoMainImgSpat(EnumFunctionDuty duty, SInt argc, const Char ** argv)
     fprintf(m_stdE,"%s minimum transform level is 0\n",ERR_M);
     return Err_Other;
   }
-  m_images.DoSpatialTransform(TransformEnum(info.subStr[arg_trns][0]),
-                              level,fwd);
+
+  // the tiling stays with the images, for the inverse
+  SInt tile = m_images.GetImage(0).GetComponent(0).GetTileWidth();
+  if ( info.subFlag[arg_tile] & Att_Set ){
+    tile = atoi(info.subStr[arg_tile][0]);
+    if ( tile < 0 ){
+      fprintf(m_stdE,"%s minimum tile size is 0\n",ERR_M);
+      return Err_Other;
+    }
+  }
+  if ( tile > 0 ){
+    HeatWaveWorkerPool pool(atoi(info.subStr[arg_thrd][0]));
+    m_images.SetTiling(tile, tile, &pool);
+    if ( m_verbose ){
+      fprintf(m_stdE,"%s transforming %dx%d tiles on %d thread(s)\n",
+              VRB_M, tile, tile, pool.GetThreads());
+    }
+    // the cache does not tell tilings apart
+    m_images.DoSpatialTransform(TransformEnum(info.subStr[arg_trns][0]),
+                                level,fwd);
+    m_images.SetTiling(tile, tile);
+    return ret;
+  }
+  m_images.SetTiling(0, 0);
+  if ( m_cache != NULL ){
+    m_cache->DoSpatialTransform(m_images,
+                                TransformEnum(info.subStr[arg_trns][0]),
+                                level,fwd);
+  }
+  else {
+    m_images.DoSpatialTransform(TransformEnum(info.subStr[arg_trns][0]),
+                                level,fwd);
+  }
   return ret;
 }
 
@@ -146,7 +189,7 @@ SInt
 MiscTool::DoMainImgTemp(EnumFunctionDuty duty, SInt argc, const Char ** argv)
 { 
   // set up a ArgInfo struct#
-  enum{ arg_trns = 0, arg_inv, arg_total};
+  enum{ arg_trns = 0, arg_inv, arg_gop, arg_scene, arg_thrd, arg_total};
   MiscArgInfo info(arg_total);
   info.singleName = "-tt";
   info.doubleName = "--temporal-transform";
@@ -164,6 +207,22 @@ MiscTool::DoMainImgTemp(EnumFunctionDuty duty, SInt argc, const Char ** argv)
   info.subName[arg_inv] = "inverse";
   info.subDesc[arg_inv] = "do inverse transform";
   info.subFlag[arg_inv] = Att_S;
+
+  info.subName[arg_gop] = "gop=";
+  info.subDesc[arg_gop] = "maximum frames per group, 0 for no limit";
+  info.subFlag[arg_gop] = Att_S|Att_TR|Att_IN;
+  info.subStrDes[arg_gop] = "int";
+
+  info.subName[arg_scene] = "scenes=";
+  info.subDesc[arg_scene] = "detect scene switches, which start new groups";
+  info.subFlag[arg_scene] = Att_S|Att_TR|Att_DN;
+  info.subStrDes[arg_scene] = "threshold";
+
+  info.subName[arg_thrd] = "threads=";
+  info.subDesc[arg_thrd] = "transform groups in parallel, 0 for all cores";
+  info.subFlag[arg_thrd] = Att_S|Att_TR|Att_IN;
+  info.subStrDes[arg_thrd] = "int";
+  info.subStrDef[arg_thrd] = "1";
     
   // perform the minor duty's
   if( duty != Dty_Perform ){
@@ -189,12 +248,81 @@ MiscTool::DoMainImgTemp(EnumFunctionDuty duty, SInt argc, const Char ** argv)
     fprintf(m_stdE,"%s minimum transform level is 0\n",ERR_M);
     return Err_Other;
   }
-  m_images.DoTemporalTransform(TransformEnum(info.subStr[arg_trns][0]),
-                               level,fwd);
+  
+  // the grouping stays with the images, for the inverse
+  if ( info.subFlag[arg_scene] & Att_Set ){
+    SInt scenes = m_images.DoSceneDetection(atof(info.subStr[arg_scene][0]));
+    if ( m_verbose ){
+      fprintf(m_stdE,"%s %d scene(s) detected\n", VRB_M, scenes);
+    }
+  }
+  SInt gop = m_images.GetGroupLength();
+  if ( info.subFlag[arg_gop] & Att_Set ){
+    gop = atoi(info.subStr[arg_gop][0]);
+  }
+  HeatWaveWorkerPool pool(atoi(info.subStr[arg_thrd][0]));
+  m_images.SetGrouping(gop, &pool);
+  if ( m_verbose ){
+    fprintf(m_stdE,"%s transforming %d group(s) on %d thread(s)\n", VRB_M,
+            m_images.GetGroupCount(), pool.GetThreads());
+  }
+  if ( m_cache != NULL ){
+    m_cache->DoTemporalTransform(m_images,
+                                 TransformEnum(info.subStr[arg_trns][0]),
+                                 level,fwd);
+  }
+  else {
+    m_images.DoTemporalTransform(TransformEnum(info.subStr[arg_trns][0]),
+                                 level,fwd);
+  }
+  m_images.SetGrouping(gop);
   m_images.SetMinPrecSgn();
   return ret;
 }
 
+SInt
+MiscTool::DoMainCache(EnumFunctionDuty duty, SInt argc, const Char ** argv)
+{
+  // set up a ArgInfo struct
+  MiscArgInfo info(0);
+  info.singleName = "-cache";
+  info.doubleName = "--transform-cache";
+  info.description = "cache transform results in a directory";
+  info.descriptionLong = "keep the results of the following spatial and "
+    "temporal transforms in a directory, created if missing, and read them "
+    "back rather than transforming when the same samples are transformed "
+    "the same way again, as in repeated parameter sweeps. Results are filed "
+    "by a hash of the samples and parameters, so the directory may be "
+    "shared and is safe to empty at any time.";
+  info.flag = Att_FR|Att_SN;
+  info.strDes = "dir";
+
+  // perform the minor duty's
+  if( duty != Dty_Perform ){
+    return DoMinorDuty(duty, info, argc, argv);
+  };
+
+  // perform major duty
+  SInt ret = DoArgInfoRecognition(info, argc, argv);
+  struct stat st;
+  if ( (stat(info.str[0], &st) != 0) && (mkdir(info.str[0], 0777) != 0) ){
+    fprintf(m_stdE,"%s unable to create cache directory \"%s\"\n",ERR_M,
+            info.str[0]);
+    return Err_Other;
+  }
+  if ( (stat(info.str[0], &st) != 0) || !S_ISDIR(st.st_mode) ){
+    fprintf(m_stdE,"%s \"%s\" is not a directory\n",ERR_M, info.str[0]);
+    return Err_Other;
+  }
+  delete m_cache;
+  m_cache = new HeatWaveCache(info.str[0]);
+  if ( m_verbose ){
+    fprintf(m_stdE,"%s caching transforms in \"%s\"\n", VRB_M,
+            info.str[0]);
+  }
+  return ret;
+}
+
 SInt
 MiscTool::DoMainImgClrT(EnumFunctionDuty duty, SInt argc, const Char ** argv)
 { 
@@ -349,10 +477,9 @@ MiscTool::DoMainImgComp(EnumFunctionDuty duty, SInt argc, const Char ** argv)
                   tempFile);
           return Err_Other;
         }
-        vector<Smpl> vec;
         SimpleCompressor comp;
         SimpleHuffTable table;
-        Smpl * data = cmp.GetData();
+        HeatWaveView view = cmp.GetView();
         SInt * histogram = NULL;
         SInt hist_range = 0;
         SInt hist_offset = 0;
@@ -370,11 +497,16 @@ MiscTool::DoMainImgComp(EnumFunctionDuty duty, SInt argc, const Char ** argv)
         }
         delete [] histogram;
         table.BuildBinary();
-        vec.reserve(size);
-        for ( SInt i = 0 ; i < (size) ; ++ i){
-          vec.push_back(data[i]);
+        if ( view.IsPacked() ){
+          Smpl * data = view.GetCopy();
+          comp.SetData(data, view.GetWidth(), view.GetHeight(), 
+                       view.GetWidth());
+          delete [] data;
+        }
+        else {
+          comp.SetData(view.GetRow(0), view.GetWidth(), view.GetHeight(), 
+                       view.GetPitch());
         }
-        comp.SetData(vec);
         comp.SetHuffman(table);
         comp.Externalise(fout);
         fout.flush();
@@ -522,6 +654,283 @@ MiscTool::DoMainImgComp(EnumFunctionDuty duty, SInt argc, const Char ** argv)
   return ret;
 }
 
+SInt
+MiscTool::DoMainImgEval(EnumFunctionDuty duty, SInt argc, const Char ** argv)
+{ 
+  // set up a ArgInfo struct
+  enum{ arg_trns = 0, arg_levs, arg_steps, arg_thrd, arg_total};
+  MiscArgInfo info(arg_total);
+  info.singleName = "-ev";
+  info.doubleName = "--evaluate";
+  info.description = "score transforms by the entropy of their sub-bands";
+  info.descriptionLong = "transform each component of all images with each"
+    " of the given transforms, in parallel, and print the zero order entropy"
+    " and the Huffman coded size of each sub-band for each level, in bits"
+    " per sample. With quantizer steps the sub-bands are scored quantized at"
+    " each step, followed by the estimated mean squared error in the image."
+    " The images are left unchanged.";
+
+  info.subName[arg_trns] = "transforms=";
+  info.subDesc[arg_trns] = "comma separated transforms or \"all\"";
+  info.subFlag[arg_trns] = Att_S|Att_TR|Att_SN;
+  info.subStrDes[arg_trns] = "list";
+  info.subStrDef[arg_trns] = "all";
+
+  info.subName[arg_levs] = "levels=";
+  info.subDesc[arg_levs] = "comma separated levels";
+  info.subFlag[arg_levs] = Att_S|Att_TR|Att_SN;
+  info.subStrDes[arg_levs] = "list";
+  info.subStrDef[arg_levs] = "4";
+
+  info.subName[arg_steps] = "steps=";
+  info.subDesc[arg_steps] = "comma separated base quantizer steps";
+  info.subFlag[arg_steps] = Att_S|Att_TR|Att_SN;
+  info.subStrDes[arg_steps] = "list";
+  info.subStrDef[arg_steps] = "1";
+
+  info.subName[arg_thrd] = "threads=";
+  info.subDesc[arg_thrd] = "number of threads, 0 for all cores";
+  info.subFlag[arg_thrd] = Att_S|Att_TR|Att_IN;
+  info.subStrDes[arg_thrd] = "int";
+  info.subStrDef[arg_thrd] = "0";
+  
+  // perform the minor duty's
+  if( duty != Dty_Perform ){
+    return DoMinorDuty(duty, info, argc, argv);
+  };
+  
+  // perform major duty
+  SInt ret = DoArgInfoRecognition(info, argc, argv);
+  if ( !CheckImgNum(0,1) ){
+    return Err_Other;
+  }
+
+  HeatWaveEvaluator eval;
+  Char tmp[100];
+  const Char * str = info.subStr[arg_trns][0];
+  if ( strcmp(str,"all") == 0 ){
+    for ( SInt i = Trn1_1 ; i < TrnTotal ; ++i ){
+      eval.AddTransform((EnumTransform)i);
+    }
+  }
+  else {
+    while ( *str ){
+      SInt len = strcspn(str,",");
+      if ( len >= (SInt)sizeof(tmp) ){
+        len = sizeof(tmp)-1;
+      }
+      strncpy(tmp,str,len);
+      tmp[len] = '\0';
+      if ( TransformEnum(tmp) == TrnUnknown ){
+        fprintf(m_stdE,"%s unrecognized transform \"%s\"\n",ERR_M,tmp);
+        return Err_Other;
+      }
+      eval.AddTransform(TransformEnum(tmp));
+      str += len;
+      str += (*str == ',') ? 1 : 0;
+    }
+  }
+  str = info.subStr[arg_levs][0];
+  while ( *str ){
+    Char * end = NULL;
+    SInt lev = strtol(str,&end,10);
+    if ( (end == str) || (lev < 0) || ((*end != ',') && (*end != '\0')) ){
+      fprintf(m_stdE,"%s bad level list \"%s\"\n",ERR_M,
+              info.subStr[arg_levs][0]);
+      return Err_Other;
+    }
+    eval.AddLevel(lev);
+    str = end+((*end == ',') ? 1 : 0);
+  }
+  Bool lossy = False;
+  str = info.subStr[arg_steps][0];
+  while ( *str ){
+    Char * end = NULL;
+    SFloat64 step = strtod(str,&end);
+    if ( (end == str) || (step < 1.0) || ((*end != ',') && (*end != '\0')) ){
+      fprintf(m_stdE,"%s bad step list \"%s\", steps are at least 1\n",
+              ERR_M,info.subStr[arg_steps][0]);
+      return Err_Other;
+    }
+    eval.AddStep(step);
+    lossy = lossy || (step > 1.0);
+    str = end+((*end == ',') ? 1 : 0);
+  }
+
+  HeatWaveWorkerPool pool(atoi(info.subStr[arg_thrd][0]));
+  if ( m_verbose ){
+    fprintf(m_stdE,"%s evaluating %d image(s) on %d thread(s)\n", VRB_M,
+            m_images.GetImageN(), pool.GetThreads());
+  }
+  eval.DoEvaluate(m_images, &pool);
+
+  // per sub-band in bits per sample, with a total per transform and level,
+  // the step and error only when quantizing
+  fprintf(m_stdO,"%s transform %slevel component sub-band samples entropy"
+          " huffman%s\n",RES_M,lossy ? "step " : "",lossy ? " mse" : "");
+  SFloat64 smpln = 0.0, ent = 0.0, huf = 0.0, dst = 0.0;
+  Char step[32] = "";
+  for ( SInt i = 0 ; i < eval.GetScoreN() ; ++i ){
+    const HeatWaveScore & sc = eval.GetScore(i);
+    if ( lossy ){
+      sprintf(step,"%g ",sc.m_step);
+    }
+    if ( sc.m_samples > 0.0 ){
+      fprintf(m_stdO,"%s %s %s%d %d %s%d %.0f %.4f %.4f",RES_M,
+              TransformName(sc.m_trn),step,sc.m_lev,sc.m_cmp,
+              SubbandName(sc.m_sub),sc.m_res,sc.m_samples,
+              sc.m_entropy/sc.m_samples,sc.m_huffman/sc.m_samples);
+      if ( lossy ){
+        fprintf(m_stdO," %.4f",sc.m_distortion/sc.m_samples);
+      }
+      fprintf(m_stdO,"\n");
+    }
+    smpln += sc.m_samples;
+    ent += sc.m_entropy;
+    huf += sc.m_huffman;
+    dst += sc.m_distortion;
+    if ( ((i+1) == eval.GetScoreN()) ||
+         (eval.GetScore(i+1).m_trn != sc.m_trn) ||
+         (eval.GetScore(i+1).m_step != sc.m_step) ||
+         (eval.GetScore(i+1).m_lev != sc.m_lev) ){
+      if ( smpln > 0.0 ){
+        fprintf(m_stdO,"%s %s %s%d total %.0f %.4f %.4f",RES_M,
+                TransformName(sc.m_trn),step,sc.m_lev,smpln,ent/smpln,
+                huf/smpln);
+        if ( lossy ){
+          fprintf(m_stdO," %.4f",dst/smpln);
+        }
+        fprintf(m_stdO,"\n");
+      }
+      smpln = ent = huf = dst = 0.0;
+    }
+  }
+  return ret;
+}
+
+SInt
+MiscTool::DoMainImgBitp(EnumFunctionDuty duty, SInt argc, const Char ** argv)
+{ 
+  // set up a ArgInfo struct
+  MiscArgInfo info(0);
+  info.singleName = "-bp";
+  info.doubleName = "--bitplane-code";
+  info.description = "embedded bitplane code all components to a rate";
+  info.descriptionLong = "code each component of all images, normally"
+    " spatially transformed, with the embedded bitplane coder, cut the"
+    " stream at the rate given in bits per sample (0 for lossless) and"
+    " replace the component with the decoded stream. The size of each"
+    " stream is printed.";
+  info.strDes = "rate";
+  info.strDef = "0";
+  info.flag = Att_FO|Att_DN;
+
+  // perform the minor duty's
+  if( duty != Dty_Perform ){
+    return DoMinorDuty(duty, info, argc, argv);
+  };
+  
+  // perform major duty
+  SInt ret = DoArgInfoRecognition(info, argc, argv);
+  if ( !CheckImgNum(0,1) ){
+    return Err_Other;
+  }
+  SFloat64 rate = atof(info.str[0]);
+  if ( rate < 0.0 ){
+    fprintf(m_stdE,"%s the rate can not be negative\n",ERR_M);
+    return Err_Other;
+  }
+
+  HeatWaveBitplaneCoder coder;
+  SFloat64 smpln = 0.0, bytes = 0.0;
+  for ( SInt i = 0 ; i < m_images.GetImageN() ; ++i ){
+    HeatWaveImage & img = m_images.GetImage(i);
+    for ( SInt c = 0 ; c < img.GetComponentN() ; ++c ){
+      HeatWaveComponent & cmp = img.GetComponent(c);
+      SInt budget = 0;
+      if ( rate > 0.0 ){
+        budget = (SInt)(rate*cmp.GetSize()/8.0);
+        if ( budget < HEATWAVEBITPLANEHEADER ){
+          budget = HEATWAVEBITPLANEHEADER;
+        }
+      }
+      SInt size = coder.DoEncode(cmp, budget);
+      if ( (size < 0) ||
+           !coder.DoDecode(coder.GetStream(), size, cmp) ){
+        fprintf(m_stdE,"%s unable to code image %d %s component\n",ERR_M,
+                i,ColorName(cmp.GetColor()));
+        return Err_Other;
+      }
+      fprintf(m_stdO,"%s image %d %s component %d bytes %.4f bits per"
+              " sample\n",RES_M,i,ColorName(cmp.GetColor()),size,
+              size*8.0/cmp.GetSize());
+      smpln += cmp.GetSize();
+      bytes += size;
+    }
+  }
+  if ( smpln > 0.0 ){
+    fprintf(m_stdO,"%s total %.0f bytes %.4f bits per sample\n",RES_M,
+            bytes,bytes*8.0/smpln);
+  }
+  return ret;
+}
+
+SInt
+MiscTool::DoMainImgQuan(EnumFunctionDuty duty, SInt argc, const Char ** argv)
+{ 
+  // set up a ArgInfo struct
+  enum{ arg_inv = 0, arg_total};
+  MiscArgInfo info(arg_total);
+  info.singleName = "-q";
+  info.doubleName = "--quantize";
+  info.description = "quantize the sub-bands of all components";
+  info.descriptionLong = "dead-zone quantize each sub-band of all"
+    " components in place, with the base step divided by the norm of the"
+    " sub-band for the transform and level the component is at. The"
+    " inverse puts the quantized samples back at the middle of their bins.";
+  info.strDes = "step";
+  info.strDef = "1";
+  info.flag = Att_FO|Att_DN;
+
+  info.subName[arg_inv] = "inverse";
+  info.subDesc[arg_inv] = "reconstruct quantized components";
+  info.subFlag[arg_inv] = Att_S;
+
+  // perform the minor duty's
+  if( duty != Dty_Perform ){
+    return DoMinorDuty(duty, info, argc, argv);
+  };
+  
+  // perform major duty
+  SInt ret = DoArgInfoRecognition(info, argc, argv);
+  if ( !CheckImgNum(0,1) ){
+    return Err_Other;
+  }
+  SFloat64 step = atof(info.str[0]);
+  if ( step < 1.0 ){
+    fprintf(m_stdE,"%s the step must be at least 1\n",ERR_M);
+    return Err_Other;
+  }
+  Bool fwd = True;
+  if ( info.subFlag[arg_inv] & Att_Set ){
+    fwd = False;
+  }
+
+  HeatWaveQuantizer qnt(step);
+  for ( SInt i = 0 ; i < m_images.GetImageN() ; ++i ){
+    HeatWaveImage & img = m_images.GetImage(i);
+    for ( SInt c = 0 ; c < img.GetComponentN() ; ++c ){
+      if ( fwd ){
+        qnt.DoQuantize(img.GetComponent(c));
+      }
+      else {
+        qnt.DoDequantize(img.GetComponent(c));
+      }
+    }
+  }
+  return ret;
+}
+
 SInt
 MiscTool::DoMainImgHiEq(EnumFunctionDuty duty, SInt argc, const Char ** argv)
 { 
@@ -7,6 +7,7 @@
  ****************************************************************************/
 
 #include "SimpleCompressor.hpp"
+#include "HeatWaveProfiler.hpp"
 
 SimpleCompressor::SimpleCompressor()
 {
@@ -36,6 +37,16 @@ SimpleCompressor::SetData(vector<int> & vec)
   m_data = vec;
 }
 
+void
+SimpleCompressor::SetData(const int * data, int width, int height, int pitch)
+{
+  m_data.clear();
+  m_data.reserve(width*height);
+  for ( int y = 0 ; y < height ; ++y ){
+    m_data.insert(m_data.end(), data + (y*pitch), data + (y*pitch) + width);
+  }
+}
+
 vector<int> &
 SimpleCompressor::GetData()
 {
@@ -57,6 +68,7 @@ SimpleCompressor::SetHuffman(SimpleHuffTable & table)
 void 
 SimpleCompressor::Externalise(ofstream & strm)
 {
+  HEATWAVEPROFILE(PrfHuffman, m_data.size(), m_data.size()*sizeof(int));
   int size = ExternSize();
   int vec_length = m_data.size();
 
@@ -148,6 +160,7 @@ SimpleCompressor::Internalise(ifstream & strm)
   int vec_size;
   strm.read((char*)&size,4);
   strm.read((char*)&vec_size,4);
+  HEATWAVEPROFILE(PrfHuffman, vec_size, size+((SInt64)vec_size*sizeof(int)));
   
   ASSERT (size > 8);
   
@@ -7,6 +7,7 @@
  *****************************************************************************/
 
 #include "SimpleHuffNode.hpp"
+#include "HeatWaveMemory.hpp"
 
 SimpleHuffNode::SimpleHuffNode()
 {
@@ -18,6 +19,7 @@ SimpleHuffNode::SimpleHuffNode()
   m_parent = NULL;
   m_bitset = false;
   m_sort_by_index = true;
+  HeatWaveMemory::AddBytes(MemHuffman, sizeof(SimpleHuffNode));
 }
 
 SimpleHuffNode::SimpleHuffNode(SInt index, SInt frequency, 
@@ -30,6 +32,7 @@ SimpleHuffNode::SimpleHuffNode(SInt index, SInt frequency,
   m_right = child_right;
   m_parent = parent;
   m_sort_by_index = sort_by_index;
+  HeatWaveMemory::AddBytes(MemHuffman, sizeof(SimpleHuffNode));
   
   if ( HasTwoChildren() )
     {
@@ -56,12 +59,14 @@ SimpleHuffNode::SimpleHuffNode(const SimpleHuffNode & rhs)
   m_parent = NULL;
   m_depth = 0;
   m_bitset = false;
+  HeatWaveMemory::AddBytes(MemHuffman, sizeof(SimpleHuffNode));
   
   Copy(rhs);
 }
   
 SimpleHuffNode::~SimpleHuffNode()
 {
+  HeatWaveMemory::SubBytes(MemHuffman, sizeof(SimpleHuffNode));
   delete m_right;
   m_right = NULL;
   delete m_left;
@@ -8,6 +8,7 @@
 
 #include "SimpleHuffTable.hpp"
 #include "MiscMathTool.hpp"
+#include "HeatWaveProfiler.hpp"
 
 SimpleHuffTable::SimpleHuffTable()
 {
@@ -242,6 +243,7 @@ SimpleHuffTable::BuildBinary()
     org_size = m_table.size();
     CopyTable();
   }
+  HEATWAVEPROFILE(PrfHuffman, org_size, org_size*sizeof(SimpleHuffNode));
   
   while ( m_temp.size() > 1) {
     m_tempIter = m_temp.begin();
@@ -0,0 +1,490 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveAVIReader.cpp
+ * @brief  A test fixture for the HeatWaveAVIReader class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ *
+ **/
+
+#include <TestHeatWaveAVIReader.hpp>
+#include <unistd.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestHeatWaveAVIReader);
+
+// local variables
+#define TEST_AVI_WIDTH 8
+#define TEST_AVI_HEIGHT 4
+#define TEST_AVI_FRAMES 6
+#define TEST_AVI_AHEAD 2
+#define TEST_AVI_WIDEWIDTH 36
+#define TEST_AVI_MAXBYTES (4*TEST_AVI_WIDEWIDTH*TEST_AVI_HEIGHT)
+#define TEST_AVI_LAYOUTFRAMES 2
+#define TEST_AVI_BGRWIDTH 5
+#define TEST_AVI_BGRHEIGHT 3
+
+// a reader that shows the state of its read ahead thread
+class Probe_Reader : public HeatWaveAVIReader
+{
+public:
+  Bool IsRunning() const { return m_running; }
+  SInt GetRingN() { return Locked(m_ringN, 0); }
+  SInt GetPoolN() { return Locked(m_pooln, 0); }
+  // the frame the ring hands out next
+  SInt GetInOrder() { return Locked(m_next, m_ringN); }
+private:
+  // the thread changes these under the lock
+  SInt Locked(const SInt & val, const SInt & sub)
+  {
+    LockMutex(&m_mutex);
+    SInt ret = val-sub;
+    UnlockMutex(&m_mutex);
+    return ret;
+  }
+};
+
+// the sample of a color at a place in a frame, the same for every layout
+Smpl
+Avi_Value(SInt c, SInt x, SInt y, SInt f)
+{
+  return (Smpl)(((c*60)+(x*7)+(y*13)+f) & 0xFF);
+}
+
+// the four characters as a little endian integer
+UInt
+Avi_FourCC(const char * str)
+{
+  UInt ret = 0;
+  for ( SInt i = FOUR_CC-1 ; i >= 0 ; --i ){
+    ret = (ret << 8) | (UInt8)str[i];
+  }
+  return ret;
+}
+
+// write a chunk header, or a list header when a type is given
+void
+Put_Avi_Header(FILE * fp, const char * name, UInt size,
+               const char * type = NULL)
+{
+  UInt len = size+(type ? FOUR_CC : 0);
+  fwrite(name, 1, FOUR_CC, fp);
+  fwrite(&len, sizeof(UInt), 1, fp);
+  if ( type ){
+    fwrite(type, 1, FOUR_CC, fp);
+  }
+}
+
+// write the smallest raw video the reader takes, the frames one after the
+// other in data, no index and no padding of the header
+Bool
+Write_Avi(const char * name, const char * handler, UInt comp, SInt bits,
+          SInt width, SInt height, const UInt8 * data, SInt len, SInt num)
+{
+  HeatWaveAVIHeader avih;
+  HeatWaveAVIStreamHeader strh;
+  HeatWaveAVIBitmapHeader strf;
+  memset((char*)&avih, 0, sizeof(avih));
+  memset((char*)&strh, 0, sizeof(strh));
+  memset((char*)&strf, 0, sizeof(strf));
+  avih.dwMicroSecPerFrame = 40000;
+  avih.dwTotalFrames = num;
+  avih.dwStreams = 1;
+  avih.dwWidth = width;
+  avih.dwHeight = (height < 0) ? -height : height;
+  memmove(strh.fccType, "vids", FOUR_CC);
+  memmove(strh.fccHandler, handler, FOUR_CC);
+  strh.dwScale = 1;
+  strh.dwRate = 25;
+  strh.dwLength = num;
+  strf.biSize = sizeof(strf);
+  strf.biWidth = width;
+  strf.biHeight = (UInt)height;
+  strf.biPlanes = 1;
+  strf.biBitCount = bits;
+  strf.biCompression = comp;
+  strf.biSizeImage = len;
+
+  UInt strl = (2*CHUNK_HEADER)+sizeof(strh)+sizeof(strf);
+  UInt hdrl = CHUNK_HEADER+sizeof(avih)+LIST_HEADER+strl;
+  UInt movi = num*(CHUNK_HEADER+len+(len & 1));
+  FILE * fp = fopen(name, "wb");
+  if ( fp == NULL ){
+    return False;
+  }
+  Put_Avi_Header(fp, "RIFF", (2*LIST_HEADER)+hdrl+movi, "AVI ");
+  Put_Avi_Header(fp, "LIST", hdrl, "hdrl");
+  Put_Avi_Header(fp, "avih", sizeof(avih));
+  fwrite(&avih, sizeof(avih), 1, fp);
+  Put_Avi_Header(fp, "LIST", strl, "strl");
+  Put_Avi_Header(fp, "strh", sizeof(strh));
+  fwrite(&strh, sizeof(strh), 1, fp);
+  Put_Avi_Header(fp, "strf", sizeof(strf));
+  fwrite(&strf, sizeof(strf), 1, fp);
+  Put_Avi_Header(fp, "LIST", movi, "movi");
+  for ( SInt f = 0 ; f < num ; ++f ){
+    Put_Avi_Header(fp, "00db", len);
+    fwrite(data+(f*len), 1, len, fp);
+    if ( len & 1 ){
+      fputc(0, fp);
+    }
+  }
+  return (fclose(fp) == 0);
+}
+
+// pack frame f in the layout of a four character code, "DIB " for rows of
+// BGR padded to 4 bytes, bottom up unless the height is negative
+SInt
+Pack_Frame(const char * fcc, SInt width, SInt height, SInt f, UInt8 * out)
+{
+  UInt8 * ptr = out;
+  if ( !strcmp(fcc, "DIB ") ){
+    Bool bottomUp = (height > 0);
+    height = bottomUp ? height : -height;
+    SInt pitch = ((3*width)+3) & ~3;
+    memset(out, 0, pitch*height);
+    for ( SInt y = 0 ; y < height ; ++y ){
+      UInt8 * row = out+((bottomUp ? (height-1-y) : y)*pitch);
+      for ( SInt x = 0 ; x < width ; ++x ){
+        for ( SInt c = 0 ; c < 3 ; ++c ){
+          row[(3*x)+2-c] = (UInt8)Avi_Value(c, x, y, f);
+        }
+      }
+    }
+    return pitch*height;
+  }
+  if ( !strcmp(fcc, "YUY2") || !strcmp(fcc, "UYVY") ){
+    // byte offsets of Y0 and U in each quad, Y1 and V follow by 2
+    SInt oy = strcmp(fcc, "YUY2") ? 1 : 0;
+    SInt ou = 1-oy;
+    for ( SInt y = 0 ; y < height ; ++y ){
+      for ( SInt x = 0 ; x < width/2 ; ++x , ptr += 4 ){
+        ptr[oy] = (UInt8)Avi_Value(0, 2*x, y, f);
+        ptr[oy+2] = (UInt8)Avi_Value(0, (2*x)+1, y, f);
+        ptr[ou] = (UInt8)Avi_Value(1, x, y, f);
+        ptr[ou+2] = (UInt8)Avi_Value(2, x, y, f);
+      }
+    }
+    return ptr-out;
+  }
+  for ( SInt y = 0 ; y < height ; ++y ){
+    for ( SInt x = 0 ; x < width ; ++x ){
+      *ptr++ = (UInt8)Avi_Value(0, x, y, f);
+    }
+  }
+  if ( !strcmp(fcc, "NV12") ){
+    // one plane of U and V pairs
+    for ( SInt y = 0 ; y < height/2 ; ++y ){
+      for ( SInt x = 0 ; x < width/2 ; ++x ){
+        *ptr++ = (UInt8)Avi_Value(1, x, y, f);
+        *ptr++ = (UInt8)Avi_Value(2, x, y, f);
+      }
+    }
+    return ptr-out;
+  }
+  // YV12, the V plane before the U plane
+  for ( SInt c = 2 ; c > 0 ; --c ){
+    for ( SInt y = 0 ; y < height/2 ; ++y ){
+      for ( SInt x = 0 ; x < width/2 ; ++x ){
+        *ptr++ = (UInt8)Avi_Value(c, x, y, f);
+      }
+    }
+  }
+  return ptr-out;
+}
+
+// write num frames in the layout of a four character code, as Pack_Frame()
+Bool
+Write_Video(const char * name, const char * fcc = "YV12",
+            SInt width = TEST_AVI_WIDTH, SInt height = TEST_AVI_HEIGHT,
+            SInt num = TEST_AVI_FRAMES)
+{
+  UInt8 data[TEST_AVI_FRAMES*TEST_AVI_MAXBYTES];
+  UInt8 * ptr = data;
+  for ( SInt f = 0 ; f < num ; ++f ){
+    ptr += Pack_Frame(fcc, width, height, f, ptr);
+  }
+  SInt len = (ptr-data)/num;
+  if ( !strcmp(fcc, "DIB ") ){
+    return Write_Avi(name, fcc, 0, 24, width, height, data, len, num);
+  }
+  SInt bits = (!strcmp(fcc, "YUY2") || !strcmp(fcc, "UYVY")) ? 16 : 12;
+  return Write_Avi(name, fcc, Avi_FourCC(fcc), bits, width, height, data,
+                   len, num);
+}
+
+// True if a frame holds the samples of frame f, for subsampling of the
+// chroma by hStep and vStep
+Bool
+Is_Frame(HeatWaveImage * img, SInt f, SInt hStep = 2, SInt vStep = 2,
+         SInt width = TEST_AVI_WIDTH, SInt height = TEST_AVI_HEIGHT)
+{
+  if ( (img == NULL) || (img->GetComponentN() != 3) ){
+    return False;
+  }
+  Bool check = True;
+  for ( SInt c = 0 ; c < 3 ; ++c ){
+    const HeatWaveComponent & cmp = img->GetComponent(c);
+    SInt w = width/(c ? hStep : 1);
+    SInt h = height/(c ? vStep : 1);
+    if ( (cmp.GetWidth() != w) || (cmp.GetHeight() != h) ){
+      return False;
+    }
+    for ( SInt y = 0 ; y < h ; ++y ){
+      for ( SInt x = 0 ; x < w ; ++x ){
+        check &= (cmp.GetSmpl(x, y) == Avi_Value(c, x, y, f));
+      }
+    }
+  }
+  return check;
+}
+
+// a new YUV frame of the size of the video with the chroma subsampled by
+// hStep and vStep
+HeatWaveImage *
+New_Frame(SInt hStep, SInt vStep)
+{
+  HeatWaveComponent ** cmp = new HeatWaveComponent*[3];
+  const EnumColor clr[3] = { ClrY, ClrU, ClrV };
+  for ( SInt c = 0 ; c < 3 ; ++c ){
+    SInt hs = c ? hStep : 1;
+    SInt vs = c ? vStep : 1;
+    cmp[c] = new HeatWaveComponent(0, 0, hs, vs, TEST_AVI_WIDTH/hs,
+                                   TEST_AVI_HEIGHT/vs, False, 8, clr[c]);
+  }
+  return new HeatWaveImage(0, 0, TEST_AVI_WIDTH, TEST_AVI_HEIGHT, SpcYUV, 3,
+                           cmp, True, False);
+}
+
+// True if two frames have the same samples
+Bool
+Same_Frame(HeatWaveImage * a, HeatWaveImage * b)
+{
+  if ( (a == NULL) || (b == NULL) ||
+       (a->GetComponentN() != b->GetComponentN()) ){
+    return False;
+  }
+  Bool check = True;
+  for ( SInt c = 0 ; c < a->GetComponentN() ; ++c ){
+    const HeatWaveComponent & ca = a->GetComponent(c);
+    const HeatWaveComponent & cb = b->GetComponent(c);
+    if ( (ca.GetWidth() != cb.GetWidth()) ||
+         (ca.GetHeight() != cb.GetHeight()) ){
+      return False;
+    }
+    for ( SInt y = 0 ; y < ca.GetHeight() ; ++y ){
+      for ( SInt x = 0 ; x < ca.GetWidth() ; ++x ){
+        check &= (ca.GetSmpl(x, y) == cb.GetSmpl(x, y));
+      }
+    }
+  }
+  return check;
+}
+
+// True if every frame of a video in the layout of a four character code
+// reads back, without and with the read ahead thread
+Bool
+Read_Video(const char * name, const char * fcc, EnumSpace spc,
+           SInt hStep, SInt vStep, SInt width = TEST_AVI_WIDTH,
+           SInt height = TEST_AVI_HEIGHT)
+{
+  Bool check = Write_Video(name, fcc, width, height, TEST_AVI_LAYOUTFRAMES);
+  SInt rows = (height < 0) ? -height : height;
+  for ( SInt ahead = 0 ; check && (ahead < 2) ; ++ahead ){
+    HeatWaveAVIReader rdr;
+    check &= rdr.OpenFile(name) && rdr.AnalyseFile();
+    check &= check && rdr.SetPrefetch(ahead);
+    for ( SInt f = 0 ; check && (f < TEST_AVI_LAYOUTFRAMES) ; ++f ){
+      HeatWaveImage * img = rdr.LoadFrame(f);
+      check &= Is_Frame(img, f, hStep, vStep, width, rows);
+      check &= (img != NULL) && (img->GetSpace() == spc);
+      rdr.DoRecycle(img);
+    }
+    rdr.CloseFile();
+  }
+  return check;
+}
+
+void
+TestHeatWaveAVIReader::setUp(void)
+{
+  strcpy(file, "TestHeatWaveAVIReader.XXXXXX");
+  SInt fd = mkstemp(file);
+  CPPUNIT_ASSERT (fd >= 0);
+  close(fd);
+}
+
+void
+TestHeatWaveAVIReader::tearDown(void)
+{
+  remove(file);
+}
+
+void
+TestHeatWaveAVIReader::PrefetchInOrder(void)
+{
+  CPPUNIT_ASSERT (Write_Video(file));
+  HeatWaveAVIReader plain;
+  Probe_Reader ahead;
+  CPPUNIT_ASSERT (plain.OpenFile(file) && plain.AnalyseFile());
+  CPPUNIT_ASSERT (ahead.OpenFile(file) && ahead.AnalyseFile());
+  CPPUNIT_ASSERT (ahead.SetPrefetch(TEST_AVI_AHEAD));
+  CPPUNIT_ASSERT (ahead.IsRunning());
+  for ( SInt f = 0 ; f < TEST_AVI_FRAMES ; ++f ){
+    HeatWaveImage * a = plain.LoadFrame(f);
+    HeatWaveImage * b = ahead.LoadFrame(f);
+    CPPUNIT_ASSERT (Is_Frame(a, f));
+    CPPUNIT_ASSERT (Same_Frame(a, b));
+    // in order the thread keeps going
+    CPPUNIT_ASSERT (ahead.IsRunning());
+    CPPUNIT_ASSERT_EQUAL (f+1, ahead.GetInOrder());
+    delete a;
+    ahead.DoRecycle(b);
+  }
+  CPPUNIT_ASSERT (plain.CloseFile());
+  CPPUNIT_ASSERT (ahead.CloseFile());
+  CPPUNIT_ASSERT (!ahead.IsRunning());
+}
+
+void
+TestHeatWaveAVIReader::PrefetchSeek(void)
+{
+  CPPUNIT_ASSERT (Write_Video(file));
+  Probe_Reader rdr;
+  CPPUNIT_ASSERT (rdr.OpenFile(file) && rdr.AnalyseFile());
+  CPPUNIT_ASSERT (rdr.SetPrefetch(TEST_AVI_AHEAD));
+  HeatWaveImage * img = rdr.LoadFrame(0);
+  CPPUNIT_ASSERT (Is_Frame(img, 0));
+  rdr.DoRecycle(img);
+
+  // forward past the ring, back, and forward again, each restarts the
+  // thread after the frame asked for
+  const SInt seek[] = { 4, 1, 3, 2 };
+  for ( SInt i = 0 ; i < (SInt)(sizeof(seek)/sizeof(SInt)) ; ++i ){
+    img = rdr.LoadFrame(seek[i]);
+    CPPUNIT_ASSERT (Is_Frame(img, seek[i]));
+    CPPUNIT_ASSERT (rdr.IsRunning());
+    CPPUNIT_ASSERT_EQUAL (seek[i]+1, rdr.GetInOrder());
+    rdr.DoRecycle(img);
+  }
+  // then in order from the last seek to the end
+  for ( SInt f = 3 ; f < TEST_AVI_FRAMES ; ++f ){
+    img = rdr.LoadFrame(f);
+    CPPUNIT_ASSERT (Is_Frame(img, f));
+    rdr.DoRecycle(img);
+  }
+  CPPUNIT_ASSERT (rdr.LoadFrame(TEST_AVI_FRAMES) == NULL);
+
+  // the frames on the ring go back to the pool on stopping
+  img = rdr.LoadFrame(0);
+  CPPUNIT_ASSERT (Is_Frame(img, 0));
+  delete img;
+  CPPUNIT_ASSERT (rdr.SetPrefetch(0));
+  CPPUNIT_ASSERT (!rdr.IsRunning());
+  CPPUNIT_ASSERT_EQUAL (0, rdr.GetRingN());
+  img = rdr.LoadFrame(1);
+  CPPUNIT_ASSERT (Is_Frame(img, 1));
+  CPPUNIT_ASSERT (!rdr.IsRunning());
+  delete img;
+  CPPUNIT_ASSERT (rdr.CloseFile());
+}
+
+void
+TestHeatWaveAVIReader::RecycleOtherLayout(void)
+{
+  CPPUNIT_ASSERT (Write_Video(file));
+  Probe_Reader rdr;
+  CPPUNIT_ASSERT (rdr.OpenFile(file) && rdr.AnalyseFile());
+
+  // frames not laid out as the video are deleted, not pooled
+  rdr.DoRecycle(new HeatWaveImage(0, 0, TEST_AVI_WIDTH, TEST_AVI_HEIGHT,
+                                  SpcGrey, 1));
+  CPPUNIT_ASSERT_EQUAL (0, rdr.GetPoolN());
+  rdr.DoRecycle(New_Frame(2, 1));
+  CPPUNIT_ASSERT_EQUAL (0, rdr.GetPoolN());
+  rdr.DoRecycle(New_Frame(1, 1));
+  CPPUNIT_ASSERT_EQUAL (0, rdr.GetPoolN());
+  HeatWaveImage * img = rdr.LoadFrame(0);
+  CPPUNIT_ASSERT (Is_Frame(img, 0));
+
+  // a transformed and packed frame is taken back and read into as new
+  img->DoPyramidTransform(Trn9m7, 2);
+  img->DoPack();
+  rdr.DoRecycle(img);
+  CPPUNIT_ASSERT_EQUAL (1, rdr.GetPoolN());
+  HeatWaveImage * again = rdr.LoadFrame(1);
+  CPPUNIT_ASSERT (again == img);
+  CPPUNIT_ASSERT_EQUAL (0, rdr.GetPoolN());
+  CPPUNIT_ASSERT (Is_Frame(again, 1));
+  CPPUNIT_ASSERT_EQUAL ((SInt)0, again->GetComponent(0).GetTransformLevel());
+  CPPUNIT_ASSERT (!again->GetComponent(0).IsPacked());
+
+  // and the same with the thread reading into the pooled frames
+  CPPUNIT_ASSERT (rdr.SetPrefetch(TEST_AVI_AHEAD));
+  for ( SInt f = 2 ; f < TEST_AVI_FRAMES ; ++f ){
+    again->DoPyramidTransform(Trn9m7, 1);
+    rdr.DoRecycle(again);
+    again = rdr.LoadFrame(f);
+    CPPUNIT_ASSERT (Is_Frame(again, f));
+  }
+  delete again;
+  CPPUNIT_ASSERT (rdr.CloseFile());
+}
+
+void
+TestHeatWaveAVIReader::LayoutYV12(void)
+{
+  CPPUNIT_ASSERT (Read_Video(file, "YV12", SpcYUV, 2, 2));
+}
+
+void
+TestHeatWaveAVIReader::LayoutNV12(void)
+{
+  CPPUNIT_ASSERT (Read_Video(file, "NV12", SpcYUV, 2, 2));
+}
+
+void
+TestHeatWaveAVIReader::LayoutYUYV(void)
+{
+  CPPUNIT_ASSERT (Read_Video(file, "YUY2", SpcYUV, 2, 1));
+  CPPUNIT_ASSERT (Read_Video(file, "UYVY", SpcYUV, 2, 1));
+}
+
+void
+TestHeatWaveAVIReader::LayoutWide(void)
+{
+  // wide enough for the vector rows and a scalar tail
+  CPPUNIT_ASSERT (Read_Video(file, "YV12", SpcYUV, 2, 2, TEST_AVI_WIDEWIDTH));
+  CPPUNIT_ASSERT (Read_Video(file, "NV12", SpcYUV, 2, 2, TEST_AVI_WIDEWIDTH));
+  CPPUNIT_ASSERT (Read_Video(file, "YUY2", SpcYUV, 2, 1, TEST_AVI_WIDEWIDTH));
+  CPPUNIT_ASSERT (Read_Video(file, "UYVY", SpcYUV, 2, 1, TEST_AVI_WIDEWIDTH));
+}
+
+void
+TestHeatWaveAVIReader::LayoutBGR(void)
+{
+  // an odd width pads the rows
+  CPPUNIT_ASSERT (Read_Video(file, "DIB ", SpcRGB, 1, 1,
+                             TEST_AVI_BGRWIDTH, TEST_AVI_BGRHEIGHT));
+  CPPUNIT_ASSERT (Read_Video(file, "DIB ", SpcRGB, 1, 1,
+                             TEST_AVI_BGRWIDTH, -TEST_AVI_BGRHEIGHT));
+}
+
+void
+TestHeatWaveAVIReader::LoadPacked(void)
+{
+  CPPUNIT_ASSERT (Write_Video(file));
+  HeatWaveAVIReader rdr;
+  CPPUNIT_ASSERT (rdr.OpenFile(file) && rdr.AnalyseFile());
+  HeatWaveVideo * video = rdr.LoadVideo(True);
+  CPPUNIT_ASSERT (video != NULL);
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_AVI_FRAMES, video->GetImageN());
+  for ( SInt f = 0 ; f < TEST_AVI_FRAMES ; ++f ){
+    HeatWaveImage & img = video->GetImage(f);
+    for ( SInt c = 0 ; c < 3 ; ++c ){
+      CPPUNIT_ASSERT (img.GetComponent(c).IsPacked());
+    }
+    CPPUNIT_ASSERT (Is_Frame(&img, f));
+  }
+  delete video;
+  CPPUNIT_ASSERT (rdr.CloseFile());
+}
@@ -0,0 +1,167 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveAVIWriter.cpp
+ * @brief  A test fixture for the HeatWaveAVIWriter class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ *
+ **/
+
+#include <TestHeatWaveAVIWriter.hpp>
+#include <unistd.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestHeatWaveAVIWriter);
+
+// local variables
+#define TEST_AVIW_WIDTH 10
+#define TEST_AVIW_HEIGHT 6
+#define TEST_AVIW_FRAMES 5
+#define TEST_AVIW_ROOM 100
+
+// a writer that can be moved close to the size limit
+class Probe_Writer : public HeatWaveAVIWriter
+{
+public:
+  SInt GetPos() const { return m_pos; }
+  void SetPos(SInt pos) { m_pos = pos; }
+};
+
+// the sample of a color at a place in a frame
+Smpl
+Aviw_Value(SInt c, SInt x, SInt y, SInt f)
+{
+  return (Smpl)(((c*50)+(x*11)+(y*17)+(f*29)) & 0xFF);
+}
+
+// frame f in YUV with the chroma subsampled by 2, as IYUV, or in grey
+HeatWaveImage *
+New_AviwFrame(SInt f, Bool grey)
+{
+  SInt num = grey ? 1 : 3;
+  HeatWaveComponent ** cmp = new HeatWaveComponent*[num];
+  const EnumColor clr[3] = { ClrY, ClrU, ClrV };
+  for ( SInt c = 0 ; c < num ; ++c ){
+    SInt s = c ? 2 : 1;
+    SInt w = TEST_AVIW_WIDTH/s;
+    SInt h = TEST_AVIW_HEIGHT/s;
+    cmp[c] = new HeatWaveComponent(0, 0, s, s, w, h, False, 8, clr[c]);
+    for ( SInt y = 0 ; y < h ; ++y ){
+      for ( SInt x = 0 ; x < w ; ++x ){
+        cmp[c]->SetSmpl(x, y, Aviw_Value(c, x, y, f));
+      }
+    }
+  }
+  return new HeatWaveImage(0, 0, TEST_AVIW_WIDTH, TEST_AVIW_HEIGHT,
+                           grey ? SpcGrey : SpcYUV, num, cmp, True, False);
+}
+
+// True if a frame read back holds the samples of frame f
+Bool
+Is_AviwFrame(HeatWaveImage * img, SInt f, Bool grey)
+{
+  SInt num = grey ? 1 : 3;
+  if ( (img == NULL) || (img->GetComponentN() != num) ){
+    return False;
+  }
+  Bool check = True;
+  for ( SInt c = 0 ; c < num ; ++c ){
+    const HeatWaveComponent & cmp = img->GetComponent(c);
+    SInt s = c ? 2 : 1;
+    if ( (cmp.GetWidth() != TEST_AVIW_WIDTH/s) ||
+         (cmp.GetHeight() != TEST_AVIW_HEIGHT/s) ){
+      return False;
+    }
+    for ( SInt y = 0 ; y < cmp.GetHeight() ; ++y ){
+      for ( SInt x = 0 ; x < cmp.GetWidth() ; ++x ){
+        check &= (cmp.GetSmpl(x, y) == Aviw_Value(c, x, y, f));
+      }
+    }
+  }
+  return check;
+}
+
+// True if frames written with the writer read back the same with the reader
+Bool
+Check_RoundTrip(const char * name, Bool grey)
+{
+  HeatWaveAVIWriter wrt;
+  Bool check = wrt.OpenFile(name, grey ? VidGREY : VidIYUV, TEST_AVIW_WIDTH,
+                            TEST_AVIW_HEIGHT);
+  for ( SInt f = 0 ; check && (f < TEST_AVIW_FRAMES) ; ++f ){
+    HeatWaveImage * img = New_AviwFrame(f, grey);
+    check &= wrt.AddFrame(*img);
+    delete img;
+  }
+  check &= (wrt.GetFrameN() == TEST_AVIW_FRAMES);
+  check &= wrt.CloseFile();
+
+  HeatWaveAVIReader rdr;
+  check &= check && rdr.OpenFile(name) && rdr.AnalyseFile();
+  check &= check && 
+    (rdr.GetVideoHeader()->dwLength == (UInt)TEST_AVIW_FRAMES);
+  for ( SInt f = 0 ; check && (f < TEST_AVIW_FRAMES) ; ++f ){
+    HeatWaveImage * img = rdr.LoadFrame(f);
+    check &= Is_AviwFrame(img, f, grey);
+    delete img;
+  }
+  rdr.CloseFile();
+  return check;
+}
+
+void
+TestHeatWaveAVIWriter::setUp(void)
+{
+  strcpy(file, "TestHeatWaveAVIWriter.XXXXXX");
+  SInt fd = mkstemp(file);
+  CPPUNIT_ASSERT (fd >= 0);
+  close(fd);
+}
+
+void
+TestHeatWaveAVIWriter::tearDown(void)
+{
+  remove(file);
+}
+
+void
+TestHeatWaveAVIWriter::RoundTripIYUV(void)
+{
+  CPPUNIT_ASSERT (Check_RoundTrip(file, False));
+}
+
+void
+TestHeatWaveAVIWriter::RoundTripGrey(void)
+{
+  CPPUNIT_ASSERT (Check_RoundTrip(file, True));
+}
+
+void
+TestHeatWaveAVIWriter::SizeLimit(void)
+{
+  Probe_Writer wrt;
+  HeatWaveImage * img = New_AviwFrame(0, False);
+  CPPUNIT_ASSERT (wrt.OpenFile(file, VidIYUV, TEST_AVIW_WIDTH,
+                               TEST_AVIW_HEIGHT));
+  CPPUNIT_ASSERT (wrt.AddFrame(*img));
+
+  // just short of the limit the frame is refused, the file stays usable
+  SInt pos = wrt.GetPos();
+  wrt.SetPos(HEATWAVEAVIMAXSIZE-TEST_AVIW_ROOM);
+  CPPUNIT_ASSERT (!wrt.AddFrame(*img));
+  CPPUNIT_ASSERT (!strcmp(wrt.GetError(),
+                          "file would exceed the AVI 1.0 size limit"));
+  wrt.SetPos(pos);
+  CPPUNIT_ASSERT (wrt.AddFrame(*img));
+  CPPUNIT_ASSERT_EQUAL ((SInt)2, wrt.GetFrameN());
+  CPPUNIT_ASSERT (wrt.CloseFile());
+  delete img;
+
+  HeatWaveAVIReader rdr;
+  CPPUNIT_ASSERT (rdr.OpenFile(file) && rdr.AnalyseFile());
+  for ( SInt f = 0 ; f < 2 ; ++f ){
+    HeatWaveImage * back = rdr.LoadFrame(f);
+    CPPUNIT_ASSERT (Is_AviwFrame(back, 0, False));
+    delete back;
+  }
+  CPPUNIT_ASSERT (rdr.CloseFile());
+}
@@ -0,0 +1,155 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveBitplaneCoder.cpp
+ * @brief  A test fixture for the HeatWaveBitplaneCoder class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#include <TestHeatWaveBitplaneCoder.hpp>
+#include <math.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestHeatWaveBitplaneCoder);
+
+// local variables, a top left corner away from 0 to catch coordinate mixups
+#define TEST_BPC_TLX 3
+#define TEST_BPC_TLY 5
+
+// the mean squared difference of two components of the same geometry
+SFloat64
+Get_MSE(const HeatWaveComponent & a, const HeatWaveComponent & b)
+{
+  SFloat64 sum = 0.0;
+  for ( SInt y = a.GetTLY() ; y < a.GetTLY()+a.GetHeight() ; ++y ){
+    for ( SInt x = a.GetTLX() ; x < a.GetTLX()+a.GetWidth() ; ++x ){
+      SFloat64 dif = (SFloat64)a.GetSmpl(x, y)-(SFloat64)b.GetSmpl(x, y);
+      sum += dif*dif;
+    }
+  }
+  return sum/(a.GetWidth()*a.GetHeight());
+}
+
+void
+TestHeatWaveBitplaneCoder::setUp(void)
+{
+}
+
+void
+TestHeatWaveBitplaneCoder::tearDown(void)
+{
+}
+
+HeatWaveComponent *
+TestHeatWaveBitplaneCoder::GetComponent(SInt width, SInt height, SInt lev,
+                                        SInt twd, SInt thg)
+{
+  HeatWaveComponent * cmp = new HeatWaveComponent(TEST_BPC_TLX, TEST_BPC_TLY,
+                                                  1, 1, width, height, True,
+                                                  10, ClrY);
+  for ( SInt y = 0 ; y < height ; ++y ){
+    for ( SInt x = 0 ; x < width ; ++x ){
+      Smpl val = (Smpl)((((x*31)+(y*17)+(x*y/3)) % 256) +
+                        (SInt)(40*sin(x*0.1)*cos(y*0.07)));
+      cmp->SetSmpl(x+TEST_BPC_TLX, y+TEST_BPC_TLY, val);
+    }
+  }
+  if ( twd > 0 ){
+    cmp->SetTiling(twd, thg);
+  }
+  cmp->DoPyramidTransform(Trn9m7, lev);
+  return cmp;
+}
+
+void
+TestHeatWaveBitplaneCoder::DoRoundTrip(HeatWaveComponent & cmp)
+{
+  HeatWaveBitplaneCoder coder;
+  SInt size = coder.DoEncode(cmp);
+  CPPUNIT_ASSERT (size >= HEATWAVEBITPLANEHEADER);
+  CPPUNIT_ASSERT_EQUAL (size, coder.GetStreamSize());
+  HeatWaveComponent dec(TEST_BPC_TLX, TEST_BPC_TLY, 1, 1, cmp.GetWidth(),
+                        cmp.GetHeight(), True, 10, ClrY);
+  if ( cmp.GetTileWidth() > 0 ){
+    dec.SetTiling(cmp.GetTileWidth(), cmp.GetTileHeight());
+  }
+  CPPUNIT_ASSERT (coder.DoDecode(coder.GetStream(), size, dec));
+  CPPUNIT_ASSERT_EQUAL (cmp.GetTransformLevel(), dec.GetTransformLevel());
+  CPPUNIT_ASSERT_EQUAL (cmp.GetTransformType(), dec.GetTransformType());
+  CPPUNIT_ASSERT_EQUAL (0.0, Get_MSE(cmp, dec));
+}
+
+void
+TestHeatWaveBitplaneCoder::LosslessOdd(void)
+{
+  const SInt sizes[][2] = {{67, 45}, {3, 2}, {1, 1}, {129, 97}};
+  const SInt levs[] = {0, 1, 3, 9};
+  for ( SInt s = 0 ; s < 4 ; ++s ){
+    for ( SInt l = 0 ; l < 4 ; ++l ){
+      HeatWaveComponent * cmp = GetComponent(sizes[s][0], sizes[s][1], 
+                                             levs[l]);
+      DoRoundTrip(*cmp);
+      delete cmp;
+    }
+  }
+}
+
+void
+TestHeatWaveBitplaneCoder::LosslessTiled(void)
+{
+  const SInt levs[] = {0, 2, 5};
+  for ( SInt l = 0 ; l < 3 ; ++l ){
+    HeatWaveComponent * cmp = GetComponent(100, 33, levs[l], 16, 16);
+    DoRoundTrip(*cmp);
+    delete cmp;
+    cmp = GetComponent(129, 97, levs[l], 32, 20);
+    DoRoundTrip(*cmp);
+    delete cmp;
+  }
+}
+
+void
+TestHeatWaveBitplaneCoder::BudgetIsPrefix(void)
+{
+  HeatWaveComponent * cmp = GetComponent(67, 45, 3, 32, 32);
+  HeatWaveBitplaneCoder full;
+  SInt size = full.DoEncode(*cmp);
+  HeatWaveBitplaneCoder cut;
+  CPPUNIT_ASSERT_EQUAL ((SInt)-1, cut.DoEncode(*cmp, 
+                                               HEATWAVEBITPLANEHEADER-1));
+  for ( SInt budget = HEATWAVEBITPLANEHEADER ; budget <= size+1 ;
+        budget += 37 ){
+    SInt part = cut.DoEncode(*cmp, budget);
+    CPPUNIT_ASSERT (part <= budget);
+    CPPUNIT_ASSERT (part <= size);
+    CPPUNIT_ASSERT (memcmp(cut.GetStream(), full.GetStream(), part) == 0);
+  }
+  delete cmp;
+}
+
+void
+TestHeatWaveBitplaneCoder::ErrorFallsWithBudget(void)
+{
+  HeatWaveComponent * cmp = GetComponent(128, 96, 4);
+  HeatWaveBitplaneCoder coder;
+  SInt size = coder.DoEncode(*cmp);
+  HeatWaveComponent dec(*cmp);
+  SFloat64 last = -1.0;
+  // the budgets double, from the header to the whole stream
+  for ( SInt budget = HEATWAVEBITPLANEHEADER+1 ; ; budget *= 2 ){
+    if ( budget > size ){
+      budget = size;
+    }
+    CPPUNIT_ASSERT (coder.DoDecode(coder.GetStream(), budget, dec));
+    SFloat64 mse = Get_MSE(*cmp, dec);
+    if ( last >= 0.0 ){
+      CPPUNIT_ASSERT (mse <= last);
+    }
+    last = mse;
+    if ( budget == size ){
+      break;
+    }
+  }
+  CPPUNIT_ASSERT_EQUAL (0.0, last);
+  delete cmp;
+}
@@ -0,0 +1,169 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveCache.cpp
+ * @brief  A test fixture for the HeatWaveCache class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#include <TestHeatWaveCache.hpp>
+#include <dirent.h>
+#include <unistd.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestHeatWaveCache);
+
+// local variables
+#define TEST_CACHE_WIDTH 23
+#define TEST_CACHE_HEIGHT 17
+#define TEST_CACHE_LEVEL 3
+
+// True if two components have the same samples and transform state
+Bool
+Same_Result(const HeatWaveComponent & a, const HeatWaveComponent & b)
+{
+  Bool check = True;
+  check &= (a.GetTransformLevel() == b.GetTransformLevel());
+  check &= (a.GetTransformType() == b.GetTransformType());
+  for ( SInt y = 0 ; y < TEST_CACHE_HEIGHT ; ++y ){
+    for ( SInt x = 0 ; x < TEST_CACHE_WIDTH ; ++x ){
+      check &= (a.GetSmpl(x, y) == b.GetSmpl(x, y));
+    }
+  }
+  return check;
+}
+
+void
+TestHeatWaveCache::setUp(void)
+{
+  strcpy(dir, "TestHeatWaveCache.XXXXXX");
+  CPPUNIT_ASSERT (mkdtemp(dir) != NULL);
+  cmpA = new HeatWaveComponent(0, 0, 1, 1, TEST_CACHE_WIDTH, 
+                               TEST_CACHE_HEIGHT, False, 8, ClrY);
+  for ( SInt y = 0 ; y < TEST_CACHE_HEIGHT ; ++y ){
+    for ( SInt x = 0 ; x < TEST_CACHE_WIDTH ; ++x ){
+      cmpA->SetSmpl(x, y, (Smpl)(((x*x)+(y*11)) & 0xFF));
+    }
+  }
+  // the expected result
+  cmpT = new HeatWaveComponent(*cmpA);
+  cmpT->DoPyramidTransform(Trn9m7, TEST_CACHE_LEVEL);
+}
+
+void
+TestHeatWaveCache::tearDown(void)
+{
+  delete cmpA;
+  delete cmpT;
+  DIR * dd = opendir(dir);
+  if ( dd != NULL ){
+    struct dirent * ent = NULL;
+    Char name[512];
+    while ( (ent = readdir(dd)) != NULL ){
+      if ( ent->d_name[0] != '.' ){
+        sprintf(name, "%s/%s", dir, ent->d_name);
+        remove(name);
+      }
+    }
+    closedir(dd);
+  }
+  rmdir(dir);
+}
+
+Char *
+TestHeatWaveCache::GetResultFile()
+{
+  Char * ret = NULL;
+  SInt num = 0;
+  DIR * dd = opendir(dir);
+  struct dirent * ent = NULL;
+  while ( (dd != NULL) && ((ent = readdir(dd)) != NULL) ){
+    if ( ent->d_name[0] != '.' ){
+      delete [] ret;
+      ret = new Char[strlen(dir)+strlen(ent->d_name)+2];
+      sprintf(ret, "%s/%s", dir, ent->d_name);
+      ++num;
+    }
+  }
+  if ( dd != NULL ){
+    closedir(dd);
+  }
+  if ( num != 1 ){
+    delete [] ret;
+    ret = NULL;
+  }
+  return ret;
+}
+
+void
+TestHeatWaveCache::MissThenHit(void)
+{
+  HeatWaveComponent cmpB(*cmpA);
+  HeatWaveCache cache(dir);
+  cache.DoPyramidTransform(cmpB, Trn9m7, TEST_CACHE_LEVEL);
+  CPPUNIT_ASSERT_EQUAL ((SInt)0, cache.GetHits());
+  CPPUNIT_ASSERT_EQUAL ((SInt)1, cache.GetMisses());
+  CPPUNIT_ASSERT (Same_Result(cmpB, *cmpT));
+
+  // another cache on the directory finds the result
+  HeatWaveComponent cmpC(*cmpA);
+  HeatWaveCache other(dir);
+  other.DoPyramidTransform(cmpC, Trn9m7, TEST_CACHE_LEVEL);
+  CPPUNIT_ASSERT_EQUAL ((SInt)1, other.GetHits());
+  CPPUNIT_ASSERT_EQUAL ((SInt)0, other.GetMisses());
+  CPPUNIT_ASSERT (Same_Result(cmpC, *cmpT));
+}
+
+void
+TestHeatWaveCache::OtherInputMisses(void)
+{
+  HeatWaveCache cache(dir);
+  HeatWaveComponent cmpB(*cmpA);
+  cache.DoPyramidTransform(cmpB, Trn9m7, TEST_CACHE_LEVEL);
+
+  // one sample, the transform or the level changed
+  HeatWaveComponent cmpC(*cmpA);
+  cmpC.SetSmpl(5, 5, cmpC.GetSmpl(5, 5)+1);
+  cache.DoPyramidTransform(cmpC, Trn9m7, TEST_CACHE_LEVEL);
+  HeatWaveComponent cmpD(*cmpA);
+  cache.DoPyramidTransform(cmpD, Trn2_2, TEST_CACHE_LEVEL);
+  HeatWaveComponent cmpE(*cmpA);
+  cache.DoPyramidTransform(cmpE, Trn9m7, TEST_CACHE_LEVEL-1);
+  CPPUNIT_ASSERT_EQUAL ((SInt)0, cache.GetHits());
+  CPPUNIT_ASSERT_EQUAL ((SInt)4, cache.GetMisses());
+  CPPUNIT_ASSERT_EQUAL (TEST_CACHE_LEVEL-1, cmpE.GetTransformLevel());
+}
+
+void
+TestHeatWaveCache::TruncatedFileMisses(void)
+{
+  HeatWaveCache cache(dir);
+  HeatWaveComponent cmpB(*cmpA);
+  cache.DoPyramidTransform(cmpB, Trn9m7, TEST_CACHE_LEVEL);
+  Char * name = GetResultFile();
+  CPPUNIT_ASSERT (name != NULL);
+
+  // cut the file short, as a full disk or a killed process would
+  FILE * file = fopen(name, "rb");
+  CPPUNIT_ASSERT (file != NULL);
+  UInt8 buf[4096];
+  size_t size = fread(buf, 1, sizeof(buf), file);
+  fclose(file);
+  CPPUNIT_ASSERT (size > 64);
+  file = fopen(name, "wb");
+  CPPUNIT_ASSERT (file != NULL);
+  fwrite(buf, 1, size-7, file);
+  fclose(file);
+  delete [] name;
+
+  // a miss, transformed and filed again
+  HeatWaveComponent cmpC(*cmpA);
+  cache.DoPyramidTransform(cmpC, Trn9m7, TEST_CACHE_LEVEL);
+  CPPUNIT_ASSERT_EQUAL ((SInt)0, cache.GetHits());
+  CPPUNIT_ASSERT_EQUAL ((SInt)2, cache.GetMisses());
+  CPPUNIT_ASSERT (Same_Result(cmpC, *cmpT));
+  HeatWaveComponent cmpD(*cmpA);
+  cache.DoPyramidTransform(cmpD, Trn9m7, TEST_CACHE_LEVEL);
+  CPPUNIT_ASSERT_EQUAL ((SInt)1, cache.GetHits());
+  CPPUNIT_ASSERT (Same_Result(cmpD, *cmpT));
+}
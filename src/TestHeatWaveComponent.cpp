@@ -0,0 +1,465 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveComponent.cpp
+ * @brief  A test fixture for the HeatWaveComponent class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#include <TestHeatWaveComponent.hpp>
+#include <HeatWaveMemory.hpp>
+#include <HeatWaveWorkerPool.hpp>
+#include <HeatWaveImage.hpp>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestHeatWaveComponent);
+
+// local variables
+#define TEST_CMP_TLX 2
+#define TEST_CMP_TLY 1
+#define TEST_CMP_WIDTH 13
+#define TEST_CMP_HEIGHT 7
+#define TEST_TILE_WIDTH 61
+#define TEST_TILE_HEIGHT 45
+#define TEST_TILE_SIZE 16
+#define TEST_TILE_LEVELS 3
+#define TEST_TILE_THREADS 4
+#define TEST_TILE_JOBS 6
+#define TEST_ROI_TLX 5
+#define TEST_ROI_TLY 3
+#define TEST_ROI_WIDTH 97
+#define TEST_ROI_HEIGHT 83
+#define TEST_ROI_LEVELS 4
+#define TEST_ROI_AREAS 6
+
+// the sample expected at a position, with a offset to tell copies apart
+Smpl
+Test_Smpl(SInt x, SInt y, Smpl off = 0)
+{
+  return (Smpl)((x*7)-(y*5)+off);
+}
+
+// True if all samples of a component are Test_Smpl(x,y,off)
+Bool
+Check_Smpls(const HeatWaveComponent & cmp, Smpl off = 0)
+{
+  Bool check = True;
+  for ( SInt y = cmp.GetTLY() ; y < cmp.GetTLY()+cmp.GetHeight() ; ++y ){
+    for ( SInt x = cmp.GetTLX() ; x < cmp.GetTLX()+cmp.GetWidth() ; ++x ){
+      check &= (cmp.GetSmpl(x, y) == Test_Smpl(x, y, off));
+    }
+  }
+  return check;
+}
+
+// a hashed 8-bit pattern, a smooth one leaves the high passes empty
+Smpl
+Test_Noise(SInt x, SInt y)
+{
+  return (Smpl)((((UInt32)((y*131)+x))*2654435761U) >> 24);
+}
+
+// a component of Test_Noise samples, tiled on a pool
+HeatWaveComponent *
+New_Tiled(HeatWaveWorkerPool * pool)
+{
+  HeatWaveComponent * cmp = new HeatWaveComponent(0, 0, 1, 1, 
+                                                  TEST_TILE_WIDTH, 
+                                                  TEST_TILE_HEIGHT, False, 
+                                                  8, ClrY);
+  for ( SInt y = 0 ; y < TEST_TILE_HEIGHT ; ++y ){
+    for ( SInt x = 0 ; x < TEST_TILE_WIDTH ; ++x ){
+      cmp->SetSmpl(x, y, Test_Noise(x, y));
+    }
+  }
+  cmp->SetTiling(TEST_TILE_SIZE, TEST_TILE_SIZE, pool);
+  return cmp;
+}
+
+// True if each tile holds what transforming it on its own gives
+Bool
+Check_Tiles(const HeatWaveComponent & cmp, EnumTransform trn, SInt lev)
+{
+  Bool check = True;
+  for ( SInt t = 0 ; t < cmp.GetTileCount() ; ++t ){
+    SInt tlx, tly, wid, hei;
+    check &= cmp.GetTileInfo(t, tlx, tly, wid, hei);
+    HeatWaveComponent one(0, 0, 1, 1, wid, hei, False, 8, ClrY);
+    for ( SInt y = 0 ; y < hei ; ++y ){
+      for ( SInt x = 0 ; x < wid ; ++x ){
+        one.SetSmpl(x, y, Test_Noise(tlx+x, tly+y));
+      }
+    }
+    one.DoPyramidTransform(trn, lev);
+    for ( SInt y = 0 ; y < hei ; ++y ){
+      for ( SInt x = 0 ; x < wid ; ++x ){
+        check &= (one.GetSmpl(x, y) == cmp.GetSmpl(tlx+x, tly+y));
+      }
+    }
+  }
+  return check;
+}
+
+// True if a component holds the Test_Noise samples
+Bool
+Check_Noise(const HeatWaveComponent & cmp)
+{
+  Bool check = True;
+  for ( SInt y = 0 ; y < cmp.GetHeight() ; ++y ){
+    for ( SInt x = 0 ; x < cmp.GetWidth() ; ++x ){
+      check &= (cmp.GetSmpl(x, y) == Test_Noise(x, y));
+    }
+  }
+  return check;
+}
+
+// a component of Test_Noise samples, transformed to lev
+HeatWaveComponent *
+New_Transformed(EnumTransform trn, SInt lev)
+{
+  HeatWaveComponent * cmp = new HeatWaveComponent(TEST_ROI_TLX, TEST_ROI_TLY,
+                                                  1, 1, TEST_ROI_WIDTH, 
+                                                  TEST_ROI_HEIGHT, False, 8,
+                                                  ClrY);
+  for ( SInt y = 0 ; y < TEST_ROI_HEIGHT ; ++y ){
+    for ( SInt x = 0 ; x < TEST_ROI_WIDTH ; ++x ){
+      cmp->SetSmpl(TEST_ROI_TLX+x, TEST_ROI_TLY+y, Test_Noise(x, y));
+    }
+  }
+  cmp->DoPyramidTransform(trn, lev);
+  return cmp;
+}
+
+// True if out holds the samples of the LL of ref at level res, from x,y on
+// the grid of that level
+Bool
+Check_LL(const HeatWaveComponent & ref, SInt res, SInt x, SInt y,
+         const HeatWaveComponent & out)
+{
+  SInt llx, lly, llw, llh;
+  Bool check = ref.GetSubbandInfo(res, SubLL, llx, lly, llw, llh);
+  check &= (out.GetTLX() == (TEST_ROI_TLX+x));
+  check &= (out.GetTLY() == (TEST_ROI_TLY+y));
+  check &= ((x+out.GetWidth()) <= llw) && ((y+out.GetHeight()) <= llh);
+  for ( SInt j = 0 ; check && (j < out.GetHeight()) ; ++j ){
+    for ( SInt i = 0 ; i < out.GetWidth() ; ++i ){
+      check &= (out.GetSmpl(out.GetTLX()+i, out.GetTLY()+j) == 
+                ref.GetSmpl(llx+x+i, lly+y+j));
+    }
+  }
+  return check;
+}
+
+// transforms a tiled component on the pool the job itself runs on
+class TestTiledJob : public HeatWaveJob
+{
+public:
+  void DoRun()
+  {
+    m_reached = m_cmp->DoPyramidTransform(Trn2_2, TEST_TILE_LEVELS);
+  }
+  HeatWaveComponent * m_cmp;
+  SInt m_reached;
+};
+
+void
+TestHeatWaveComponent::setUp(void)
+{
+  cmpA = new HeatWaveComponent(TEST_CMP_TLX, TEST_CMP_TLY, 1, 1, 
+                               TEST_CMP_WIDTH, TEST_CMP_HEIGHT, True, 12, 
+                               ClrY);
+  for ( SInt y = TEST_CMP_TLY ; y < TEST_CMP_TLY+TEST_CMP_HEIGHT ; ++y ){
+    for ( SInt x = TEST_CMP_TLX ; x < TEST_CMP_TLX+TEST_CMP_WIDTH ; ++x ){
+      cmpA->SetSmpl(x, y, Test_Smpl(x, y));
+    }
+  }
+}
+
+void
+TestHeatWaveComponent::tearDown(void)
+{
+  delete cmpA;
+}
+
+void
+TestHeatWaveComponent::CopyThenWrite(void)
+{
+  HeatWaveComponent cmpB(*cmpA);
+  HeatWaveComponent cmpC(TEST_CMP_TLX, TEST_CMP_TLY, 1, 1, 1, 1, True, 12, 
+                         ClrY);
+  cmpC = cmpB;
+  CPPUNIT_ASSERT (cmpA->IsShared());
+  CPPUNIT_ASSERT (cmpB.IsShared());
+  CPPUNIT_ASSERT (cmpC.IsShared());
+
+  // a sample write unshares the writer only
+  cmpB.SetSmpl(TEST_CMP_TLX, TEST_CMP_TLY, 1000);
+  CPPUNIT_ASSERT (!cmpB.IsShared());
+  CPPUNIT_ASSERT (cmpA->IsShared());
+  CPPUNIT_ASSERT_EQUAL ((Smpl)1000, cmpB.GetSmpl(TEST_CMP_TLX, TEST_CMP_TLY));
+  CPPUNIT_ASSERT (Check_Smpls(*cmpA));
+  CPPUNIT_ASSERT (Check_Smpls(cmpC));
+
+  // so does writing through the raw data and rows
+  Smpl * data = cmpC.GetData();
+  for ( SInt i = 0 ; i < TEST_CMP_WIDTH*TEST_CMP_HEIGHT ; ++i ){
+    data[i] += 3;
+  }
+  CPPUNIT_ASSERT (!cmpC.IsShared());
+  CPPUNIT_ASSERT (Check_Smpls(cmpC, 3));
+  CPPUNIT_ASSERT (Check_Smpls(*cmpA));
+  Smpl ** rows = cmpA->GetRows();
+  rows[0][0] = -1000;
+  CPPUNIT_ASSERT (!cmpA->IsShared());
+  CPPUNIT_ASSERT_EQUAL ((Smpl)1000, cmpB.GetSmpl(TEST_CMP_TLX, TEST_CMP_TLY));
+  CPPUNIT_ASSERT (Check_Smpls(cmpC, 3));
+}
+
+void
+TestHeatWaveComponent::ConstReadKeepsShared(void)
+{
+  HeatWaveComponent cmpB(*cmpA);
+  const HeatWaveComponent & cnst = cmpB;
+  const Smpl * data = cnst.GetData();
+  const Smpl * const * rows = cnst.GetRows();
+  CPPUNIT_ASSERT (cmpA->IsShared());
+  CPPUNIT_ASSERT (cmpB.IsShared());
+  CPPUNIT_ASSERT_EQUAL (Test_Smpl(TEST_CMP_TLX, TEST_CMP_TLY), data[0]);
+  CPPUNIT_ASSERT_EQUAL (Test_Smpl(TEST_CMP_TLX+1, TEST_CMP_TLY+2),
+                        rows[2][1]);
+}
+
+void
+TestHeatWaveComponent::UnsharePacked(void)
+{
+  CPPUNIT_ASSERT (cmpA->DoPack());
+  HeatWaveComponent cmpB(*cmpA);
+  CPPUNIT_ASSERT (cmpB.IsPacked());
+  CPPUNIT_ASSERT (cmpB.IsShared());
+  cmpB.DoUnshare();
+  CPPUNIT_ASSERT (cmpB.IsPacked());
+  CPPUNIT_ASSERT (!cmpB.IsShared());
+  CPPUNIT_ASSERT (!cmpA->IsShared());
+  cmpB.SetSmpl(TEST_CMP_TLX+1, TEST_CMP_TLY+1, 77);
+  CPPUNIT_ASSERT (cmpB.IsPacked());
+  CPPUNIT_ASSERT_EQUAL ((Smpl)77, cmpB.GetSmpl(TEST_CMP_TLX+1, 
+                                                TEST_CMP_TLY+1));
+  CPPUNIT_ASSERT (Check_Smpls(*cmpA));
+
+  // unpacking a shared packed copy leaves the other packed
+  HeatWaveComponent cmpC(*cmpA);
+  cmpC.DoUnpack();
+  CPPUNIT_ASSERT (!cmpC.IsPacked());
+  CPPUNIT_ASSERT (cmpA->IsPacked());
+  CPPUNIT_ASSERT (Check_Smpls(cmpC));
+  CPPUNIT_ASSERT (Check_Smpls(*cmpA));
+}
+
+void
+TestHeatWaveComponent::LastOwnerFrees(void)
+{
+  SInt64 base = HeatWaveMemory::GetCurrent(MemPlanes);
+  HeatWaveComponent * cmpB = new HeatWaveComponent(*cmpA);
+  HeatWaveComponent * cmpC = new HeatWaveComponent(*cmpB);
+  // the copies add no planes
+  CPPUNIT_ASSERT_EQUAL (base, HeatWaveMemory::GetCurrent(MemPlanes));
+
+  // the storage outlives the component it came from
+  delete cmpA;
+  cmpA = NULL;
+  CPPUNIT_ASSERT_EQUAL (base, HeatWaveMemory::GetCurrent(MemPlanes));
+  CPPUNIT_ASSERT (Check_Smpls(*cmpB));
+  delete cmpB;
+  CPPUNIT_ASSERT_EQUAL (base, HeatWaveMemory::GetCurrent(MemPlanes));
+  CPPUNIT_ASSERT (!cmpC->IsShared());
+  CPPUNIT_ASSERT (Check_Smpls(*cmpC));
+
+  // the last owner frees it
+  delete cmpC;
+  CPPUNIT_ASSERT_EQUAL (base - (SInt64)(TEST_CMP_WIDTH*TEST_CMP_HEIGHT*
+                                        sizeof(Smpl)),
+                        HeatWaveMemory::GetCurrent(MemPlanes));
+}
+
+void
+TestHeatWaveComponent::Swap(void)
+{
+  HeatWaveComponent cmpB(0, 0, 1, 1, 3, 2, False, 8, ClrU);
+  cmpB.SetSmpl(2, 1, 200);
+  HeatWaveComponent cmpC(*cmpA);
+  cmpA->DoSwap(cmpB);
+  CPPUNIT_ASSERT_EQUAL ((SInt)3, cmpA->GetWidth());
+  CPPUNIT_ASSERT_EQUAL ((SInt)2, cmpA->GetHeight());
+  CPPUNIT_ASSERT_EQUAL ((SInt)0, cmpA->GetTLX());
+  CPPUNIT_ASSERT_EQUAL (ClrU, cmpA->GetColor());
+  CPPUNIT_ASSERT (!cmpA->IsShared());
+  CPPUNIT_ASSERT_EQUAL ((Smpl)200, cmpA->GetSmpl(2, 1));
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_CMP_WIDTH, cmpB.GetWidth());
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_CMP_TLX, cmpB.GetTLX());
+  CPPUNIT_ASSERT_EQUAL (ClrY, cmpB.GetColor());
+  // the shared storage went along
+  CPPUNIT_ASSERT (cmpB.IsShared());
+  CPPUNIT_ASSERT (Check_Smpls(cmpB));
+  cmpB.SetSmpl(TEST_CMP_TLX, TEST_CMP_TLY, 5);
+  CPPUNIT_ASSERT (Check_Smpls(cmpC));
+  cmpA->DoSwap(cmpB);
+  CPPUNIT_ASSERT_EQUAL ((Smpl)5, cmpA->GetSmpl(TEST_CMP_TLX, TEST_CMP_TLY));
+  CPPUNIT_ASSERT_EQUAL ((Smpl)200, cmpB.GetSmpl(2, 1));
+}
+
+void
+TestHeatWaveComponent::CopyKeepsLift(void)
+{
+  // copies made and assigned around transforms, each with its own lift
+  HeatWaveComponent * big = New_Transformed(Trn4_4, 2);
+  HeatWaveComponent cmpB(*cmpA);
+  cmpB.DoPyramidTransform(Trn2_2, 2);
+  HeatWaveComponent cmpC(*big);
+  cmpB = *big;
+  delete big;
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_ROI_WIDTH, cmpB.GetWidth());
+  CPPUNIT_ASSERT_EQUAL (Trn4_4, cmpB.GetTransformType());
+  CPPUNIT_ASSERT_EQUAL ((SInt)0, cmpB.DoPyramidTransform(Trn4_4, 0, False));
+  CPPUNIT_ASSERT_EQUAL ((SInt)0, cmpC.DoPyramidTransform(Trn4_4, 0, False));
+  for ( SInt y = 0 ; y < TEST_ROI_HEIGHT ; ++y ){
+    for ( SInt x = 0 ; x < TEST_ROI_WIDTH ; ++x ){
+      CPPUNIT_ASSERT_EQUAL (Test_Noise(x, y), 
+                            cmpB.GetSmpl(TEST_ROI_TLX+x, TEST_ROI_TLY+y));
+      CPPUNIT_ASSERT_EQUAL (Test_Noise(x, y), 
+                            cmpC.GetSmpl(TEST_ROI_TLX+x, TEST_ROI_TLY+y));
+    }
+  }
+  CPPUNIT_ASSERT (Check_Smpls(*cmpA));
+
+  HeatWaveImage imgA(0, 0, TEST_CMP_WIDTH, TEST_CMP_HEIGHT, SpcRGB, 3);
+  imgA.GetComponent(1) = *cmpA;
+  imgA.DoPyramidTransform(Trn2_2, 1);
+  HeatWaveImage imgB(imgA);
+  HeatWaveImage imgC(0, 0, 1, 1, SpcGrey, 1);
+  imgC = imgA;
+  imgA.DoPyramidTransform(Trn2_2, 0, False);
+  imgB.DoPyramidTransform(Trn2_2, 0, False);
+  imgC.DoPyramidTransform(Trn2_2, 0, False);
+  CPPUNIT_ASSERT_EQUAL ((SInt)3, imgC.GetComponentN());
+  CPPUNIT_ASSERT (Check_Smpls(imgA.GetComponent(1)));
+  CPPUNIT_ASSERT (Check_Smpls(imgB.GetComponent(1)));
+  CPPUNIT_ASSERT (Check_Smpls(imgC.GetComponent(1)));
+}
+
+void
+TestHeatWaveComponent::TiledRoundTrip(void)
+{
+  HeatWaveWorkerPool pool(TEST_TILE_THREADS);
+  EnumTransform trns[3] = {Trn2_2, Trn4_4, Trn9m7};
+  for ( SInt i = 0 ; i < 3 ; ++i ){
+    HeatWaveComponent * cmp = New_Tiled(&pool);
+    // 4 by 3 tiles, the last column and row narrower
+    CPPUNIT_ASSERT_EQUAL ((SInt)12, cmp->GetTileCount());
+    CPPUNIT_ASSERT_EQUAL ((SInt)TEST_TILE_LEVELS,
+                          cmp->DoPyramidTransform(trns[i], TEST_TILE_LEVELS));
+    CPPUNIT_ASSERT (Check_Tiles(*cmp, trns[i], TEST_TILE_LEVELS));
+
+    // the sub-bands are those of the tiles, there are none for the whole
+    SInt x, y, width, height;
+    CPPUNIT_ASSERT (!cmp->GetSubbandInfo(1, SubHH, x, y, width, height));
+    CPPUNIT_ASSERT (!cmp->GetView(1, SubHH).IsValid());
+    CPPUNIT_ASSERT (cmp->GetSubbandInfo(0, SubLL, x, y, width, height));
+    CPPUNIT_ASSERT (cmp->GetSubbandInfo(5, 1, SubHH, x, y, width, height));
+    CPPUNIT_ASSERT_EQUAL ((SInt)(TEST_TILE_SIZE+(TEST_TILE_SIZE/2)), x);
+    CPPUNIT_ASSERT_EQUAL ((SInt)(TEST_TILE_SIZE+(TEST_TILE_SIZE/2)), y);
+
+    CPPUNIT_ASSERT_EQUAL ((SInt)0, 
+                          cmp->DoPyramidTransform(trns[i], 0, False));
+    CPPUNIT_ASSERT (Check_Noise(*cmp));
+    delete cmp;
+  }
+}
+
+void
+TestHeatWaveComponent::TiledInsideJob(void)
+{
+  // more jobs than threads, each waiting for tiles queued behind the others
+  HeatWaveWorkerPool pool(2);
+  HeatWaveComponent * cmps[TEST_TILE_JOBS];
+  TestTiledJob jobs[TEST_TILE_JOBS];
+  for ( SInt j = 0 ; j < TEST_TILE_JOBS ; ++j ){
+    cmps[j] = New_Tiled(&pool);
+    jobs[j].m_cmp = cmps[j];
+    jobs[j].m_reached = 0;
+    pool.DoSubmit(&(jobs[j]));
+  }
+  pool.DoWait();
+  for ( SInt j = 0 ; j < TEST_TILE_JOBS ; ++j ){
+    CPPUNIT_ASSERT_EQUAL ((SInt)TEST_TILE_LEVELS, jobs[j].m_reached);
+    CPPUNIT_ASSERT (Check_Tiles(*cmps[j], Trn2_2, TEST_TILE_LEVELS));
+    delete cmps[j];
+  }
+}
+
+void
+TestHeatWaveComponent::ResolutionMatchesInverse(void)
+{
+  for ( SInt t = Trn1_1 ; t < TrnTotal ; ++t ){
+    for ( SInt lev = 1 ; lev <= TEST_ROI_LEVELS ; ++lev ){
+      HeatWaveComponent * cmp = New_Transformed((EnumTransform)t, lev);
+      CPPUNIT_ASSERT_EQUAL (lev, cmp->GetTransformLevel());
+      for ( SInt res = 0 ; res <= lev ; ++res ){
+        // the full inverse down to res, the LL of which is the resolution
+        HeatWaveComponent ref(*cmp);
+        ref.DoPyramidTransform((EnumTransform)t, res, False);
+        HeatWaveComponent out;
+        CPPUNIT_ASSERT (cmp->GetResolution(res, out));
+        CPPUNIT_ASSERT (Check_LL(ref, res, 0, 0, out));
+        SInt x, y, llw, llh;
+        ref.GetSubbandInfo(res, SubLL, x, y, llw, llh);
+        CPPUNIT_ASSERT_EQUAL (llw, out.GetWidth());
+        CPPUNIT_ASSERT_EQUAL (llh, out.GetHeight());
+      }
+      HeatWaveComponent out;
+      CPPUNIT_ASSERT (!cmp->GetResolution(lev+1, out));
+      CPPUNIT_ASSERT (!cmp->GetResolution(-1, out));
+      delete cmp;
+    }
+  }
+}
+
+void
+TestHeatWaveComponent::RegionMatchesInverse(void)
+{
+  for ( SInt t = Trn1_1 ; t < TrnTotal ; ++t ){
+    for ( SInt lev = 1 ; lev <= TEST_ROI_LEVELS ; ++lev ){
+      HeatWaveComponent * cmp = New_Transformed((EnumTransform)t, lev);
+      for ( SInt res = 0 ; res < lev ; ++res ){
+        HeatWaveComponent ref(*cmp);
+        ref.DoPyramidTransform((EnumTransform)t, res, False);
+        SInt x, y, llw, llh;
+        ref.GetSubbandInfo(res, SubLL, x, y, llw, llh);
+        // corners, the middle (further than the margin from the edges
+        // at full size), odd offsets and a sliver along the right edge
+        SInt area[TEST_ROI_AREAS][4] = {
+          {0, 0, 1, 1},
+          {llw-1, llh-1, 1, 1},
+          {llw/3, llh/3, (llw/3)+1, (llh/3)+1},
+          {1, 2, llw-2, llh-3},
+          {llw-2, 0, 2, llh},
+          {0, 0, llw, llh}};
+        for ( SInt a = 0 ; a < TEST_ROI_AREAS ; ++a ){
+          HeatWaveComponent out;
+          CPPUNIT_ASSERT (cmp->GetRegion(res, TEST_ROI_TLX+area[a][0],
+                                         TEST_ROI_TLY+area[a][1], 
+                                         area[a][2], area[a][3], out));
+          CPPUNIT_ASSERT_EQUAL (area[a][2], out.GetWidth());
+          CPPUNIT_ASSERT_EQUAL (area[a][3], out.GetHeight());
+          CPPUNIT_ASSERT (Check_LL(ref, res, area[a][0], area[a][1], out));
+        }
+        // outside the LL of the level
+        HeatWaveComponent out;
+        CPPUNIT_ASSERT (!cmp->GetRegion(res, TEST_ROI_TLX+llw-1, 
+                                        TEST_ROI_TLY, 2, 1, out));
+        CPPUNIT_ASSERT (!cmp->GetRegion(res, TEST_ROI_TLX-1, 
+                                        TEST_ROI_TLY, 1, 1, out));
+      }
+      delete cmp;
+    }
+  }
+}
@@ -0,0 +1,168 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveDigest.cpp
+ * @brief  A test fixture for the HeatWaveDigest class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#include <TestHeatWaveDigest.hpp>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestHeatWaveDigest);
+
+// local variables, small chunks so that each component has several leaves
+#define TEST_DIG_WIDTH 40
+#define TEST_DIG_HEIGHT 30
+#define TEST_DIG_FRAMES 6
+#define TEST_DIG_CHANGED 3
+#define TEST_DIG_CHUNK 1024
+#define TEST_DIG_THREADS 3
+#define TEST_DIG_LONG 100
+
+// a 64 bit constant from its halves, C++98 has no long long literals
+UInt64
+Test_U64(UInt32 hi, UInt32 lo)
+{
+  return (((UInt64)hi) << 32) | (UInt64)lo;
+}
+
+// a video of RGB frames of hashed 8-bit samples
+HeatWaveVideo *
+New_DigVideo()
+{
+  HeatWaveVideo * vid = new HeatWaveVideo();
+  for ( SInt f = 0 ; f < TEST_DIG_FRAMES ; ++f ){
+    HeatWaveImage * img = new HeatWaveImage(0, 0, TEST_DIG_WIDTH, 
+                                            TEST_DIG_HEIGHT, SpcRGB, 3);
+    for ( SInt c = 0 ; c < 3 ; ++c ){
+      HeatWaveComponent & cmp = img->GetComponent(c);
+      for ( SInt y = 0 ; y < TEST_DIG_HEIGHT ; ++y ){
+        for ( SInt x = 0 ; x < TEST_DIG_WIDTH ; ++x ){
+          UInt32 h = (UInt32)((((f*3)+c)*4096)+(y*TEST_DIG_WIDTH)+x);
+          cmp.SetSmpl(x, y, (Smpl)(((h*2654435761U) >> 24) & 0xFF));
+        }
+      }
+    }
+    img->SetMinPrecSgn();
+    vid->AddImage(img);
+  }
+  return vid;
+}
+
+// the first frame whose digests differ, -1 if none
+SInt
+Get_FirstDifference(const HeatWaveDigest & a, const HeatWaveDigest & b)
+{
+  for ( SInt i = 0 ; (i < a.GetFrameN()) && (i < b.GetFrameN()) ; ++i ){
+    if ( memcmp(a.GetFrame(i), b.GetFrame(i), a.GetSize()) ){
+      return i;
+    }
+  }
+  return -1;
+}
+
+void
+TestHeatWaveDigest::setUp(void)
+{
+}
+
+void
+TestHeatWaveDigest::tearDown(void)
+{
+}
+
+void
+TestHeatWaveDigest::KnownXXH64(void)
+{
+  UInt8 data[TEST_DIG_LONG];
+  for ( SInt i = 0 ; i < TEST_DIG_LONG ; ++i ){
+    data[i] = (UInt8)i;
+  }
+  CPPUNIT_ASSERT (HeatWaveDigest::GetXXH64((const UInt8*)"", 0) ==
+                  Test_U64(0xef46db37, 0x51d8e999));
+  CPPUNIT_ASSERT (HeatWaveDigest::GetXXH64((const UInt8*)"abc", 3) ==
+                  Test_U64(0x44bc2cf5, 0xad770999));
+  // the four lane loop, then 8, 4 and 1 byte tails
+  CPPUNIT_ASSERT (HeatWaveDigest::GetXXH64(data, TEST_DIG_LONG) ==
+                  Test_U64(0x6ac1e580, 0x32166597));
+
+  // the digest is written big endian
+  UInt8 out[8];
+  Char hex[17];
+  HeatWaveDigest::DoXXH64((const UInt8*)"abc", 3, out);
+  HeatWaveDigest::GetHex(out, 8, hex);
+  CPPUNIT_ASSERT (!strcmp(hex, "44bc2cf5ad770999"));
+}
+
+void
+TestHeatWaveDigest::KnownCRC32C(void)
+{
+  UInt8 data[32];
+  CPPUNIT_ASSERT_EQUAL ((UInt32)0xe3069283, 
+                        HeatWaveDigest::GetCRC32C((const UInt8*)"123456789",
+                                                  9));
+  // continued in two parts
+  UInt32 crc = HeatWaveDigest::GetCRC32C((const UInt8*)"1234", 4);
+  CPPUNIT_ASSERT_EQUAL ((UInt32)0xe3069283, 
+                        HeatWaveDigest::GetCRC32C((const UInt8*)"56789", 5,
+                                                  crc));
+  // from RFC 3720, B.4
+  memset(data, 0, 32);
+  CPPUNIT_ASSERT_EQUAL ((UInt32)0x8a9136aa, 
+                        HeatWaveDigest::GetCRC32C(data, 32));
+  for ( SInt i = 0 ; i < 32 ; ++i ){
+    data[i] = (UInt8)i;
+  }
+  CPPUNIT_ASSERT_EQUAL ((UInt32)0x46dd794e, 
+                        HeatWaveDigest::GetCRC32C(data, 32));
+
+  UInt8 out[4];
+  Char hex[9];
+  HeatWaveDigest::DoCRC32C((const UInt8*)"123456789", 9, out);
+  HeatWaveDigest::GetHex(out, 4, hex);
+  CPPUNIT_ASSERT (!strcmp(hex, "e3069283"));
+}
+
+void
+TestHeatWaveDigest::PackedSame(void)
+{
+  HeatWaveVideo * plain = New_DigVideo();
+  HeatWaveVideo * packed = New_DigVideo();
+  CPPUNIT_ASSERT (packed->DoPack());
+  CPPUNIT_ASSERT (packed->GetComponent(0, 0).IsPacked());
+  HeatWaveWorkerPool pool(TEST_DIG_THREADS);
+  HeatWaveDigest a(HeatWaveDigest::DoXXH64, 8, TEST_DIG_CHUNK);
+  HeatWaveDigest b(HeatWaveDigest::DoXXH64, 8, TEST_DIG_CHUNK);
+  a.DoDigest(*plain);
+  b.DoDigest(*packed, &pool);
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_DIG_FRAMES, b.GetFrameN());
+  CPPUNIT_ASSERT_EQUAL ((SInt)-1, Get_FirstDifference(a, b));
+  CPPUNIT_ASSERT (!memcmp(a.GetRoot(), b.GetRoot(), 8));
+  // and the samples stay packed
+  CPPUNIT_ASSERT (packed->GetComponent(0, 0).IsPacked());
+  delete plain;
+  delete packed;
+}
+
+void
+TestHeatWaveDigest::FirstDifference(void)
+{
+  HeatWaveVideo * org = New_DigVideo();
+  HeatWaveVideo * oth = New_DigVideo();
+  HeatWaveComponent & cmp = oth->GetComponent(TEST_DIG_CHANGED, 2);
+  cmp.SetSmpl(TEST_DIG_WIDTH-1, TEST_DIG_HEIGHT-1, 
+              cmp.GetSmpl(TEST_DIG_WIDTH-1, TEST_DIG_HEIGHT-1) ^ 1);
+  HeatWaveWorkerPool pool(TEST_DIG_THREADS);
+  HeatWaveDigest a(HeatWaveDigest::DoCRC32C, 4, TEST_DIG_CHUNK);
+  HeatWaveDigest b(HeatWaveDigest::DoCRC32C, 4, TEST_DIG_CHUNK);
+  a.DoDigest(*org, &pool);
+  b.DoDigest(*oth, &pool);
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_DIG_CHANGED, Get_FirstDifference(a, b));
+  CPPUNIT_ASSERT (memcmp(a.GetRoot(), b.GetRoot(), 4));
+  for ( SInt f = TEST_DIG_CHANGED+1 ; f < TEST_DIG_FRAMES ; ++f ){
+    CPPUNIT_ASSERT (!memcmp(a.GetFrame(f), b.GetFrame(f), 4));
+  }
+  delete org;
+  delete oth;
+}
@@ -0,0 +1,163 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveFloatComponent.cpp
+ * @brief  A test fixture for the HeatWaveFloatComponent class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#include <TestHeatWaveFloatComponent.hpp>
+#include <math.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestHeatWaveFloatComponent);
+
+// local variables, odd sizes so both ends of a line take the mirror
+#define TEST_FLT_TLX 3
+#define TEST_FLT_TLY 2
+#define TEST_FLT_WIDTH 37
+#define TEST_FLT_HEIGHT 29
+#define TEST_FLT_LEVELS 3
+#define TEST_FLT_LINE 41
+#define TEST_FLT_TOLERANCE 1e-2
+
+// a hashed pattern in -1024..1023, a smooth one is too kind to the lifting
+Smpl
+Test_FltSmpl(SInt x, SInt y)
+{
+  return (Smpl)(((((UInt32)((y*131)+x))*2654435761U) >> 21) & 0x7FF) - 1024;
+}
+
+// the forward 9/7 lifting of an interleaved line in double precision, with
+// the same whole sample symmetric extension
+void
+Lift_Reference(SFloat64 * x, SInt len)
+{
+  const SFloat64 cof[4] = {HEATWAVEF97ALPHA, HEATWAVEF97BETA,
+                           HEATWAVEF97GAMMA, HEATWAVEF97DELTA};
+  for ( SInt s = 0 ; s < 4 ; ++s ){
+    for ( SInt i = ((s%2) == 0) ? 1 : 0 ; i < len ; i += 2 ){
+      SFloat64 lft = (i > 0) ? x[i-1] : x[i+1];
+      SFloat64 rgt = ((i+1) < len) ? x[i+1] : x[i-1];
+      x[i] += cof[s]*(lft + rgt);
+    }
+  }
+  for ( SInt i = 0 ; i < len ; ++i ){
+    x[i] *= ((i%2) == 0) ? (1.0/HEATWAVEF97K) : HEATWAVEF97K;
+  }
+}
+
+void
+TestHeatWaveFloatComponent::setUp(void)
+{
+  cmpA = new HeatWaveComponent(TEST_FLT_TLX, TEST_FLT_TLY, 1, 1,
+                               TEST_FLT_WIDTH, TEST_FLT_HEIGHT, True, 12,
+                               ClrY);
+  for ( SInt y = TEST_FLT_TLY ; y < TEST_FLT_TLY+TEST_FLT_HEIGHT ; ++y ){
+    for ( SInt x = TEST_FLT_TLX ; x < TEST_FLT_TLX+TEST_FLT_WIDTH ; ++x ){
+      cmpA->SetSmpl(x, y, Test_FltSmpl(x, y));
+    }
+  }
+}
+
+void
+TestHeatWaveFloatComponent::tearDown(void)
+{
+  delete cmpA;
+}
+
+void
+TestHeatWaveFloatComponent::LiftLineReference(void)
+{
+  // every length up to a few vectors, so each tail length is covered
+  SFloat32 flt[TEST_FLT_LINE];
+  SFloat64 dbl[TEST_FLT_LINE];
+  for ( SInt len = 2 ; len <= TEST_FLT_LINE ; ++len ){
+    for ( SInt i = 0 ; i < len ; ++i ){
+      flt[i] = (SFloat32)Test_FltSmpl(i, len);
+      dbl[i] = flt[i];
+    }
+    HeatWaveFloatComponent::DoLiftLine(flt, len, True);
+    Lift_Reference(dbl, len);
+    for ( SInt i = 0 ; i < len ; ++i ){
+      CPPUNIT_ASSERT_DOUBLES_EQUAL (dbl[i], flt[i], TEST_FLT_TOLERANCE);
+    }
+    HeatWaveFloatComponent::DoLiftLine(flt, len, False);
+    for ( SInt i = 0 ; i < len ; ++i ){
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ((SFloat64)Test_FltSmpl(i, len), flt[i],
+                                    TEST_FLT_TOLERANCE);
+    }
+  }
+}
+
+void
+TestHeatWaveFloatComponent::RoundTrip97(void)
+{
+  HeatWaveFloatComponent flt(*cmpA);
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_FLT_LEVELS,
+                        flt.DoPyramidTransform(TEST_FLT_LEVELS));
+
+  // the sub-bands are laid out as for the integer transforms
+  SInt x, y, width, height, ix, iy, iwidth, iheight;
+  for ( SInt res = 1 ; res <= TEST_FLT_LEVELS ; ++res ){
+    CPPUNIT_ASSERT (flt.GetSubbandInfo(res, SubHH, x, y, width, height));
+    CPPUNIT_ASSERT (cmpA->GetSubbandInfo(res, SubHH, ix, iy, iwidth,
+                                         iheight));
+    CPPUNIT_ASSERT (x == ix && y == iy && width == iwidth &&
+                    height == iheight);
+  }
+
+  CPPUNIT_ASSERT_EQUAL ((SInt)0, flt.DoPyramidTransform(0, False));
+  for ( SInt y = TEST_FLT_TLY ; y < TEST_FLT_TLY+TEST_FLT_HEIGHT ; ++y ){
+    for ( SInt x = TEST_FLT_TLX ; x < TEST_FLT_TLX+TEST_FLT_WIDTH ; ++x ){
+      CPPUNIT_ASSERT_DOUBLES_EQUAL ((SFloat64)Test_FltSmpl(x, y),
+                                    flt.GetSmpl(x, y), TEST_FLT_TOLERANCE);
+    }
+  }
+
+  HeatWaveComponent out;
+  flt.GetComponent(out);
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_FLT_TLX, out.GetTLX());
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_FLT_TLY, out.GetTLY());
+  for ( SInt y = TEST_FLT_TLY ; y < TEST_FLT_TLY+TEST_FLT_HEIGHT ; ++y ){
+    for ( SInt x = TEST_FLT_TLX ; x < TEST_FLT_TLX+TEST_FLT_WIDTH ; ++x ){
+      CPPUNIT_ASSERT_EQUAL (Test_FltSmpl(x, y), out.GetSmpl(x, y));
+    }
+  }
+}
+
+void
+TestHeatWaveFloatComponent::ConvertClamps(void)
+{
+  HeatWaveFloatComponent flt;
+  cmpA->SetTransformLevel(2);
+  flt.SetComponent(*cmpA);
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_FLT_TLX, flt.GetTLX());
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_FLT_TLY, flt.GetTLY());
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_FLT_WIDTH, flt.GetWidth());
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_FLT_HEIGHT, flt.GetHeight());
+  CPPUNIT_ASSERT_EQUAL ((SInt)2, flt.GetTransformLevel());
+
+  // rounding to nearest (halves up) and saturating at the sample range
+  const SInt tlx = TEST_FLT_TLX, tly = TEST_FLT_TLY;
+  flt.SetSmpl(tlx, tly, 3e10f);
+  flt.SetSmpl(tlx+1, tly, -3e10f);
+  flt.SetSmpl(tlx+2, tly, 2.5f);
+  flt.SetSmpl(tlx+3, tly, -2.5f);
+  flt.SetSmpl(tlx+4, tly, -2.51f);
+  flt.SetSmpl(tlx+5, tly, 1.49f);
+
+  HeatWaveComponent out;
+  flt.GetComponent(out);
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_FLT_WIDTH, out.GetWidth());
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_FLT_HEIGHT, out.GetHeight());
+  CPPUNIT_ASSERT_EQUAL ((SInt)2, out.GetTransformLevel());
+  CPPUNIT_ASSERT_EQUAL (Trn9m7, out.GetTransformType());
+  CPPUNIT_ASSERT_EQUAL ((Smpl)SMPLMAX, out.GetSmpl(tlx, tly));
+  CPPUNIT_ASSERT_EQUAL ((Smpl)SMPLMIN, out.GetSmpl(tlx+1, tly));
+  CPPUNIT_ASSERT_EQUAL ((Smpl)3, out.GetSmpl(tlx+2, tly));
+  CPPUNIT_ASSERT_EQUAL ((Smpl)-2, out.GetSmpl(tlx+3, tly));
+  CPPUNIT_ASSERT_EQUAL ((Smpl)-3, out.GetSmpl(tlx+4, tly));
+  CPPUNIT_ASSERT_EQUAL ((Smpl)1, out.GetSmpl(tlx+5, tly));
+  CPPUNIT_ASSERT_EQUAL (Test_FltSmpl(tlx+6, tly), out.GetSmpl(tlx+6, tly));
+}
@@ -0,0 +1,317 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveImageFile.cpp
+ * @brief  A test fixture for the HeatWaveImageFile class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ *
+ **/
+
+#include <TestHeatWaveImageFile.hpp>
+#include <unistd.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestHeatWaveImageFile);
+
+// local variables, odd widths so that the BMP rows are padded
+#define TEST_IMF_WIDTH 13
+#define TEST_IMF_HEIGHT 5
+#define TEST_IMF_SMALLWIDTH 3
+#define TEST_IMF_SMALLHEIGHT 2
+#define TEST_IMF_HUGE 100000
+
+// decodes bytes held in memory, so that every read is checked
+class Probe_ImageFile : public HeatWaveImageFile
+{
+public:
+  static HeatWaveImage * Read(const UInt8 * data, SInt64 size,
+                              const Char *& errm)
+  {
+    return DoReadData(data, size, errm);
+  }
+};
+
+// the sample of a component at a place, within prec bits
+Smpl
+Imf_Value(SInt c, SInt x, SInt y, SInt prec)
+{
+  UInt32 h = (UInt32)((c*4096)+(y*TEST_IMF_WIDTH)+x)*2654435761U;
+  return (Smpl)((h >> 8) & ((1 << prec)-1));
+}
+
+// a grey or RGB image of hashed samples
+HeatWaveImage *
+New_ImfImage(SInt num, SInt prec)
+{
+  HeatWaveComponent ** cmp = new HeatWaveComponent*[num];
+  const EnumColor grey[1] = { ClrGrey };
+  const EnumColor rgb[3] = { ClrRed, ClrGreen, ClrBlue };
+  for ( SInt c = 0 ; c < num ; ++c ){
+    cmp[c] = new HeatWaveComponent(0, 0, 1, 1, TEST_IMF_WIDTH,
+                                   TEST_IMF_HEIGHT, False, prec,
+                                   (num == 1) ? grey[c] : rgb[c]);
+    for ( SInt y = 0 ; y < TEST_IMF_HEIGHT ; ++y ){
+      for ( SInt x = 0 ; x < TEST_IMF_WIDTH ; ++x ){
+        cmp[c]->SetSmpl(x, y, Imf_Value(c, x, y, prec));
+      }
+    }
+  }
+  return new HeatWaveImage(0, 0, TEST_IMF_WIDTH, TEST_IMF_HEIGHT,
+                           (num == 1) ? SpcGrey : SpcRGB, num, cmp, True,
+                           False);
+}
+
+// True if a image read back holds the samples of New_ImfImage()
+Bool
+Is_ImfImage(HeatWaveImage * img, SInt num, SInt prec)
+{
+  if ( (img == NULL) || (img->GetComponentN() != num) ){
+    return False;
+  }
+  Bool check = True;
+  for ( SInt c = 0 ; c < num ; ++c ){
+    const HeatWaveComponent & cmp = img->GetComponent(c);
+    if ( (cmp.GetWidth() != TEST_IMF_WIDTH) ||
+         (cmp.GetHeight() != TEST_IMF_HEIGHT) || (cmp.GetPrec() != prec) ){
+      return False;
+    }
+    for ( SInt y = 0 ; y < TEST_IMF_HEIGHT ; ++y ){
+      for ( SInt x = 0 ; x < TEST_IMF_WIDTH ; ++x ){
+        check &= (cmp.GetSmpl(x, y) == Imf_Value(c, x, y, prec));
+      }
+    }
+  }
+  return check;
+}
+
+// True if a image written natively reads back the same
+Bool
+Check_RoundTrip(const Char * file, const Char * form, SInt num, SInt prec)
+{
+  const Char * errm = NULL;
+  HeatWaveImage * img = New_ImfImage(num, prec);
+  Bool check = HeatWaveImageFile::IsWritable(*img, file, form);
+  check &= HeatWaveImageFile::DoWrite(*img, file, form, errm);
+  check &= (errm == NULL);
+  delete img;
+  img = HeatWaveImageFile::DoRead(file, NULL, errm);
+  check &= Is_ImfImage(img, num, prec) && (errm == NULL);
+  delete img;
+  return check;
+}
+
+// read a file into memory
+UInt8 *
+Get_ImfBytes(const Char * file, SInt & size)
+{
+  FILE * in = fopen(file, "rb");
+  fseek(in, 0, SEEK_END);
+  size = (SInt)ftell(in);
+  rewind(in);
+  UInt8 * data = new UInt8[size];
+  size = (SInt)fread(data, 1, size, in);
+  fclose(in);
+  return data;
+}
+
+// True if the first len bytes of data are refused with a reason, from a
+// buffer of exactly that size
+Bool
+Is_Refused(const UInt8 * data, SInt len)
+{
+  UInt8 * copy = new UInt8[len];
+  memcpy(copy, data, len);
+  const Char * errm = NULL;
+  HeatWaveImage * img = Probe_ImageFile::Read(copy, len, errm);
+  delete [] copy;
+  Bool check = (img == NULL) && (errm != NULL);
+  delete img;
+  return check;
+}
+
+// put a little endian number
+void
+Put_ImfLE(UInt8 * ptr, UInt32 val, SInt len)
+{
+  for ( SInt i = 0 ; i < len ; ++i ){
+    ptr[i] = (UInt8)(val >> (8*i));
+  }
+}
+
+// a BMP header with pal palette entries, the rows follow at 54+4*pal
+void
+Put_ImfBMP(UInt8 * data, SInt width, SInt height, SInt bpp, SInt pal,
+           SInt size)
+{
+  memset(data, 0, 54);
+  data[0] = 'B';
+  data[1] = 'M';
+  Put_ImfLE(data+2, size, 4);
+  Put_ImfLE(data+10, 54+4*pal, 4);
+  Put_ImfLE(data+14, 40, 4);
+  Put_ImfLE(data+18, width, 4);
+  Put_ImfLE(data+22, (UInt32)height, 4);
+  Put_ImfLE(data+26, 1, 2);
+  Put_ImfLE(data+28, bpp, 2);
+  Put_ImfLE(data+46, pal, 4);
+}
+
+void
+TestHeatWaveImageFile::setUp(void)
+{
+  strcpy(file, "TestHeatWaveImageFile.XXXXXX");
+  SInt fd = mkstemp(file);
+  CPPUNIT_ASSERT (fd >= 0);
+  close(fd);
+}
+
+void
+TestHeatWaveImageFile::tearDown(void)
+{
+  remove(file);
+}
+
+void
+TestHeatWaveImageFile::RoundTripBMP(void)
+{
+  // grey goes through a 8 bit palette, RGB through 24 bits
+  CPPUNIT_ASSERT (Check_RoundTrip(file, "bmp", 1, 8));
+  CPPUNIT_ASSERT (Check_RoundTrip(file, "bmp", 3, 8));
+  HeatWaveImage * img = New_ImfImage(1, 12);
+  CPPUNIT_ASSERT (!HeatWaveImageFile::IsWritable(*img, file, "bmp"));
+  delete img;
+}
+
+void
+TestHeatWaveImageFile::RoundTripPNM(void)
+{
+  // P5 and P6, at 8 and 16 bits
+  CPPUNIT_ASSERT (Check_RoundTrip(file, "pnm", 1, 8));
+  CPPUNIT_ASSERT (Check_RoundTrip(file, "pnm", 3, 8));
+  CPPUNIT_ASSERT (Check_RoundTrip(file, "pnm", 1, 16));
+  CPPUNIT_ASSERT (Check_RoundTrip(file, "pnm", 3, 12));
+}
+
+void
+TestHeatWaveImageFile::ReadPalette(void)
+{
+  // 3x2 of 8 bit indices in a 4 colour palette, rows padded to 4 bytes
+  const UInt8 pal[4][3] = { {0,0,0}, {255,0,0}, {0,128,0}, {10,20,30} };
+  const UInt8 idx[TEST_IMF_SMALLHEIGHT][TEST_IMF_SMALLWIDTH] = 
+    { {0,1,2}, {3,2,1} };
+  SInt size = 54+(4*4)+(4*TEST_IMF_SMALLHEIGHT);
+  UInt8 * data = new UInt8[size];
+  memset(data, 0, size);
+  Put_ImfBMP(data, TEST_IMF_SMALLWIDTH, TEST_IMF_SMALLHEIGHT, 8, 4, size);
+  for ( SInt i = 0 ; i < 4 ; ++i ){
+    for ( SInt c = 0 ; c < 3 ; ++c ){
+      data[54+(4*i)+2-c] = pal[i][c];
+    }
+  }
+  for ( SInt y = 0 ; y < TEST_IMF_SMALLHEIGHT ; ++y ){
+    // bottom up
+    UInt8 * row = data+54+16+(4*(TEST_IMF_SMALLHEIGHT-1-y));
+    memcpy(row, idx[y], TEST_IMF_SMALLWIDTH);
+  }
+  const Char * errm = NULL;
+  HeatWaveImage * img = Probe_ImageFile::Read(data, size, errm);
+  delete [] data;
+  CPPUNIT_ASSERT (img != NULL);
+  CPPUNIT_ASSERT_EQUAL ((SInt)3, img->GetComponentN());
+  for ( SInt y = 0 ; y < TEST_IMF_SMALLHEIGHT ; ++y ){
+    for ( SInt x = 0 ; x < TEST_IMF_SMALLWIDTH ; ++x ){
+      for ( SInt c = 0 ; c < 3 ; ++c ){
+        CPPUNIT_ASSERT_EQUAL ((Smpl)pal[idx[y][x]][c],
+                              img->GetComponent(c).GetSmpl(x, y));
+      }
+    }
+  }
+  delete img;
+}
+
+void
+TestHeatWaveImageFile::Read32Bit(void)
+{
+  // top down (negative height) BGRX
+  SInt size = 54+(4*TEST_IMF_SMALLWIDTH*TEST_IMF_SMALLHEIGHT);
+  UInt8 * data = new UInt8[size];
+  Put_ImfBMP(data, TEST_IMF_SMALLWIDTH, -TEST_IMF_SMALLHEIGHT, 32, 0, size);
+  for ( SInt y = 0 ; y < TEST_IMF_SMALLHEIGHT ; ++y ){
+    for ( SInt x = 0 ; x < TEST_IMF_SMALLWIDTH ; ++x ){
+      UInt8 * px = data+54+(4*((y*TEST_IMF_SMALLWIDTH)+x));
+      for ( SInt c = 0 ; c < 3 ; ++c ){
+        px[2-c] = (UInt8)Imf_Value(c, x, y, 8);
+      }
+      px[3] = 0xff;
+    }
+  }
+  const Char * errm = NULL;
+  HeatWaveImage * img = Probe_ImageFile::Read(data, size, errm);
+  delete [] data;
+  CPPUNIT_ASSERT (img != NULL);
+  CPPUNIT_ASSERT_EQUAL ((SInt)3, img->GetComponentN());
+  for ( SInt y = 0 ; y < TEST_IMF_SMALLHEIGHT ; ++y ){
+    for ( SInt x = 0 ; x < TEST_IMF_SMALLWIDTH ; ++x ){
+      for ( SInt c = 0 ; c < 3 ; ++c ){
+        CPPUNIT_ASSERT_EQUAL (Imf_Value(c, x, y, 8),
+                              img->GetComponent(c).GetSmpl(x, y));
+      }
+    }
+  }
+  delete img;
+}
+
+void
+TestHeatWaveImageFile::TruncatedBMP(void)
+{
+  const Char * errm = NULL;
+  HeatWaveImage * img = New_ImfImage(1, 8);
+  CPPUNIT_ASSERT (HeatWaveImageFile::DoWrite(*img, file, "bmp", errm));
+  delete img;
+  SInt size = 0;
+  UInt8 * data = Get_ImfBytes(file, size);
+
+  // cut in the header, the palette and the rows
+  CPPUNIT_ASSERT (Is_Refused(data, 20));
+  CPPUNIT_ASSERT (Is_Refused(data, 53));
+  CPPUNIT_ASSERT (Is_Refused(data, 54+512));
+  CPPUNIT_ASSERT (Is_Refused(data, size-1));
+
+  // a header claiming more rows or a bigger header than the file holds
+  Put_ImfLE(data+22, TEST_IMF_HUGE, 4);
+  CPPUNIT_ASSERT (Is_Refused(data, size));
+  Put_ImfLE(data+22, TEST_IMF_HEIGHT, 4);
+  Put_ImfLE(data+14, 0x7fffffff, 4);
+  CPPUNIT_ASSERT (Is_Refused(data, size));
+  Put_ImfLE(data+14, 40, 4);
+  Put_ImfLE(data+10, 0xfffffff0, 4);
+  CPPUNIT_ASSERT (Is_Refused(data, size));
+  delete [] data;
+}
+
+void
+TestHeatWaveImageFile::TruncatedPNM(void)
+{
+  const Char * errm = NULL;
+  HeatWaveImage * img = New_ImfImage(3, 16);
+  CPPUNIT_ASSERT (HeatWaveImageFile::DoWrite(*img, file, "pnm", errm));
+  delete img;
+  SInt size = 0;
+  UInt8 * data = Get_ImfBytes(file, size);
+
+  // cut in the header ("P6\n13 5\n65535\n") and the samples
+  CPPUNIT_ASSERT (Is_Refused(data, 2));
+  CPPUNIT_ASSERT (Is_Refused(data, 6));
+  CPPUNIT_ASSERT (Is_Refused(data, 14));
+  CPPUNIT_ASSERT (Is_Refused(data, size-1));
+  delete [] data;
+
+  // sizes beyond the file, or too big to be a number
+  const Char * huge[] = { "P5\n100000 100000\n255\n....",
+                          "P6 13 5 65535 .",
+                          "P5 13 5 70000 ..........",
+                          "P5 999999999999 5 255 ....",
+                          "P5 # a comment without an end" };
+  for ( SInt i = 0 ; i < (SInt)(sizeof(huge)/sizeof(huge[0])) ; ++i ){
+    CPPUNIT_ASSERT (Is_Refused((const UInt8*)huge[i], strlen(huge[i])));
+  }
+}
@@ -320,7 +320,107 @@ TestHeatWaveLift::SplitAndJoinAll (void){
   }
 }
 
+void 
+TestHeatWaveLift::LiftSmpl16 (void){
+  // the 16-bit kernels must match the full precision kernels
+  const SInt len = 37;
+  Smpl   data[len];
+  Smpl16 data16[len];
+  Smpl   * even,   * odd;
+  Smpl16 * even16, * odd16;
+  HeatWaveLift::m_lftFunction   func[HEATWAVELIFTMAXSTEPS];
+  HeatWaveLift::m_lftFunction16 func16[HEATWAVELIFTMAXSTEPS];
+  
+  for ( SInt t = Trn0_0 ; t < TrnTotal ; ++t ){
+    for ( SInt i = 0 ; i < len ; ++i ){
+      data[i] = data16[i] = (Smpl16)((i*97)%256);
+    }
+    SInt n = liftA->GetFuncArray(func, (EnumTransform)t, True);
+    CPPUNIT_ASSERT(n == liftA->GetFuncArray(func16, (EnumTransform)t, True));
+    liftA->Split(data, len, 1, even, odd);
+    liftA->Split(data16, len, 1, even16, odd16);
+    for ( SInt s = 0 ; s < n ; ++s ){
+      (liftA->*func[s])(even, odd, len, 1, True);
+      (liftA->*func16[s])(even16, odd16, len, 1, True);
+    }
+    for ( SInt i = 0 ; i < len ; ++i ){
+      CPPUNIT_ASSERT(data[i] == data16[i]);
+    }
+  }
+}
+
+/** Full range 16-bit samples, without pattern. */
+static Smpl16
+Test_Noise(SInt i)
+{
+  return (Smpl16)((((UInt32)i)*2654435761U) >> 16);
+}
+
+void
+TestHeatWaveLift::LiftRows16 (void){
+  // the row and run kernels must match the column by column and sample by
+  // sample kernels, also where sums of 16-bit samples overflow
+  const SInt num = 13;
+  const SInt lens[] = {4, 9, 10, 23};
+  Smpl16 cols[num*23], ref[num*23], run[23], gap[2*23];
+  Smpl16 * even, * odd;
+  HeatWaveLift::m_lftFunction16 func[HEATWAVELIFTMAXSTEPS];
+  
+  for ( SInt l = 0 ; l < 4 ; ++l ){
+    const SInt len = lens[l];
+    for ( SInt i = 0 ; i < num*len ; ++i ){
+      cols[i] = ref[i] = Test_Noise(i);
+    }
+    for ( SInt d = 0 ; d < 2 ; ++d ){
+      Bool fwd = (d == 0);
+      SInt n = liftA->GetFuncArray(func, Trn2_2, fwd);
+      if ( fwd ){
+        liftA->SplitRows(cols, len, num, num);
+        for ( SInt k = 0 ; k < num ; ++k ){
+          liftA->Split(ref+k, len*num, num, even, odd);
+        }
+      }
+      for ( SInt s = 0 ; s < n ; ++s ){
+        SInt even_len = ((len+1)>>1)*num;
+        liftA->DoLiftColumns(func[s], cols, cols+even_len, len, num, num, 
+                             fwd);
+        for ( SInt k = 0 ; k < num ; ++k ){
+          (liftA->*func[s])(ref+k, ref+k+even_len, len, num, fwd);
+        }
+      }
+      if ( !fwd ){
+        liftA->JoinRows(cols, len, num, num);
+        for ( SInt k = 0 ; k < num ; ++k ){
+          liftA->Join(ref+k, len*num, num);
+        }
+      }
+      for ( SInt i = 0 ; i < num*len ; ++i ){
+        CPPUNIT_ASSERT_EQUAL (ref[i], cols[i]);
+      }
+    }
+    // lifted twice, forward then inverse
+    for ( SInt i = 0 ; i < num*len ; ++i ){
+      CPPUNIT_ASSERT_EQUAL (Test_Noise(i), cols[i]);
+    }
+    
+    // contiguous samples against the same samples a step apart
+    for ( SInt i = 0 ; i < len ; ++i ){
+      run[i] = gap[2*i] = Test_Noise(i);
+    }
+    SInt n = liftA->GetFuncArray(func, Trn2_2, True);
+    SInt even_len = (len+1)>>1;
+    for ( SInt s = 0 ; s < n ; ++s ){
+      (liftA->*func[s])(run, run+even_len, len, 1, True);
+      (liftA->*func[s])(gap, gap+(2*even_len), len, 2, True);
+    }
+    for ( SInt i = 0 ; i < len ; ++i ){
+      CPPUNIT_ASSERT_EQUAL (gap[2*i], run[i]);
+    }
+  }
+}
+
 // setUp/tearDown functions
+
 void 
 TestHeatWaveLift::setUp (){  
   liftList[0] = liftA = new HeatWaveLift(-1);
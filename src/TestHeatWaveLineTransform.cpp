@@ -0,0 +1,99 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveLineTransform.cpp
+ * @brief  A test fixture for the HeatWaveLineTransform class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#include <TestHeatWaveLineTransform.hpp>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestHeatWaveLineTransform);
+
+// local variables, more levels than any of the sizes allow
+#define TEST_LINE_LEVELS 6
+
+// a hashed pattern in -1024..1023
+Smpl
+Test_LineSmpl(SInt x, SInt y)
+{
+  return (Smpl)(((((UInt32)((y*131)+x))*2654435761U) >> 21) & 0x7FF) - 1024;
+}
+
+// True if streaming the rows of a width x height component gives the same
+// samples, to the bit, and levels as the whole component pyramid transform
+Bool
+Check_Line(SInt width, SInt height)
+{
+  HeatWaveComponent cmp(0, 0, 1, 1, width, height, True, 12, ClrY);
+  for ( SInt y = 0 ; y < height ; ++y ){
+    for ( SInt x = 0 ; x < width ; ++x ){
+      cmp.SetSmpl(x, y, Test_LineSmpl(x, y));
+    }
+  }
+  HeatWaveFloatComponent whole(cmp);
+  HeatWaveFloatComponent lines(cmp);
+  for ( SInt i = 0 ; i < lines.GetSize() ; ++i ){
+    lines.GetData()[i] = 0.0f;
+  }
+
+  SInt levels = whole.DoPyramidTransform(TEST_LINE_LEVELS);
+  HeatWaveLineComponentSink sink(lines);
+  HeatWaveLineTransform trn(width, height, TEST_LINE_LEVELS, &sink);
+  Smpl * row = new Smpl[width];
+  Bool check = True;
+  for ( SInt y = 0 ; y < height ; ++y ){
+    for ( SInt x = 0 ; x < width ; ++x ){
+      row[x] = cmp.GetSmpl(x, y);
+    }
+    check &= (!trn.IsDone() && trn.Push(row));
+  }
+  check &= trn.IsDone();
+  check &= !trn.Push(row);
+  delete [] row;
+
+  check &= (trn.GetLevels() == levels);
+  for ( SInt i = 0 ; i < whole.GetSize() ; ++i ){
+    check &= (memcmp(whole.GetData()+i, lines.GetData()+i,
+                     sizeof(SFloat32)) == 0);
+  }
+  return check;
+}
+
+void
+TestHeatWaveLineTransform::setUp(void)
+{
+}
+
+void
+TestHeatWaveLineTransform::tearDown(void)
+{
+}
+
+void
+TestHeatWaveLineTransform::MatchColumn(void)
+{
+  // too narrow to transform, the rows pass straight through
+  CPPUNIT_ASSERT (Check_Line(1, 9));
+}
+
+void
+TestHeatWaveLineTransform::MatchRow(void)
+{
+  CPPUNIT_ASSERT (Check_Line(9, 1));
+}
+
+void
+TestHeatWaveLineTransform::MatchSquare(void)
+{
+  CPPUNIT_ASSERT (Check_Line(2, 2));
+}
+
+void
+TestHeatWaveLineTransform::MatchTall(void)
+{
+  // odd width, and rows enough to cycle the ring of every level
+  CPPUNIT_ASSERT (Check_Line(7, 100));
+  CPPUNIT_ASSERT (Check_Line(100, 7));
+}
@@ -0,0 +1,133 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWavePipeline.cpp
+ * @brief  A test fixture for the HeatWavePipeline class and its stages.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#include <TestHeatWavePipeline.hpp>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestHeatWavePipeline);
+
+// local variables, the last group is short
+#define TEST_PIPE_WIDTH 16
+#define TEST_PIPE_HEIGHT 12
+#define TEST_PIPE_FRAMES 7
+#define TEST_PIPE_GOP 4
+#define TEST_PIPE_LEVEL 2
+#define TEST_PIPE_DEPTH 1
+
+// a RGB frame of hashed 8-bit samples, sample (0,0) of red is the frame
+HeatWaveImage *
+New_Frame(SInt f)
+{
+  HeatWaveImage * img = new HeatWaveImage(0, 0, TEST_PIPE_WIDTH, 
+                                          TEST_PIPE_HEIGHT, SpcRGB, 3);
+  for ( SInt c = 0 ; c < 3 ; ++c ){
+    HeatWaveComponent & cmp = img->GetComponent(c);
+    for ( SInt y = 0 ; y < TEST_PIPE_HEIGHT ; ++y ){
+      for ( SInt x = 0 ; x < TEST_PIPE_WIDTH ; ++x ){
+        UInt32 h = (UInt32)((((f*3)+c)*1024)+(y*TEST_PIPE_WIDTH)+x);
+        cmp.SetSmpl(x, y, (Smpl)(((h*2654435761U) >> 24) & 0xFF));
+      }
+    }
+  }
+  img->GetComponent(0).SetSmpl(0, 0, (Smpl)f);
+  img->SetMinPrecSgn();
+  return img;
+}
+
+// produces the frames in turn
+class Test_FrameSource : public HeatWaveSource
+{
+public:
+  Test_FrameSource() { m_next = 0; }
+  virtual HeatWaveImage * GetNextFrame()
+  {
+    return (m_next < TEST_PIPE_FRAMES) ? New_Frame(m_next++) : NULL;
+  }
+private:
+  SInt m_next;
+};
+
+// True if both videos hold the same samples
+Bool
+Check_Videos(const HeatWaveVideo & lhs, const HeatWaveVideo & rhs)
+{
+  if ( lhs.GetImageN() != rhs.GetImageN() ){
+    return False;
+  }
+  for ( SInt i = 0 ; i < lhs.GetImageN() ; ++i ){
+    for ( SInt c = 0 ; c < lhs.GetImage(i).GetComponentN() ; ++c ){
+      HeatWaveComponent & a = lhs.GetComponent(i, c);
+      HeatWaveComponent & b = rhs.GetComponent(i, c);
+      for ( SInt y = 0 ; y < a.GetHeight() ; ++y ){
+        for ( SInt x = 0 ; x < a.GetWidth() ; ++x ){
+          if ( a.GetSmpl(x, y) != b.GetSmpl(x, y) ){
+            return False;
+          }
+        }
+      }
+    }
+  }
+  return True;
+}
+
+void
+TestHeatWavePipeline::setUp(void)
+{
+}
+
+void
+TestHeatWavePipeline::tearDown(void)
+{
+}
+
+void
+TestHeatWavePipeline::KeepsOrder(void)
+{
+  Test_FrameSource source;
+  HeatWaveVideo video;
+  HeatWaveVideoSink sink(video);
+  HeatWavePipeline pipe(TEST_PIPE_DEPTH);
+  pipe.SetSource(&source);
+  pipe.AddStage(&sink);
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_PIPE_FRAMES, pipe.DoRun());
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_PIPE_FRAMES, video.GetImageN());
+  for ( SInt f = 0 ; f < TEST_PIPE_FRAMES ; ++f ){
+    CPPUNIT_ASSERT_EQUAL ((Smpl)f, video.GetComponent(f, 0).GetSmpl(0, 0));
+  }
+}
+
+void
+TestHeatWavePipeline::MatchesSequential(void)
+{
+  // as -lv file gop=4 color=YUV spatial=2 temporal=2 transform=2_2
+  Test_FrameSource source;
+  HeatWaveColorStage color(SpcYUV, True);
+  HeatWaveSpatialStage spatial(Trn2_2, TEST_PIPE_LEVEL);
+  HeatWaveTemporalStage temporal(Trn2_2, TEST_PIPE_LEVEL, True, 
+                                 TEST_PIPE_GOP);
+  HeatWaveVideo piped;
+  HeatWaveVideoSink sink(piped);
+  HeatWavePipeline pipe(TEST_PIPE_DEPTH);
+  pipe.SetSource(&source);
+  pipe.AddStage(&color);
+  pipe.AddStage(&spatial);
+  pipe.AddStage(&temporal);
+  pipe.AddStage(&sink);
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_PIPE_FRAMES, pipe.DoRun());
+
+  // as -lv file -ct YUV -st 2 transform=2_2 -tt 2 transform=2_2 gop=4
+  HeatWaveVideo video;
+  for ( SInt f = 0 ; f < TEST_PIPE_FRAMES ; ++f ){
+    video.AddImage(New_Frame(f));
+  }
+  video.SetSpace(SpcYUV, False, -1, True);
+  video.DoSpatialTransform(Trn2_2, TEST_PIPE_LEVEL);
+  video.SetGrouping(TEST_PIPE_GOP);
+  video.DoTemporalTransform(Trn2_2, TEST_PIPE_LEVEL);
+  CPPUNIT_ASSERT (Check_Videos(piped, video));
+}
@@ -0,0 +1,120 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveQuantizer.cpp
+ * @brief  A test fixture for the HeatWaveQuantizer class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#include <TestHeatWaveQuantizer.hpp>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestHeatWaveQuantizer);
+
+// the rows are quantized whole, in vectors where there are any, and one
+// sample at a time, which only takes the scalar path
+#define TEST_QUANTIZER_STEPS 5
+#define TEST_QUANTIZER_SMPLS 64
+
+const SFloat64 testSteps[TEST_QUANTIZER_STEPS] = {49.0, 3.0, 10.0, 7.5, 1.5};
+
+// samples on and next to the bin boundaries of a step, both signs
+SInt
+Fill_Boundaries(Smpl * row, SFloat64 step)
+{
+  SInt num = 0;
+  for ( SInt k = 0 ; k < (TEST_QUANTIZER_SMPLS/6) ; ++k ){
+    Smpl b = (Smpl)(k*step);
+    row[num++] = b-1;
+    row[num++] = b;
+    row[num++] = b+1;
+    row[num++] = -(b-1);
+    row[num++] = -b;
+    row[num++] = -(b+1);
+  }
+  while ( num % 4 ){
+    row[num++] = 0;
+  }
+  return num;
+}
+
+void
+TestHeatWaveQuantizer::setUp(void)
+{
+}
+
+void
+TestHeatWaveQuantizer::tearDown(void)
+{
+}
+
+void
+TestHeatWaveQuantizer::QuantizeBoundaries(void)
+{
+  Smpl vec[TEST_QUANTIZER_SMPLS];
+  Smpl one[TEST_QUANTIZER_SMPLS];
+  for ( SInt s = 0 ; s < TEST_QUANTIZER_STEPS ; ++s ){
+    SInt num = Fill_Boundaries(vec, testSteps[s]);
+    memcpy(one, vec, num*sizeof(Smpl));
+    HeatWaveQuantizer::DoQuantize(vec, num, 1, num, testSteps[s]);
+    for ( SInt i = 0 ; i < num ; ++i ){
+      HeatWaveQuantizer::DoQuantize(one+i, 1, 1, 1, testSteps[s]);
+    }
+    for ( SInt i = 0 ; i < num ; ++i ){
+      CPPUNIT_ASSERT_EQUAL (one[i], vec[i]);
+    }
+    if ( testSteps[s] == (SFloat64)(SInt)testSteps[s] ){
+      // whole steps, the bins are exact
+      Fill_Boundaries(one, testSteps[s]);
+      SInt step = (SInt)testSteps[s];
+      for ( SInt i = 0 ; i < num ; ++i ){
+        Smpl mag = (one[i] < 0) ? -one[i] : one[i];
+        Smpl bin = (one[i] < 0) ? -(mag/step) : (mag/step);
+        CPPUNIT_ASSERT_EQUAL (bin, vec[i]);
+      }
+    }
+  }
+}
+
+void
+TestHeatWaveQuantizer::DequantizeBoundaries(void)
+{
+  Smpl vec[TEST_QUANTIZER_SMPLS];
+  Smpl one[TEST_QUANTIZER_SMPLS];
+  for ( SInt s = 0 ; s < TEST_QUANTIZER_STEPS ; ++s ){
+    SInt num = Fill_Boundaries(vec, testSteps[s]);
+    HeatWaveQuantizer::DoQuantize(vec, num, 1, num, testSteps[s]);
+    memcpy(one, vec, num*sizeof(Smpl));
+    HeatWaveQuantizer::DoDequantize(vec, num, 1, num, testSteps[s]);
+    for ( SInt i = 0 ; i < num ; ++i ){
+      HeatWaveQuantizer::DoDequantize(one+i, 1, 1, 1, testSteps[s]);
+    }
+    for ( SInt i = 0 ; i < num ; ++i ){
+      CPPUNIT_ASSERT_EQUAL (one[i], vec[i]);
+    }
+  }
+}
+
+void
+TestHeatWaveQuantizer::StepOneKeeps(void)
+{
+  const SInt width = 37;
+  const SInt height = 21;
+  HeatWaveComponent cmp(0, 0, 1, 1, width, height, True, 12, ClrY);
+  for ( SInt y = 0 ; y < height ; ++y ){
+    for ( SInt x = 0 ; x < width ; ++x ){
+      cmp.SetSmpl(x, y, (Smpl)(((x*31)+(y*17)) % 4001)-2000);
+    }
+  }
+  HeatWaveComponent org(cmp);
+  cmp.DoPyramidTransform(Trn9m7, 3);
+  HeatWaveQuantizer qnt(1.0);
+  qnt.DoQuantize(cmp);
+  qnt.DoDequantize(cmp);
+  cmp.DoPyramidTransform(Trn9m7, 0, False);
+  for ( SInt y = 0 ; y < height ; ++y ){
+    for ( SInt x = 0 ; x < width ; ++x ){
+      CPPUNIT_ASSERT_EQUAL (org.GetSmpl(x, y), cmp.GetSmpl(x, y));
+    }
+  }
+}
@@ -0,0 +1,129 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveResampler.cpp
+ * @brief  A test fixture for the HeatWaveResampler class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#include <TestHeatWaveResampler.hpp>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestHeatWaveResampler);
+
+// local variables, the long side is a multiple of 1 << TEST_RSMP_OCTAVES
+#define TEST_RSMP_LONG 96
+#define TEST_RSMP_SHORT 7
+#define TEST_RSMP_OCTAVES 2
+
+// a component of hashed 8-bit samples
+HeatWaveComponent *
+New_Rsmp(SInt width, SInt height)
+{
+  HeatWaveComponent * cmp;
+  cmp = new HeatWaveComponent(0, 0, 1, 1, width, height, False, 8, ClrY);
+  for ( SInt y = 0 ; y < height ; ++y ){
+    for ( SInt x = 0 ; x < width ; ++x ){
+      UInt32 h = (UInt32)((y*width)+x)*2654435761U;
+      cmp->SetSmpl(x, y, (Smpl)((h >> 24) & 0xFF));
+    }
+  }
+  return cmp;
+}
+
+// the resampling as SetHStep() and SetVStep() did it before the resampler,
+// a transform and resize of the whole component per octave
+void
+Do_OldResample(HeatWaveComponent & cmp, EnumTransform trn, Bool hor, 
+               SInt oct)
+{
+  for ( SInt i = 0 ; i < oct ; ++i ){
+    SInt width = cmp.GetWidth();
+    SInt height = cmp.GetHeight();
+    cmp.DoTransform(True, trn, 0, 0, width, height, True, True, !hor, hor,
+                    True);
+    cmp.DoResize(hor ? (width/2) : width, hor ? height : (height/2), True, 0,
+                 True);
+  }
+  for ( SInt i = 0 ; i > oct ; --i ){
+    SInt width = cmp.GetWidth()*(hor ? 2 : 1);
+    SInt height = cmp.GetHeight()*(hor ? 1 : 2);
+    cmp.DoResize(width, height, True, 0, True);
+    cmp.DoTransform(False, trn, 0, 0, width, height, True, True, !hor, hor,
+                    True);
+  }
+}
+
+// True if the samples and sizes are the same
+Bool
+Check_Rsmp(const HeatWaveComponent & lhs, const HeatWaveComponent & rhs)
+{
+  if ( (lhs.GetWidth() != rhs.GetWidth()) ||
+       (lhs.GetHeight() != rhs.GetHeight()) ){
+    return False;
+  }
+  for ( SInt y = 0 ; y < lhs.GetHeight() ; ++y ){
+    for ( SInt x = 0 ; x < lhs.GetWidth() ; ++x ){
+      if ( lhs.GetSmpl(x, y) != rhs.GetSmpl(x, y) ){
+        return False;
+      }
+    }
+  }
+  return True;
+}
+
+// True if reducing by the sampling period and increasing back give the same
+// samples as the old path, with the row kernels and a generic transform
+Bool
+Check_Resample(SInt width, SInt height, Bool hor)
+{
+  EnumTransform trns[] = { Trn2_2, Trn4_4 };
+  SInt step = 1 << TEST_RSMP_OCTAVES;
+  Bool check = True;
+  for ( SInt t = 0 ; t < 2 ; ++t ){
+    HeatWaveComponent * cmp = New_Rsmp(width, height);
+    HeatWaveComponent * old = New_Rsmp(width, height);
+    if ( hor ){
+      cmp->SetHStep(step, True, trns[t]);
+    }
+    else{
+      cmp->SetVStep(step, True, trns[t]);
+    }
+    Do_OldResample(*old, trns[t], hor, TEST_RSMP_OCTAVES);
+    check &= Check_Rsmp(*cmp, *old);
+    if ( hor ){
+      cmp->SetHStep(1, True, trns[t]);
+    }
+    else{
+      cmp->SetVStep(1, True, trns[t]);
+    }
+    Do_OldResample(*old, trns[t], hor, -TEST_RSMP_OCTAVES);
+    check &= Check_Rsmp(*cmp, *old);
+    check &= (cmp->GetWidth() == width) && (cmp->GetHeight() == height);
+    delete cmp;
+    delete old;
+  }
+  return check;
+}
+
+void
+TestHeatWaveResampler::setUp(void)
+{
+}
+
+void
+TestHeatWaveResampler::tearDown(void)
+{
+}
+
+void
+TestHeatWaveResampler::MatchWide(void)
+{
+  CPPUNIT_ASSERT (Check_Resample(TEST_RSMP_LONG, TEST_RSMP_SHORT, True));
+}
+
+void
+TestHeatWaveResampler::MatchTall(void)
+{
+  CPPUNIT_ASSERT (Check_Resample(TEST_RSMP_SHORT, TEST_RSMP_LONG, False));
+}
@@ -0,0 +1,155 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestHeatWaveVideo.cpp
+ * @brief  A test fixture for the scene detection and grouping of the
+ *         HeatWaveVideo class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#include <TestHeatWaveVideo.hpp>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestHeatWaveVideo);
+
+// local variables, a dark scene then a hard cut to a bright one
+#define TEST_VID_WIDTH 32
+#define TEST_VID_HEIGHT 24
+#define TEST_VID_FRAMES 10
+#define TEST_VID_CUT 6
+#define TEST_VID_GOP 4
+#define TEST_VID_LEVEL 2
+#define TEST_VID_THREADS 3
+
+// a grey frame, a slowly brightening level plus hashed noise in 0..7
+HeatWaveImage *
+New_Scene(SInt f)
+{
+  HeatWaveImage * img = new HeatWaveImage(0, 0, TEST_VID_WIDTH, 
+                                          TEST_VID_HEIGHT, SpcGrey, 1);
+  SInt base = ((f < TEST_VID_CUT) ? 40 : 200) + f;
+  HeatWaveComponent & cmp = img->GetComponent(0);
+  for ( SInt y = 0 ; y < TEST_VID_HEIGHT ; ++y ){
+    for ( SInt x = 0 ; x < TEST_VID_WIDTH ; ++x ){
+      UInt32 h = (UInt32)((f*4096)+(y*TEST_VID_WIDTH)+x)*2654435761U;
+      cmp.SetSmpl(x, y, (Smpl)(base + (SInt)(h >> 29)));
+    }
+  }
+  img->SetMinPrecSgn();
+  return img;
+}
+
+HeatWaveVideo *
+New_Scenes()
+{
+  HeatWaveVideo * vid = new HeatWaveVideo();
+  for ( SInt f = 0 ; f < TEST_VID_FRAMES ; ++f ){
+    vid->AddImage(New_Scene(f));
+  }
+  return vid;
+}
+
+// True if both videos hold the same samples
+Bool
+Check_Scenes(const HeatWaveVideo & lhs, const HeatWaveVideo & rhs)
+{
+  if ( lhs.GetImageN() != rhs.GetImageN() ){
+    return False;
+  }
+  for ( SInt f = 0 ; f < lhs.GetImageN() ; ++f ){
+    HeatWaveComponent & a = lhs.GetComponent(f, 0);
+    HeatWaveComponent & b = rhs.GetComponent(f, 0);
+    for ( SInt y = 0 ; y < TEST_VID_HEIGHT ; ++y ){
+      for ( SInt x = 0 ; x < TEST_VID_WIDTH ; ++x ){
+        if ( a.GetSmpl(x, y) != b.GetSmpl(x, y) ){
+          return False;
+        }
+      }
+    }
+  }
+  return True;
+}
+
+void
+TestHeatWaveVideo::setUp(void)
+{
+}
+
+void
+TestHeatWaveVideo::tearDown(void)
+{
+}
+
+void
+TestHeatWaveVideo::SceneCut(void)
+{
+  HeatWaveVideo * vid = New_Scenes();
+  CPPUNIT_ASSERT_EQUAL ((SInt)2, vid->DoSceneDetection());
+  for ( SInt f = 0 ; f < TEST_VID_FRAMES ; ++f ){
+    CPPUNIT_ASSERT_EQUAL ((f == 0) || (f == TEST_VID_CUT),
+                          vid->GetImage(f).GetSceneSwitch());
+  }
+  delete vid;
+}
+
+void
+TestHeatWaveVideo::Groups(void)
+{
+  HeatWaveVideo * vid = New_Scenes();
+  SInt strt = -1;
+  SInt len = -1;
+
+  // no cut and no limit, a single group
+  CPPUNIT_ASSERT_EQUAL ((SInt)1, vid->GetGroupCount());
+
+  // split at the cut and after every TEST_VID_GOP images
+  vid->DoSceneDetection();
+  vid->SetGrouping(TEST_VID_GOP);
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_VID_GOP, vid->GetGroupLength());
+  CPPUNIT_ASSERT_EQUAL ((SInt)3, vid->GetGroupCount());
+  CPPUNIT_ASSERT (vid->GetGroupInfo(0, strt, len));
+  CPPUNIT_ASSERT_EQUAL ((SInt)0, strt);
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_VID_GOP, len);
+  CPPUNIT_ASSERT (vid->GetGroupInfo(1, strt, len));
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_VID_GOP, strt);
+  CPPUNIT_ASSERT_EQUAL ((SInt)(TEST_VID_CUT-TEST_VID_GOP), len);
+  CPPUNIT_ASSERT (vid->GetGroupInfo(2, strt, len));
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_VID_CUT, strt);
+  CPPUNIT_ASSERT_EQUAL ((SInt)(TEST_VID_FRAMES-TEST_VID_CUT), len);
+  CPPUNIT_ASSERT (!vid->GetGroupInfo(3, strt, len));
+  CPPUNIT_ASSERT (!vid->GetGroupInfo(-1, strt, len));
+
+  // only the cut
+  vid->SetGrouping(0);
+  CPPUNIT_ASSERT_EQUAL ((SInt)2, vid->GetGroupCount());
+  CPPUNIT_ASSERT (vid->GetGroupInfo(1, strt, len));
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_VID_CUT, strt);
+  delete vid;
+}
+
+void
+TestHeatWaveVideo::GroupedRoundTrip(void)
+{
+  HeatWaveWorkerPool pool(TEST_VID_THREADS);
+  HeatWaveVideo * vid = New_Scenes();
+  HeatWaveVideo * seq = New_Scenes();
+  HeatWaveVideo * org = New_Scenes();
+  vid->DoSceneDetection();
+  seq->DoSceneDetection();
+
+  // the groups on the pool give the same coefficients as one after another
+  vid->SetGrouping(TEST_VID_GOP, &pool);
+  seq->SetGrouping(TEST_VID_GOP);
+  CPPUNIT_ASSERT_EQUAL ((SInt)TEST_VID_LEVEL, 
+                        vid->DoTemporalTransform(Trn2_2, TEST_VID_LEVEL));
+  seq->DoTemporalTransform(Trn2_2, TEST_VID_LEVEL);
+  CPPUNIT_ASSERT (Check_Scenes(*vid, *seq));
+  CPPUNIT_ASSERT (!Check_Scenes(*vid, *org));
+
+  // and come back exactly
+  CPPUNIT_ASSERT_EQUAL ((SInt)0, vid->DoTemporalTransform(Trn2_2, 0, False));
+  CPPUNIT_ASSERT (Check_Scenes(*vid, *org));
+  delete vid;
+  delete seq;
+  delete org;
+}
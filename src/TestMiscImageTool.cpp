@@ -0,0 +1,291 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestMiscImageTool.cpp
+ * @brief  A test fixture for the MiscImageTool class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ * 
+ **/
+
+#include <TestMiscImageTool.hpp>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestMiscImageTool);
+
+// local variables
+#define TEST_IMG_WIDTH 19
+#define TEST_IMG_HEIGHT 11
+#define TEST_IMG_FILE "TestMiscImageTool.jp2"
+#define TEST_IMG_JPEG "TestMiscImageTool.jpg"
+#define TEST_IMG_JPEGWIDTH 21
+#define TEST_IMG_JPEGHEIGHT 13
+
+static Bool testJasInit = False;
+
+// 21x13 YCbCr with 4:2:0 sampling (luma 2x2, chroma 1x1)
+static const UInt8 testJpegYUV[] = {
+  0xff, 0xd8, 0xff, 0xe0, 0x00, 0x10, 0x4a, 0x46, 0x49, 0x46, 0x00, 0x01,
+  0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0xff, 0xdb, 0x00, 0x43,
+  0x00, 0x08, 0x06, 0x06, 0x07, 0x06, 0x05, 0x08, 0x07, 0x07, 0x07, 0x09,
+  0x09, 0x08, 0x0a, 0x0c, 0x14, 0x0d, 0x0c, 0x0b, 0x0b, 0x0c, 0x19, 0x12,
+  0x13, 0x0f, 0x14, 0x1d, 0x1a, 0x1f, 0x1e, 0x1d, 0x1a, 0x1c, 0x1c, 0x20,
+  0x24, 0x2e, 0x27, 0x20, 0x22, 0x2c, 0x23, 0x1c, 0x1c, 0x28, 0x37, 0x29,
+  0x2c, 0x30, 0x31, 0x34, 0x34, 0x34, 0x1f, 0x27, 0x39, 0x3d, 0x38, 0x32,
+  0x3c, 0x2e, 0x33, 0x34, 0x32, 0xff, 0xdb, 0x00, 0x43, 0x01, 0x09, 0x09,
+  0x09, 0x0c, 0x0b, 0x0c, 0x18, 0x0d, 0x0d, 0x18, 0x32, 0x21, 0x1c, 0x21,
+  0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32,
+  0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32,
+  0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32,
+  0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32,
+  0x32, 0x32, 0xff, 0xc0, 0x00, 0x11, 0x08, 0x00, 0x0d, 0x00, 0x15, 0x03,
+  0x01, 0x22, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01, 0xff, 0xc4, 0x00,
+  0x17, 0x00, 0x00, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x05, 0x06, 0xff, 0xc4,
+  0x00, 0x1b, 0x10, 0x00, 0x02, 0x02, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x02, 0x03, 0x11,
+  0x21, 0x61, 0x31, 0xff, 0xc4, 0x00, 0x17, 0x01, 0x00, 0x03, 0x01, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x02, 0x04, 0x05, 0x06, 0xff, 0xc4, 0x00, 0x19, 0x11, 0x00, 0x03, 0x01,
+  0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x01, 0x04, 0x02, 0x11, 0x21, 0xff, 0xda, 0x00, 0x0c, 0x03,
+  0x01, 0x00, 0x02, 0x11, 0x03, 0x11, 0x00, 0x3f, 0x00, 0x91, 0x5a, 0x3c,
+  0x1c, 0xad, 0x1e, 0x15, 0x2b, 0x5e, 0x03, 0x95, 0xaf, 0x00, 0x6a, 0xb5,
+  0x8a, 0x45, 0x5b, 0xf0, 0x93, 0x04, 0x75, 0xe0, 0x1a, 0x18, 0x2f, 0x0c,
+  0x01, 0x17, 0x56, 0xbe, 0x9a, 0x2c, 0xd6, 0xf8, 0x8f, 0xff, 0xd9
+};
+
+// 21x13 grey
+static const UInt8 testJpegGrey[] = {
+  0xff, 0xd8, 0xff, 0xe0, 0x00, 0x10, 0x4a, 0x46, 0x49, 0x46, 0x00, 0x01,
+  0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0xff, 0xdb, 0x00, 0x43,
+  0x00, 0x08, 0x06, 0x06, 0x07, 0x06, 0x05, 0x08, 0x07, 0x07, 0x07, 0x09,
+  0x09, 0x08, 0x0a, 0x0c, 0x14, 0x0d, 0x0c, 0x0b, 0x0b, 0x0c, 0x19, 0x12,
+  0x13, 0x0f, 0x14, 0x1d, 0x1a, 0x1f, 0x1e, 0x1d, 0x1a, 0x1c, 0x1c, 0x20,
+  0x24, 0x2e, 0x27, 0x20, 0x22, 0x2c, 0x23, 0x1c, 0x1c, 0x28, 0x37, 0x29,
+  0x2c, 0x30, 0x31, 0x34, 0x34, 0x34, 0x1f, 0x27, 0x39, 0x3d, 0x38, 0x32,
+  0x3c, 0x2e, 0x33, 0x34, 0x32, 0xff, 0xc0, 0x00, 0x0b, 0x08, 0x00, 0x0d,
+  0x00, 0x15, 0x01, 0x01, 0x11, 0x00, 0xff, 0xc4, 0x00, 0x14, 0x00, 0x01,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x06, 0xff, 0xc4, 0x00, 0x1b, 0x10, 0x00, 0x02, 0x03,
+  0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x04, 0x02, 0x03, 0x21, 0x31, 0x13, 0x23, 0xff, 0xda, 0x00,
+  0x08, 0x01, 0x01, 0x00, 0x00, 0x3f, 0x00, 0x1c, 0x82, 0x7c, 0xc1, 0x42,
+  0x09, 0xf3, 0x04, 0xab, 0x27, 0xf3, 0xe0, 0x3d, 0x0a, 0x21, 0x82, 0x94,
+  0x28, 0x86, 0x09, 0x16, 0xa2, 0x1e, 0x67, 0xff, 0xd9
+};
+
+// 21x13 stored as RGB, which has no raw YCbCr
+static const UInt8 testJpegRGB[] = {
+  0xff, 0xd8, 0xff, 0xee, 0x00, 0x0e, 0x41, 0x64, 0x6f, 0x62, 0x65, 0x00,
+  0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xdb, 0x00, 0x43, 0x00, 0x08,
+  0x06, 0x06, 0x07, 0x06, 0x05, 0x08, 0x07, 0x07, 0x07, 0x09, 0x09, 0x08,
+  0x0a, 0x0c, 0x14, 0x0d, 0x0c, 0x0b, 0x0b, 0x0c, 0x19, 0x12, 0x13, 0x0f,
+  0x14, 0x1d, 0x1a, 0x1f, 0x1e, 0x1d, 0x1a, 0x1c, 0x1c, 0x20, 0x24, 0x2e,
+  0x27, 0x20, 0x22, 0x2c, 0x23, 0x1c, 0x1c, 0x28, 0x37, 0x29, 0x2c, 0x30,
+  0x31, 0x34, 0x34, 0x34, 0x1f, 0x27, 0x39, 0x3d, 0x38, 0x32, 0x3c, 0x2e,
+  0x33, 0x34, 0x32, 0xff, 0xc0, 0x00, 0x11, 0x08, 0x00, 0x0d, 0x00, 0x15,
+  0x03, 0x52, 0x11, 0x00, 0x47, 0x11, 0x00, 0x42, 0x11, 0x00, 0xff, 0xc4,
+  0x00, 0x18, 0x00, 0x00, 0x03, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x06, 0x04, 0x07,
+  0xff, 0xc4, 0x00, 0x21, 0x10, 0x00, 0x01, 0x02, 0x05, 0x05, 0x01, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x04,
+  0x01, 0x05, 0x14, 0x21, 0x41, 0x12, 0x15, 0x31, 0x33, 0x62, 0x22, 0xff,
+  0xda, 0x00, 0x0c, 0x03, 0x52, 0x00, 0x47, 0x00, 0x42, 0x00, 0x00, 0x3f,
+  0x00, 0x94, 0x96, 0xe0, 0x57, 0xb3, 0xf9, 0x37, 0xb9, 0x5b, 0x9b, 0x96,
+  0x12, 0xdc, 0x06, 0xcf, 0xe4, 0x4c, 0xe5, 0x6e, 0x6e, 0x56, 0x34, 0xea,
+  0x0d, 0x9f, 0xc8, 0xa9, 0x55, 0xbe, 0xf9, 0x39, 0x1c, 0xb7, 0x05, 0xd5,
+  0x02, 0x43, 0xf7, 0x2a, 0x46, 0xe5, 0x84, 0xb7, 0x01, 0x40, 0x90, 0x9d,
+  0xca, 0x91, 0xb9, 0x58, 0xd3, 0xa8, 0x28, 0x12, 0x14, 0xaa, 0xa4, 0x75,
+  0x9f, 0xff, 0xd9
+};
+
+// write a embedded JPEG to the test file
+void
+Put_Jpeg(const UInt8 * data, SInt len)
+{
+  FILE * out = fopen(TEST_IMG_JPEG, "wb");
+  CPPUNIT_ASSERT (out != NULL);
+  CPPUNIT_ASSERT_EQUAL ((size_t)len, fwrite(data, 1, len, out));
+  fclose(out);
+}
+
+// True if a component has the given steps and size
+Bool
+Is_Geometry(const HeatWaveComponent & cmp, SInt hst, SInt vst, SInt width,
+            SInt height)
+{
+  return ( (cmp.GetHStep() == hst) && (cmp.GetVStep() == vst) &&
+           (cmp.GetWidth() == width) && (cmp.GetHeight() == height) );
+}
+
+void
+TestMiscImageTool::setUp(void)
+{
+  if ( !testJasInit ){
+    jas_init();
+    testJasInit = True;
+  }
+  imgA = new HeatWaveImage(0, 0, TEST_IMG_WIDTH, TEST_IMG_HEIGHT, SpcRGB, 3);
+  for ( SInt c = 0 ; c < 3 ; ++c ){
+    HeatWaveComponent & cmp = imgA->GetComponent(c);
+    cmp.SetPrec(8);
+    cmp.SetSgnd(False);
+    for ( SInt y = 0 ; y < TEST_IMG_HEIGHT ; ++y ){
+      for ( SInt x = 0 ; x < TEST_IMG_WIDTH ; ++x ){
+        cmp.SetSmpl(x, y, (Smpl)(((x*13)+(y*7)+(c*50)) & 0xFF));
+      }
+    }
+  }
+}
+
+void
+TestMiscImageTool::tearDown(void)
+{
+  delete imgA;
+  remove(TEST_IMG_FILE);
+  remove(TEST_IMG_JPEG);
+}
+
+void
+TestMiscImageTool::DoRoundTrip(const HeatWaveImage & img)
+{
+  MiscImageTool tool;
+  CPPUNIT_ASSERT (tool.WriteImage(img, TEST_IMG_FILE, "jp2", NULL, False));
+  HeatWaveImage * back = tool.ReadImage(TEST_IMG_FILE, "jp2", NULL);
+  CPPUNIT_ASSERT (back != NULL);
+  CPPUNIT_ASSERT_EQUAL ((SInt)3, back->GetComponentN());
+  Bool check = True;
+  for ( SInt c = 0 ; c < 3 ; ++c ){
+    const HeatWaveComponent & cmp = img.GetComponent(c);
+    const HeatWaveComponent & chk = back->GetComponent(c);
+    check &= (chk.GetWidth() == TEST_IMG_WIDTH);
+    check &= (chk.GetHeight() == TEST_IMG_HEIGHT);
+    for ( SInt y = 0 ; check && (y < TEST_IMG_HEIGHT) ; ++y ){
+      for ( SInt x = 0 ; x < TEST_IMG_WIDTH ; ++x ){
+        check &= (chk.GetSmpl(x, y) == cmp.GetSmpl(x, y));
+      }
+    }
+  }
+  delete back;
+  CPPUNIT_ASSERT (check);
+}
+
+void
+TestMiscImageTool::SaveJasper(void)
+{
+  DoRoundTrip(*imgA);
+}
+
+void
+TestMiscImageTool::SaveJasperPacked(void)
+{
+  CPPUNIT_ASSERT (imgA->DoPack());
+  CPPUNIT_ASSERT (imgA->GetComponent(0).IsPacked());
+  DoRoundTrip(*imgA);
+  // a copy shares the packed storage
+  HeatWaveImage imgB(*imgA);
+  DoRoundTrip(imgB);
+  CPPUNIT_ASSERT (imgA->GetComponent(0).IsPacked());
+  CPPUNIT_ASSERT (imgB.GetComponent(0).IsPacked());
+}
+
+void
+TestMiscImageTool::ReadJPEGScale(void)
+{
+  MiscImageTool tool;
+  for ( SInt scale = 1 ; scale <= 8 ; scale *= 2 ){
+    // luma rounds up at each scale
+    SInt width = (TEST_IMG_JPEGWIDTH+scale-1)/scale;
+    SInt height = (TEST_IMG_JPEGHEIGHT+scale-1)/scale;
+    Put_Jpeg(testJpegYUV, sizeof(testJpegYUV));
+    HeatWaveImage * img = tool.ReadJPEG(TEST_IMG_JPEG, scale, True);
+    CPPUNIT_ASSERT (img != NULL);
+    CPPUNIT_ASSERT_EQUAL ((SInt)3, img->GetComponentN());
+    CPPUNIT_ASSERT (img->GetSpace() == SpcYUV);
+    CPPUNIT_ASSERT (Is_Geometry(img->GetComponent(0), 1, 1, width, height));
+    // chroma is halved unscaled, but may be scaled less than luma so that
+    // the step depends on the library, it must still cover the luma
+    SInt step = img->GetComponent(1).GetHStep();
+    CPPUNIT_ASSERT ((step == 2) || ((step == 1) && (scale > 1)));
+    for ( SInt c = 1 ; c < 3 ; ++c ){
+      CPPUNIT_ASSERT (Is_Geometry(img->GetComponent(c), step, step,
+                                  (width+step-1)/step,
+                                  (height+step-1)/step));
+    }
+    delete img;
+    img = tool.ReadJPEG(TEST_IMG_JPEG, scale, False);
+    CPPUNIT_ASSERT (img != NULL);
+    CPPUNIT_ASSERT_EQUAL ((SInt)3, img->GetComponentN());
+    for ( SInt c = 0 ; c < 3 ; ++c ){
+      CPPUNIT_ASSERT (Is_Geometry(img->GetComponent(c), 1, 1, width,
+                                  height));
+    }
+    delete img;
+    Put_Jpeg(testJpegGrey, sizeof(testJpegGrey));
+    img = tool.ReadJPEG(TEST_IMG_JPEG, scale, True);
+    CPPUNIT_ASSERT (img != NULL);
+    CPPUNIT_ASSERT_EQUAL ((SInt)1, img->GetComponentN());
+    CPPUNIT_ASSERT (img->GetSpace() == SpcGrey);
+    CPPUNIT_ASSERT (Is_Geometry(img->GetComponent(0), 1, 1, width, height));
+    delete img;
+  }
+  CPPUNIT_ASSERT (tool.ReadJPEG(TEST_IMG_JPEG, 3, True) == NULL);
+}
+
+void
+TestMiscImageTool::ReadJPEGRaw(void)
+{
+  MiscImageTool tool;
+  // raw grey is what the scanlines give
+  Put_Jpeg(testJpegGrey, sizeof(testJpegGrey));
+  HeatWaveImage * raw = tool.ReadJPEG(TEST_IMG_JPEG, 2, True);
+  HeatWaveImage * scan = tool.ReadJPEG(TEST_IMG_JPEG, 2, False);
+  CPPUNIT_ASSERT ((raw != NULL) && (scan != NULL));
+  const HeatWaveComponent & grey = raw->GetComponent(0);
+  Bool check = True;
+  for ( SInt y = 0 ; y < grey.GetHeight() ; ++y ){
+    for ( SInt x = 0 ; x < grey.GetWidth() ; ++x ){
+      check &= (grey.GetSmpl(x, y) == scan->GetComponent(0).GetSmpl(x, y));
+    }
+  }
+  CPPUNIT_ASSERT (check);
+  delete raw;
+  delete scan;
+
+  // raw luma is the luma of the converted RGB, up to rounding
+  Put_Jpeg(testJpegYUV, sizeof(testJpegYUV));
+  raw = tool.ReadJPEG(TEST_IMG_JPEG, 1, True);
+  scan = tool.ReadJPEG(TEST_IMG_JPEG, 1, False);
+  CPPUNIT_ASSERT ((raw != NULL) && (scan != NULL));
+  const HeatWaveComponent & luma = raw->GetComponent(0);
+  for ( SInt y = 0 ; y < TEST_IMG_JPEGHEIGHT ; ++y ){
+    for ( SInt x = 0 ; x < TEST_IMG_JPEGWIDTH ; ++x ){
+      SFloat64 rgb = 0.299*scan->GetComponent(0).GetSmpl(x, y) +
+        0.587*scan->GetComponent(1).GetSmpl(x, y) +
+        0.114*scan->GetComponent(2).GetSmpl(x, y);
+      check &= (fabs(rgb-luma.GetSmpl(x, y)) < 2.0);
+    }
+  }
+  CPPUNIT_ASSERT (check);
+  delete raw;
+  delete scan;
+}
+
+void
+TestMiscImageTool::ReadJPEGFallback(void)
+{
+  MiscImageTool tool;
+  // no raw YCbCr in a RGB JPEG, so full size RGB comes back
+  Put_Jpeg(testJpegRGB, sizeof(testJpegRGB));
+  HeatWaveImage * img = tool.ReadJPEG(TEST_IMG_JPEG, 2, True);
+  CPPUNIT_ASSERT (img != NULL);
+  CPPUNIT_ASSERT_EQUAL ((SInt)3, img->GetComponentN());
+  CPPUNIT_ASSERT (img->GetSpace() == SpcRGB);
+  const EnumColor clrs[3] = { ClrRed, ClrGreen, ClrBlue };
+  for ( SInt c = 0 ; c < 3 ; ++c ){
+    CPPUNIT_ASSERT (img->GetComponent(c).GetColor() == clrs[c]);
+    CPPUNIT_ASSERT (Is_Geometry(img->GetComponent(c), 1, 1,
+                                (TEST_IMG_JPEGWIDTH+1)/2,
+                                (TEST_IMG_JPEGHEIGHT+1)/2));
+  }
+  delete img;
+}
@@ -0,0 +1,148 @@
+/****************************************************************************/
+/**
+ *
+ * @file   TestMiscTool.cpp
+ * @brief  A test fixture for the MiscTool class.
+ * @author Johan Hendrik Ehlers <johanhendrikehlers@gmail.com>
+ *
+ **/
+
+#include <TestMiscTool.hpp>
+#include <HeatWaveImageFile.hpp>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TestMiscTool);
+
+// local variables
+#define TEST_TOOL_SCRIPT "TestMiscTool.bts"
+#define TEST_TOOL_LIST "TestMiscTool.lst"
+#define TEST_TOOL_REPORT "TestMiscTool.csv"
+#define TEST_TOOL_ERRORS "TestMiscTool.err"
+#define TEST_TOOL_FILES 2
+
+static const Char * testToolFile[TEST_TOOL_FILES] =
+  { "TestMiscTool0.pgm", "TestMiscTool1.pgm" };
+static const SInt testToolWidth[TEST_TOOL_FILES] = { 13, 6 };
+static const Char * testToolNames[] = { "TestMiscTool", NULL };
+static const Char * testToolEmpty[] = { NULL };
+
+// write a text file
+void
+Put_Text(const Char * file, const Char * text)
+{
+  FILE * out = fopen(file, "wt");
+  CPPUNIT_ASSERT (out != NULL);
+  fputs(text, out);
+  fclose(out);
+}
+
+// run a batch over the list, True if the tool reports success
+Bool
+Do_Batch(const Char * list)
+{
+  Put_Text(TEST_TOOL_LIST, list);
+  MiscTool tool(testToolNames, testToolEmpty, testToolEmpty, testToolEmpty,
+                testToolEmpty, "", "", 1, "", 78, False, NULL, NULL,
+                TEST_TOOL_ERRORS);
+  const Char * argv[] = { "TestMiscTool", "-bt", TEST_TOOL_SCRIPT,
+                          "list=" TEST_TOOL_LIST, "threads=2",
+                          "report=" TEST_TOOL_REPORT };
+  // like MiscTool::DoBatchFile(), DoArguments() gives True on errors
+  return !tool.DoArguments(sizeof(argv)/sizeof(argv[0]), argv);
+}
+
+// get the report line of a file index, False if there is none
+Bool
+Get_ReportLine(SInt indx, Char * line, SInt len)
+{
+  FILE * in = fopen(TEST_TOOL_REPORT, "rt");
+  CPPUNIT_ASSERT (in != NULL);
+  Char pre[16];
+  sprintf(pre, "%d,", indx);
+  Bool found = False;
+  while ( !found && fgets(line, len, in) ){
+    found = (strncmp(line, pre, strlen(pre)) == 0);
+  }
+  fclose(in);
+  return found;
+}
+
+void
+TestMiscTool::setUp(void)
+{
+  for ( SInt f = 0 ; f < TEST_TOOL_FILES ; ++f ){
+    HeatWaveImage img(0, 0, testToolWidth[f], 5, SpcGrey, 1);
+    img.GetComponent(0).SetPrec(8);
+    img.GetComponent(0).SetSgnd(False);
+    const Char * errm = NULL;
+    CPPUNIT_ASSERT (HeatWaveImageFile::DoWrite(img, testToolFile[f], NULL,
+                                               errm));
+  }
+  // one line, the comment is skipped
+  Put_Text(TEST_TOOL_SCRIPT, "-l %f -i # describe %b\n");
+}
+
+void
+TestMiscTool::tearDown(void)
+{
+  for ( SInt f = 0 ; f < TEST_TOOL_FILES ; ++f ){
+    remove(testToolFile[f]);
+  }
+  remove(TEST_TOOL_SCRIPT);
+  remove(TEST_TOOL_LIST);
+  remove(TEST_TOOL_REPORT);
+  remove(TEST_TOOL_ERRORS);
+}
+
+void
+TestMiscTool::BatchReport(void)
+{
+  Char list[256];
+  sprintf(list, "%s\n# skipped\n\n%s\n", testToolFile[0], testToolFile[1]);
+  CPPUNIT_ASSERT (Do_Batch(list));
+
+  // a header and a line per file, in the order they finished
+  Char line[4096];
+  FILE * in = fopen(TEST_TOOL_REPORT, "rt");
+  CPPUNIT_ASSERT (in != NULL);
+  SInt lines = 0;
+  while ( fgets(line, sizeof(line), in) ){
+    if ( lines++ == 0 ){
+      CPPUNIT_ASSERT (strcmp(line,
+                      "index,file,status,msec,images,results,error\n") == 0);
+    }
+  }
+  fclose(in);
+  CPPUNIT_ASSERT_EQUAL ((SInt)(TEST_TOOL_FILES+1), lines);
+  for ( SInt f = 0 ; f < TEST_TOOL_FILES ; ++f ){
+    CPPUNIT_ASSERT (Get_ReportLine(f, line, sizeof(line)));
+    Char pre[64];
+    sprintf(pre, "%d,%s,ok,", f, testToolFile[f]);
+    CPPUNIT_ASSERT (strncmp(line, pre, strlen(pre)) == 0);
+    // msec, one image, the results of -i and no error
+    SFloat64 msec = -1;
+    SInt imgn = 0, used = 0;
+    CPPUNIT_ASSERT (sscanf(line+strlen(pre), "%lf,%d,%n", &msec, &imgn,
+                           &used) == 2);
+    CPPUNIT_ASSERT (msec >= 0);
+    CPPUNIT_ASSERT_EQUAL ((SInt)1, imgn);
+    Char width[64];
+    sprintf(width, "Image[0] width: %d |", testToolWidth[f]);
+    CPPUNIT_ASSERT (strstr(line+strlen(pre)+used, width) != NULL);
+    CPPUNIT_ASSERT (strcmp(line+strlen(line)-2, ",\n") == 0);
+  }
+}
+
+void
+TestMiscTool::BatchFailure(void)
+{
+  // a missing file fails on its own, and so the batch
+  Char list[256];
+  sprintf(list, "%s\nTestMiscTool.missing.pgm\n", testToolFile[0]);
+  CPPUNIT_ASSERT (!Do_Batch(list));
+  Char line[4096];
+  CPPUNIT_ASSERT (Get_ReportLine(0, line, sizeof(line)));
+  CPPUNIT_ASSERT (strstr(line, ",ok,") != NULL);
+  CPPUNIT_ASSERT (Get_ReportLine(1, line, sizeof(line)));
+  CPPUNIT_ASSERT (strstr(line, ",failed,") != NULL);
+  CPPUNIT_ASSERT (strcmp(line+strlen(line)-2, ",\n") != 0);
+}